@@ -0,0 +1,207 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/audio/batched_spectrogram.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "pffft.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Factor to convert ln(SQUARED_MAGNITUDE) to deciBels = 10.0/ln(10.0).
+constexpr float kLnSquaredMagnitudeToDb = 4.342944819032518;
+
+// pffft real transforms must be a multiple of 32 samples long.
+constexpr int kMinFftLength = 32;
+
+int NextPowerOfTwo(int value) {
+  int power = 1;
+  while (power < value) {
+    power *= 2;
+  }
+  return power;
+}
+
+using StridedMap =
+    Eigen::Map<const Eigen::ArrayXf, Eigen::Unaligned, Eigen::InnerStride<2>>;
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<BatchedSpectrogram>> BatchedSpectrogram::Create(
+    const std::vector<double>& window, int step_length, int num_channels) {
+  if (window.empty() || step_length <= 0 || num_channels <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid spectrogram configuration: window length ", window.size(),
+        ", step length ", step_length, ", channels ", num_channels));
+  }
+  const int fft_length = NextPowerOfTwo(window.size());
+  if (fft_length < kMinFftLength) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("FFT length ", fft_length, " for window length ",
+                     window.size(), " is shorter than ", kMinFftLength));
+  }
+  PFFFT_Setup* setup = pffft_new_setup(fft_length, PFFFT_REAL);
+  if (setup == nullptr) {
+    return absl::InternalError(
+        absl::StrCat("Failed to set up an FFT of length ", fft_length));
+  }
+  return std::unique_ptr<BatchedSpectrogram>(
+      new BatchedSpectrogram(window, step_length, num_channels, fft_length,
+                             setup));
+}
+
+BatchedSpectrogram::BatchedSpectrogram(const std::vector<double>& window,
+                                       int step_length, int num_channels,
+                                       int fft_length, PFFFT_Setup* setup)
+    : window_length_(window.size()),
+      step_length_(step_length),
+      num_channels_(num_channels),
+      fft_length_(fft_length),
+      fft_setup_(setup),
+      window_(Eigen::Map<const Eigen::ArrayXd>(window.data(), window.size())
+                  .cast<float>()),
+      samples_(num_channels, window_length_ + step_length_),
+      // The tail of fft_input_ past the window is never written, which
+      // zero-pads each frame.
+      fft_input_(fft_length, 0.0f),
+      fft_output_(fft_length),
+      fft_work_(fft_length) {}
+
+BatchedSpectrogram::~BatchedSpectrogram() { pffft_destroy_setup(fft_setup_); }
+
+int BatchedSpectrogram::AppendSamples(const Matrix& input) {
+  const int num_dropped =
+      std::min<int>(samples_to_drop_, static_cast<int>(input.cols()));
+  samples_to_drop_ -= num_dropped;
+  const int num_new_samples = input.cols() - num_dropped;
+  const int num_samples = num_buffered_samples_ + num_new_samples;
+  if (num_samples > samples_.cols()) {
+    RowMajorMatrix samples(num_channels_,
+                           std::max<int>(num_samples, 2 * samples_.cols()));
+    samples.leftCols(num_buffered_samples_) =
+        samples_.leftCols(num_buffered_samples_);
+    samples_.swap(samples);
+  }
+  samples_.middleCols(num_buffered_samples_, num_new_samples) =
+      input.rightCols(num_new_samples);
+  num_buffered_samples_ = num_samples;
+  if (num_buffered_samples_ < window_length_) {
+    return 0;
+  }
+  return (num_buffered_samples_ - window_length_) / step_length_ + 1;
+}
+
+void BatchedSpectrogram::TransformFrame(int channel, int start) {
+  Eigen::Map<Eigen::ArrayXf>(fft_input_.data(), window_length_) =
+      window_ * Eigen::Map<const Eigen::ArrayXf>(
+                    samples_.row(channel).data() + start, window_length_);
+  pffft_transform_ordered(fft_setup_, fft_input_.data(), fft_output_.data(),
+                          fft_work_.data(), PFFFT_FORWARD);
+}
+
+void BatchedSpectrogram::ConsumeFrames(int num_frames) {
+  if (num_frames == 0) {
+    return;
+  }
+  const int num_consumed = num_frames * step_length_;
+  if (num_consumed >= num_buffered_samples_) {
+    samples_to_drop_ = num_consumed - num_buffered_samples_;
+    num_buffered_samples_ = 0;
+    return;
+  }
+  // Fewer than window_length_ samples remain, so this is cheap compared to
+  // the transforms.
+  num_buffered_samples_ -= num_consumed;
+  for (int channel = 0; channel < num_channels_; ++channel) {
+    float* row = samples_.row(channel).data();
+    std::memmove(row, row + num_consumed,
+                 num_buffered_samples_ * sizeof(float));
+  }
+}
+
+int BatchedSpectrogram::ComputeSpectrogram(const Matrix& input,
+                                           OutputType output_type, float scale,
+                                           std::vector<Matrix>* output) {
+  const int num_frames = AppendSamples(input);
+  output->resize(num_channels_);
+  const int num_bins = output_frequency_channels();
+  const int num_inner_bins = num_bins - 2;
+  for (int channel = 0; channel < num_channels_; ++channel) {
+    Matrix& spectrogram = (*output)[channel];
+    spectrogram.resize(num_bins, num_frames);
+    for (int frame = 0; frame < num_frames; ++frame) {
+      TransformFrame(channel, frame * step_length_);
+      // Ordered pffft output is [re(0), re(N/2), re(1), im(1), re(2), ...].
+      const float* fft = fft_output_.data();
+      auto bins = spectrogram.col(frame).array();
+      bins(0) = fft[0] * fft[0];
+      bins(num_bins - 1) = fft[1] * fft[1];
+      bins.segment(1, num_inner_bins) =
+          StridedMap(fft + 2, num_inner_bins).square() +
+          StridedMap(fft + 3, num_inner_bins).square();
+      switch (output_type) {
+        case OutputType::kSquaredMagnitude:
+          bins *= scale;
+          break;
+        case OutputType::kLinearMagnitude:
+          bins = scale * bins.sqrt();
+          break;
+        case OutputType::kDecibels:
+          bins = (scale * kLnSquaredMagnitudeToDb) * bins.log();
+          break;
+      }
+    }
+  }
+  ConsumeFrames(num_frames);
+  return num_frames;
+}
+
+int BatchedSpectrogram::ComputeComplexSpectrogram(
+    const Matrix& input, float scale, std::vector<Eigen::MatrixXcf>* output) {
+  const int num_frames = AppendSamples(input);
+  output->resize(num_channels_);
+  const int num_bins = output_frequency_channels();
+  const int num_inner_bins = num_bins - 2;
+  for (int channel = 0; channel < num_channels_; ++channel) {
+    Eigen::MatrixXcf& spectrogram = (*output)[channel];
+    spectrogram.resize(num_bins, num_frames);
+    for (int frame = 0; frame < num_frames; ++frame) {
+      TransformFrame(channel, frame * step_length_);
+      const float* fft = fft_output_.data();
+      auto bins = spectrogram.col(frame);
+      bins(0) = std::complex<float>(scale * fft[0], 0.0f);
+      bins(num_bins - 1) = std::complex<float>(scale * fft[1], 0.0f);
+      // audio_dsp::Spectrogram, which SpectrogramCalculator otherwise uses,
+      // returns the complex conjugate of the forward transform computed by
+      // pffft. Match it so that phases do not depend on the engine.
+      bins.segment(1, num_inner_bins).real() =
+          scale * StridedMap(fft + 2, num_inner_bins).matrix();
+      bins.segment(1, num_inner_bins).imag() =
+          -scale * StridedMap(fft + 3, num_inner_bins).matrix();
+    }
+  }
+  ConsumeFrames(num_frames);
+  return num_frames;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_AUDIO_BATCHED_SPECTROGRAM_H_
+#define MEDIAPIPE_CALCULATORS_AUDIO_BATCHED_SPECTROGRAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/matrix.h"
+
+struct PFFFT_Setup;
+
+namespace mediapipe {
+
+// Computes the short-time Fourier transform of all channels of a multichannel
+// time series at once, with single precision SIMD FFTs.
+//
+// Frames are computed with the same framing as audio_dsp::Spectrogram: a frame
+// starts every step_length samples and is emitted once window.size() samples
+// of it have been received. Each frame is windowed, zero-padded to the next
+// power of two and transformed, and the squared magnitude, linear magnitude or
+// decibel values are computed in the same pass, directly into the output.
+//
+// Output is one num_frequency_bins x num_frames matrix per channel, which is
+// the layout SpectrogramCalculator emits.
+class BatchedSpectrogram {
+ public:
+  enum class OutputType { kSquaredMagnitude, kLinearMagnitude, kDecibels };
+
+  // Returns an error if the FFT length, the smallest power of two enclosing
+  // the window, is shorter than 32 samples, which pffft does not support.
+  static absl::StatusOr<std::unique_ptr<BatchedSpectrogram>> Create(
+      const std::vector<double>& window, int step_length, int num_channels);
+
+  ~BatchedSpectrogram();
+
+  BatchedSpectrogram(const BatchedSpectrogram&) = delete;
+  BatchedSpectrogram& operator=(const BatchedSpectrogram&) = delete;
+
+  // Appends the samples of input, a num_channels x num_samples matrix, and
+  // writes the frames completed by them, multiplied by scale, to output.
+  // Returns the number of frames, which may be 0.
+  int ComputeSpectrogram(const Matrix& input, OutputType output_type,
+                         float scale, std::vector<Matrix>* output);
+
+  // Same as above, but outputs the complex spectrum.
+  int ComputeComplexSpectrogram(const Matrix& input, float scale,
+                                std::vector<Eigen::MatrixXcf>* output);
+
+  int output_frequency_channels() const { return fft_length_ / 2 + 1; }
+
+ private:
+  using RowMajorMatrix =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  BatchedSpectrogram(const std::vector<double>& window, int step_length,
+                     int num_channels, int fft_length, PFFFT_Setup* setup);
+
+  // Buffers the samples of input and returns the number of frames that can
+  // be computed from the buffered samples.
+  int AppendSamples(const Matrix& input);
+
+  // Windows and transforms the frame of the given channel starting at sample
+  // start of the buffer. The ordered pffft output is left in fft_output_.
+  void TransformFrame(int channel, int start);
+
+  // Removes the samples before the first sample of the next frame.
+  void ConsumeFrames(int num_frames);
+
+  const int window_length_;
+  const int step_length_;
+  const int num_channels_;
+  const int fft_length_;
+  PFFFT_Setup* const fft_setup_;
+
+  Eigen::ArrayXf window_;
+  // Buffered samples, one row per channel, so that each channel's samples
+  // are contiguous. Only the first num_buffered_samples_ columns are valid.
+  RowMajorMatrix samples_;
+  int num_buffered_samples_ = 0;
+  // Samples of the next input that precede the next frame. Only nonzero if
+  // step_length is longer than the window.
+  int samples_to_drop_ = 0;
+
+  std::vector<float, Eigen::aligned_allocator<float>> fft_input_;
+  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+  // pffft requires memory to work with to avoid using the stack.
+  std::vector<float, Eigen::aligned_allocator<float>> fft_work_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_AUDIO_BATCHED_SPECTROGRAM_H_
@@ -23,6 +23,7 @@
 #include "absl/strings/string_view.h"
 #include "audio/dsp/spectrogram/spectrogram.h"
 #include "audio/dsp/window_functions.h"
+#include "mediapipe/calculators/audio/batched_spectrogram.h"
 #include "mediapipe/calculators/audio/spectrogram_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -172,6 +173,17 @@ class SpectrogramCalculator : public CalculatorBase {
       const OutputMatrixType postprocess_output_fn(const OutputMatrixType&),
       CalculatorContext* cc);
 
+  // Computes all channels with batched_spectrogram_ instead.
+  absl::Status ProcessVectorBatched(const Matrix& input_stream,
+                                    CalculatorContext* cc);
+
+  // Emits the spectrogram matrices, one per channel, of num_frames frames
+  // each, unless there are no frames.
+  template <class OutputMatrixType>
+  absl::Status OutputSpectrogramMatrices(
+      std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+      int num_frames, CalculatorContext* cc);
+
   // Use the MediaPipe timestamp instead of the estimated one. Useful when the
   // data is intermittent.
   bool use_local_timestamp_;
@@ -198,6 +210,9 @@ class SpectrogramCalculator : public CalculatorBase {
   bool allow_multichannel_input_;
   // Vector of Spectrogram objects, one for each channel.
   std::vector<std::unique_ptr<audio_dsp::Spectrogram>> spectrogram_generators_;
+  // Computes all channels at once if use_batched_fft is set, in which case
+  // spectrogram_generators_ is empty.
+  std::unique_ptr<BatchedSpectrogram> batched_spectrogram_;
   // Fixed scale factor applied to output values (regardless of type).
   double output_scale_;
 
@@ -294,14 +309,22 @@ absl::Status SpectrogramCalculator::Open(CalculatorContext* cc) {
 
   // Propagate settings down to the actual Spectrogram object.
   spectrogram_generators_.clear();
-  for (int i = 0; i < num_input_channels_; i++) {
-    spectrogram_generators_.push_back(
-        std::unique_ptr<audio_dsp::Spectrogram>(new audio_dsp::Spectrogram()));
-    spectrogram_generators_[i]->Initialize(window, frame_step_samples());
-  }
+  batched_spectrogram_.reset();
+  if (spectrogram_options.use_batched_fft()) {
+    ASSIGN_OR_RETURN(batched_spectrogram_,
+                     BatchedSpectrogram::Create(window, frame_step_samples(),
+                                                num_input_channels_));
+    num_output_channels_ = batched_spectrogram_->output_frequency_channels();
+  } else {
+    for (int i = 0; i < num_input_channels_; i++) {
+      spectrogram_generators_.push_back(std::unique_ptr<audio_dsp::Spectrogram>(
+          new audio_dsp::Spectrogram()));
+      spectrogram_generators_[i]->Initialize(window, frame_step_samples());
+    }
 
-  num_output_channels_ =
-      spectrogram_generators_[0]->output_frequency_channels();
+    num_output_channels_ =
+        spectrogram_generators_[0]->output_frequency_channels();
+  }
   std::unique_ptr<TimeSeriesHeader> output_header(
       new TimeSeriesHeader(input_header));
   // Store the actual sample rate of the input audio in the TimeSeriesHeader
@@ -406,23 +429,66 @@ absl::Status SpectrogramCalculator::ProcessVectorToOutput(
       spectrogram_matrices->push_back(output_frames);
     }
   }
+  if (!spectrogram_matrices->empty()) {
+    RET_CHECK_EQ(spectrogram_matrices->size(), input_stream.rows())
+        << "Inconsistent number of spectrogram channels.";
+  }
+  return OutputSpectrogramMatrices(std::move(spectrogram_matrices),
+                                   output_vectors.size(), cc);
+}
+
+absl::Status SpectrogramCalculator::ProcessVectorBatched(
+    const Matrix& input_stream, CalculatorContext* cc) {
+  const float scale = output_scale_;
+  if (output_type_ == SpectrogramCalculatorOptions::COMPLEX) {
+    auto spectrogram_matrices =
+        std::make_unique<std::vector<Eigen::MatrixXcf>>();
+    const int num_frames = batched_spectrogram_->ComputeComplexSpectrogram(
+        input_stream, scale, spectrogram_matrices.get());
+    return OutputSpectrogramMatrices(std::move(spectrogram_matrices),
+                                     num_frames, cc);
+  }
+  BatchedSpectrogram::OutputType output_type;
+  switch (output_type_) {
+    case SpectrogramCalculatorOptions::SQUARED_MAGNITUDE:
+      output_type = BatchedSpectrogram::OutputType::kSquaredMagnitude;
+      break;
+    case SpectrogramCalculatorOptions::LINEAR_MAGNITUDE:
+      output_type = BatchedSpectrogram::OutputType::kLinearMagnitude;
+      break;
+    case SpectrogramCalculatorOptions::DECIBELS:
+      output_type = BatchedSpectrogram::OutputType::kDecibels;
+      break;
+    default:
+      return absl::Status(absl::StatusCode::kInvalidArgument,
+                          "Unrecognized spectrogram output type.");
+  }
+  auto spectrogram_matrices = std::make_unique<std::vector<Matrix>>();
+  const int num_frames = batched_spectrogram_->ComputeSpectrogram(
+      input_stream, output_type, scale, spectrogram_matrices.get());
+  return OutputSpectrogramMatrices(std::move(spectrogram_matrices), num_frames,
+                                   cc);
+}
+
+template <class OutputMatrixType>
+absl::Status SpectrogramCalculator::OutputSpectrogramMatrices(
+    std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+    int num_frames, CalculatorContext* cc) {
   // If the input is very short, there may not be enough accumulated,
   // unprocessed samples to cause any new frames to be generated by
   // the spectrogram object.  If so, we don't want to emit
   // a packet at all.
-  if (!spectrogram_matrices->empty()) {
-    RET_CHECK_EQ(spectrogram_matrices->size(), input_stream.rows())
-        << "Inconsistent number of spectrogram channels.";
+  if (num_frames > 0) {
     if (allow_multichannel_input_) {
       cc->Outputs().Index(0).Add(spectrogram_matrices.release(),
                                  CurrentOutputTimestamp(cc));
     } else {
       cc->Outputs().Index(0).Add(
-          new OutputMatrixType(spectrogram_matrices->at(0)),
+          new OutputMatrixType(std::move(spectrogram_matrices->at(0))),
           CurrentOutputTimestamp(cc));
     }
-    cumulative_completed_frames_ += output_vectors.size();
-    last_completed_frames_ = output_vectors.size();
+    cumulative_completed_frames_ += num_frames;
+    last_completed_frames_ = num_frames;
     if (!use_local_timestamp_) {
       // In non-local timestamp mode the timestamp of the next packet will be
       // equal to CumulativeOutputTimestamp(). Inform the framework about this
@@ -435,6 +501,9 @@ absl::Status SpectrogramCalculator::ProcessVectorToOutput(
 
 absl::Status SpectrogramCalculator::ProcessVector(const Matrix& input_stream,
                                                   CalculatorContext* cc) {
+  if (batched_spectrogram_) {
+    return ProcessVectorBatched(input_stream, cc);
+  }
   switch (output_type_) {
       // These blocks deliberately ignore clang-format to preserve the
       // "silhouette" of the different cases.
@@ -846,6 +846,78 @@ TEST_F(SpectrogramCalculatorTest,
   }
 }
 
+TEST_F(SpectrogramCalculatorTest, BatchedFftMatchesPerChannelSpectrogram) {
+  // Packets shorter than a step and longer than several frames.
+  const std::vector<int> input_packet_sizes = {30, 250, 7, 100, 333, 1};
+  options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(60.0 / input_sample_rate_);
+  options_.set_allow_multichannel_input(true);
+  num_input_channels_ = 8;
+  const float tone_frequency_hz = 440.0;
+
+  for (auto output_type : {SpectrogramCalculatorOptions::SQUARED_MAGNITUDE,
+                           SpectrogramCalculatorOptions::LINEAR_MAGNITUDE,
+                           SpectrogramCalculatorOptions::DECIBELS,
+                           SpectrogramCalculatorOptions::COMPLEX}) {
+    options_.set_output_type(output_type);
+    options_.set_use_batched_fft(false);
+    InitializeGraph();
+    FillInputHeader();
+    SetupMultichannelInputPackets(input_packet_sizes, tone_frequency_hz);
+    MP_ASSERT_OK(Run());
+    const std::vector<Packet> expected = output().packets;
+
+    options_.set_use_batched_fft(true);
+    InitializeGraph();
+    FillInputHeader();
+    SetupMultichannelInputPackets(input_packet_sizes, tone_frequency_hz);
+    MP_ASSERT_OK(Run());
+
+    CheckOutputHeadersAndTimestamps();
+    ASSERT_EQ(output().packets.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(output().packets[i].Timestamp(), expected[i].Timestamp());
+      for (int channel = 0; channel < num_input_channels_; ++channel) {
+        // The batched engine computes in single precision. Compare relative to
+        // the largest value of the frame, since decibels of the bins without
+        // energy are dominated by rounding.
+        if (output_type == SpectrogramCalculatorOptions::COMPLEX) {
+          const Eigen::MatrixXcf& batched =
+              output().packets[i].Get<std::vector<Eigen::MatrixXcf>>()[channel];
+          const Eigen::MatrixXcf& reference =
+              expected[i].Get<std::vector<Eigen::MatrixXcf>>()[channel];
+          ASSERT_EQ(batched.rows(), reference.rows());
+          ASSERT_EQ(batched.cols(), reference.cols());
+          EXPECT_LE((batched - reference).cwiseAbs().maxCoeff(),
+                    1e-4f * reference.cwiseAbs().maxCoeff());
+        } else {
+          const Matrix& batched =
+              output().packets[i].Get<std::vector<Matrix>>()[channel];
+          const Matrix& reference =
+              expected[i].Get<std::vector<Matrix>>()[channel];
+          ASSERT_EQ(batched.rows(), reference.rows());
+          ASSERT_EQ(batched.cols(), reference.cols());
+          if (output_type == SpectrogramCalculatorOptions::DECIBELS) {
+            for (int frame = 0; frame < reference.cols(); ++frame) {
+              const float max_db = reference.col(frame).maxCoeff();
+              for (int bin = 0; bin < reference.rows(); ++bin) {
+                // Only compare bins within 60 dB of the peak.
+                if (reference(bin, frame) > max_db - 60.0f) {
+                  EXPECT_NEAR(batched(bin, frame), reference(bin, frame),
+                              0.01f);
+                }
+              }
+            }
+          } else {
+            EXPECT_LE((batched - reference).cwiseAbs().maxCoeff(),
+                      1e-4f * reference.cwiseAbs().maxCoeff());
+          }
+        }
+      }
+    }
+  }
+}
+
 void BM_ProcessDC(benchmark::State& state) {
   CalculatorGraphConfig::Node node_config;
   node_config.set_calculator("SpectrogramCalculator");
@@ -891,5 +963,45 @@ void BM_ProcessDC(benchmark::State& state) {
 
 BENCHMARK(BM_ProcessDC);
 
+// Measures a 16 channel spectrogram with the per-channel audio_dsp
+// spectrograms (arg 0) and the batched FFT engine (arg 1).
+void BM_ProcessMultichannel(benchmark::State& state) {
+  CalculatorGraphConfig::Node node_config;
+  node_config.set_calculator("SpectrogramCalculator");
+  node_config.add_input_stream("input_audio");
+  node_config.add_output_stream("output_spectrogram");
+
+  SpectrogramCalculatorOptions* options =
+      node_config.mutable_options()->MutableExtension(
+          SpectrogramCalculatorOptions::ext);
+  options->set_frame_duration_seconds(0.025);
+  options->set_frame_overlap_seconds(0.015);
+  options->set_pad_final_packet(false);
+  options->set_allow_multichannel_input(true);
+  options->set_output_type(SpectrogramCalculatorOptions::DECIBELS);
+  options->set_use_batched_fft(state.range(0));
+
+  const int num_input_channels = 16;
+  const int packet_size_samples = 160000;
+  TimeSeriesHeader* header = new TimeSeriesHeader();
+  header->set_sample_rate(16000.0);
+  header->set_num_channels(num_input_channels);
+
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).header = Adopt(header);
+  runner.MutableInputs()->Index(0).packets.push_back(
+      Adopt(new Matrix(
+                Matrix::Random(num_input_channels, packet_size_samples)))
+          .At(Timestamp(0)));
+
+  for (auto _ : state) {
+    ASSERT_TRUE(runner.Run().ok());
+  }
+  state.SetItemsProcessed(state.iterations() * num_input_channels *
+                          packet_size_samples);
+}
+
+BENCHMARK(BM_ProcessMultichannel)->Arg(0)->Arg(1);
+
 }  // anonymous namespace
 }  // namespace mediapipe
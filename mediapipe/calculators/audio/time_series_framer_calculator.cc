@@ -15,6 +15,8 @@
 // Defines TimeSeriesFramerCalculator.
 #include <math.h>
 
+#include <algorithm>
+#include <deque>
 #include <vector>
 
 #include "Eigen/Core"
@@ -127,145 +129,199 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   // The current timestamp is updated along with the incoming packets.
   Timestamp current_timestamp_;
 
-  // Samples are buffered in a vector of sample blocks.
-  class SampleBlockBuffer {
+  // Samples are buffered in a contiguous circular buffer, which only grows
+  // when more samples are buffered than ever before, so that steady state
+  // framing does not allocate.
+  class SampleRingBuffer {
    public:
     // Initializes the buffer.
     void Init(double sample_rate, int num_channels) {
       ts_units_per_sample_ = Timestamp::kTimestampUnitsPerSecond / sample_rate;
       num_channels_ = num_channels;
+      samples_.resize(num_channels, 0);
+      first_column_ = 0;
       num_samples_ = 0;
-      first_block_offset_ = 0;
+      first_sample_index_ = 0;
+      blocks_.clear();
     }
 
     // Number of channels, equal to the number of rows in each Matrix.
     int num_channels() const { return num_channels_; }
-    // Total number of available samples over all blocks.
+    // Total number of available samples.
     int num_samples() const { return num_samples_; }
 
     // Pushes a new block of samples on the back of the buffer with `timestamp`
     // being the input timestamp of the packet containing the Matrix.
     void Push(const Matrix& samples, Timestamp timestamp);
-    // Copies `count` samples from the front of the buffer. If there are fewer
-    // samples than this, the result is zero padded to have `count` samples.
-    // The timestamp of the last copied sample is written to *last_timestamp.
-    // This output is used below to update `current_timestamp_`, which is only
-    // used when `use_local_timestamp` is true.
-    Matrix CopySamples(int count, Timestamp* last_timestamp) const;
+    // Copies `count` samples from the front of the buffer into *output,
+    // multiplying each row by `window` in the same pass if it is not null. If
+    // there are fewer samples than this, the result is zero padded to have
+    // `count` samples. The timestamp of the last copied sample is written to
+    // *last_timestamp. This output is used below to update
+    // `current_timestamp_`, which is only used when `use_local_timestamp` is
+    // true.
+    void CopySamples(int count, const Eigen::RowVectorXf* window,
+                     Matrix* output, Timestamp* last_timestamp) const;
     // Drops `count` samples from the front of the buffer. If `count` exceeds
     // `num_samples()`, the buffer is emptied.  Returns how many samples were
     // dropped.
     int DropSamples(int count);
+    // Returns the timestamp of the sample at `index` from the front of the
+    // buffer.
+    Timestamp SampleTimestamp(int index) const;
 
    private:
+    // The start of an input block that overlaps the buffered samples.
     struct Block {
-      // Matrix of num_channels rows by num_samples columns, a block of possibly
-      // multiple samples.
-      Matrix samples;
+      // Index of the first sample of the block since the start of the stream.
+      int64_t first_sample;
       // Timestamp of the first sample in the Block. This comes from the input
       // packet's timestamp that contains this Matrix.
       Timestamp timestamp;
-
-      Block() : timestamp(Timestamp::Unstarted()) {}
-      Block(const Matrix& samples, Timestamp timestamp)
-          : samples(samples), timestamp(timestamp) {}
-      int num_samples() const { return samples.cols(); }
     };
-    std::vector<Block> blocks_;
+
+    // Grows the buffer to hold `capacity` samples, moving the buffered samples
+    // to the front of the new storage.
+    void Reserve(int capacity);
+
+    // Matrix of num_channels rows by capacity columns. The i-th buffered
+    // sample is column (first_column_ + i) % capacity.
+    Matrix samples_;
+    int first_column_;
+    int num_samples_;
+    // Index of the first buffered sample since the start of the stream.
+    int64_t first_sample_index_;
+    // Input blocks overlapping the buffered samples, in order.
+    std::deque<Block> blocks_;
     // Number of timestamp units per sample. Used to compute timestamps as
     // nth sample timestamp = base_timestamp + round(ts_units_per_sample_ * n).
     double ts_units_per_sample_;
     // Number of rows in each Matrix.
     int num_channels_;
-    // The total number of samples over all blocks, equal to
-    // (sum_i blocks_[i].num_samples()) - first_block_offset_.
-    int num_samples_;
-    // The number of samples in the first block that have been discarded. This
-    // way we can cheaply represent "partially discarding" a block.
-    int first_block_offset_;
   } sample_buffer_;
 
+  // Returns a Matrix to copy the next output frame into. It reuses the
+  // storage of the last copied output frame once downstream calculators have
+  // released it, so that frames are only reallocated when they are still in
+  // use or their dimensions change.
+  Matrix TakeOutputFrameBuffer();
+
   bool use_window_;
   Eigen::RowVectorXf window_;
 
   bool use_local_timestamp_;
+
+  // The last output frame copied from sample_buffer_, see
+  // TakeOutputFrameBuffer().
+  Packet last_output_frame_;
 };
 REGISTER_CALCULATOR(TimeSeriesFramerCalculator);
 
-void TimeSeriesFramerCalculator::SampleBlockBuffer::Push(const Matrix& samples,
-                                                         Timestamp timestamp) {
-  num_samples_ += samples.cols();
-  blocks_.emplace_back(samples, timestamp);
+void TimeSeriesFramerCalculator::SampleRingBuffer::Reserve(int capacity) {
+  Matrix samples(num_channels_, capacity);
+  const int head = std::min<int>(num_samples_, samples_.cols() - first_column_);
+  samples.leftCols(head) = samples_.middleCols(first_column_, head);
+  samples.middleCols(head, num_samples_ - head) =
+      samples_.leftCols(num_samples_ - head);
+  samples_.swap(samples);
+  first_column_ = 0;
 }
 
-Matrix TimeSeriesFramerCalculator::SampleBlockBuffer::CopySamples(
-    int count, Timestamp* last_timestamp) const {
-  Matrix copied(num_channels_, count);
-
-  if (!blocks_.empty()) {
-    int num_copied = 0;
-    // First block has an offset for samples that have been discarded.
-    int offset = first_block_offset_;
-    int n;
-    Timestamp last_block_ts;
-    int last_sample_index;
-
-    for (auto it = blocks_.begin(); it != blocks_.end() && count > 0; ++it) {
-      n = std::min(it->num_samples() - offset, count);
-      // Copy `n` samples from the next block.
-      copied.middleCols(num_copied, n) = it->samples.middleCols(offset, n);
-      count -= n;
-      num_copied += n;
-      last_block_ts = it->timestamp;
-      last_sample_index = offset + n - 1;
-      offset = 0;  // No samples have been discarded in subsequent blocks.
-    }
-
-    // Compute the timestamp of the last copied sample.
-    *last_timestamp =
-        last_block_ts + std::round(ts_units_per_sample_ * last_sample_index);
+void TimeSeriesFramerCalculator::SampleRingBuffer::Push(const Matrix& samples,
+                                                        Timestamp timestamp) {
+  const int count = samples.cols();
+  if (count == 0) {
+    return;
   }
+  if (num_samples_ + count > samples_.cols()) {
+    Reserve(std::max<int>(2 * samples_.cols(), num_samples_ + count));
+  }
+  blocks_.push_back({first_sample_index_ + num_samples_, timestamp});
+
+  // Copy in up to two parts, wrapping around the end of the buffer.
+  const int capacity = samples_.cols();
+  const int end_column = (first_column_ + num_samples_) % capacity;
+  const int head = std::min(count, capacity - end_column);
+  samples_.middleCols(end_column, head) = samples.leftCols(head);
+  samples_.leftCols(count - head) = samples.rightCols(count - head);
+  num_samples_ += count;
+}
 
-  if (count > 0) {
-    copied.rightCols(count).setZero();  // Zero pad if needed.
+void TimeSeriesFramerCalculator::SampleRingBuffer::CopySamples(
+    int count, const Eigen::RowVectorXf* window, Matrix* output,
+    Timestamp* last_timestamp) const {
+  // Eigen only reallocates "output" if its size changes.
+  output->resize(num_channels_, count);
+  auto copy_columns = [this, window, output](int column, int output_column,
+                                             int n) {
+    if (window) {
+      output->middleCols(output_column, n) =
+          samples_.middleCols(column, n).array().rowwise() *
+          window->segment(output_column, n).array();
+    } else {
+      output->middleCols(output_column, n) = samples_.middleCols(column, n);
+    }
+  };
+
+  // Copy in up to two parts, wrapping around the end of the buffer.
+  const int num_copied = std::min(count, num_samples_);
+  const int head =
+      std::min<int>(num_copied, samples_.cols() - first_column_);
+  copy_columns(first_column_, 0, head);
+  copy_columns(0, head, num_copied - head);
+  if (num_copied < count) {
+    output->rightCols(count - num_copied).setZero();  // Zero pad if needed.
   }
 
-  return copied;
+  if (num_copied > 0) {
+    *last_timestamp = SampleTimestamp(num_copied - 1);
+  }
 }
 
-int TimeSeriesFramerCalculator::SampleBlockBuffer::DropSamples(int count) {
-  if (blocks_.empty()) {
+int TimeSeriesFramerCalculator::SampleRingBuffer::DropSamples(int count) {
+  const int num_dropped = std::min(count, num_samples_);
+  if (num_dropped == 0) {
     return 0;
   }
+  first_column_ = (first_column_ + num_dropped) % samples_.cols();
+  num_samples_ -= num_dropped;
+  first_sample_index_ += num_dropped;
 
-  auto block_it = blocks_.begin();
-  if (first_block_offset_ + count < block_it->num_samples()) {
-    // `count` is less than the remaining samples in the first block.
-    first_block_offset_ += count;
-    num_samples_ -= count;
-    return count;
+  // Drop the blocks that have no samples left.
+  if (num_samples_ == 0) {
+    blocks_.clear();
+  }
+  while (blocks_.size() > 1 && blocks_[1].first_sample <= first_sample_index_) {
+    blocks_.pop_front();
   }
+  return num_dropped;
+}
 
-  int num_samples_dropped = block_it->num_samples() - first_block_offset_;
-  count -= num_samples_dropped;
-  first_block_offset_ = 0;
+Timestamp TimeSeriesFramerCalculator::SampleRingBuffer::SampleTimestamp(
+    int index) const {
+  const int64_t sample = first_sample_index_ + index;
+  // Find the last block starting at or before the sample.
+  auto block = std::upper_bound(
+      blocks_.begin(), blocks_.end(), sample,
+      [](int64_t sample, const Block& block) {
+        return sample < block.first_sample;
+      });
+  --block;
+  const int sample_index = sample - block->first_sample;
+  return block->timestamp + std::round(ts_units_per_sample_ * sample_index);
+}
 
-  for (++block_it; block_it != blocks_.end(); ++block_it) {
-    if (block_it->num_samples() > count) {
-      break;
+Matrix TimeSeriesFramerCalculator::TakeOutputFrameBuffer() {
+  Matrix frame;
+  if (!last_output_frame_.IsEmpty()) {
+    // Fails if the frame is still referenced downstream.
+    auto released = last_output_frame_.Consume<Matrix>();
+    if (released.ok()) {
+      frame.swap(**released);
     }
-    num_samples_dropped += block_it->num_samples();
-    count -= block_it->num_samples();
-  }
-
-  blocks_.erase(blocks_.begin(), block_it);  // Drop whole blocks.
-  if (!blocks_.empty()) {
-    first_block_offset_ = count;  // Drop part of the next block.
-    num_samples_dropped += count;
+    last_output_frame_ = Packet();
   }
-
-  num_samples_ -= num_samples_dropped;
-  return num_samples_dropped;
+  return frame;
 }
 
 absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
@@ -274,26 +330,40 @@ absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
     current_timestamp_ = initial_input_timestamp_;
   }
 
+  // If the input packet holds exactly the next output frame, it is output
+  // as is instead of copying its samples.
+  const Packet& input_packet = cc->Inputs().Index(0).Value();
+  const Matrix& input_samples = input_packet.Get<Matrix>();
+  bool output_input_packet =
+      !use_window_ && input_samples.cols() == frame_duration_samples_ &&
+      sample_buffer_.num_samples() == samples_still_to_drop_;
+
   // Add input data to the internal buffer.
-  sample_buffer_.Push(cc->Inputs().Index(0).Get<Matrix>(),
-                      cc->InputTimestamp());
+  sample_buffer_.Push(input_samples, cc->InputTimestamp());
 
   // Construct and emit framed output packets.
   while (sample_buffer_.num_samples() >=
          frame_duration_samples_ + samples_still_to_drop_) {
     sample_buffer_.DropSamples(samples_still_to_drop_);
-    Matrix output_frame = sample_buffer_.CopySamples(frame_duration_samples_,
-                                                     &current_timestamp_);
+    Packet output_packet;
+    if (output_input_packet) {
+      current_timestamp_ =
+          sample_buffer_.SampleTimestamp(frame_duration_samples_ - 1);
+      output_packet = input_packet;
+      output_input_packet = false;
+    } else {
+      Matrix output_frame = TakeOutputFrameBuffer();
+      sample_buffer_.CopySamples(frame_duration_samples_,
+                                 use_window_ ? &window_ : nullptr,
+                                 &output_frame, &current_timestamp_);
+      output_packet = MakePacketPooled<Matrix>(std::move(output_frame));
+      last_output_frame_ = output_packet;
+    }
     const int frame_step_samples = next_frame_step_samples();
     samples_still_to_drop_ = frame_step_samples;
 
-    if (use_window_) {
-      // Apply the window to each row of output_frame.
-      output_frame.array().rowwise() *= window_.array();
-    }
-
-    cc->Outputs().Index(0).AddPacket(MakePacket<Matrix>(std::move(output_frame))
-                                         .At(CurrentOutputTimestamp()));
+    cc->Outputs().Index(0).AddPacket(
+        std::move(output_packet).At(CurrentOutputTimestamp()));
     ++cumulative_output_frames_;
     cumulative_completed_samples_ += frame_step_samples;
   }
@@ -311,10 +381,12 @@ absl::Status TimeSeriesFramerCalculator::Close(CalculatorContext* cc) {
   sample_buffer_.DropSamples(samples_still_to_drop_);
 
   if (sample_buffer_.num_samples() > 0 && pad_final_packet_) {
-    Matrix output_frame = sample_buffer_.CopySamples(frame_duration_samples_,
-                                                     &current_timestamp_);
-    cc->Outputs().Index(0).AddPacket(MakePacket<Matrix>(std::move(output_frame))
-                                         .At(CurrentOutputTimestamp()));
+    Matrix output_frame = TakeOutputFrameBuffer();
+    sample_buffer_.CopySamples(frame_duration_samples_, /*window=*/nullptr,
+                               &output_frame, &current_timestamp_);
+    cc->Outputs().Index(0).AddPacket(
+        MakePacketPooled<Matrix>(std::move(output_frame))
+            .At(CurrentOutputTimestamp()));
   }
 
   return absl::OkStatus();
@@ -26,13 +26,21 @@
 
 using ::mediapipe::Matrix;
 
-void BM_TimeSeriesFramerCalculator(benchmark::State& state) {
-  constexpr float kSampleRate = 32000.0;
-  constexpr int kNumChannels = 2;
-  constexpr int kFrameDurationSeconds = 5.0;
+namespace {
+
+constexpr float kSampleRate = 32000.0;
+constexpr int kNumChannels = 2;
+
+// Runs a graph with a TimeSeriesFramerCalculator configured with `options` on
+// `num_packets` input packets per iteration, each holding between
+// `min_input_size` and `max_input_size` samples.
+void RunFramerBenchmark(
+    benchmark::State& state,
+    const mediapipe::TimeSeriesFramerCalculatorOptions& framer_options,
+    int min_input_size, int max_input_size, int num_packets) {
   std::mt19937 rng(0 /*seed*/);
-  // Input around a half second's worth of samples at a time.
-  std::uniform_int_distribution<int> input_size_dist(15000, 17000);
+  std::uniform_int_distribution<int> input_size_dist(min_input_size,
+                                                     max_input_size);
   // Generate a pool of random blocks of samples up front.
   std::vector<Matrix> sample_pool;
   sample_pool.reserve(20);
@@ -48,19 +56,17 @@ void BM_TimeSeriesFramerCalculator(benchmark::State& state) {
   node->set_calculator("TimeSeriesFramerCalculator");
   node->add_input_stream("input");
   node->add_output_stream("output");
-  mediapipe::TimeSeriesFramerCalculatorOptions* options =
-      node->mutable_options()->MutableExtension(
-          mediapipe::TimeSeriesFramerCalculatorOptions::ext);
-  options->set_frame_duration_seconds(kFrameDurationSeconds);
+  *node->mutable_options()->MutableExtension(
+      mediapipe::TimeSeriesFramerCalculatorOptions::ext) = framer_options;
 
   for (auto _ : state) {
     state.PauseTiming();  // Pause benchmark timing.
 
     // Prepare input packets of random blocks of samples.
     std::vector<mediapipe::Packet> input_packets;
-    input_packets.reserve(32);
+    input_packets.reserve(num_packets);
     float t = 0;
-    for (int i = 0; i < 32; ++i) {
+    for (int i = 0; i < num_packets; ++i) {
       auto samples =
           std::make_unique<Matrix>(sample_pool[pool_index_dist(rng)]);
       const int num_samples = samples->cols();
@@ -87,6 +93,38 @@ void BM_TimeSeriesFramerCalculator(benchmark::State& state) {
     CHECK_OK(graph.WaitUntilIdle());
   }
 }
+
+}  // namespace
+
+void BM_TimeSeriesFramerCalculator(benchmark::State& state) {
+  constexpr int kFrameDurationSeconds = 5.0;
+  mediapipe::TimeSeriesFramerCalculatorOptions options;
+  options.set_frame_duration_seconds(kFrameDurationSeconds);
+  // Input around a half second's worth of samples at a time.
+  RunFramerBenchmark(state, options, 15000, 17000, /*num_packets=*/32);
+}
 BENCHMARK(BM_TimeSeriesFramerCalculator);
 
+// Short overlapping frames with a window, as used for audio features: 25ms
+// frames every 10ms from 10ms input blocks.
+void BM_TimeSeriesFramerCalculatorOverlappingWindowedFrames(
+    benchmark::State& state) {
+  mediapipe::TimeSeriesFramerCalculatorOptions options;
+  options.set_frame_duration_seconds(0.025);
+  options.set_frame_overlap_seconds(0.015);
+  options.set_window_function(
+      mediapipe::TimeSeriesFramerCalculatorOptions::HANN);
+  RunFramerBenchmark(state, options, 300, 340, /*num_packets=*/1000);
+}
+BENCHMARK(BM_TimeSeriesFramerCalculatorOverlappingWindowedFrames);
+
+// Input packets that hold exactly one frame each, which are output without
+// copying.
+void BM_TimeSeriesFramerCalculatorFrameSizedInput(benchmark::State& state) {
+  mediapipe::TimeSeriesFramerCalculatorOptions options;
+  options.set_frame_duration_seconds(0.025);
+  RunFramerBenchmark(state, options, 800, 800, /*num_packets=*/1000);
+}
+BENCHMARK(BM_TimeSeriesFramerCalculatorFrameSizedInput);
+
 BENCHMARK_MAIN();
@@ -481,5 +481,20 @@ TEST_F(TimeSeriesFramerCalculatorTimestampingTest, UseCumulativeTimeStamp) {
   CheckOutputTimestamps();
 }
 
+TEST_F(TimeSeriesFramerCalculatorTimestampingTest,
+       InputPacketsOfFrameSizeAreOutputWithoutCopy) {
+  options_.set_frame_duration_seconds(kUniversalInputPacketSize /
+                                      input_sample_rate_);
+  options_.set_use_local_timestamp(true);
+
+  MP_ASSERT_OK(RunTimestampTest());
+  CheckOutputTimestamps();
+  ASSERT_EQ(input().packets.size(), output().packets.size());
+  for (int i = 0; i < output().packets.size(); ++i) {
+    EXPECT_EQ(&input().packets[i].Get<Matrix>(),
+              &output().packets[i].Get<Matrix>());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
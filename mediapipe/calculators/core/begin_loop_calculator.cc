@@ -14,6 +14,7 @@
 
 #include "mediapipe/calculators/core/begin_loop_calculator.h"
 
+#include <string>
 #include <vector>
 
 #include "mediapipe/framework/formats/detection.pb.h"
@@ -81,4 +82,8 @@ REGISTER_CALCULATOR(BeginLoopImageCalculator);
 typedef BeginLoopCalculator<std::vector<float>> BeginLoopFloatCalculator;
 REGISTER_CALCULATOR(BeginLoopFloatCalculator);
 
+// A calculator to process std::vector<std::string>.
+typedef BeginLoopCalculator<std::vector<std::string>> BeginLoopStringCalculator;
+REGISTER_CALCULATOR(BeginLoopStringCalculator);
+
 }  // namespace mediapipe
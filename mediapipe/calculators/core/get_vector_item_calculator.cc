@@ -14,6 +14,8 @@
 
 #include "mediapipe/calculators/core/get_vector_item_calculator.h"
 
+#include <array>
+
 #include "mediapipe/framework/formats/classification.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
@@ -45,5 +47,10 @@ REGISTER_CALCULATOR(GetNormalizedRectVectorItemCalculator);
 using GetRectVectorItemCalculator = GetVectorItemCalculator<Rect>;
 REGISTER_CALCULATOR(GetRectVectorItemCalculator);
 
+// For the LETTERBOX_PADDINGS output of ImageToTensorCalculator.
+using GetLetterboxPaddingVectorItemCalculator =
+    GetVectorItemCalculator<std::array<float, 4>>;
+REGISTER_CALCULATOR(GetLetterboxPaddingVectorItemCalculator);
+
 }  // namespace api2
 }  // namespace mediapipe
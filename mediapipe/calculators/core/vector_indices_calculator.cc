@@ -14,7 +14,10 @@
 
 #include "mediapipe/calculators/core/vector_indices_calculator.h"
 
+#include <string>
+
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -29,5 +32,12 @@ using NormalizedLandmarkListVectorIndicesCalculator =
     VectorIndicesCalculator<mediapipe::NormalizedLandmarkList>;
 REGISTER_CALCULATOR(NormalizedLandmarkListVectorIndicesCalculator);
 
+using NormalizedRectVectorIndicesCalculator =
+    VectorIndicesCalculator<mediapipe::NormalizedRect>;
+REGISTER_CALCULATOR(NormalizedRectVectorIndicesCalculator);
+
+using StringVectorIndicesCalculator = VectorIndicesCalculator<std::string>;
+REGISTER_CALCULATOR(StringVectorIndicesCalculator);
+
 }  // namespace api2
 }  // namespace mediapipe
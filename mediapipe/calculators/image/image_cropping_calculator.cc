@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/image/image_cropping_calculator.h"
 
 #include <cmath>
+#include <memory>
 
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
@@ -227,6 +228,27 @@ absl::Status ImageCroppingCalculator::RenderCpu(CalculatorContext* cc) {
   float rect_center_x = specs.center_x, rect_center_y = specs.center_y;
   float rotation = specs.rotation;
 
+  if (options_.output_views() && rotation == 0.0f &&
+      target_width <= output_max_width_ &&
+      target_height <= output_max_height_) {
+    // warpPerspective copies the pixels unchanged if the crop is shifted by
+    // whole pixels, so the crop can alias the input instead.
+    const float left = rect_center_x - target_width / 2.0f;
+    const float top = rect_center_y - target_height / 2.0f;
+    if (left >= 0 && top >= 0 && left == std::floor(left) &&
+        top == std::floor(top) && left + target_width <= input_img.Width() &&
+        top + target_height <= input_img.Height() && target_width > 0 &&
+        target_height > 0) {
+      std::unique_ptr<ImageFrame> output_frame = ImageFrame::CreateView(
+          SharedPtrWithPacket<ImageFrame>(cc->Inputs().Tag(kImageTag).Value()),
+          static_cast<int>(left), static_cast<int>(top), target_width,
+          target_height);
+      cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
+                                       cc->InputTimestamp());
+      return absl::OkStatus();
+    }
+  }
+
   // Get border mode and value for OpenCV.
   int border_mode;
   MP_RETURN_IF_ERROR(GetBorderModeForOpenCV(cc, &border_mode));
@@ -376,5 +376,47 @@ TEST(ImageCroppingCalculatorTest, RedundantSpecWithInputStream) {
             expectRect);
 }  // TEST
 
+// Test that an unrotated crop at whole pixel offsets is output as a view of
+// the input when output_views is set.
+TEST(ImageCroppingCalculatorTest, OutputsViewOfInput) {
+  auto calculator_node =
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "ImageCroppingCalculator"
+            input_stream: "IMAGE:input_frames"
+            output_stream: "IMAGE:cropped_output_frames"
+            options: {
+              [mediapipe.ImageCroppingCalculatorOptions.ext] {
+                width: 20
+                height: 10
+                output_views: true
+              }
+            }
+          )pb");
+  mediapipe::CalculatorRunner runner(calculator_node);
+
+  const auto input_frame = GetInputFrame(input_width, input_height, 3);
+  auto input_frame_packet =
+      mediapipe::MakePacket<mediapipe::ImageFrame>(std::move(*input_frame));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      input_frame_packet.At(mediapipe::Timestamp(1)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_image =
+      runner.Outputs().Tag("IMAGE").packets[0].Get<mediapipe::ImageFrame>();
+  const auto& input_image = input_frame_packet.Get<mediapipe::ImageFrame>();
+  EXPECT_TRUE(output_image.IsReadOnly());
+  // The crop is centered, so its top left pixel is (40, 45).
+  EXPECT_EQ(output_image.PixelData(),
+            input_image.PixelData() + 45 * input_image.WidthStep() + 40 * 3);
+
+  cv::Mat output_mat = formats::MatView(&output_image);
+  cv::Mat expected_mat =
+      formats::MatView(&input_image)(cv::Rect(40, 45, 20, 10));
+  double max_diff = cv::norm(expected_mat, output_mat, cv::NORM_INF);
+  EXPECT_EQ(max_diff, 0);
+}  // TEST
+
 }  // namespace
 }  // namespace mediapipe
@@ -27,12 +27,14 @@
 #include "audio/dsp/resampler_q.h"
 #include "audio/dsp/window_functions.h"
 #include "mediapipe/calculators/tensor/audio_to_tensor_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/time_series_util.h"
@@ -104,7 +106,9 @@ bool IsValidFftSize(int size) {
 //     be cached in a global sample buffer. The audio data resampled from the
 //     current raw audio input will be appended to the global sample buffer.
 //     The calculator will process the global sample buffer and output as many
-//     tensors as possible.
+//     tensors as possible. The sample buffer is reused across Process() calls,
+//     so once it fits the largest input packet, processing a packet does not
+//     reallocate it.
 //   Non-streaming mode: when "stream_mode" is set to false in the calculator
 //     options, the calculators treats the packets in the input audio stream as
 //     a batch of unrelated audio buffers. In each Process() call, the input
@@ -201,9 +205,19 @@ class AudioToTensorCalculator : public Node {
   audio_dsp::QResamplerParams params_;
   // A QResampler instance to resample an audio stream.
   std::unique_ptr<audio_dsp::QResampler<float>> resampler_;
+  // Reused resampler input and output in the streaming mode.
+  Matrix mixdown_buffer_;
+  Matrix resampled_buffer_;
+  // The samples buffered in the streaming mode are the first
+  // num_buffered_samples_ columns. Processed samples are moved out after each
+  // Process() call, so the buffer only grows if an input packet does not fit.
   Matrix sample_buffer_;
-  int processed_buffer_cols_ = 0;
+  int num_buffered_samples_ = 0;
+  // The number of samples before the first sample of the next frame in the
+  // buffer last passed to ProcessBuffer().
+  int num_processed_samples_ = 0;
   double gain_ = 1.0;
+  std::shared_ptr<TensorPool> tensor_pool_;
 
   // The internal state of the FFT library.
   PFFFT_Setup* fft_state_ = nullptr;
@@ -219,15 +233,17 @@ class AudioToTensorCalculator : public Node {
                                        const Matrix& input);
 
   absl::Status SetupStreamingResampler(double input_sample_rate_);
-  void AppendToSampleBuffer(Matrix buffer_to_append);
+  // Appends num_samples columns to the buffered samples and returns them, so
+  // that they can be written in place.
+  Matrix::ColsBlockXpr AppendToSampleBuffer(int num_samples);
   void AppendZerosToSampleBuffer(int num_samples);
+  // Removes the samples processed by the last ProcessBuffer() call.
+  void DropProcessedSamples();
 
-  absl::StatusOr<std::vector<Tensor>> ConvertToTensor(
-      const Matrix& block, std::vector<int> tensor_dims);
-  absl::Status OutputTensor(const Matrix& block, Timestamp timestamp,
-                            CalculatorContext* cc);
-  absl::Status ProcessBuffer(const Matrix& buffer, bool should_flush,
-                             CalculatorContext* cc);
+  absl::Status OutputTensor(const Eigen::Ref<const Matrix>& block,
+                            Timestamp timestamp, CalculatorContext* cc);
+  absl::Status ProcessBuffer(const Eigen::Ref<const Matrix>& buffer,
+                             bool should_flush, CalculatorContext* cc);
 };
 
 absl::Status AudioToTensorCalculator::UpdateContract(CalculatorContract* cc) {
@@ -254,6 +270,7 @@ absl::Status AudioToTensorCalculator::UpdateContract(CalculatorContract* cc) {
       options.flush_mode() != Options::PROCEED_AS_USUAL) {
     return absl::InvalidArgumentError("Unsupported flush mode");
   }
+  cc->UseService(kTensorPoolService).Optional();
   return absl::OkStatus();
 }
 
@@ -273,7 +290,7 @@ absl::Status AudioToTensorCalculator::Open(CalculatorContext* cc) {
   stream_mode_ = options.stream_mode();
   if (stream_mode_) {
     check_inconsistent_timestamps_ = options.check_inconsistent_timestamps();
-    sample_buffer_.resize(num_channels_, Eigen::NoChange);
+    sample_buffer_.resize(num_channels_, num_samples_ + frame_step_);
   }
   padding_samples_before_ = options.padding_samples_before();
   padding_samples_after_ = options.padding_samples_after();
@@ -302,6 +319,7 @@ absl::Status AudioToTensorCalculator::Open(CalculatorContext* cc) {
     }
   }
   AppendZerosToSampleBuffer(padding_samples_before_);
+  tensor_pool_ = GetTensorPool(cc);
   if (options.has_fft_size()) {
     RET_CHECK(IsValidFftSize(options.fft_size()))
         << "FFT size must be of the form fft_size = (2^a)*(3^b)*(5^c) where b "
@@ -349,15 +367,17 @@ absl::Status AudioToTensorCalculator::Process(CalculatorContext* cc) {
         "The audio data should be stored in column-major.");
   }
   CHECK(channels_match || mono_output);
+  if (stream_mode_) {
+    // Mixes down and applies the gain while appending to the sample buffer.
+    return ProcessStreamingData(cc, input_frame);
+  }
   const Matrix& input = channels_match ? input_frame
                                        // Mono mixdown.
                                        : input_frame.colwise().mean();
   if (gain_ != 1.0) {
-    return stream_mode_ ? ProcessStreamingData(cc, input * gain_)
-                        : ProcessNonStreamingData(cc, input * gain_);
+    return ProcessNonStreamingData(cc, input * gain_);
   }
-  return stream_mode_ ? ProcessStreamingData(cc, input)
-                      : ProcessNonStreamingData(cc, input);
+  return ProcessNonStreamingData(cc, input);
 }
 
 absl::Status AudioToTensorCalculator::Close(CalculatorContext* cc) {
@@ -365,12 +385,17 @@ absl::Status AudioToTensorCalculator::Close(CalculatorContext* cc) {
     return absl::OkStatus();
   }
   if (resampler_) {
-    Matrix resampled_buffer(num_channels_, 0);
-    resampler_->Flush(&resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    resampler_->Flush(&resampled_buffer_);
+    auto flushed = AppendToSampleBuffer(resampled_buffer_.cols());
+    flushed = resampled_buffer_;
+    if (gain_ != 1.0) {
+      flushed *= gain_;
+    }
   }
   AppendZerosToSampleBuffer(padding_samples_after_);
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/true, cc));
+  MP_RETURN_IF_ERROR(ProcessBuffer(
+      sample_buffer_.leftCols(num_buffered_samples_), /*should_flush=*/true,
+      cc));
   if (fft_state_) {
     pffft_destroy_setup(fft_state_);
   }
@@ -378,8 +403,7 @@ absl::Status AudioToTensorCalculator::Close(CalculatorContext* cc) {
 }
 
 absl::Status AudioToTensorCalculator::ProcessStreamingData(
-    CalculatorContext* cc, const Matrix& input) {
-  const auto& input_buffer = input;
+    CalculatorContext* cc, const Matrix& input_buffer) {
   if (initial_timestamp_ == Timestamp::Unstarted()) {
     initial_timestamp_ = cc->InputTimestamp();
     next_output_timestamp_ = initial_timestamp_;
@@ -399,26 +423,36 @@ absl::Status AudioToTensorCalculator::ProcessStreamingData(
     }
   }
 
+  // The special case of `num_channels_ == 1` is automatic mixdown to mono.
+  const bool mixdown = input_buffer.rows() != num_channels_;
   if (resampler_) {
-    Matrix resampled_buffer(num_channels_, 0);
-    resampler_->ProcessSamples(input_buffer, &resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    if (mixdown) {
+      mixdown_buffer_ = input_buffer.colwise().mean();
+      resampler_->ProcessSamples(mixdown_buffer_, &resampled_buffer_);
+    } else {
+      resampler_->ProcessSamples(input_buffer, &resampled_buffer_);
+    }
+    auto appended = AppendToSampleBuffer(resampled_buffer_.cols());
+    appended = resampled_buffer_;
+    if (gain_ != 1.0) {
+      appended *= gain_;
+    }
   } else {
-    // Tries to consume the input matrix first to avoid extra data copy.
-    auto status_or_matrix = kAudioIn(cc).packet().Consume<Matrix>();
-    if (status_or_matrix.ok()) {
-      Matrix local_matrix(num_channels_, 0);
-      local_matrix.swap(*status_or_matrix.value());
-      AppendToSampleBuffer(std::move(local_matrix));
+    auto appended = AppendToSampleBuffer(input_buffer.cols());
+    if (mixdown) {
+      appended = input_buffer.colwise().mean();
     } else {
-      AppendToSampleBuffer(input_buffer);
+      appended = input_buffer;
+    }
+    if (gain_ != 1.0) {
+      appended *= gain_;
     }
   }
 
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/false, cc));
-  // Removes the processed samples from the global sample buffer.
-  sample_buffer_ = Matrix(sample_buffer_.rightCols(sample_buffer_.cols() -
-                                                   processed_buffer_cols_ - 1));
+  MP_RETURN_IF_ERROR(ProcessBuffer(
+      sample_buffer_.leftCols(num_buffered_samples_), /*should_flush=*/false,
+      cc));
+  DropProcessedSamples();
   return absl::OkStatus();
 }
 
@@ -456,106 +490,126 @@ absl::Status AudioToTensorCalculator::SetupStreamingResampler(
   return absl::OkStatus();
 }
 
+Matrix::ColsBlockXpr AudioToTensorCalculator::AppendToSampleBuffer(
+    int num_samples) {
+  const int num_buffered_samples = num_buffered_samples_ + num_samples;
+  if (num_buffered_samples > sample_buffer_.cols()) {
+    sample_buffer_.conservativeResize(
+        num_channels_,
+        std::max<int>(num_buffered_samples, 2 * sample_buffer_.cols()));
+  }
+  auto appended = sample_buffer_.middleCols(num_buffered_samples_, num_samples);
+  num_buffered_samples_ = num_buffered_samples;
+  return appended;
+}
+
 void AudioToTensorCalculator::AppendZerosToSampleBuffer(int num_samples) {
   CHECK_GE(num_samples, 0);  // Ensured by `UpdateContract`.
   if (num_samples == 0) {
     return;
   }
-  sample_buffer_.conservativeResize(Eigen::NoChange,
-                                    sample_buffer_.cols() + num_samples);
-  sample_buffer_.rightCols(num_samples).setZero();
+  AppendToSampleBuffer(num_samples).setZero();
 }
 
-void AudioToTensorCalculator::AppendToSampleBuffer(Matrix buffer_to_append) {
-  sample_buffer_.conservativeResize(
-      Eigen::NoChange, sample_buffer_.cols() + buffer_to_append.cols());
-  sample_buffer_.rightCols(buffer_to_append.cols()).swap(buffer_to_append);
-}
-
-absl::StatusOr<std::vector<Tensor>> AudioToTensorCalculator::ConvertToTensor(
-    const Matrix& block, std::vector<int> tensor_dims) {
-  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape(tensor_dims));
-  auto buffer_view = tensor.GetCpuWriteView();
-  int total_size = 1;
-  for (int dim : tensor_dims) {
-    total_size *= dim;
-  }
-  if (block.size() < total_size) {
-    std::memset(buffer_view.buffer<float>(), 0, tensor.bytes());
-  }
-  std::memcpy(buffer_view.buffer<float>(), block.data(),
-              block.size() * sizeof(float));
-  std::vector<Tensor> tensor_vector;
-  tensor_vector.push_back(std::move(tensor));
-  return tensor_vector;
+void AudioToTensorCalculator::DropProcessedSamples() {
+  const int num_remaining_samples =
+      num_buffered_samples_ - num_processed_samples_;
+  if (num_processed_samples_ > 0 && num_remaining_samples > 0) {
+    // The columns are contiguous, so the remaining samples are moved at once.
+    std::memmove(sample_buffer_.data(),
+                 sample_buffer_.col(num_processed_samples_).data(),
+                 num_remaining_samples * num_channels_ * sizeof(float));
+  }
+  num_buffered_samples_ = num_remaining_samples;
 }
 
-absl::Status AudioToTensorCalculator::OutputTensor(const Matrix& block,
-                                                   Timestamp timestamp,
-                                                   CalculatorContext* cc) {
-  std::vector<Tensor> output_tensor;
+absl::Status AudioToTensorCalculator::OutputTensor(
+    const Eigen::Ref<const Matrix>& block, Timestamp timestamp,
+    CalculatorContext* cc) {
+  Tensor::Shape shape = {num_channels_, num_samples_};
   if (fft_state_) {
-    Eigen::VectorXf time_series_data =
-        Eigen::VectorXf::Map(block.data(), block.size());
-    //  Window on input audio prior to FFT.
-    std::transform(time_series_data.begin(), time_series_data.end(),
-                   fft_window_.begin(), fft_input_buffer_.begin(),
-                   std::multiplies<float>());
-    pffft_transform_ordered(fft_state_, fft_input_buffer_.data(),
-                            fft_output_.data(), fft_workplace_.data(),
-                            PFFFT_FORWARD);
-    if (kDcAndNyquistOut(cc).IsConnected()) {
-      kDcAndNyquistOut(cc).Send(std::make_pair(fft_output_[0], fft_output_[1]),
-                                timestamp);
-    }
     switch (dft_tensor_format_) {
-      case Options::WITH_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data() + 2, 1, fft_size_ - 2);
-        fft_output_matrix.conservativeResize(Eigen::NoChange, fft_size_);
-        // The last two elements are Nyquist component.
-        fft_output_matrix(fft_size_ - 2) = fft_output_[1];  // Nyquist real part
-        fft_output_matrix(fft_size_ - 1) = 0.0f;  // Nyquist imagery part
-        ASSIGN_OR_RETURN(output_tensor, ConvertToTensor(fft_output_matrix,
-                                                        {2, fft_size_ / 2}));
+      case Options::WITH_NYQUIST:
+        shape = {2, fft_size_ / 2};
         break;
-      }
-      case Options::WITH_DC_AND_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data(), 1, fft_size_);
-        fft_output_matrix.conservativeResize(Eigen::NoChange, fft_size_ + 2);
-        fft_output_matrix(1) = 0.0f;  // DC imagery part.
-        // The last two elements are  Nyquist component.
-        fft_output_matrix(fft_size_) = fft_output_[1];  // Nyquist real part
-        fft_output_matrix(fft_size_ + 1) = 0.0f;        // Nyquist imagery part
-        ASSIGN_OR_RETURN(
-            output_tensor,
-            ConvertToTensor(fft_output_matrix, {2, (fft_size_ + 2) / 2}));
+      case Options::WITH_DC_AND_NYQUIST:
+        shape = {2, (fft_size_ + 2) / 2};
         break;
-      }
-      case Options::WITHOUT_DC_AND_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data() + 2, 1, fft_size_ - 2);
-        ASSIGN_OR_RETURN(
-            output_tensor,
-            ConvertToTensor(fft_output_matrix, {2, (fft_size_ - 2) / 2}));
+      case Options::WITHOUT_DC_AND_NYQUIST:
+        shape = {2, (fft_size_ - 2) / 2};
         break;
-      }
       default:
         return absl::InvalidArgumentError("Unsupported dft tensor format.");
     }
-
-  } else {
-    ASSIGN_OR_RETURN(output_tensor,
-                     ConvertToTensor(block, {num_channels_, num_samples_}));
   }
-  kTensorsOut(cc).Send(std::move(output_tensor), timestamp);
+  // The tensor is written in place, and its buffer is recycled through the
+  // graph's tensor pool if available.
+  Tensor tensor = CreateCpuTensor(tensor_pool_.get(),
+                                  Tensor::ElementType::kFloat32, shape);
+  {
+    auto buffer_view = tensor.GetCpuWriteView();
+    float* tensor_buffer = buffer_view.buffer<float>();
+    if (fft_state_) {
+      //  Window on input audio prior to FFT. A final frame shorter than the
+      //  FFT is zero-padded.
+      const int num_frame_samples = block.cols();
+      Eigen::Map<Eigen::ArrayXf> fft_input(fft_input_buffer_.data(),
+                                           fft_size_);
+      fft_input.head(num_frame_samples) =
+          block.row(0).transpose().array() *
+          Eigen::Map<const Eigen::ArrayXf>(fft_window_.data(),
+                                           num_frame_samples);
+      fft_input.tail(fft_size_ - num_frame_samples).setZero();
+      pffft_transform_ordered(fft_state_, fft_input_buffer_.data(),
+                              fft_output_.data(), fft_workplace_.data(),
+                              PFFFT_FORWARD);
+      if (kDcAndNyquistOut(cc).IsConnected()) {
+        kDcAndNyquistOut(cc).Send(
+            std::make_pair(fft_output_[0], fft_output_[1]), timestamp);
+      }
+      switch (dft_tensor_format_) {
+        case Options::WITH_NYQUIST:
+          std::memcpy(tensor_buffer, fft_output_.data() + 2,
+                      (fft_size_ - 2) * sizeof(float));
+          // The last two elements are Nyquist component.
+          tensor_buffer[fft_size_ - 2] = fft_output_[1];  // Nyquist real part
+          tensor_buffer[fft_size_ - 1] = 0.0f;  // Nyquist imagery part
+          break;
+        case Options::WITH_DC_AND_NYQUIST:
+          std::memcpy(tensor_buffer, fft_output_.data(),
+                      fft_size_ * sizeof(float));
+          tensor_buffer[1] = 0.0f;  // DC imagery part.
+          // The last two elements are  Nyquist component.
+          tensor_buffer[fft_size_] = fft_output_[1];  // Nyquist real part
+          tensor_buffer[fft_size_ + 1] = 0.0f;        // Nyquist imagery part
+          break;
+        default:
+          std::memcpy(tensor_buffer, fft_output_.data() + 2,
+                      (fft_size_ - 2) * sizeof(float));
+          break;
+      }
+    } else {
+      if (block.size() < shape.num_elements()) {
+        std::memset(tensor_buffer, 0, tensor.bytes());
+      }
+      Eigen::Map<Matrix>(tensor_buffer, block.rows(), block.cols()) = block;
+    }
+  }
+  if (tensor_pool_) {
+    LogTensorPoolUsage(cc, *tensor_pool_,
+                       cc->Outputs().Tag(kTensorsOut.Tag()).Name());
+  }
+  std::vector<Tensor> output_tensor;
+  output_tensor.push_back(std::move(tensor));
+  kTensorsOut(cc).Send(
+      api2::MakePacketPooled<std::vector<Tensor>>(std::move(output_tensor))
+          .At(timestamp));
   return absl::OkStatus();
 }
 
-absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
-                                                    bool should_flush,
-                                                    CalculatorContext* cc) {
+absl::Status AudioToTensorCalculator::ProcessBuffer(
+    const Eigen::Ref<const Matrix>& buffer, bool should_flush,
+    CalculatorContext* cc) {
   const bool should_flush_at_timestamp_max =
       stream_mode_ && should_flush &&
       flush_mode_ == Options::ENTIRE_TAIL_AT_TIMESTAMP_MAX;
@@ -590,7 +644,7 @@ absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
     Timestamp timestamp = timestamps.back();
     kTimestampsOut(cc).Send(std::move(timestamps), timestamp);
   }
-  processed_buffer_cols_ = next_frame_first_col - 1;
+  num_processed_samples_ = next_frame_first_col;
   return absl::OkStatus();
 }
 
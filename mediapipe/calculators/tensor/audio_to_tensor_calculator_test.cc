@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
@@ -301,6 +302,10 @@ class AudioToTensorCalculatorStreamingModeTest : public ::testing::Test {
     num_iterations_ = num_iterations;
   }
 
+  void SetVolumeGainDb(double volume_gain_db) {
+    volume_gain_db_ = volume_gain_db;
+  }
+
   int GetExpectedNumOfSamples() { return output_sample_buffer_->cols(); }
 
   void Run(int num_samples, int num_overlapping_samples,
@@ -332,13 +337,15 @@ class AudioToTensorCalculatorStreamingModeTest : public ::testing::Test {
               padding_samples_before: $3
               padding_samples_after: $4
               flush_mode: $5
+              volume_gain_db: $6
             }
           }
         }
         )",
                          /*$0=*/num_samples, /*$1=*/num_overlapping_samples,
                          /*$2=*/target_sample_rate, /*$3=*/padding_before,
-                         /*$4=*/padding_after, /*$5=*/flush_mode));
+                         /*$4=*/padding_after, /*$5=*/flush_mode,
+                         /*$6=*/volume_gain_db_));
     tool::AddVectorSink("tensors", &graph_config, &tensors_packets_);
 
     // Run the graph.
@@ -370,6 +377,7 @@ class AudioToTensorCalculatorStreamingModeTest : public ::testing::Test {
       output_sample_buffer_ =
           ResampleBuffer(*sample_buffer_, resampling_factor);
     }
+    *output_sample_buffer_ *= std::pow(10.0, volume_gain_db_ / 20.0);
     if (padding_before != 0 || padding_after != 0) {
       Matrix padded = Matrix::Zero(
           2, padding_before + output_sample_buffer_->cols() + padding_after);
@@ -424,6 +432,7 @@ class AudioToTensorCalculatorStreamingModeTest : public ::testing::Test {
  private:
   int input_buffer_num_samples_ = 10;
   int num_iterations_ = 10;
+  double volume_gain_db_ = 0.0;
   CalculatorGraph graph_;
   std::vector<Packet> tensors_packets_;
   std::unique_ptr<Matrix> sample_buffer_;
@@ -526,6 +535,20 @@ TEST_F(AudioToTensorCalculatorStreamingModeTest,
   CloseGraph();
 }
 
+TEST_F(AudioToTensorCalculatorStreamingModeTest,
+       DownsamplingWithOverlappingAndGain) {
+  SetInputBufferNumSamplesPerChannel(100);
+  SetVolumeGainDb(6.0);
+  Run(/*num_samples=*/64, /*num_overlapping_samples=*/16,
+      /*resampling_factor=*/0.5f);
+  CheckTensorsOutputPackets(
+      /*sample_offset=*/96,
+      /*num_packets=*/DivideRoundedUp(GetExpectedNumOfSamples(), 48),
+      /*timestamp_interval=*/9600,
+      /*output_last_at_close=*/true);
+  CloseGraph();
+}
+
 TEST_F(AudioToTensorCalculatorStreamingModeTest, NegativePaddingUnsupported) {
   SetInputBufferNumSamplesPerChannel(1024);
   Run(/*num_samples=*/256, /*num_overlapping_samples=*/64,
@@ -25,12 +25,14 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/calculators/tensor/bert_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
@@ -71,8 +73,11 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 // TODO: Handle preprocessing for other Text Tasks too.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The input text.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts, tokenized on `num_threads` threads. Exactly one
+//     of TEXT and TEXTS must be connected.
 // Side Inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the BERT model. Used to determine the order of
@@ -92,6 +97,10 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 //            and 0 elsewhere.
 //     The Tensors will have size equal to the max sequence length for the BERT
 //     model.
+//     With TEXTS, the Tensors have a row per text, padded to the max sequence
+//     length or, for dynamic input tensors, to the longest text of the batch.
+//     Their shape is dynamic so that the inference runner resizes the model
+//     inputs to the batch size.
 //
 // Example:
 // node {
@@ -107,12 +116,14 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 // }
 class BertPreprocessorCalculator : public Node {
  public:
-  static constexpr Input<std::string> kTextIn{"TEXT"};
+  static constexpr Input<std::string>::Optional kTextIn{"TEXT"};
+  static constexpr Input<std::vector<std::string>>::Optional kTextsIn{"TEXTS"};
   static constexpr SideInput<ModelMetadataExtractor> kMetadataExtractorSideIn{
       "METADATA_EXTRACTOR"};
   static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
 
-  MEDIAPIPE_NODE_CONTRACT(kTextIn, kMetadataExtractorSideIn, kTensorsOut);
+  MEDIAPIPE_NODE_CONTRACT(kTextIn, kTextsIn, kMetadataExtractorSideIn,
+                          kTensorsOut);
 
   static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
@@ -130,22 +141,33 @@ class BertPreprocessorCalculator : public Node {
   int input_masks_tensor_index_ = 2;
   // Whether the model's input tensor shapes are dynamic.
   bool has_dynamic_input_tensors_ = false;
+  // Tokenizes the texts of a TEXTS batch if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
 
   // Applies `tokenizer_` to the `input_text` to generate a vector of tokens.
   // This util prepends "[CLS]" and appends "[SEP]" to the input tokens and
   // clips the vector of tokens to have length at most `bert_max_seq_len_` if
   // the input tensors are static.
   std::vector<std::string> TokenizeInputText(absl::string_view input_text);
-  // Processes the `input_tokens` to generate the three input tensors of size
-  // `tensor_size` for the BERT model.
+  // Converts the `input_tokens` to their ids in the vocab.
+  std::vector<int32_t> LookupInputIds(
+      const std::vector<std::string>& input_tokens);
+  // Processes the `input_ids` of each text to generate the three input
+  // tensors of size `[input_ids.size(), tensor_size]` for the BERT model.
   std::vector<Tensor> GenerateInputTensors(
-      const std::vector<std::string>& input_tokens, int tensor_size);
+      const std::vector<std::vector<int32_t>>& input_ids, int tensor_size,
+      bool is_dynamic);
+  // Tokenizes the `input_texts` and converts their tokens to ids.
+  std::vector<std::vector<int32_t>> TokenizeInputTexts(
+      const std::vector<std::string>& input_texts);
 };
 
 absl::Status BertPreprocessorCalculator::UpdateContract(
     CalculatorContract* cc) {
   const auto& options =
       cc->Options<mediapipe::BertPreprocessorCalculatorOptions>();
+  RET_CHECK(kTextIn(cc).IsConnected() ^ kTextsIn(cc).IsConnected())
+      << "Exactly one of TEXT and TEXTS must be connected.";
   if (options.has_dynamic_input_tensors()) {
     return absl::OkStatus();
   } else {
@@ -186,19 +208,73 @@ absl::Status BertPreprocessorCalculator::Open(CalculatorContext* cc) {
       cc->Options<mediapipe::BertPreprocessorCalculatorOptions>();
   bert_max_seq_len_ = options.bert_max_seq_len();
   has_dynamic_input_tensors_ = options.has_dynamic_input_tensors();
+  if (kTextsIn(cc).IsConnected() && options.num_threads() > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>("bert_preprocessor",
+                                                options.num_threads());
+    thread_pool_->StartWorkers();
+  }
   return absl::OkStatus();
 }
 
 absl::Status BertPreprocessorCalculator::Process(CalculatorContext* cc) {
+  if (kTextsIn(cc).IsConnected()) {
+    const std::vector<std::string>& input_texts = kTextsIn(cc).Get();
+    RET_CHECK(!input_texts.empty()) << "TEXTS must not be empty.";
+    std::vector<std::vector<int32_t>> input_ids =
+        TokenizeInputTexts(input_texts);
+    int tensor_size = bert_max_seq_len_;
+    if (has_dynamic_input_tensors_) {
+      tensor_size = 0;
+      for (const auto& ids : input_ids) {
+        tensor_size = std::max<int>(tensor_size, ids.size());
+      }
+    }
+    kTensorsOut(cc).Send(
+        GenerateInputTensors(input_ids, tensor_size, /*is_dynamic=*/true));
+    return absl::OkStatus();
+  }
+
   int tensor_size = bert_max_seq_len_;
   std::vector<std::string> input_tokens = TokenizeInputText(kTextIn(cc).Get());
   if (has_dynamic_input_tensors_) {
     tensor_size = input_tokens.size();
   }
-  kTensorsOut(cc).Send(GenerateInputTensors(input_tokens, tensor_size));
+  kTensorsOut(cc).Send(GenerateInputTensors({LookupInputIds(input_tokens)},
+                                            tensor_size,
+                                            has_dynamic_input_tensors_));
   return absl::OkStatus();
 }
 
+std::vector<std::vector<int32_t>>
+BertPreprocessorCalculator::TokenizeInputTexts(
+    const std::vector<std::string>& input_texts) {
+  std::vector<std::vector<int32_t>> input_ids(input_texts.size());
+  auto tokenize = [this, &input_texts, &input_ids](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      input_ids[i] = LookupInputIds(TokenizeInputText(input_texts[i]));
+    }
+  };
+  const int num_texts = input_texts.size();
+  const int num_ranges =
+      thread_pool_ == nullptr
+          ? 1
+          : std::min(thread_pool_->num_threads(), num_texts);
+  if (num_ranges == 1) {
+    tokenize(0, num_texts);
+    return input_ids;
+  }
+  absl::BlockingCounter counter(num_ranges);
+  for (int range = 0; range < num_ranges; ++range) {
+    thread_pool_->Schedule([&tokenize, &counter, range, num_ranges, num_texts] {
+      tokenize(num_texts * range / num_ranges,
+               num_texts * (range + 1) / num_ranges);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  return input_ids;
+}
+
 std::vector<std::string> BertPreprocessorCalculator::TokenizeInputText(
     absl::string_view input_text) {
   std::string processed_input = std::string(input_text);
@@ -224,40 +300,49 @@ std::vector<std::string> BertPreprocessorCalculator::TokenizeInputText(
   return input_tokens;
 }
 
-std::vector<Tensor> BertPreprocessorCalculator::GenerateInputTensors(
-    const std::vector<std::string>& input_tokens, int tensor_size) {
-  std::vector<int32_t> input_ids(tensor_size, 0);
-  std::vector<int32_t> segment_ids(tensor_size, 0);
-  std::vector<int32_t> input_masks(tensor_size, 0);
-  // Convert tokens back into ids and set mask
+std::vector<int32_t> BertPreprocessorCalculator::LookupInputIds(
+    const std::vector<std::string>& input_tokens) {
+  std::vector<int32_t> input_ids(input_tokens.size(), 0);
   for (int i = 0; i < input_tokens.size(); ++i) {
     tokenizer_->LookupId(input_tokens[i], &input_ids[i]);
-    input_masks[i] = 1;
   }
-  //                           |<-----------tensor_size------------>|
-  // input_ids                 [CLS] s1  s2...  sn [SEP]  0  0...  0
-  // segment_ids                 0    0   0...  0    0    0  0...  0
-  // input_masks                 1    1   1...  1    1    0  0...  0
+  return input_ids;
+}
 
+std::vector<Tensor> BertPreprocessorCalculator::GenerateInputTensors(
+    const std::vector<std::vector<int32_t>>& input_ids, int tensor_size,
+    bool is_dynamic) {
+  const int batch_size = input_ids.size();
   std::vector<Tensor> input_tensors;
   input_tensors.reserve(kNumInputTensorsForBert);
   for (int i = 0; i < kNumInputTensorsForBert; ++i) {
     input_tensors.push_back(
         {Tensor::ElementType::kInt32,
-         Tensor::Shape({1, tensor_size}, has_dynamic_input_tensors_)});
+         Tensor::Shape({batch_size, tensor_size}, is_dynamic)});
   }
-  std::memcpy(input_tensors[input_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_ids.data(), input_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[segment_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              segment_ids.data(), segment_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[input_masks_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_masks.data(), input_masks.size() * sizeof(int32_t));
+  auto input_ids_view =
+      input_tensors[input_ids_tensor_index_].GetCpuWriteView();
+  auto segment_ids_view =
+      input_tensors[segment_ids_tensor_index_].GetCpuWriteView();
+  auto input_masks_view =
+      input_tensors[input_masks_tensor_index_].GetCpuWriteView();
+  int32_t* input_ids_buffer = input_ids_view.buffer<int32_t>();
+  int32_t* segment_ids_buffer = segment_ids_view.buffer<int32_t>();
+  int32_t* input_masks_buffer = input_masks_view.buffer<int32_t>();
+  std::fill_n(input_ids_buffer, batch_size * tensor_size, 0);
+  std::fill_n(segment_ids_buffer, batch_size * tensor_size, 0);
+  std::fill_n(input_masks_buffer, batch_size * tensor_size, 0);
+  // Set the ids and mask of each row.
+  for (int i = 0; i < batch_size; ++i) {
+    const int num_ids = std::min<int>(input_ids[i].size(), tensor_size);
+    std::memcpy(input_ids_buffer + i * tensor_size, input_ids[i].data(),
+                num_ids * sizeof(int32_t));
+    std::fill_n(input_masks_buffer + i * tensor_size, num_ids, 1);
+  }
+  //                           |<-----------tensor_size------------>|
+  // input_ids                 [CLS] s1  s2...  sn [SEP]  0  0...  0
+  // segment_ids                 0    0   0...  0    0    0  0...  0
+  // input_masks                 1    1   1...  1    1    0  0...  0
   return input_tensors;
 }
 
@@ -152,5 +152,65 @@ TEST(BertPreprocessorCalculatorTest, LongInput) {
   EXPECT_THAT(processed_tensor_values, ElementsAreArray(expected_result));
 }
 
+TEST(BertPreprocessorCalculatorTest, BatchedTexts) {
+  const std::vector<std::string> texts = {
+      "it's a charming and often affecting journey",
+      "unflinchingly bleak and desperate", "meh"};
+  auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"(
+        input_stream: "texts"
+        output_stream: "tensors"
+        node {
+          calculator: "BertPreprocessorCalculator"
+          input_stream: "TEXTS:texts"
+          input_side_packet: "METADATA_EXTRACTOR:metadata_extractor"
+          output_stream: "TENSORS:tensors"
+          options {
+            [mediapipe.BertPreprocessorCalculatorOptions.ext] {
+              bert_max_seq_len: $0
+              num_threads: 2
+            }
+          }
+        }
+      )",
+                       kBertMaxSeqLen));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensors", &graph_config, &output_packets);
+  std::string model_buffer =
+      tasks::core::LoadBinaryContent(kTestModelPath.data());
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ModelMetadataExtractor> extractor,
+                          ModelMetadataExtractor::CreateFromModelBuffer(
+                              model_buffer.data(), model_buffer.size()));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(
+      graph_config,
+      {{"metadata_extractor",
+        MakePacket<ModelMetadataExtractor>(std::move(*extractor))}}));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "texts", MakePacket<std::vector<std::string>>(texts).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  ASSERT_EQ(output_packets.size(), 1);
+  const auto& tensors = output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensors.size(), kNumInputTensorsForBert);
+  for (int i = 0; i < texts.size(); ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::vector<int>> expected_result,
+        RunBertPreprocessorCalculator(texts[i], kTestModelPath));
+    for (int j = 0; j < tensors.size(); ++j) {
+      EXPECT_THAT(tensors[j].shape().dims,
+                  ElementsAreArray({static_cast<int>(texts.size()),
+                                    kBertMaxSeqLen}));
+      const int* buffer = tensors[j].GetCpuReadView().buffer<int>() +
+                          i * kBertMaxSeqLen;
+      EXPECT_THAT(std::vector<int>(buffer, buffer + kBertMaxSeqLen),
+                  ElementsAreArray(expected_result[j]));
+    }
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace
 }  // namespace mediapipe
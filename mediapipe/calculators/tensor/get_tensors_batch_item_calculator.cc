@@ -0,0 +1,110 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Takes one entry of the batch (first) dimension of all input tensors, e.g. to
+// process the outputs of an inference on a batch of regions of interest one
+// region at a time, inside a BeginLoop/EndLoop pair.
+//
+// Inputs:
+//   TENSORS - std::vector<Tensor>
+//     CPU tensors that all have the same batch size.
+//   INDEX - int
+//     Index of the batch entry to take.
+//
+// Outputs:
+//   TENSORS - std::vector<Tensor>
+//     The batch entry of each input tensor, as a tensor with a batch size of 1
+//     and the same element type and quantization parameters.
+//
+// Usage example:
+// node {
+//   calculator: "GetTensorsBatchItemCalculator"
+//   input_stream: "TENSORS:batched_tensors"
+//   input_stream: "INDEX:index"
+//   output_stream: "TENSORS:tensors"
+// }
+class GetTensorsBatchItemCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
+  static constexpr Input<int> kInIndex{"INDEX"};
+  static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInIndex, kOutTensors);
+
+  static absl::Status UpdateContract(CalculatorContract* cc) {
+    cc->UseService(kTensorPoolService).Optional();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    tensor_pool_ = GetTensorPool(cc);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInTensors(cc).IsEmpty() || kInIndex(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const auto& input_tensors = *kInTensors(cc);
+    const int index = *kInIndex(cc);
+    auto output_tensors = std::make_unique<std::vector<Tensor>>();
+    output_tensors->reserve(input_tensors.size());
+    for (int i = 0; i < input_tensors.size(); ++i) {
+      const Tensor& input_tensor = input_tensors[i];
+      const auto& dims = input_tensor.shape().dims;
+      RET_CHECK(!dims.empty() && dims[0] > 0)
+          << "Tensor " << i << " has no batch dimension.";
+      RET_CHECK(index >= 0 && index < dims[0])
+          << "Index " << index << " is out of range for tensor " << i
+          << " with batch size " << dims[0];
+      RET_CHECK(input_tensor.element_type() != Tensor::ElementType::kChar)
+          << "String tensors can't be indexed by batch entry.";
+      std::vector<int> item_dims = dims;
+      item_dims[0] = 1;
+      output_tensors->push_back(CreateCpuTensor(
+          tensor_pool_.get(), input_tensor.element_type(),
+          Tensor::Shape(item_dims), input_tensor.quantization_parameters()));
+      const size_t item_bytes = input_tensor.bytes() / dims[0];
+      std::memcpy(output_tensors->back().GetCpuWriteView().buffer<char>(),
+                  input_tensor.GetCpuReadView().buffer<char>() +
+                      index * item_bytes,
+                  item_bytes);
+    }
+    kOutTensors(cc).Send(std::move(output_tensors));
+    return absl::OkStatus();
+  }
+
+ private:
+  std::shared_ptr<TensorPool> tensor_pool_;
+};
+
+MEDIAPIPE_REGISTER_NODE(GetTensorsBatchItemCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -0,0 +1,113 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::mediapipe::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+constexpr char kCalculatorConfig[] = R"pb(
+  calculator: "GetTensorsBatchItemCalculator"
+  input_stream: "TENSORS:input"
+  input_stream: "INDEX:index"
+  output_stream: "TENSORS:output"
+)pb";
+
+template <typename T>
+Tensor MakeTensor(Tensor::ElementType type, const Tensor::Shape& shape,
+                  const std::vector<T>& values,
+                  Tensor::QuantizationParameters quantization_parameters = {}) {
+  Tensor tensor(type, shape, quantization_parameters);
+  auto view = tensor.GetCpuWriteView();
+  std::copy(values.begin(), values.end(), view.buffer<T>());
+  return tensor;
+}
+
+template <typename T>
+std::vector<T> GetValues(const Tensor& tensor) {
+  auto view = tensor.GetCpuReadView();
+  const T* buffer = view.buffer<T>();
+  return std::vector<T>(buffer, buffer + tensor.shape().num_elements());
+}
+
+class GetTensorsBatchItemCalculatorTest : public ::testing::Test {
+ protected:
+  GetTensorsBatchItemCalculatorTest()
+      : runner_(ParseTextProtoOrDie<Node>(kCalculatorConfig)) {}
+
+  // Adds a batch of 3 entries with a float and a quantized tensor.
+  void PushTensors(int index) {
+    auto tensors = std::make_unique<std::vector<Tensor>>();
+    tensors->push_back(MakeTensor<float>(Tensor::ElementType::kFloat32,
+                                         Tensor::Shape{3, 2},
+                                         {0, 1, 10, 11, 20, 21}));
+    tensors->push_back(MakeTensor<uint8_t>(
+        Tensor::ElementType::kUInt8, Tensor::Shape{3, 1, 1}, {5, 6, 7},
+        Tensor::QuantizationParameters{0.5f, 3}));
+    runner_.MutableInputs()->Tag("TENSORS").packets.push_back(
+        Adopt(tensors.release()).At(Timestamp(0)));
+    runner_.MutableInputs()->Tag("INDEX").packets.push_back(
+        MakePacket<int>(index).At(Timestamp(0)));
+  }
+
+  CalculatorRunner runner_;
+};
+
+TEST_F(GetTensorsBatchItemCalculatorTest, TakesBatchEntryOfAllTensors) {
+  PushTensors(/*index=*/1);
+
+  MP_ASSERT_OK(runner_.Run());
+
+  const auto& packets = runner_.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& tensors = packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensors.size(), 2);
+  EXPECT_EQ(tensors[0].element_type(), Tensor::ElementType::kFloat32);
+  EXPECT_THAT(tensors[0].shape().dims, ElementsAre(1, 2));
+  EXPECT_THAT(GetValues<float>(tensors[0]), ElementsAre(10, 11));
+  EXPECT_EQ(tensors[1].element_type(), Tensor::ElementType::kUInt8);
+  EXPECT_THAT(tensors[1].shape().dims, ElementsAre(1, 1, 1));
+  EXPECT_THAT(GetValues<uint8_t>(tensors[1]), ElementsAre(6));
+  EXPECT_FLOAT_EQ(tensors[1].quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(tensors[1].quantization_parameters().zero_point, 3);
+}
+
+TEST_F(GetTensorsBatchItemCalculatorTest, FailsWithOutOfRangeIndex) {
+  PushTensors(/*index=*/3);
+
+  auto status = runner_.Run();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+  EXPECT_THAT(status.message(), HasSubstr("out of range"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -19,12 +19,14 @@
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -79,9 +81,19 @@ namespace api2 {
 //     Describes region of image to extract.
 //     @Optional: rect covering the whole image is used if not specified.
 //
+//   NORM_RECTS - std::vector<NormalizedRect> @Optional
+//     Describes multiple regions of the image to extract into one batched
+//     tensor, e.g. all detected hands or faces of a frame. Cannot be used
+//     together with NORM_RECT. Nothing is output for an empty vector.
+//     CPU only: requires a CPU image on IMAGE and the OpenCV converter, so it
+//     cannot be used with IMAGE_GPU, GPU-backed images or
+//     MEDIAPIPE_DISABLE_OPENCV.
+//
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     With NORM_RECTS, the Tensor has one batch entry per region, in the
+//     order of the regions, and a dynamic shape.
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix that
 //     maps a point on the input image to a point on the output tensor, and
@@ -98,6 +110,11 @@ namespace api2 {
 //     20x20 and places it in the middle of the output image with an equal
 //     padding of 10 pixels at the top and the bottom. The resulting array is
 //     therefore [0.f, 0.25f, 0.f, 0.25f] (10/40 = 0.25f).
+//   MATRICES - std::vector<std::array<float, 16>> @Optional
+//   LETTERBOX_PADDINGS - std::vector<std::array<float, 4>> @Optional
+//     Same as MATRIX and LETTERBOX_PADDING, one per region of NORM_RECTS.
+//     MATRIX and LETTERBOX_PADDING cannot be used with NORM_RECTS, and these
+//     can only be used with NORM_RECTS.
 //
 // Example:
 // node {
@@ -126,13 +143,20 @@ class ImageToTensorCalculator : public Node {
   static constexpr Input<GpuBuffer>::Optional kInGpu{"IMAGE_GPU"};
   static constexpr Input<mediapipe::NormalizedRect>::Optional kInNormRect{
       "NORM_RECT"};
+  static constexpr Input<std::vector<mediapipe::NormalizedRect>>::Optional
+      kInNormRects{"NORM_RECTS"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   static constexpr Output<std::array<float, 4>>::Optional kOutLetterboxPadding{
       "LETTERBOX_PADDING"};
   static constexpr Output<std::array<float, 16>>::Optional kOutMatrix{"MATRIX"};
+  static constexpr Output<std::vector<std::array<float, 4>>>::Optional
+      kOutLetterboxPaddings{"LETTERBOX_PADDINGS"};
+  static constexpr Output<std::vector<std::array<float, 16>>>::Optional
+      kOutMatrices{"MATRICES"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kOutTensors,
-                          kOutLetterboxPadding, kOutMatrix);
+  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kInNormRects, kOutTensors,
+                          kOutLetterboxPadding, kOutMatrix,
+                          kOutLetterboxPaddings, kOutMatrices);
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
     const auto& options =
@@ -141,6 +165,26 @@ class ImageToTensorCalculator : public Node {
     RET_CHECK_OK(ValidateOptionOutputDims(options));
     RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
         << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    if (kInNormRects(cc).IsConnected()) {
+      RET_CHECK(!kInNormRect(cc).IsConnected())
+          << "NORM_RECT and NORM_RECTS cannot be used together.";
+      RET_CHECK(!kOutLetterboxPadding(cc).IsConnected() &&
+                !kOutMatrix(cc).IsConnected())
+          << "Use LETTERBOX_PADDINGS and MATRICES with NORM_RECTS.";
+      // Only the OpenCV converter writes several regions into one tensor.
+      RET_CHECK(!kInGpu(cc).IsConnected())
+          << "NORM_RECTS only supports CPU images on the IMAGE input.";
+#if MEDIAPIPE_DISABLE_OPENCV
+      return absl::UnimplementedError(
+          "NORM_RECTS requires the OpenCV converter, which is unavailable when "
+          "MEDIAPIPE_DISABLE_OPENCV is defined.");
+#endif  // MEDIAPIPE_DISABLE_OPENCV
+    } else {
+      RET_CHECK(!kOutLetterboxPaddings(cc).IsConnected() &&
+                !kOutMatrices(cc).IsConnected())
+          << "LETTERBOX_PADDINGS and MATRICES require NORM_RECTS.";
+    }
+    cc->UseService(kTensorPoolService).Optional();
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -161,6 +205,7 @@ class ImageToTensorCalculator : public Node {
   absl::Status Open(CalculatorContext* cc) {
     options_ = cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
     params_ = GetOutputTensorParams(options_);
+    tensor_pool_ = GetTensorPool(cc);
     return absl::OkStatus();
   }
 
@@ -170,6 +215,9 @@ class ImageToTensorCalculator : public Node {
       // Timestamp bound update happens automatically.
       return absl::OkStatus();
     }
+    if (kInNormRects(cc).IsConnected()) {
+      return ProcessBatch(cc);
+    }
 
     absl::optional<mediapipe::NormalizedRect> norm_rect;
     if (kInNormRect(cc).IsConnected()) {
@@ -219,13 +267,24 @@ class ImageToTensorCalculator : public Node {
 
     Tensor::ElementType output_tensor_type =
         GetOutputTensorType(image->UsesGpu(), params_);
-    Tensor tensor(output_tensor_type, {1, tensor_height, tensor_width,
-                                       GetNumOutputChannels(*image)});
+    const Tensor::Shape tensor_shape = {1, tensor_height, tensor_width,
+                                        GetNumOutputChannels(*image)};
+    // CPU tensors recycle their buffers through the graph's tensor pool.
+    Tensor tensor =
+        image->UsesGpu()
+            ? Tensor(output_tensor_type, tensor_shape)
+            : CreateCpuTensor(tensor_pool_.get(), output_tensor_type,
+                              tensor_shape);
     MP_RETURN_IF_ERROR((image->UsesGpu() ? gpu_converter_ : cpu_converter_)
                            ->Convert(*image, roi, params_.range_min,
                                      params_.range_max,
                                      /*tensor_buffer_offset=*/0, tensor));
 
+    if (tensor_pool_ && !image->UsesGpu()) {
+      LogTensorPoolUsage(cc, *tensor_pool_,
+                         cc->Outputs().Tag(kOutTensors.Tag()).Name());
+    }
+
     auto result = std::make_unique<std::vector<Tensor>>();
     result->push_back(std::move(tensor));
     kOutTensors(cc).Send(std::move(result));
@@ -234,6 +293,74 @@ class ImageToTensorCalculator : public Node {
   }
 
  private:
+  // Extracts all regions of NORM_RECTS into a single batched tensor.
+  absl::Status ProcessBatch(CalculatorContext* cc) {
+    if (kInNormRects(cc).IsEmpty() || kInNormRects(cc)->empty()) {
+      // Timestamp bound update happens automatically.
+      return absl::OkStatus();
+    }
+    const auto& norm_rects = *kInNormRects(cc);
+
+    ASSIGN_OR_RETURN(auto image, GetInputImage(kIn(cc)));
+    if (image->UsesGpu()) {
+      return absl::InvalidArgumentError(
+          "NORM_RECTS only supports CPU images, but the IMAGE input holds a "
+          "GPU image.");
+    }
+
+    const int tensor_width = params_.output_width.value_or(image->width());
+    const int tensor_height = params_.output_height.value_or(image->height());
+    std::vector<RotatedRect> rois;
+    rois.reserve(norm_rects.size());
+    auto paddings = std::make_unique<std::vector<std::array<float, 4>>>();
+    paddings->reserve(norm_rects.size());
+    for (const auto& norm_rect : norm_rects) {
+      RotatedRect roi = GetRoi(image->width(), image->height(), norm_rect);
+      ASSIGN_OR_RETURN(auto padding,
+                       PadRoi(tensor_width, tensor_height,
+                              options_.keep_aspect_ratio(), &roi));
+      rois.push_back(roi);
+      paddings->push_back(padding);
+    }
+    if (kOutLetterboxPaddings(cc).IsConnected()) {
+      kOutLetterboxPaddings(cc).Send(std::move(paddings));
+    }
+    if (kOutMatrices(cc).IsConnected()) {
+      auto matrices = std::make_unique<std::vector<std::array<float, 16>>>(
+          rois.size());
+      for (int i = 0; i < rois.size(); ++i) {
+        GetRotatedSubRectToRectTransformMatrix(
+            rois[i], image->width(), image->height(),
+            /*flip_horizontaly=*/false, &(*matrices)[i]);
+      }
+      kOutMatrices(cc).Send(std::move(matrices));
+    }
+
+    MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, *image.get()));
+
+    // The batch size varies with the number of regions, so that inference
+    // has to resize its inputs to it.
+    const Tensor::Shape tensor_shape(
+        {static_cast<int>(rois.size()), tensor_height, tensor_width,
+         GetNumOutputChannels(*image)},
+        /*is_dynamic=*/true);
+    Tensor tensor = CreateCpuTensor(
+        tensor_pool_.get(), GetOutputTensorType(/*uses_gpu=*/false, params_),
+        tensor_shape);
+    MP_RETURN_IF_ERROR(cpu_converter_->BatchConvert(
+        *image, rois, params_.range_min, params_.range_max, tensor));
+
+    if (tensor_pool_) {
+      LogTensorPoolUsage(cc, *tensor_pool_,
+                         cc->Outputs().Tag(kOutTensors.Tag()).Name());
+    }
+
+    auto result = std::make_unique<std::vector<Tensor>>();
+    result->push_back(std::move(tensor));
+    kOutTensors(cc).Send(std::move(result));
+    return absl::OkStatus();
+  }
+
   absl::Status InitConverterIfNecessary(CalculatorContext* cc,
                                         const Image& image) {
     // Lazy initialization of the GPU or CPU converter.
@@ -297,6 +424,7 @@ class ImageToTensorCalculator : public Node {
   std::unique_ptr<ImageToTensorConverter> cpu_converter_;
   mediapipe::ImageToTensorCalculatorOptions options_;
   OutputTensorParams params_;
+  std::shared_ptr<TensorPool> tensor_pool_;
 };
 
 MEDIAPIPE_REGISTER_NODE(ImageToTensorCalculator);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <cmath>
 #include <optional>
 #include <string>
@@ -512,6 +513,90 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeAndUseInputImageDims) {
           /*keep_aspect=*/false, BorderMode::kZero, roi);
 }
 
+TEST(ImageToTensorCalculatorTest, MultipleRoisAreBatched) {
+  auto graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        input_stream: "rois"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:input_image"
+          input_stream: "NORM_RECTS:rois"
+          output_stream: "TENSORS:tensor"
+          output_stream: "MATRICES:matrices"
+          output_stream: "LETTERBOX_PADDINGS:paddings"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 256
+              output_tensor_height: 256
+              keep_aspect_ratio: true
+              output_tensor_float_range { min: 0.0f max: 1.0f }
+              border_mode: BORDER_REPLICATE
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> tensor_packets;
+  std::vector<Packet> matrices_packets;
+  std::vector<Packet> paddings_packets;
+  tool::AddVectorSink("tensor", &graph_config, &tensor_packets);
+  tool::AddVectorSink("matrices", &graph_config, &matrices_packets);
+  tool::AddVectorSink("paddings", &graph_config, &paddings_packets);
+
+  std::vector<mediapipe::NormalizedRect> rois(2);
+  for (auto& roi : rois) {
+    roi.set_x_center(0.65f);
+    roi.set_y_center(0.4f);
+    roi.set_width(0.5f);
+    roi.set_height(0.5f);
+  }
+  rois[0].set_rotation(0);
+  rois[1].set_rotation(M_PI * 90.0f / 180.0f);
+  const std::vector<cv::Mat> expected_results = {
+      GetRgb(GetFilePath("medium_sub_rect_keep_aspect.png")),
+      GetRgb(GetFilePath("medium_sub_rect_keep_aspect_with_rotation.png"))};
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  cv::Mat input = GetRgb(GetFilePath("input.jpg"));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("input_image", MakeImagePacket(input)));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "rois", MakePacket<std::vector<mediapipe::NormalizedRect>>(rois).At(
+                  Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(tensor_packets, testing::SizeIs(1));
+  ASSERT_THAT(matrices_packets, testing::SizeIs(1));
+  ASSERT_THAT(paddings_packets, testing::SizeIs(1));
+  EXPECT_THAT(matrices_packets[0].Get<std::vector<std::array<float, 16>>>(),
+              testing::SizeIs(2));
+  EXPECT_THAT(paddings_packets[0].Get<std::vector<std::array<float, 4>>>(),
+              testing::SizeIs(2));
+
+  const std::vector<Tensor>& tensor_vec =
+      tensor_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_THAT(tensor_vec, testing::SizeIs(1));
+  const Tensor& tensor = tensor_vec[0];
+  EXPECT_EQ(tensor.shape().dims, std::vector<int>({2, 256, 256, 3}));
+  auto view = tensor.GetCpuReadView();
+  for (int i = 0; i < 2; ++i) {
+    cv::Mat tensor_mat(256, 256, CV_32FC3,
+                       const_cast<float*>(view.buffer<float>()) +
+                           i * 256 * 256 * 3);
+    cv::Mat result_rgb;
+    tensor_mat.convertTo(result_rgb, CV_8UC3, 255.0f);
+    cv::Mat diff;
+    cv::absdiff(result_rgb, expected_results[i], diff);
+    double max_val;
+    cv::minMaxLoc(diff, nullptr, &max_val);
+    EXPECT_LE(max_val, 5) << "roi " << i;
+  }
+
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 TEST(ImageToTensorCalculatorTest, CanBeUsedWithoutGpuServiceSet) {
   auto graph_config =
       mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
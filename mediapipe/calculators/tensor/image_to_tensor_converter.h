@@ -15,9 +15,11 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_H_
 
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
@@ -46,6 +48,25 @@ class ImageToTensorConverter {
                                const RotatedRect& roi, float range_min,
                                float range_max, int tensor_buffer_offset,
                                Tensor& output_tensor) = 0;
+
+  // Converts multiple regions of the same image into one batched tensor.
+  // @rois describes the regions of interest, the i-th of which is written to
+  // the i-th batch entry of @output_tensor, whose batch dimension must be at
+  // least rois.size().
+  // Only the OpenCV converter supports several regions. The default
+  // implementation converts a single region with "Convert", as the other
+  // converters only write whole tensors.
+  virtual absl::Status BatchConvert(const mediapipe::Image& input,
+                                    absl::Span<const RotatedRect> rois,
+                                    float range_min, float range_max,
+                                    Tensor& output_tensor) {
+    if (rois.size() != 1) {
+      return absl::UnimplementedError(
+          "This converter does not support several regions of interest.");
+    }
+    return Convert(input, rois[0], range_min, range_max,
+                   /*tensor_buffer_offset=*/0, output_tensor);
+  }
 };
 
 }  // namespace mediapipe
@@ -14,9 +14,13 @@
 
 #include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -26,48 +30,170 @@
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
 
 namespace {
 
-class OpenCvProcessor : public ImageToTensorConverter {
- public:
-  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
-      : tensor_type_(tensor_type) {
-    switch (border_mode) {
-      case BorderMode::kReplicate:
-        border_mode_ = cv::BORDER_REPLICATE;
-        break;
-      case BorderMode::kZero:
-        border_mode_ = cv::BORDER_CONSTANT;
-        break;
+// Maps output pixel (x, y) of a region to the input image position
+// origin + x * col_step + y * row_step.
+struct RoiTransform {
+  float origin_x;
+  float origin_y;
+  float col_step_x;
+  float col_step_y;
+  float row_step_x;
+  float row_step_y;
+};
+
+// Maps the corners of an output_width x output_height output to the corners
+// of the rotated roi, the same way as the perspective transform between
+// cv::boxPoints and the output corners would.
+RoiTransform GetRoiTransform(const RotatedRect& roi, int output_width,
+                             int output_height) {
+  const float cos_r = std::cos(roi.rotation);
+  const float sin_r = std::sin(roi.rotation);
+  const float scale_x = roi.width / output_width;
+  const float scale_y = roi.height / output_height;
+  RoiTransform transform;
+  transform.col_step_x = cos_r * scale_x;
+  transform.col_step_y = sin_r * scale_x;
+  transform.row_step_x = -sin_r * scale_y;
+  transform.row_step_y = cos_r * scale_y;
+  transform.origin_x =
+      roi.center_x - 0.5f * (cos_r * roi.width - sin_r * roi.height);
+  transform.origin_y =
+      roi.center_y - 0.5f * (sin_r * roi.width + cos_r * roi.height);
+  return transform;
+}
+
+// Rounds and saturates like cv::saturate_cast.
+template <typename T>
+T SaturateCast(float value) {
+  return cv::saturate_cast<T>(value);
+}
+
+template <>
+float SaturateCast<float>(float value) {
+  return value;
+}
+
+// Bilinearly samples the rotated region of src described by transform into
+// the output_height x output_width x output_channels buffer at dst, and
+// converts each sample to value * scale + offset, in a single pass.
+// Channels of src past output_channels (alpha) are dropped, and a single
+// channel src is replicated to all output channels.
+template <typename T>
+void SampleRoi(const cv::Mat& src, const RoiTransform& transform,
+               bool replicate_border, float scale, float offset,
+               int output_width, int output_height, int output_channels,
+               T* dst) {
+  const int src_width = src.cols;
+  const int src_height = src.rows;
+  const int src_channels = src.channels();
+  const int channel_step = src_channels == 1 ? 0 : 1;
+  const size_t src_step = src.step[0];
+  const uint8_t* src_data = src.ptr<uint8_t>();
+
+  // Returns the pixel at (x, y) of src, or nullptr for zero border pixels.
+  auto border_pixel = [&](int x, int y) -> const uint8_t* {
+    if (replicate_border) {
+      x = std::clamp(x, 0, src_width - 1);
+      y = std::clamp(y, 0, src_height - 1);
+    } else if (x < 0 || y < 0 || x >= src_width || y >= src_height) {
+      return nullptr;
     }
-    switch (tensor_type_) {
-      case Tensor::ElementType::kInt8:
-        mat_type_ = CV_8SC3;
-        mat_gray_type_ = CV_8SC1;
-        break;
-      case Tensor::ElementType::kFloat32:
-        mat_type_ = CV_32FC3;
-        mat_gray_type_ = CV_32FC1;
-        break;
-      case Tensor::ElementType::kUInt8:
-        mat_type_ = CV_8UC3;
-        mat_gray_type_ = CV_8UC1;
-        break;
-      default:
-        mat_type_ = -1;
-        mat_gray_type_ = -1;
+    return src_data + y * src_step + x * src_channels;
+  };
+
+  for (int y = 0; y < output_height; ++y) {
+    const float row_x = transform.origin_x + y * transform.row_step_x;
+    const float row_y = transform.origin_y + y * transform.row_step_y;
+    for (int x = 0; x < output_width; ++x) {
+      // Positions more than a pixel outside of src sample the border only,
+      // so clamping them does not change the result but keeps them in int
+      // range.
+      const float src_x = std::clamp(row_x + x * transform.col_step_x, -2.0f,
+                                     src_width + 1.0f);
+      const float src_y = std::clamp(row_y + x * transform.col_step_y, -2.0f,
+                                     src_height + 1.0f);
+      const float floor_x = std::floor(src_x);
+      const float floor_y = std::floor(src_y);
+      const int x0 = static_cast<int>(floor_x);
+      const int y0 = static_cast<int>(floor_y);
+      const float wx = src_x - floor_x;
+      const float wy = src_y - floor_y;
+      const float w00 = (1.0f - wx) * (1.0f - wy);
+      const float w01 = wx * (1.0f - wy);
+      const float w10 = (1.0f - wx) * wy;
+      const float w11 = wx * wy;
+      if (x0 >= 0 && y0 >= 0 && x0 + 1 < src_width && y0 + 1 < src_height) {
+        const uint8_t* p00 = src_data + y0 * src_step + x0 * src_channels;
+        const uint8_t* p01 = p00 + src_channels;
+        const uint8_t* p10 = p00 + src_step;
+        const uint8_t* p11 = p10 + src_channels;
+        for (int c = 0, sc = 0; c < output_channels; ++c, sc += channel_step) {
+          const float value =
+              w00 * p00[sc] + w01 * p01[sc] + w10 * p10[sc] + w11 * p11[sc];
+          dst[c] = SaturateCast<T>(value * scale + offset);
+        }
+      } else {
+        const uint8_t* p00 = border_pixel(x0, y0);
+        const uint8_t* p01 = border_pixel(x0 + 1, y0);
+        const uint8_t* p10 = border_pixel(x0, y0 + 1);
+        const uint8_t* p11 = border_pixel(x0 + 1, y0 + 1);
+        for (int c = 0, sc = 0; c < output_channels; ++c, sc += channel_step) {
+          float value = 0.0f;
+          if (p00) value += w00 * p00[sc];
+          if (p01) value += w01 * p01[sc];
+          if (p10) value += w10 * p10[sc];
+          if (p11) value += w11 * p11[sc];
+          dst[c] = SaturateCast<T>(value * scale + offset);
+        }
+      }
+      dst += output_channels;
     }
   }
+}
+
+class OpenCvProcessor : public ImageToTensorConverter {
+ public:
+  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : replicate_border_(border_mode == BorderMode::kReplicate),
+        tensor_type_(tensor_type) {}
 
   absl::Status Convert(const mediapipe::Image& input, const RotatedRect& roi,
                        float range_min, float range_max,
                        int tensor_buffer_offset,
                        Tensor& output_tensor) override {
+    RET_CHECK_GE(tensor_buffer_offset, 0)
+        << "The input tensor_buffer_offset needs to be non-negative.";
+    return ConvertRois(input, absl::MakeConstSpan(&roi, 1), range_min,
+                       range_max, tensor_buffer_offset, output_tensor);
+  }
+
+  absl::Status BatchConvert(const mediapipe::Image& input,
+                            absl::Span<const RotatedRect> rois,
+                            float range_min, float range_max,
+                            Tensor& output_tensor) override {
+    RET_CHECK_GE(output_tensor.shape().dims[0], static_cast<int>(rois.size()))
+        << "The batch dimension of the output tensor is smaller than the "
+           "number of regions: "
+        << rois.size();
+    return ConvertRois(input, rois, range_min, range_max,
+                       /*tensor_buffer_offset=*/0, output_tensor);
+  }
+
+ private:
+  // Writes the regions to consecutive images in output_tensor, starting at
+  // tensor_buffer_offset bytes, with a single write view of the tensor.
+  absl::Status ConvertRois(const mediapipe::Image& input,
+                           absl::Span<const RotatedRect> rois, float range_min,
+                           float range_max, int tensor_buffer_offset,
+                           Tensor& output_tensor) {
     const bool is_supported_format =
         input.image_format() == mediapipe::ImageFormat::SRGB ||
         input.image_format() == mediapipe::ImageFormat::SRGBA ||
@@ -77,8 +203,6 @@ class OpenCvProcessor : public ImageToTensorConverter {
           "Unsupported format: ", static_cast<uint32_t>(input.image_format())));
     }
 
-    RET_CHECK_GE(tensor_buffer_offset, 0)
-        << "The input tensor_buffer_offset needs to be non-negative.";
     const auto& output_shape = output_tensor.shape();
     MP_RETURN_IF_ERROR(ValidateTensorShape(output_shape));
 
@@ -87,88 +211,46 @@ class OpenCvProcessor : public ImageToTensorConverter {
     const int output_channels = output_shape.dims[3];
     const int num_elements_per_img =
         output_height * output_width * output_channels;
+
+    constexpr float kInputImageRangeMin = 0.0f;
+    constexpr float kInputImageRangeMax = 255.0f;
+    ASSIGN_OR_RETURN(
+        auto transform,
+        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                    range_min, range_max));
+
+    auto src = mediapipe::formats::MatView(&input);
     auto buffer_view = output_tensor.GetCpuWriteView();
-    cv::Mat dst;
-    const int dst_data_type = output_channels == 1 ? mat_gray_type_ : mat_type_;
+    auto convert = [&](auto* buffer) -> absl::Status {
+      using T = std::remove_pointer_t<decltype(buffer)>;
+      const int element_offset = tensor_buffer_offset / sizeof(T);
+      RET_CHECK_GE(output_shape.num_elements(),
+                   element_offset +
+                       static_cast<int>(rois.size()) * num_elements_per_img)
+          << "The buffer offset + the input image size is larger than the "
+             "allocated tensor buffer.";
+      T* dst = buffer + element_offset;
+      for (const RotatedRect& roi : rois) {
+        SampleRoi(*src, GetRoiTransform(roi, output_width, output_height),
+                  replicate_border_, transform.scale, transform.offset,
+                  output_width, output_height, output_channels, dst);
+        dst += num_elements_per_img;
+      }
+      return absl::OkStatus();
+    };
     switch (tensor_type_) {
       case Tensor::ElementType::kInt8:
-        RET_CHECK_GE(
-            output_shape.num_elements(),
-            tensor_buffer_offset / sizeof(int8_t) + num_elements_per_img)
-            << "The buffer offset + the input image size is larger than the "
-               "allocated tensor buffer.";
-        dst = cv::Mat(output_height, output_width, dst_data_type,
-                      buffer_view.buffer<int8_t>() +
-                          tensor_buffer_offset / sizeof(int8_t));
-        break;
+        return convert(buffer_view.buffer<int8_t>());
       case Tensor::ElementType::kFloat32:
-        RET_CHECK_GE(
-            output_shape.num_elements(),
-            tensor_buffer_offset / sizeof(float) + num_elements_per_img)
-            << "The buffer offset + the input image size is larger than the "
-               "allocated tensor buffer.";
-        dst = cv::Mat(
-            output_height, output_width, dst_data_type,
-            buffer_view.buffer<float>() + tensor_buffer_offset / sizeof(float));
-        break;
+        return convert(buffer_view.buffer<float>());
       case Tensor::ElementType::kUInt8:
-        RET_CHECK_GE(
-            output_shape.num_elements(),
-            tensor_buffer_offset / sizeof(uint8_t) + num_elements_per_img)
-            << "The buffer offset + the input image size is larger than the "
-               "allocated tensor buffer.";
-        dst = cv::Mat(output_height, output_width, dst_data_type,
-                      buffer_view.buffer<uint8_t>() +
-                          tensor_buffer_offset / sizeof(uint8_t));
-        break;
+        return convert(buffer_view.buffer<uint8_t>());
       default:
         return InvalidArgumentError(
             absl::StrCat("Unsupported tensor type: ", tensor_type_));
     }
-
-    const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
-                                       cv::Size2f(roi.width, roi.height),
-                                       roi.rotation * 180.f / M_PI);
-    cv::Mat src_points;
-    cv::boxPoints(rotated_rect, src_points);
-
-    const float dst_width = output_width;
-    const float dst_height = output_height;
-    /* clang-format off */
-    float dst_corners[8] = {0.0f,      dst_height,
-                            0.0f,      0.0f,
-                            dst_width, 0.0f,
-                            dst_width, dst_height};
-    /* clang-format on */
-
-    auto src = mediapipe::formats::MatView(&input);
-    cv::Mat dst_points = cv::Mat(4, 2, CV_32F, dst_corners);
-    cv::Mat projection_matrix =
-        cv::getPerspectiveTransform(src_points, dst_points);
-    cv::Mat transformed;
-    cv::warpPerspective(*src, transformed, projection_matrix,
-                        cv::Size(dst_width, dst_height),
-                        /*flags=*/cv::INTER_LINEAR,
-                        /*borderMode=*/border_mode_);
-
-    if (transformed.channels() > output_channels) {
-      cv::Mat proper_channels_mat;
-      cv::cvtColor(transformed, proper_channels_mat, cv::COLOR_RGBA2RGB);
-      transformed = proper_channels_mat;
-    }
-
-    constexpr float kInputImageRangeMin = 0.0f;
-    constexpr float kInputImageRangeMax = 255.0f;
-    ASSIGN_OR_RETURN(
-        auto transform,
-        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
-                                    range_min, range_max));
-    transformed.convertTo(dst, dst_data_type, transform.scale,
-                          transform.offset);
-    return absl::OkStatus();
   }
 
- private:
   absl::Status ValidateTensorShape(const Tensor::Shape& output_shape) {
     RET_CHECK_EQ(output_shape.dims.size(), 4)
         << "Wrong output dims size: " << output_shape.dims.size();
@@ -179,10 +261,8 @@ class OpenCvProcessor : public ImageToTensorConverter {
     return absl::OkStatus();
   }
 
-  enum cv::BorderTypes border_mode_;
+  bool replicate_border_;
   Tensor::ElementType tensor_type_;
-  int mat_type_;
-  int mat_gray_type_;
 };
 
 }  // namespace
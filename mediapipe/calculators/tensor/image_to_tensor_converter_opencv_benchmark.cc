@@ -0,0 +1,125 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares the fused ROI sampling of the OpenCV image to tensor converter with
+// the cv::warpPerspective, cv::cvtColor and cv::Mat::convertTo sequence it
+// replaced, for a rotated ROI of a VGA frame and float output tensors.
+#include <cmath>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_opencv.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kImageWidth = 640;
+constexpr int kImageHeight = 480;
+
+Image MakeImage(int channels) {
+  auto frame = std::make_shared<ImageFrame>(
+      channels == 4 ? ImageFormat::SRGBA : ImageFormat::SRGB, kImageWidth,
+      kImageHeight);
+  Image image(frame);
+  cv::randu(*formats::MatView(&image), cv::Scalar::all(0),
+            cv::Scalar::all(255));
+  return image;
+}
+
+RotatedRect MakeRoi() {
+  return {/*center_x=*/kImageWidth * 0.5f, /*center_y=*/kImageHeight * 0.5f,
+          /*width=*/kImageHeight * 0.6f, /*height=*/kImageHeight * 0.6f,
+          /*rotation=*/static_cast<float>(M_PI / 6)};
+}
+
+// state.range(0) is the number of image channels, 3 or 4, and state.range(1)
+// the width and height of the output tensor.
+void BM_OpenCvConverter(benchmark::State& state) {
+  const Image image = MakeImage(state.range(0));
+  const RotatedRect roi = MakeRoi();
+  const int size = state.range(1);
+  auto converter = CreateOpenCvConverter(/*cc=*/nullptr, BorderMode::kZero,
+                                         Tensor::ElementType::kFloat32);
+  CHECK_OK(converter.status());
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, size, size, 3});
+  for (auto _ : state) {
+    CHECK_OK((*converter)->Convert(image, roi, /*range_min=*/-1.0f,
+                                   /*range_max=*/1.0f,
+                                   /*tensor_buffer_offset=*/0, tensor));
+  }
+}
+BENCHMARK(BM_OpenCvConverter)
+    ->Args({3, 128})
+    ->Args({4, 128})
+    ->Args({3, 256})
+    ->Args({4, 256});
+
+// The converter before ROI sampling was fused, with the same arguments.
+void BM_WarpPerspective(benchmark::State& state) {
+  const Image image = MakeImage(state.range(0));
+  const RotatedRect roi = MakeRoi();
+  const int size = state.range(1);
+  const float dst_size = size;
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, size, size, 3});
+  for (auto _ : state) {
+    auto view = tensor.GetCpuWriteView();
+    cv::Mat dst(size, size, CV_32FC3, view.buffer<float>());
+    const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
+                                       cv::Size2f(roi.width, roi.height),
+                                       roi.rotation * 180.f / M_PI);
+    cv::Mat src_points;
+    cv::boxPoints(rotated_rect, src_points);
+    /* clang-format off */
+    float dst_corners[8] = {0.0f,     dst_size,
+                            0.0f,     0.0f,
+                            dst_size, 0.0f,
+                            dst_size, dst_size};
+    /* clang-format on */
+    cv::Mat dst_points(4, 2, CV_32F, dst_corners);
+    cv::Mat projection_matrix =
+        cv::getPerspectiveTransform(src_points, dst_points);
+    cv::Mat transformed;
+    cv::warpPerspective(*formats::MatView(&image), transformed,
+                        projection_matrix, cv::Size(size, size),
+                        /*flags=*/cv::INTER_LINEAR,
+                        /*borderMode=*/cv::BORDER_CONSTANT);
+    if (transformed.channels() > 3) {
+      cv::Mat rgb;
+      cv::cvtColor(transformed, rgb, cv::COLOR_RGBA2RGB);
+      transformed = rgb;
+    }
+    // Maps [0, 255] to [-1, 1], as the converter does.
+    transformed.convertTo(dst, CV_32FC3, 2.0 / 255.0, -1.0);
+  }
+}
+BENCHMARK(BM_WarpPerspective)
+    ->Args({3, 128})
+    ->Args({4, 128})
+    ->Args({3, 256})
+    ->Args({4, 256});
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -0,0 +1,183 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns "shape" with its first dimension replaced by "batch_size".
+Tensor::Shape WithBatchSize(const Tensor::Shape& shape, int batch_size,
+                            bool is_dynamic) {
+  std::vector<int> dims = shape.dims;
+  dims[0] = batch_size;
+  return Tensor::Shape(dims, is_dynamic);
+}
+
+// Returns true if "a" and "b" have the same dimensions except for the first.
+bool HaveSameEntryShape(const Tensor::Shape& a, const Tensor::Shape& b) {
+  return a.dims.size() == b.dims.size() &&
+         std::equal(a.dims.begin() + 1, a.dims.end(), b.dims.begin() + 1);
+}
+
+}  // namespace
+
+InferenceBatcher::InferenceBatcher(int max_batch_size,
+                                   absl::Duration max_latency,
+                                   std::shared_ptr<TensorPool> tensor_pool)
+    : max_batch_size_(max_batch_size),
+      max_latency_(max_latency),
+      tensor_pool_(std::move(tensor_pool)) {
+  pending_.reserve(max_batch_size_);
+  batch_sizes_.reserve(max_batch_size_);
+}
+
+absl::Status InferenceBatcher::Add(api2::Packet<std::vector<Tensor>> packet,
+                                   absl::Time now) {
+  const std::vector<Tensor>& tensors = packet.Get();
+  RET_CHECK(!tensors.empty());
+  const int batch_size =
+      tensors[0].shape().dims.empty() ? 0 : tensors[0].shape().dims[0];
+  RET_CHECK_GT(batch_size, 0);
+  for (int i = 0; i < tensors.size(); ++i) {
+    const Tensor& tensor = tensors[i];
+    RET_CHECK(!tensor.shape().dims.empty() &&
+              tensor.shape().dims[0] == batch_size)
+        << "Tensor " << i << " doesn't have a batch dimension of size "
+        << batch_size;
+    RET_CHECK(tensor.element_type() != Tensor::ElementType::kChar)
+        << "String tensors can't be batched.";
+    if (!pending_.empty()) {
+      const std::vector<Tensor>& first = pending_[0].Get();
+      RET_CHECK_EQ(first.size(), tensors.size());
+      RET_CHECK(first[i].element_type() == tensor.element_type() &&
+                HaveSameEntryShape(first[i].shape(), tensor.shape()))
+          << "Tensor " << i << " doesn't match the pending batch.";
+    }
+  }
+  if (pending_.empty()) first_arrival_time_ = now;
+  pending_.push_back(std::move(packet));
+  batch_sizes_.push_back(batch_size);
+  return absl::OkStatus();
+}
+
+bool InferenceBatcher::IsReady(absl::Time now) const {
+  if (pending_.empty()) return false;
+  if (pending_.size() >= max_batch_size_) return true;
+  return max_latency_ > absl::ZeroDuration() &&
+         now - first_arrival_time_ >= max_latency_;
+}
+
+absl::StatusOr<std::vector<InferenceBatcher::Output>> InferenceBatcher::Run(
+    CalculatorContext* cc, InferenceRunner& runner) {
+  RET_CHECK(!pending_.empty());
+  ASSIGN_OR_RETURN(std::vector<Tensor> input_tensors, ConcatenateInputs());
+  ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
+                   runner.Run(cc, input_tensors));
+  // Frees the inputs before the outputs are split, so that the pool can reuse
+  // their buffers.
+  input_tensors.clear();
+  ASSIGN_OR_RETURN(std::vector<Output> outputs, SplitOutputs(output_tensors));
+  pending_.clear();
+  batch_sizes_.clear();
+  return outputs;
+}
+
+absl::StatusOr<std::vector<Tensor>> InferenceBatcher::ConcatenateInputs()
+    const {
+  int total_batch_size = 0;
+  for (int batch_size : batch_sizes_) total_batch_size += batch_size;
+
+  const std::vector<Tensor>& first = pending_[0].Get();
+  std::vector<Tensor> input_tensors;
+  input_tensors.reserve(first.size());
+  for (int i = 0; i < first.size(); ++i) {
+    // Always marked as dynamic, since a previous batch may have had a
+    // different size.
+    input_tensors.push_back(CreateCpuTensor(
+        tensor_pool_.get(), first[i].element_type(),
+        WithBatchSize(first[i].shape(), total_batch_size,
+                      /*is_dynamic=*/true),
+        first[i].quantization_parameters()));
+    auto write_view = input_tensors.back().GetCpuWriteView();
+    char* dst = write_view.buffer<char>();
+    for (const auto& packet : pending_) {
+      const Tensor& tensor = packet.Get()[i];
+      std::memcpy(dst, tensor.GetCpuReadView().buffer<char>(), tensor.bytes());
+      dst += tensor.bytes();
+    }
+  }
+  return input_tensors;
+}
+
+absl::StatusOr<std::vector<InferenceBatcher::Output>>
+InferenceBatcher::SplitOutputs(
+    const std::vector<Tensor>& output_tensors) const {
+  int total_batch_size = 0;
+  for (int batch_size : batch_sizes_) total_batch_size += batch_size;
+
+  std::vector<Output> outputs(pending_.size());
+  for (int p = 0; p < pending_.size(); ++p) {
+    outputs[p].timestamp = pending_[p].timestamp();
+    outputs[p].tensors.reserve(output_tensors.size());
+  }
+  for (int i = 0; i < output_tensors.size(); ++i) {
+    const Tensor& output_tensor = output_tensors[i];
+    RET_CHECK(!output_tensor.shape().dims.empty() &&
+              output_tensor.shape().dims[0] == total_batch_size)
+        << "Output " << i << " doesn't have a batch dimension of size "
+        << total_batch_size;
+    const int entry_bytes = output_tensor.bytes() / total_batch_size;
+    auto read_view = output_tensor.GetCpuReadView();
+    const char* src = read_view.buffer<char>();
+    for (int p = 0; p < pending_.size(); ++p) {
+      outputs[p].tensors.push_back(CreateCpuTensor(
+          tensor_pool_.get(), output_tensor.element_type(),
+          WithBatchSize(output_tensor.shape(), batch_sizes_[p],
+                        /*is_dynamic=*/false),
+          output_tensor.quantization_parameters()));
+      const int bytes = entry_bytes * batch_sizes_[p];
+      std::memcpy(outputs[p].tensors.back().GetCpuWriteView().buffer<char>(),
+                  src, bytes);
+      src += bytes;
+    }
+  }
+  return outputs;
+}
+
+bool IsInferenceBatchingEnabled(const InferenceCalculatorOptions& options) {
+  return options.batching().max_batch_size() > 1;
+}
+
+std::unique_ptr<InferenceBatcher> CreateInferenceBatcher(
+    const InferenceCalculatorOptions& options,
+    std::shared_ptr<TensorPool> tensor_pool) {
+  if (!IsInferenceBatchingEnabled(options)) return nullptr;
+  return std::make_unique<InferenceBatcher>(
+      options.batching().max_batch_size(),
+      absl::Microseconds(options.batching().max_latency_us()),
+      std::move(tensor_pool));
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Groups the input tensors of consecutive packets into a single inference.
+//
+// The tensors of each pending packet are concatenated along their first
+// (batch) dimension into tensors marked as dynamic, so that the runner resizes
+// the interpreter inputs to the combined batch size. The output tensors are
+// then split along their first dimension and handed back with the timestamps
+// of the packets they belong to, in order.
+//
+// All packets in a batch must have the same number of tensors, and their
+// tensors the same element types and the same dimensions except for the first.
+// The model must compute each batch entry independently.
+class InferenceBatcher {
+ public:
+  // The outputs of one input packet.
+  struct Output {
+    Timestamp timestamp;
+    std::vector<Tensor> tensors;
+  };
+
+  // A batch is ready once it holds "max_batch_size" packets, or once its first
+  // packet was added "max_latency" ago. A non-positive "max_latency" disables
+  // the latency limit. "tensor_pool" can be nullptr.
+  InferenceBatcher(int max_batch_size, absl::Duration max_latency,
+                   std::shared_ptr<TensorPool> tensor_pool = nullptr);
+
+  // Adds the tensors of "packet", received at "now", to the pending batch.
+  absl::Status Add(api2::Packet<std::vector<Tensor>> packet, absl::Time now);
+
+  // Returns true if the pending batch should be run at time "now".
+  bool IsReady(absl::Time now) const;
+
+  bool empty() const { return pending_.empty(); }
+  int size() const { return pending_.size(); }
+
+  // Returns the timestamp of the first pending packet, which bounds the
+  // timestamps of the outputs still to be sent. The batch must not be empty.
+  Timestamp first_timestamp() const { return pending_.front().timestamp(); }
+
+  // Runs the pending batch with "runner" and clears it.
+  absl::StatusOr<std::vector<Output>> Run(CalculatorContext* cc,
+                                          InferenceRunner& runner);
+
+ private:
+  absl::StatusOr<std::vector<Tensor>> ConcatenateInputs() const;
+  absl::StatusOr<std::vector<Output>> SplitOutputs(
+      const std::vector<Tensor>& output_tensors) const;
+
+  const int max_batch_size_;
+  const absl::Duration max_latency_;
+  std::shared_ptr<TensorPool> tensor_pool_;
+
+  std::vector<api2::Packet<std::vector<Tensor>>> pending_;
+  // Size of the first dimension of the tensors of each pending packet.
+  std::vector<int> batch_sizes_;
+  absl::Time first_arrival_time_;
+};
+
+// Returns true if "options.batching" enables batching. The outputs of a
+// packet are then sent after later packets arrive, so the calculator must not
+// declare a timestamp offset.
+bool IsInferenceBatchingEnabled(const InferenceCalculatorOptions& options);
+
+// Returns a batcher configured by "options.batching", or nullptr if batching
+// is disabled.
+std::unique_ptr<InferenceBatcher> CreateInferenceBatcher(
+    const InferenceCalculatorOptions& options,
+    std::shared_ptr<TensorPool> tensor_pool);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
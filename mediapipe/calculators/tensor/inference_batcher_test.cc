@@ -0,0 +1,121 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Doubles its single input and records the input shapes it was run with.
+class DoublingRunner : public InferenceRunner {
+ public:
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc,
+      const std::vector<Tensor>& input_tensors) override {
+    const Tensor& input = input_tensors[0];
+    input_shapes.push_back(input.shape());
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kFloat32, input.shape());
+    auto read_view = input.GetCpuReadView();
+    auto write_view = outputs[0].GetCpuWriteView();
+    for (int i = 0; i < input.shape().num_elements(); ++i) {
+      write_view.buffer<float>()[i] = 2 * read_view.buffer<float>()[i];
+    }
+    return outputs;
+  }
+
+  std::vector<Tensor::Shape> input_shapes;
+};
+
+api2::Packet<std::vector<Tensor>> MakeInput(std::vector<float> values,
+                                            int64_t timestamp) {
+  const int batch_size = values.size() / 2;
+  std::vector<Tensor> tensors;
+  tensors.emplace_back(Tensor::ElementType::kFloat32,
+                       Tensor::Shape{batch_size, 2});
+  auto view = tensors[0].GetCpuWriteView();
+  std::copy(values.begin(), values.end(), view.buffer<float>());
+  return api2::MakePacket<std::vector<Tensor>>(std::move(tensors))
+      .At(Timestamp(timestamp));
+}
+
+std::vector<float> GetValues(const Tensor& tensor) {
+  auto view = tensor.GetCpuReadView();
+  const float* buffer = view.buffer<float>();
+  return std::vector<float>(buffer, buffer + tensor.shape().num_elements());
+}
+
+TEST(InferenceBatcherTest, RunsPacketsAsOneBatch) {
+  InferenceBatcher batcher(/*max_batch_size=*/3, absl::InfiniteDuration());
+  const absl::Time now = absl::Now();
+  MP_ASSERT_OK(batcher.Add(MakeInput({1, 2}, 10), now));
+  EXPECT_FALSE(batcher.IsReady(now));
+  MP_ASSERT_OK(batcher.Add(MakeInput({3, 4, 5, 6}, 20), now));
+  EXPECT_FALSE(batcher.IsReady(now));
+  MP_ASSERT_OK(batcher.Add(MakeInput({7, 8}, 30), now));
+  EXPECT_TRUE(batcher.IsReady(now));
+
+  DoublingRunner runner;
+  MP_ASSERT_OK_AND_ASSIGN(auto outputs, batcher.Run(nullptr, runner));
+  EXPECT_TRUE(batcher.empty());
+  ASSERT_EQ(runner.input_shapes.size(), 1);
+  EXPECT_THAT(runner.input_shapes[0].dims, testing::ElementsAre(4, 2));
+  EXPECT_TRUE(runner.input_shapes[0].is_dynamic);
+
+  ASSERT_EQ(outputs.size(), 3);
+  EXPECT_EQ(outputs[0].timestamp, Timestamp(10));
+  EXPECT_THAT(outputs[0].tensors[0].shape().dims, testing::ElementsAre(1, 2));
+  EXPECT_THAT(GetValues(outputs[0].tensors[0]), testing::ElementsAre(2, 4));
+  EXPECT_EQ(outputs[1].timestamp, Timestamp(20));
+  EXPECT_THAT(outputs[1].tensors[0].shape().dims, testing::ElementsAre(2, 2));
+  EXPECT_THAT(GetValues(outputs[1].tensors[0]),
+              testing::ElementsAre(6, 8, 10, 12));
+  EXPECT_EQ(outputs[2].timestamp, Timestamp(30));
+  EXPECT_THAT(GetValues(outputs[2].tensors[0]), testing::ElementsAre(14, 16));
+}
+
+TEST(InferenceBatcherTest, IsReadyAfterMaxLatency) {
+  InferenceBatcher batcher(/*max_batch_size=*/8, absl::Milliseconds(5));
+  const absl::Time start = absl::Now();
+  MP_ASSERT_OK(batcher.Add(MakeInput({1, 2}, 10), start));
+  MP_ASSERT_OK(batcher.Add(MakeInput({3, 4}, 20), start + absl::Seconds(1)));
+  EXPECT_FALSE(batcher.IsReady(start + absl::Milliseconds(4)));
+  EXPECT_TRUE(batcher.IsReady(start + absl::Milliseconds(5)));
+}
+
+TEST(InferenceBatcherTest, RejectsMismatchedShapes) {
+  InferenceBatcher batcher(/*max_batch_size=*/8, absl::InfiniteDuration());
+  MP_ASSERT_OK(batcher.Add(MakeInput({1, 2}, 10), absl::Now()));
+
+  std::vector<Tensor> tensors;
+  tensors.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  EXPECT_FALSE(batcher
+                   .Add(api2::MakePacket<std::vector<Tensor>>(
+                            std::move(tensors))
+                            .At(Timestamp(20)),
+                        absl::Now())
+                   .ok());
+  EXPECT_EQ(batcher.size(), 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
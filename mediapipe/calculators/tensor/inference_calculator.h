@@ -50,6 +50,11 @@ namespace api2 {
 // Output:
 //  TENSORS - Vector of Tensors
 //
+// With InferenceCalculatorOptions.batching on CPU, the outputs of a packet are
+// sent once its batch runs, after later packets arrive. As the calculator has
+// no timer, a partial batch waits for the next packet or for the graph to
+// close, even past max_latency_us.
+//
 // Input side packet:
 //  DEPRECATED: Prefer to use the "OP_RESOLVER" input side packet instead.
 //  CUSTOM_OP_RESOLVER (optional) - Use a custom op resolver,
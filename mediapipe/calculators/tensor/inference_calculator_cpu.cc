@@ -20,10 +20,15 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "tensorflow/lite/interpreter.h"
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -47,7 +52,13 @@ class InferenceCalculatorCpuImpl
       CalculatorContext* cc);
   absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate(CalculatorContext* cc);
 
+  // Runs the pending batch and sends its outputs.
+  absl::Status RunBatch(CalculatorContext* cc);
+
   std::unique_ptr<InferenceRunner> inference_runner_;
+  std::shared_ptr<TensorPool> tensor_pool_;
+  // Set when batching is enabled.
+  std::unique_ptr<InferenceBatcher> batcher_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -55,16 +66,37 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  cc->UseService(kTensorPoolService).Optional();
+  if (IsInferenceBatchingEnabled(options)) {
+    // Overrides the default TimestampChange::Offset(0), as the outputs of a
+    // packet are sent once its batch runs.
+    cc->SetTimestampOffset(TimestampDiff::Unset());
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
+  tensor_pool_ = GetTensorPool(cc);
   ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  batcher_ = CreateInferenceBatcher(
+      cc->Options<mediapipe::InferenceCalculatorOptions>(), tensor_pool_);
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
+  if (batcher_) {
+    if (!kInTensors(cc).IsEmpty()) {
+      MP_RETURN_IF_ERROR(batcher_->Add(kInTensors(cc), absl::Now()));
+    }
+    if (batcher_->IsReady(absl::Now())) {
+      MP_RETURN_IF_ERROR(RunBatch(cc));
+    }
+    kOutTensors(cc).SetNextTimestampBound(
+        batcher_->empty() ? cc->InputTimestamp().NextAllowedInStream()
+                          : batcher_->first_timestamp());
+    return absl::OkStatus();
+  }
   if (kInTensors(cc).IsEmpty()) {
     return absl::OkStatus();
   }
@@ -73,25 +105,54 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
 
   ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
                    inference_runner_->Run(cc, input_tensors));
+  if (tensor_pool_) {
+    LogTensorPoolUsage(cc, *tensor_pool_,
+                       cc->Outputs().Tag(kOutTensors.Tag()).Name());
+  }
   kOutTensors(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  if (batcher_ && !batcher_->empty()) {
+    MP_RETURN_IF_ERROR(RunBatch(cc));
+  }
   inference_runner_ = nullptr;
   return absl::OkStatus();
 }
 
+absl::Status InferenceCalculatorCpuImpl::RunBatch(CalculatorContext* cc) {
+  ASSIGN_OR_RETURN(std::vector<InferenceBatcher::Output> outputs,
+                   batcher_->Run(cc, *inference_runner_));
+  if (tensor_pool_) {
+    LogTensorPoolUsage(cc, *tensor_pool_,
+                       cc->Outputs().Tag(kOutTensors.Tag()).Name());
+  }
+  for (InferenceBatcher::Output& output : outputs) {
+    kOutTensors(cc).Send(std::move(output.tensors), output.timestamp);
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 InferenceCalculatorCpuImpl::CreateInferenceRunner(CalculatorContext* cc) {
   ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
   ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
-  const int interpreter_num_threads =
-      cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate(cc));
-  return CreateInferenceInterpreterDelegateRunner(
-      std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  const int interpreter_num_threads = options.cpu_num_thread();
+  RET_CHECK(options.num_interpreters() <= 1 ||
+            options.batching().max_batch_size() <= 1)
+      << "num_interpreters and batching can't be combined.";
+  // Each interpreter gets its own delegate.
+  return CreateInferenceRunnerPool(
+      options.num_interpreters(),
+      [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+        ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate(cc));
+        return CreateInferenceInterpreterDelegateRunner(
+            model_packet, op_resolver_packet, std::move(delegate),
+            interpreter_num_threads, tensor_pool_,
+            options.enable_zero_copy_tensor_io());
+      });
 }
 
 absl::StatusOr<TfLiteDelegatePtr>
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -176,6 +178,197 @@ TEST(InferenceCalculatorTest, SmokeTest) {
       {{"$delegate", "delegate { xnnpack { num_threads: 10 } }"}}));
 }
 
+// Sends "num_packets" packets filled with i + 1 at timestamps i * 10 through
+// the graph, and stores its outputs in "output_packets". "max_in_flight" is
+// set on the inference node if positive.
+void RunPacketSequence(const std::string& graph_proto, int num_packets,
+                       int max_in_flight, std::vector<Packet>* output_packets) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(graph_proto);
+  if (max_in_flight > 0) {
+    graph_config.mutable_node(0)->set_max_in_flight(max_in_flight);
+  }
+  tool::AddVectorSink("tensor_out", &graph_config, output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int i = 0; i < num_packets; ++i) {
+    std::vector<Tensor> input_vec = CreateInputs();
+    {
+      auto view = input_vec[0].GetCpuWriteView();
+      float* buffer = view.buffer<float>();
+      std::fill_n(buffer, input_vec[0].shape().num_elements(), i + 1);
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", MakePacket<std::vector<Tensor>>(std::move(input_vec))
+                         .At(Timestamp(i * 10))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Runs a packet sequence through the graph, and checks that each packet gets
+// its own output at its own timestamp, in order.
+void DoPacketSequenceTest(const std::string& graph_proto, int num_packets,
+                          int max_in_flight = 0) {
+  std::vector<Packet> output_packets;
+  RunPacketSequence(graph_proto, num_packets, max_in_flight, &output_packets);
+
+  ASSERT_EQ(output_packets.size(), num_packets);
+  for (int i = 0; i < num_packets; ++i) {
+    EXPECT_EQ(output_packets[i].Timestamp(), Timestamp(i * 10));
+    const std::vector<Tensor>& result_vec =
+        output_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(result_vec.size(), 1);
+    const Tensor& result = result_vec[0];
+    EXPECT_EQ(result.shape().dims[0], 1);
+    auto view = result.GetCpuReadView();
+    const float* result_buffer = view.buffer<float>();
+    for (int j = 0; j < result.shape().num_elements(); ++j) {
+      ASSERT_EQ(result_buffer[j], 3 * (i + 1));
+    }
+  }
+}
+
+// Sends one packet per entry of "batch_sizes" through the graph, holding an
+// input of that batch size with a dynamic shape, filled with i + 1 for packet
+// i, and stores its outputs in "output_packets".
+void RunBatchSequence(const std::string& graph_proto,
+                      const std::vector<int>& batch_sizes,
+                      std::vector<Packet>* output_packets) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(graph_proto);
+  tool::AddVectorSink("tensor_out", &graph_config, output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int i = 0; i < batch_sizes.size(); ++i) {
+    std::vector<Tensor> input_vec;
+    input_vec.emplace_back(Tensor::ElementType::kFloat32,
+                           Tensor::Shape({batch_sizes[i], kTensorHeight,
+                                          kTensorWidth, kTensorChannels},
+                                         /*is_dynamic=*/true));
+    {
+      auto view = input_vec[0].GetCpuWriteView();
+      float* buffer = view.buffer<float>();
+      std::fill_n(buffer, input_vec[0].shape().num_elements(), i + 1);
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", MakePacket<std::vector<Tensor>>(std::move(input_vec))
+                         .At(Timestamp(i * 10))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Checks that "output_packets" hold the same tensors as "expected_packets",
+// byte for byte.
+void ExpectSameOutputs(const std::vector<Packet>& expected_packets,
+                       const std::vector<Packet>& output_packets) {
+  ASSERT_EQ(output_packets.size(), expected_packets.size());
+  for (int i = 0; i < output_packets.size(); ++i) {
+    EXPECT_EQ(output_packets[i].Timestamp(), expected_packets[i].Timestamp());
+    const auto& expected_vec = expected_packets[i].Get<std::vector<Tensor>>();
+    const auto& result_vec = output_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(result_vec.size(), expected_vec.size());
+    for (int j = 0; j < result_vec.size(); ++j) {
+      EXPECT_EQ(result_vec[j].element_type(), expected_vec[j].element_type());
+      EXPECT_EQ(result_vec[j].shape().dims, expected_vec[j].shape().dims);
+      ASSERT_EQ(result_vec[j].bytes(), expected_vec[j].bytes());
+      auto expected_view = expected_vec[j].GetCpuReadView();
+      auto result_view = result_vec[j].GetCpuReadView();
+      EXPECT_EQ(std::memcmp(result_view.buffer<void>(),
+                            expected_view.buffer<void>(),
+                            result_vec[j].bytes()),
+                0);
+    }
+  }
+}
+
+// Returns the graph running inference with "delegate" and zero-copy tensor IO.
+std::string ZeroCopyGraph(const std::string& delegate) {
+  return absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate",
+        absl::StrCat(delegate, " enable_zero_copy_tensor_io: true")}});
+}
+
+// Checks that binding the tensor buffers to the interpreter gives the same
+// outputs as copying them, over several inferences, and that outputs are not
+// overwritten by later inferences.
+void DoZeroCopyTensorIoTest(const std::string& delegate) {
+  constexpr int kNumPackets = 4;
+  std::vector<Packet> expected_packets;
+  RunPacketSequence(absl::StrReplaceAll(kGraphWithModelPathInOption,
+                                        {{"$delegate", delegate}}),
+                    kNumPackets, /*max_in_flight=*/0, &expected_packets);
+  std::vector<Packet> output_packets;
+  RunPacketSequence(ZeroCopyGraph(delegate), kNumPackets, /*max_in_flight=*/0,
+                    &output_packets);
+  ASSERT_EQ(expected_packets.size(), kNumPackets);
+  ExpectSameOutputs(expected_packets, output_packets);
+}
+
+// Same as above, with batch sizes that grow and shrink, so that buffers bound
+// by one inference are too small for the next one.
+void DoZeroCopyResizedTensorIoTest(const std::string& delegate) {
+  const std::vector<int> batch_sizes = {1, 3, 4, 2, 1, 4};
+  std::vector<Packet> expected_packets;
+  RunBatchSequence(absl::StrReplaceAll(kGraphWithModelPathInOption,
+                                       {{"$delegate", delegate}}),
+                   batch_sizes, &expected_packets);
+  std::vector<Packet> output_packets;
+  RunBatchSequence(ZeroCopyGraph(delegate), batch_sizes, &output_packets);
+  ASSERT_EQ(expected_packets.size(), batch_sizes.size());
+  for (int i = 0; i < expected_packets.size(); ++i) {
+    const auto& expected_vec = expected_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(expected_vec.size(), 1);
+    EXPECT_EQ(expected_vec[0].shape().dims[0], batch_sizes[i]);
+  }
+  ExpectSameOutputs(expected_packets, output_packets);
+}
+
+TEST(InferenceCalculatorTest, ZeroCopyTensorIoTest) {
+  DoZeroCopyTensorIoTest("delegate { tflite {} }");
+  DoZeroCopyTensorIoTest("delegate { xnnpack {} }");
+}
+
+TEST(InferenceCalculatorTest, ZeroCopyResizedTensorIoTest) {
+  DoZeroCopyResizedTensorIoTest("delegate { tflite {} }");
+  DoZeroCopyResizedTensorIoTest("delegate { xnnpack {} }");
+}
+
+// Runs several packets through the interpreter pool at once, so that
+// interpreters may finish out of order.
+TEST(InferenceCalculatorTest, InterpreterPoolTest) {
+  DoPacketSequenceTest(
+      absl::StrReplaceAll(
+          kGraphWithModelPathInOption,
+          {{"$delegate", "delegate { tflite {} } num_interpreters: 4"}}),
+      /*num_packets=*/32, /*max_in_flight=*/4);
+  DoPacketSequenceTest(
+      absl::StrReplaceAll(
+          kGraphWithModelPathInOption,
+          {{"$delegate", "delegate { xnnpack {} } num_interpreters: 4"}}),
+      /*num_packets=*/32, /*max_in_flight=*/4);
+}
+
+// Uses an odd number of packets, so the last batch is only run on close.
+TEST(InferenceCalculatorTest, BatchingTest) {
+  DoPacketSequenceTest(
+      absl::StrReplaceAll(
+          kGraphWithModelPathInOption,
+          {{"$delegate",
+            "delegate { tflite {} } batching { max_batch_size: 2 }"}}),
+      /*num_packets=*/5);
+  DoPacketSequenceTest(
+      absl::StrReplaceAll(
+          kGraphWithModelPathInOption,
+          {{"$delegate",
+            "delegate { xnnpack {} } batching { max_batch_size: 2 }"}}),
+      /*num_packets=*/5);
+}
+
 TEST(InferenceCalculatorTest, ModelAsInputSidePacketSmokeTest) {
   DoSmokeTest(kGraphWithModelAsInputSidePacket);
 }
@@ -14,11 +14,17 @@
 
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
+#include "mediapipe/framework/deps/aligned_malloc_and_free.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -72,40 +78,125 @@ void CopyTensorBufferFromInterpreter(Interpreter* interpreter,
               output_tensor->bytes());
 }
 
+// Returns the MediaPipe element type for a TfLite tensor type whose buffers can
+// be shared with the interpreter, i.e. have the same size per element.
+bool GetZeroCopyElementType(TfLiteType type, Tensor::ElementType* result) {
+  switch (type) {
+    case TfLiteType::kTfLiteFloat32:
+      *result = Tensor::ElementType::kFloat32;
+      return true;
+    case TfLiteType::kTfLiteUInt8:
+      *result = Tensor::ElementType::kUInt8;
+      return true;
+    case TfLiteType::kTfLiteInt8:
+      *result = Tensor::ElementType::kInt8;
+      return true;
+    case TfLiteType::kTfLiteInt32:
+      *result = Tensor::ElementType::kInt32;
+      return true;
+    case TfLiteType::kTfLiteBool:
+      *result = Tensor::ElementType::kBool;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Alignment TfLite requires for custom allocations.
+constexpr int kInterpreterBufferAlignment = 64;
+
+bool IsAlignedForInterpreter(const void* buffer) {
+  return reinterpret_cast<uintptr_t>(buffer) % kInterpreterBufferAlignment == 0;
+}
+
+struct AlignedFreeDeleter {
+  void operator()(void* buffer) const { aligned_free(buffer); }
+};
+
 }  // namespace
 
 class InferenceInterpreterDelegateRunner : public InferenceRunner {
  public:
   InferenceInterpreterDelegateRunner(api2::Packet<TfLiteModelPtr> model,
                                      std::unique_ptr<Interpreter> interpreter,
-                                     TfLiteDelegatePtr delegate)
+                                     TfLiteDelegatePtr delegate,
+                                     std::shared_ptr<TensorPool> tensor_pool,
+                                     bool enable_zero_copy_tensor_io)
       : model_(std::move(model)),
         interpreter_(std::move(interpreter)),
-        delegate_(std::move(delegate)) {}
+        delegate_(std::move(delegate)),
+        tensor_pool_(std::move(tensor_pool)),
+        enable_zero_copy_tensor_io_(enable_zero_copy_tensor_io) {}
 
   absl::StatusOr<std::vector<Tensor>> Run(
       CalculatorContext* cc, const std::vector<Tensor>& input_tensors) override;
 
  private:
+  // Runs inference by letting the interpreter read the input tensors and write
+  // the output tensors in place, see Run().
+  absl::StatusOr<std::vector<Tensor>> RunZeroCopy(
+      CalculatorContext* cc, const std::vector<Tensor>& input_tensors);
+
+  // Resizes the interpreter inputs for the input tensors with a dynamic shape.
+  // Returns true if any input was resized.
+  absl::StatusOr<bool> ResizeInputTensors(
+      const std::vector<Tensor>& input_tensors);
+
+  // Returns a new tensor holding a copy of interpreter output "output_index".
+  absl::StatusOr<Tensor> CopyOutputTensor(int output_index);
+
+  // Points the interpreter input "input_index" at the buffer of "input_tensor",
+  // or at a staging buffer holding a copy of it if the buffer is misaligned.
+  // "views" keeps the shared buffer locked until inference is done.
+  absl::Status BindInputTensor(const Tensor& input_tensor, int input_index,
+                               std::vector<Tensor::CpuReadView>* views);
+
+  // Returns a buffer of at least "bytes" owned by the runner for the
+  // interpreter tensor "tensor_index".
+  void* GetStagingBuffer(int tensor_index, size_t bytes);
+
+  // If the interpreter tensor "tensor_index" has a custom allocation, points
+  // it at a placeholder that AllocateTensors() accepts for any tensor size.
+  // A tensor can't go back to the arena, and the sizes of the outputs are only
+  // known once AllocateTensors() has propagated the input shapes. The tensor
+  // must be bound again before Invoke().
+  absl::Status UnbindTensor(int tensor_index);
+
+  // Points the interpreter tensor "tensor_index" at "buffer". Sets
+  // custom_allocations_changed_ if the tensor didn't have a custom allocation.
+  absl::Status SetCustomAllocation(int tensor_index, void* buffer,
+                                   size_t bytes);
+
   api2::Packet<TfLiteModelPtr> model_;
   std::unique_ptr<Interpreter> interpreter_;
   TfLiteDelegatePtr delegate_;
+  std::shared_ptr<TensorPool> tensor_pool_;
+  const bool enable_zero_copy_tensor_io_;
+  struct StagingBuffer {
+    std::unique_ptr<void, AlignedFreeDeleter> data;
+    size_t bytes = 0;
+  };
+  // Buffers backing the interpreter tensors that can't share the buffer of a
+  // MediaPipe tensor, by tensor index. Once an interpreter tensor uses a custom
+  // allocation it can't go back to the arena, so these keep it pointing at
+  // valid memory.
+  absl::flat_hash_map<int, StagingBuffer> staging_buffers_;
+  // True if a tensor got a custom allocation since the last AllocateTensors().
+  bool custom_allocations_changed_ = false;
 };
 
 absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
     CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  if (enable_zero_copy_tensor_io_) {
+    return RunZeroCopy(cc, input_tensors);
+  }
   // Read CPU input into tensors.
   RET_CHECK_EQ(interpreter_->inputs().size(), input_tensors.size());
 
   // If the input tensors have dynamic shape, then the tensors need to be
   // resized and reallocated before we can copy the tensor values.
-  bool resized_tensor_shapes = false;
-  for (int i = 0; i < input_tensors.size(); ++i) {
-    if (input_tensors[i].shape().is_dynamic) {
-      interpreter_->ResizeInputTensorStrict(i, input_tensors[i].shape().dims);
-      resized_tensor_shapes = true;
-    }
-  }
+  ASSIGN_OR_RETURN(const bool resized_tensor_shapes,
+                   ResizeInputTensors(input_tensors));
   // Reallocation is needed for memory sanity.
   if (resized_tensor_shapes) interpreter_->AllocateTensors();
 
@@ -158,60 +249,255 @@ absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
   std::vector<Tensor> output_tensors;
   output_tensors.reserve(tensor_indexes.size());
   for (int i = 0; i < tensor_indexes.size(); ++i) {
-    TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-    Tensor::Shape shape{std::vector<int>{
-        tensor->dims->data, tensor->dims->data + tensor->dims->size}};
-    switch (tensor->type) {
-      case TfLiteType::kTfLiteFloat16:
-      case TfLiteType::kTfLiteFloat32:
-        output_tensors.emplace_back(Tensor::ElementType::kFloat32, shape);
-        CopyTensorBufferFromInterpreter<float>(interpreter_.get(), i,
-                                               &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteUInt8:
-        output_tensors.emplace_back(
-            Tensor::ElementType::kUInt8, shape,
-            Tensor::QuantizationParameters{tensor->params.scale,
-                                           tensor->params.zero_point});
-        CopyTensorBufferFromInterpreter<uint8_t>(interpreter_.get(), i,
-                                                 &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteInt8:
-        output_tensors.emplace_back(
-            Tensor::ElementType::kInt8, shape,
-            Tensor::QuantizationParameters{tensor->params.scale,
-                                           tensor->params.zero_point});
-        CopyTensorBufferFromInterpreter<int8_t>(interpreter_.get(), i,
-                                                &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteInt32:
-        output_tensors.emplace_back(Tensor::ElementType::kInt32, shape);
-        CopyTensorBufferFromInterpreter<int32_t>(interpreter_.get(), i,
-                                                 &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteBool:
-        output_tensors.emplace_back(Tensor::ElementType::kBool, shape,
-                                    Tensor::QuantizationParameters{1.0f, 0});
-        CopyTensorBufferFromInterpreter<bool>(interpreter_.get(), i,
-                                              &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteString:
-        // No current use-case for copying TfLiteTensors with string type to
-        // MediaPipe Tensors.
-      default:
-        return absl::InvalidArgumentError(
-            absl::StrCat("Unsupported output tensor type:",
-                         TfLiteTypeGetName(tensor->type)));
+    ASSIGN_OR_RETURN(Tensor output_tensor, CopyOutputTensor(i));
+    output_tensors.push_back(std::move(output_tensor));
+  }
+  return output_tensors;
+}
+
+// Instead of copying, the buffers of the input tensors and of freshly created
+// output tensors are registered with the interpreter as custom allocations for
+// the duration of Invoke(). Every call binds new output tensors, so tensors
+// returned by previous calls are never overwritten and may outlive the runner.
+// Tensors whose buffers can't be shared (string tensors, float16 outputs,
+// dynamically allocated outputs, misaligned buffers) are copied.
+absl::StatusOr<std::vector<Tensor>>
+InferenceInterpreterDelegateRunner::RunZeroCopy(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  RET_CHECK_EQ(interpreter_->inputs().size(), input_tensors.size());
+  ASSIGN_OR_RETURN(const bool resized_tensor_shapes,
+                   ResizeInputTensors(input_tensors));
+  // Tensor sizes must be known before binding.
+  if (resized_tensor_shapes) {
+    // The buffers bound by the previous call may be too small for the new
+    // shapes, which AllocateTensors() rejects.
+    for (const int tensor_index : interpreter_->inputs()) {
+      MP_RETURN_IF_ERROR(UnbindTensor(tensor_index));
+    }
+    for (const int tensor_index : interpreter_->outputs()) {
+      MP_RETURN_IF_ERROR(UnbindTensor(tensor_index));
     }
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
+  std::vector<Tensor::CpuReadView> input_views;
+  input_views.reserve(input_tensors.size());
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    MP_RETURN_IF_ERROR(BindInputTensor(input_tensors[i], i, &input_views));
+  }
+
+  // Output tensors are created before inference, from the shapes computed by
+  // AllocateTensors(). Outputs that are not bound are filled in afterwards.
+  const auto& tensor_indexes = interpreter_->outputs();
+  std::vector<Tensor> bound_tensors;
+  std::vector<bool> output_bound(tensor_indexes.size(), false);
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
+    Tensor::ElementType element_type;
+    if (GetZeroCopyElementType(tensor->type, &element_type) &&
+        (tensor->allocation_type == kTfLiteArenaRw ||
+         tensor->allocation_type == kTfLiteCustom)) {
+      Tensor::Shape shape{std::vector<int>{
+          tensor->dims->data, tensor->dims->data + tensor->dims->size}};
+      Tensor::QuantizationParameters quantization_parameters;
+      if (tensor->type == kTfLiteUInt8 || tensor->type == kTfLiteInt8) {
+        quantization_parameters = {tensor->params.scale,
+                                   tensor->params.zero_point};
+      }
+      Tensor output_tensor = CreateCpuTensor(tensor_pool_.get(), element_type,
+                                             shape, quantization_parameters);
+      void* buffer = output_tensor.GetCpuWriteView().buffer<void>();
+      if (IsAlignedForInterpreter(buffer)) {
+        MP_RETURN_IF_ERROR(
+            SetCustomAllocation(tensor_indexes[i], buffer, tensor->bytes));
+        bound_tensors.push_back(std::move(output_tensor));
+        output_bound[i] = true;
+        continue;
+      }
+    }
+    if (tensor->allocation_type == kTfLiteCustom) {
+      // Bound by a previous call to a tensor that may be gone by now.
+      MP_RETURN_IF_ERROR(SetCustomAllocation(
+          tensor_indexes[i], GetStagingBuffer(tensor_indexes[i], tensor->bytes),
+          tensor->bytes));
+    }
+  }
+  // Custom allocations are only validated by AllocateTensors(), which is
+  // needed when shapes change or a tensor moves out of the arena. Rebinding a
+  // tensor that already has a custom allocation only updates its data pointer.
+  if (resized_tensor_shapes || custom_allocations_changed_) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    custom_allocations_changed_ = false;
+  }
+
+  {
+    MEDIAPIPE_PROFILING(CPU_TASK_INVOKE, cc);
+    RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+  }
+  input_views.clear();
+
+  // Inserts the copied outputs in between the bound ones.
+  std::vector<Tensor> output_tensors;
+  output_tensors.reserve(tensor_indexes.size());
+  auto next_bound_tensor = bound_tensors.begin();
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    if (output_bound[i]) {
+      output_tensors.push_back(std::move(*next_bound_tensor++));
+      continue;
+    }
+    ASSIGN_OR_RETURN(Tensor output_tensor, CopyOutputTensor(i));
+    output_tensors.push_back(std::move(output_tensor));
   }
   return output_tensors;
 }
 
+absl::StatusOr<bool> InferenceInterpreterDelegateRunner::ResizeInputTensors(
+    const std::vector<Tensor>& input_tensors) {
+  bool resized_tensor_shapes = false;
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    if (input_tensors[i].shape().is_dynamic) {
+      const std::vector<int>& dims = input_tensors[i].shape().dims;
+      if (interpreter_->ResizeInputTensorStrict(i, dims) != kTfLiteOk) {
+        // Models exported with a fixed batch size only allow resizing their
+        // batch dimension non-strictly.
+        RET_CHECK_EQ(interpreter_->ResizeInputTensor(i, dims), kTfLiteOk)
+            << "Failed to resize input " << i;
+      }
+      resized_tensor_shapes = true;
+    }
+  }
+  return resized_tensor_shapes;
+}
+
+absl::StatusOr<Tensor> InferenceInterpreterDelegateRunner::CopyOutputTensor(
+    int output_index) {
+  TfLiteTensor* tensor =
+      interpreter_->tensor(interpreter_->outputs()[output_index]);
+  Tensor::Shape shape{std::vector<int>{
+      tensor->dims->data, tensor->dims->data + tensor->dims->size}};
+  switch (tensor->type) {
+    case TfLiteType::kTfLiteFloat16:
+    case TfLiteType::kTfLiteFloat32: {
+      Tensor output_tensor = CreateCpuTensor(
+          tensor_pool_.get(), Tensor::ElementType::kFloat32, shape);
+      CopyTensorBufferFromInterpreter<float>(interpreter_.get(), output_index,
+                                             &output_tensor);
+      return output_tensor;
+    }
+    case TfLiteType::kTfLiteUInt8: {
+      Tensor output_tensor = CreateCpuTensor(
+          tensor_pool_.get(), Tensor::ElementType::kUInt8, shape,
+          Tensor::QuantizationParameters{tensor->params.scale,
+                                         tensor->params.zero_point});
+      CopyTensorBufferFromInterpreter<uint8_t>(interpreter_.get(),
+                                               output_index, &output_tensor);
+      return output_tensor;
+    }
+    case TfLiteType::kTfLiteInt8: {
+      Tensor output_tensor = CreateCpuTensor(
+          tensor_pool_.get(), Tensor::ElementType::kInt8, shape,
+          Tensor::QuantizationParameters{tensor->params.scale,
+                                         tensor->params.zero_point});
+      CopyTensorBufferFromInterpreter<int8_t>(interpreter_.get(), output_index,
+                                              &output_tensor);
+      return output_tensor;
+    }
+    case TfLiteType::kTfLiteInt32: {
+      Tensor output_tensor = CreateCpuTensor(
+          tensor_pool_.get(), Tensor::ElementType::kInt32, shape);
+      CopyTensorBufferFromInterpreter<int32_t>(interpreter_.get(),
+                                               output_index, &output_tensor);
+      return output_tensor;
+    }
+    case TfLiteType::kTfLiteBool: {
+      Tensor output_tensor = CreateCpuTensor(
+          tensor_pool_.get(), Tensor::ElementType::kBool, shape,
+          Tensor::QuantizationParameters{1.0f, 0});
+      CopyTensorBufferFromInterpreter<bool>(interpreter_.get(), output_index,
+                                            &output_tensor);
+      return output_tensor;
+    }
+    case TfLiteType::kTfLiteString:
+      // No current use-case for copying TfLiteTensors with string type to
+      // MediaPipe Tensors.
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported output tensor type:",
+                       TfLiteTypeGetName(tensor->type)));
+  }
+}
+
+absl::Status InferenceInterpreterDelegateRunner::BindInputTensor(
+    const Tensor& input_tensor, int input_index,
+    std::vector<Tensor::CpuReadView>* views) {
+  const int tensor_index = interpreter_->inputs()[input_index];
+  TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+  if (tensor->type == kTfLiteString) {
+    CopyTensorBufferToInterpreter<char>(input_tensor, interpreter_.get(),
+                                        input_index);
+    return absl::OkStatus();
+  }
+  RET_CHECK_EQ(input_tensor.bytes(), tensor->bytes)
+      << "Size mismatch for input " << input_index;
+  auto view = input_tensor.GetCpuReadView();
+  const void* buffer = view.buffer<void>();
+  if (IsAlignedForInterpreter(buffer)) {
+    // The interpreter doesn't write to its inputs.
+    MP_RETURN_IF_ERROR(SetCustomAllocation(
+        tensor_index, const_cast<void*>(buffer), tensor->bytes));
+    views->push_back(std::move(view));
+    return absl::OkStatus();
+  }
+  void* staging_buffer = GetStagingBuffer(tensor_index, tensor->bytes);
+  std::memcpy(staging_buffer, buffer, tensor->bytes);
+  return SetCustomAllocation(tensor_index, staging_buffer, tensor->bytes);
+}
+
+void* InferenceInterpreterDelegateRunner::GetStagingBuffer(int tensor_index,
+                                                           size_t bytes) {
+  StagingBuffer& staging_buffer = staging_buffers_[tensor_index];
+  if (staging_buffer.bytes < bytes) {
+    staging_buffer.data.reset(
+        aligned_malloc(bytes, kInterpreterBufferAlignment));
+    staging_buffer.bytes = bytes;
+  }
+  return staging_buffer.data.get();
+}
+
+absl::Status InferenceInterpreterDelegateRunner::UnbindTensor(
+    int tensor_index) {
+  const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+  if (tensor->allocation_type != kTfLiteCustom) {
+    return absl::OkStatus();
+  }
+  // Only the pointer needs to be valid; the data isn't accessed until the
+  // tensor is bound to a buffer of its new size.
+  const size_t bytes =
+      std::max<size_t>(tensor->bytes, kInterpreterBufferAlignment);
+  void* placeholder = GetStagingBuffer(tensor_index, bytes);
+  return SetCustomAllocation(tensor_index, placeholder,
+                             std::numeric_limits<size_t>::max());
+}
+
+absl::Status InferenceInterpreterDelegateRunner::SetCustomAllocation(
+    int tensor_index, void* buffer, size_t bytes) {
+  if (interpreter_->tensor(tensor_index)->allocation_type != kTfLiteCustom) {
+    custom_allocations_changed_ = true;
+  }
+  TfLiteCustomAllocation allocation = {buffer, bytes};
+  RET_CHECK_EQ(
+      interpreter_->SetCustomAllocationForTensor(tensor_index, allocation),
+      kTfLiteOk)
+      << "Failed to bind the buffer of tensor " << tensor_index;
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 CreateInferenceInterpreterDelegateRunner(
     api2::Packet<TfLiteModelPtr> model,
     api2::Packet<tflite::OpResolver> op_resolver, TfLiteDelegatePtr delegate,
-    int interpreter_num_threads) {
+    int interpreter_num_threads, std::shared_ptr<TensorPool> tensor_pool,
+    bool enable_zero_copy_tensor_io) {
   InterpreterBuilder interpreter_builder(*model.Get(), op_resolver.Get());
   if (delegate) {
     interpreter_builder.AddDelegate(delegate.get());
@@ -226,7 +512,8 @@ CreateInferenceInterpreterDelegateRunner(
   RET_CHECK(interpreter);
   RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
   return std::make_unique<InferenceInterpreterDelegateRunner>(
-      std::move(model), std::move(interpreter), std::move(delegate));
+      std::move(model), std::move(interpreter), std::move(delegate),
+      std::move(tensor_pool), enable_zero_copy_tensor_io);
 }
 
 }  // namespace mediapipe
@@ -22,6 +22,7 @@
 #include "mediapipe/calculators/tensor/inference_runner.h"
 #include "mediapipe/calculators/tensor/tflite_delegate_ptr.h"
 #include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/util/tflite/tflite_model_loader.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
@@ -33,11 +34,20 @@ namespace mediapipe {
 //
 // `delegate` can be nullptr, in that case newly initialized interpreter will
 // use what is available by default.
+//
+// `tensor_pool` can be nullptr, otherwise output tensors take their CPU
+// buffers from it.
+//
+// With `enable_zero_copy_tensor_io`, the interpreter reads input tensors and
+// writes output tensors in place instead of through its own buffers. See
+// InferenceCalculatorOptions.enable_zero_copy_tensor_io.
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 CreateInferenceInterpreterDelegateRunner(
     api2::Packet<TfLiteModelPtr> model,
     api2::Packet<tflite::OpResolver> op_resolver, TfLiteDelegatePtr delegate,
-    int interpreter_num_threads);
+    int interpreter_num_threads,
+    std::shared_ptr<TensorPool> tensor_pool = nullptr,
+    bool enable_zero_copy_tensor_io = false);
 
 }  // namespace mediapipe
 
@@ -0,0 +1,72 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+InferenceRunnerPool::InferenceRunnerPool(
+    std::vector<std::unique_ptr<InferenceRunner>> runners)
+    : runners_(std::move(runners)) {
+  available_.reserve(runners_.size());
+  for (const auto& runner : runners_) {
+    available_.push_back(runner.get());
+  }
+}
+
+absl::StatusOr<std::vector<Tensor>> InferenceRunnerPool::Run(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  InferenceRunner* runner;
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](std::vector<InferenceRunner*>* available) {
+          return !available->empty();
+        },
+        &available_));
+    runner = available_.back();
+    available_.pop_back();
+  }
+  absl::StatusOr<std::vector<Tensor>> output_tensors =
+      runner->Run(cc, input_tensors);
+  {
+    absl::MutexLock lock(&mutex_);
+    available_.push_back(runner);
+  }
+  return output_tensors;
+}
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunnerPool(
+    int num_runners,
+    const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+        create_runner) {
+  RET_CHECK_GT(num_runners, 0);
+  if (num_runners == 1) {
+    return create_runner();
+  }
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  runners.reserve(num_runners);
+  for (int i = 0; i < num_runners; ++i) {
+    ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, create_runner());
+    runners.push_back(std::move(runner));
+  }
+  return std::make_unique<InferenceRunnerPool>(std::move(runners));
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,61 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// An InferenceRunner that dispatches each call to Run() to one of several
+// runners that are not in use, so that concurrent calls run in parallel. Calls
+// wait while all runners are in use. Run() is thread-safe, unlike the runners
+// it owns.
+class InferenceRunnerPool : public InferenceRunner {
+ public:
+  explicit InferenceRunnerPool(
+      std::vector<std::unique_ptr<InferenceRunner>> runners);
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& input_tensors) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  const std::vector<std::unique_ptr<InferenceRunner>> runners_;
+
+  absl::Mutex mutex_;
+  std::vector<InferenceRunner*> available_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns the runner created by "create_runner" if "num_runners" is 1, or an
+// InferenceRunnerPool of "num_runners" runners created by "create_runner"
+// otherwise.
+absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunnerPool(
+    int num_runners,
+    const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+        create_runner);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
@@ -0,0 +1,108 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Counts the calls in progress across all runners, and waits in Run() until
+// "num_concurrent" calls are in progress, or a timeout.
+struct CallTracker {
+  absl::Mutex mutex;
+  int in_progress = 0;
+  int max_in_progress = 0;
+  int num_concurrent = 1;
+};
+
+class TrackingRunner : public InferenceRunner {
+ public:
+  explicit TrackingRunner(CallTracker* tracker) : tracker_(tracker) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc,
+      const std::vector<Tensor>& input_tensors) override {
+    EXPECT_FALSE(in_use_) << "Runner used concurrently.";
+    in_use_ = true;
+    {
+      absl::MutexLock lock(&tracker_->mutex);
+      ++tracker_->in_progress;
+      tracker_->max_in_progress =
+          std::max(tracker_->max_in_progress, tracker_->in_progress);
+      tracker_->mutex.AwaitWithTimeout(
+          absl::Condition(
+              +[](CallTracker* tracker) {
+                return tracker->in_progress >= tracker->num_concurrent;
+              },
+              tracker_),
+          absl::Seconds(5));
+    }
+    absl::SleepFor(absl::Milliseconds(1));
+    {
+      absl::MutexLock lock(&tracker_->mutex);
+      --tracker_->in_progress;
+    }
+    in_use_ = false;
+    return std::vector<Tensor>();
+  }
+
+ private:
+  CallTracker* const tracker_;
+  bool in_use_ = false;
+};
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>> CreatePool(
+    int num_runners, CallTracker* tracker) {
+  return CreateInferenceRunnerPool(
+      num_runners,
+      [tracker]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+        return std::make_unique<TrackingRunner>(tracker);
+      });
+}
+
+TEST(InferenceRunnerPoolTest, RunsConcurrently) {
+  CallTracker tracker;
+  tracker.num_concurrent = 3;
+  MP_ASSERT_OK_AND_ASSIGN(auto pool, CreatePool(3, &tracker));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i) {
+    threads.emplace_back([&pool]() { MP_EXPECT_OK(pool->Run(nullptr, {})); });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(tracker.max_in_progress, 3);
+}
+
+TEST(InferenceRunnerPoolTest, WaitsForAvailableRunner) {
+  CallTracker tracker;
+  MP_ASSERT_OK_AND_ASSIGN(auto pool, CreatePool(2, &tracker));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&pool]() { MP_EXPECT_OK(pool->Run(nullptr, {})); });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_LE(tracker.max_in_progress, 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
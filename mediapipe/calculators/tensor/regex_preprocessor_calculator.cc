@@ -12,20 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/calculators/tensor/regex_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/tasks/cc/text/tokenizers/regex_tokenizer.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer_utils.h"
@@ -40,8 +42,11 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 // a RegexTokenizer.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The input text.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts, tokenized on `num_threads` threads. Exactly one
+//     of TEXT and TEXTS must be connected.
 // Side Inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the text model. Used to extract the metadata
@@ -56,6 +61,8 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 //     have the id of the <UNKNOWN> token. The tensor will be padded with the
 //     <PAD> token id to have size equal to the max sequence length for the text
 //     model.
+//     With TEXTS, the tensor has a row per text and a dynamic shape so that
+//     the inference runner resizes the model input to the batch size.
 //
 // Example:
 // node {
@@ -71,12 +78,14 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 // }
 class RegexPreprocessorCalculator : public Node {
  public:
-  static constexpr Input<std::string> kTextIn{"TEXT"};
+  static constexpr Input<std::string>::Optional kTextIn{"TEXT"};
+  static constexpr Input<std::vector<std::string>>::Optional kTextsIn{"TEXTS"};
   static constexpr SideInput<ModelMetadataExtractor> kMetadataExtractorSideIn{
       "METADATA_EXTRACTOR"};
   static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
 
-  MEDIAPIPE_NODE_CONTRACT(kTextIn, kMetadataExtractorSideIn, kTensorsOut);
+  MEDIAPIPE_NODE_CONTRACT(kTextIn, kTextsIn, kMetadataExtractorSideIn,
+                          kTensorsOut);
 
   static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
@@ -86,6 +95,12 @@ class RegexPreprocessorCalculator : public Node {
   std::unique_ptr<tasks::text::tokenizers::RegexTokenizer> tokenizer_;
   // The max sequence length accepted by the text model.
   int max_seq_len_ = 0;
+  // Tokenizes the texts of a TEXTS batch if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Writes the `max_seq_len_` token ids of `input_text` to `input_tokens`.
+  void TokenizeInputText(const std::string& input_text,
+                         int32_t* input_tokens);
 };
 
 absl::Status RegexPreprocessorCalculator::UpdateContract(
@@ -94,6 +109,8 @@ absl::Status RegexPreprocessorCalculator::UpdateContract(
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   RET_CHECK(options.has_max_seq_len()) << "max_seq_len is required";
   RET_CHECK_GT(options.max_seq_len(), 0) << "max_seq_len must be positive";
+  RET_CHECK(kTextIn(cc).IsConnected() ^ kTextsIn(cc).IsConnected())
+      << "Exactly one of TEXT and TEXTS must be connected.";
   return absl::OkStatus();
 }
 
@@ -122,19 +139,72 @@ absl::Status RegexPreprocessorCalculator::Open(CalculatorContext* cc) {
   const auto& options =
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   max_seq_len_ = options.max_seq_len();
+  if (kTextsIn(cc).IsConnected() && options.num_threads() > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>("regex_preprocessor",
+                                                options.num_threads());
+    thread_pool_->StartWorkers();
+  }
   return absl::OkStatus();
 }
 
 absl::Status RegexPreprocessorCalculator::Process(CalculatorContext* cc) {
+  if (kTextIn(cc).IsConnected()) {
+    std::vector<Tensor> result;
+    result.push_back(
+        {Tensor::ElementType::kInt32, Tensor::Shape({1, max_seq_len_})});
+    TokenizeInputText(kTextIn(cc).Get(),
+                      result[0].GetCpuWriteView().buffer<int32_t>());
+    kTensorsOut(cc).Send(std::move(result));
+    return absl::OkStatus();
+  }
+
+  const std::vector<std::string>& input_texts = kTextsIn(cc).Get();
+  RET_CHECK(!input_texts.empty()) << "TEXTS must not be empty.";
+  const int num_texts = input_texts.size();
+  std::vector<Tensor> result;
+  result.push_back({Tensor::ElementType::kInt32,
+                    Tensor::Shape({num_texts, max_seq_len_},
+                                  /*is_dynamic=*/true)});
+  auto write_view = result[0].GetCpuWriteView();
+  int32_t* input_tokens = write_view.buffer<int32_t>();
+  auto tokenize = [this, &input_texts, input_tokens](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      TokenizeInputText(input_texts[i], input_tokens + i * max_seq_len_);
+    }
+  };
+  const int num_ranges =
+      thread_pool_ == nullptr
+          ? 1
+          : std::min(thread_pool_->num_threads(), num_texts);
+  if (num_ranges == 1) {
+    tokenize(0, num_texts);
+  } else {
+    absl::BlockingCounter counter(num_ranges);
+    for (int range = 0; range < num_ranges; ++range) {
+      thread_pool_->Schedule(
+          [&tokenize, &counter, range, num_ranges, num_texts] {
+            tokenize(num_texts * range / num_ranges,
+                     num_texts * (range + 1) / num_ranges);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+  }
+  kTensorsOut(cc).Send(std::move(result));
+  return absl::OkStatus();
+}
+
+void RegexPreprocessorCalculator::TokenizeInputText(
+    const std::string& input_text, int32_t* input_tokens) {
   tasks::text::tokenizers::TokenizerResult tokenizer_result =
-      tokenizer_->Tokenize(kTextIn(cc).Get());
+      tokenizer_->Tokenize(input_text);
 
   int unknown_token_id = 0;
   tokenizer_->GetUnknownToken(&unknown_token_id);
   int pad_token_id = 0;
   tokenizer_->GetPadToken(&pad_token_id);
 
-  std::vector<int> input_tokens(max_seq_len_, pad_token_id);
+  std::fill_n(input_tokens, max_seq_len_, pad_token_id);
   int start_token_id = 0;
   int input_token_index = 0;
   if (tokenizer_->GetStartToken(&start_token_id)) {
@@ -158,13 +228,6 @@ absl::Status RegexPreprocessorCalculator::Process(CalculatorContext* cc) {
   // input_tensor                 <START>, t1, t2... <PAD>, <PAD>...
   // <START> is optional, t1, t2... will be replaced by <UNKNOWN> if it's
   // not found in the tokenizer vocab.
-  std::vector<Tensor> result;
-  result.push_back(
-      {Tensor::ElementType::kInt32, Tensor::Shape({1, max_seq_len_})});
-  std::memcpy(result[0].GetCpuWriteView().buffer<int32_t>(),
-              input_tokens.data(), input_tokens.size() * sizeof(int32_t));
-  kTensorsOut(cc).Send(std::move(result));
-  return absl::OkStatus();
 }
 
 MEDIAPIPE_REGISTER_NODE(RegexPreprocessorCalculator);
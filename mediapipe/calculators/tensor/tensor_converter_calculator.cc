@@ -20,10 +20,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "mediapipe/calculators/tensor/tensor_converter_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/gpu/gpu_buffer_format.h"
@@ -167,6 +169,7 @@ class TensorConverterCalculator : public CalculatorBase {
   bool flip_vertically_ = false;
   bool row_major_matrix_ = false;
   int max_num_channels_ = 3;
+  std::shared_ptr<TensorPool> tensor_pool_;
 };
 REGISTER_CALCULATOR(TensorConverterCalculator);
 
@@ -197,6 +200,7 @@ absl::Status TensorConverterCalculator::GetContract(CalculatorContract* cc) {
 
   RET_CHECK(cc->Outputs().HasTag(kTensorsTag));
   cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  cc->UseService(kTensorPoolService).Optional();
   return absl::OkStatus();
 }
 
@@ -204,6 +208,7 @@ absl::Status TensorConverterCalculator::Open(CalculatorContext* cc) {
   cc->SetOffset(TimestampDiff(0));
 
   MP_RETURN_IF_ERROR(LoadOptions(cc));
+  tensor_pool_ = GetTensorPool(cc);
 
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kGpuBufferTag)) {
@@ -274,9 +279,9 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
           format == mediapipe::ImageFormat::VEC32F1))
       RET_CHECK_FAIL() << "Unsupported CPU input format.";
 
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{1, height, width, channels_preserved});
+    output_tensors->push_back(CreateCpuTensor(
+        tensor_pool_.get(), Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, height, width, channels_preserved}));
     auto cpu_view = output_tensors->back().GetCpuWriteView();
 
     // Copy image data into tensor.
@@ -298,13 +303,18 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
     const int height = matrix.rows();
     const int width = matrix.cols();
     const int channels = 1;
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 Tensor::Shape{1, height, width, channels});
+    output_tensors->push_back(
+        CreateCpuTensor(tensor_pool_.get(), Tensor::ElementType::kFloat32,
+                        Tensor::Shape{1, height, width, channels}));
     MP_RETURN_IF_ERROR(CopyMatrixToTensor(
         matrix, output_tensors->back().GetCpuWriteView().buffer<float>()));
   } else {
     return absl::OkStatus();
   }
+  if (tensor_pool_) {
+    LogTensorPoolUsage(cc, *tensor_pool_,
+                       cc->Outputs().Tag(kTensorsTag).Name());
+  }
   cc->Outputs()
       .Tag(kTensorsTag)
       .Add(output_tensors.release(), cc->InputTimestamp());
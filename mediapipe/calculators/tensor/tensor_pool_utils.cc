@@ -0,0 +1,57 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensor_pool_utils.h"
+
+#include "mediapipe/framework/mediapipe_profiling.h"
+
+namespace mediapipe {
+
+std::shared_ptr<TensorPool> GetTensorPool(CalculatorContext* cc) {
+  auto service = cc->Service(kTensorPoolService);
+  if (!service.IsAvailable()) {
+    return nullptr;
+  }
+  return service.GetObject().shared_from_this();
+}
+
+Tensor CreateCpuTensor(
+    TensorPool* pool, Tensor::ElementType element_type,
+    const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  if (pool == nullptr) {
+    return Tensor(element_type, shape, quantization_parameters);
+  }
+  return pool->GetTensor(element_type, shape, quantization_parameters);
+}
+
+void LogTensorPoolUsage(CalculatorContext* cc, const TensorPool& pool,
+                        const std::string& stream_name) {
+#ifdef MEDIAPIPE_PROFILER_AVAILABLE
+  ProfilingContext* profiling_context = cc->GetProfilingContext();
+  if (profiling_context == nullptr) {
+    return;
+  }
+  LogEvent(profiling_context,
+           TraceEvent(TraceEvent::TENSOR_POOL_USAGE)
+               .set_node_id(cc->NodeId())
+               .set_input_ts(cc->InputTimestamp())
+               .set_packet_ts(cc->InputTimestamp())
+               .set_stream_id(&stream_name)
+               .set_is_finish(true)
+               .set_event_data(pool.GetStats().high_water_bytes));
+#endif  // MEDIAPIPE_PROFILER_AVAILABLE
+}
+
+}  // namespace mediapipe
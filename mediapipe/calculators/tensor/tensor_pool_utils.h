@@ -0,0 +1,45 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_POOL_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_POOL_UTILS_H_
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+namespace mediapipe {
+
+// Returns the graph's TensorPool, or nullptr if kTensorPoolService is not
+// available. The calculator must request the service in its contract.
+std::shared_ptr<TensorPool> GetTensorPool(CalculatorContext* cc);
+
+// Creates a CPU tensor whose buffer comes from "pool", or from the heap if
+// "pool" is null.
+Tensor CreateCpuTensor(
+    TensorPool* pool, Tensor::ElementType element_type,
+    const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters = {});
+
+// Logs the peak number of bytes held by tensors from "pool" to the graph
+// profiler, as a TENSOR_POOL_USAGE event on the output stream "stream_name".
+void LogTensorPoolUsage(CalculatorContext* cc, const TensorPool& pool,
+                        const std::string& stream_name);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_POOL_UTILS_H_
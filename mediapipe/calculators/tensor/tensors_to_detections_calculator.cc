@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include <unordered_map>
 #include <vector>
 
+#include "Eigen/Core"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
@@ -206,13 +211,26 @@ class TensorsToDetectionsCalculator : public Node {
 
   absl::Status LoadOptions(CalculatorContext* cc);
   absl::Status GpuInit(CalculatorContext* cc);
+  // Finds the top allowed class of each box in "raw_scores" and collects the
+  // boxes whose top score may pass min_score_thresh in "box_indices", with
+  // their scores and classes in "scores" and "classes", indexed by box.
+  void ScoreBoxes(const float* raw_scores, std::vector<int>* box_indices,
+                  std::vector<float>* scores, std::vector<int>* classes);
+  // Decodes the boxes listed in "box_indices".
   absl::Status DecodeBoxes(const float* raw_boxes,
                            const std::vector<Anchor>& anchors,
+                           absl::Span<const int> box_indices,
                            std::vector<float>* boxes);
   absl::Status ConvertToDetections(const float* detection_boxes,
                                    const float* detection_scores,
                                    const int* detection_classes,
                                    std::vector<Detection>* output_detections);
+  // Like above, for the boxes listed in "box_indices" only.
+  absl::Status ConvertToDetections(const float* detection_boxes,
+                                   const float* detection_scores,
+                                   const int* detection_classes,
+                                   absl::Span<const int> box_indices,
+                                   std::vector<Detection>* output_detections);
   Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
                                float box_xmax, float score, int class_id,
                                bool flip_vertically);
@@ -233,6 +251,16 @@ class TensorsToDetectionsCalculator : public Node {
   // Allowed or ignored class indices based on provided options or side packet.
   // These are used to filter out the output detection results.
   ClassIndexSet class_index_set_;
+  // Added to the raw scores of each class to exclude classes that are not
+  // allowed from the search of the top class: 0 for allowed classes and -inf
+  // for the others. Empty if all classes are allowed.
+  std::vector<float> class_score_mask_;
+
+  // Buffers reused across frames by ProcessCPU.
+  std::vector<int> box_indices_buffer_;
+  std::vector<float> boxes_buffer_;
+  std::vector<float> scores_buffer_;
+  std::vector<int> classes_buffer_;
 
   TensorsToDetectionsCalculatorOptions options_;
   bool scores_tensor_index_is_set_ = false;
@@ -414,44 +442,17 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
       }
       anchors_init_ = true;
     }
-    std::vector<float> boxes(num_boxes_ * num_coords_);
-    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, &boxes));
-
-    std::vector<float> detection_scores(num_boxes_);
-    std::vector<int> detection_classes(num_boxes_);
-
-    // Filter classes by scores.
-    for (int i = 0; i < num_boxes_; ++i) {
-      int class_id = -1;
-      float max_score = -std::numeric_limits<float>::max();
-      // Find the top score for box i.
-      for (int score_idx = 0; score_idx < num_classes_; ++score_idx) {
-        if (IsClassIndexAllowed(score_idx)) {
-          auto score = raw_scores[i * num_classes_ + score_idx];
-          if (options_.sigmoid_score()) {
-            if (options_.has_score_clipping_thresh()) {
-              score = score < -options_.score_clipping_thresh()
-                          ? -options_.score_clipping_thresh()
-                          : score;
-              score = score > options_.score_clipping_thresh()
-                          ? options_.score_clipping_thresh()
-                          : score;
-            }
-            score = 1.0f / (1.0f + std::exp(-score));
-          }
-          if (max_score < score) {
-            max_score = score;
-            class_id = score_idx;
-          }
-        }
-      }
-      detection_scores[i] = max_score;
-      detection_classes[i] = class_id;
-    }
-
-    MP_RETURN_IF_ERROR(
-        ConvertToDetections(boxes.data(), detection_scores.data(),
-                            detection_classes.data(), output_detections));
+    // Boxes are only decoded and converted if their score can pass the
+    // threshold. The buffers are sized for all boxes, but only the entries of
+    // the selected boxes are written and read.
+    ScoreBoxes(raw_scores, &box_indices_buffer_, &scores_buffer_,
+               &classes_buffer_);
+    boxes_buffer_.resize(num_boxes_ * num_coords_);
+    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, box_indices_buffer_,
+                                   &boxes_buffer_));
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        boxes_buffer_.data(), scores_buffer_.data(), classes_buffer_.data(),
+        box_indices_buffer_, output_detections));
   } else {
     // Postprocessing on CPU with postprocessing op (e.g. anchor decoding and
     // non-maximum suppression) within the model.
@@ -736,6 +737,16 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
     }
   }
 
+  class_score_mask_.clear();
+  if (!class_index_set_.values.empty()) {
+    class_score_mask_.resize(num_classes_);
+    for (int i = 0; i < num_classes_; ++i) {
+      class_score_mask_[i] = IsClassIndexAllowed(i)
+                                 ? 0.0f
+                                 : -std::numeric_limits<float>::infinity();
+    }
+  }
+
   if (options_.has_tensor_mapping()) {
     RET_CHECK_OK(CheckCustomTensorMapping(options_.tensor_mapping()));
     tensor_mapping_ = options_.tensor_mapping();
@@ -770,10 +781,77 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+void TensorsToDetectionsCalculator::ScoreBoxes(const float* raw_scores,
+                                               std::vector<int>* box_indices,
+                                               std::vector<float>* scores,
+                                               std::vector<int>* classes) {
+  box_indices->clear();
+  scores->resize(num_boxes_);
+  classes->resize(num_boxes_);
+
+  // Clipping and the sigmoid are monotonic, so the top class can be found on
+  // the raw scores, and the score threshold can be checked on them before
+  // computing the sigmoid of the top score only. The threshold used here is
+  // slightly lowered to account for rounding; ConvertToDetections() applies the
+  // exact one.
+  const bool sigmoid = options_.sigmoid_score();
+  const bool clip = sigmoid && options_.has_score_clipping_thresh();
+  const float clip_thresh = options_.score_clipping_thresh();
+  float min_raw_score = -std::numeric_limits<float>::infinity();
+  if (options_.has_min_score_thresh()) {
+    const float thresh = options_.min_score_thresh();
+    if (!sigmoid) {
+      min_raw_score = thresh;
+    } else if (thresh >= 1.0f) {
+      min_raw_score = std::numeric_limits<float>::max();
+    } else if (thresh > 0.0f) {
+      min_raw_score = std::log(thresh / (1.0f - thresh)) - 1e-3f;
+    }
+  }
+
+  using ScoreArray = Eigen::Map<const Eigen::ArrayXf>;
+  const bool has_mask = !class_score_mask_.empty();
+  const ScoreArray mask(has_mask ? class_score_mask_.data() : raw_scores,
+                        num_classes_);
+  for (int i = 0; i < num_boxes_; ++i) {
+    const ScoreArray box_scores(raw_scores + i * num_classes_, num_classes_);
+    float max_score;
+    if (num_classes_ == 1 && !has_mask) {
+      max_score = box_scores[0];
+      if (clip) max_score = std::clamp(max_score, -clip_thresh, clip_thresh);
+    } else if (clip && has_mask) {
+      max_score =
+          (box_scores.max(-clip_thresh).min(clip_thresh) + mask).maxCoeff();
+    } else if (clip) {
+      max_score = box_scores.max(-clip_thresh).min(clip_thresh).maxCoeff();
+    } else if (has_mask) {
+      max_score = (box_scores + mask).maxCoeff();
+    } else {
+      max_score = box_scores.maxCoeff();
+    }
+    // Also skips boxes without any allowed class.
+    if (!(max_score >= min_raw_score) ||
+        max_score == -std::numeric_limits<float>::infinity()) {
+      continue;
+    }
+    // Picks the first class with the top score, like a scan in class order.
+    int class_id = 0;
+    for (; class_id + 1 < num_classes_; ++class_id) {
+      float score = box_scores[class_id];
+      if (clip) score = std::clamp(score, -clip_thresh, clip_thresh);
+      if (has_mask) score += mask[class_id];
+      if (score == max_score) break;
+    }
+    box_indices->push_back(i);
+    (*scores)[i] = sigmoid ? 1.0f / (1.0f + std::exp(-max_score)) : max_score;
+    (*classes)[i] = class_id;
+  }
+}
+
 absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
     const float* raw_boxes, const std::vector<Anchor>& anchors,
-    std::vector<float>* boxes) {
-  for (int i = 0; i < num_boxes_; ++i) {
+    absl::Span<const int> box_indices, std::vector<float>* boxes) {
+  for (int i : box_indices) {
     const int box_offset = i * num_coords_ + options_.box_coord_offset();
 
     float y_center = 0.0;
@@ -860,7 +938,17 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
 absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
     const int* detection_classes, std::vector<Detection>* output_detections) {
-  for (int i = 0; i < num_boxes_; ++i) {
+  std::vector<int> box_indices(num_boxes_);
+  std::iota(box_indices.begin(), box_indices.end(), 0);
+  return ConvertToDetections(detection_boxes, detection_scores,
+                             detection_classes, box_indices, output_detections);
+}
+
+absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
+    const float* detection_boxes, const float* detection_scores,
+    const int* detection_classes, absl::Span<const int> box_indices,
+    std::vector<Detection>* output_detections) {
+  for (int i : box_indices) {
     if (max_results_ > 0 && output_detections->size() == max_results_) {
       break;
     }
@@ -0,0 +1,140 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures TensorsToDetectionsCalculator on the CPU for the output sizes of
+// BlazeFace and SSD models. Scores are drawn so that a small fraction of the
+// boxes pass min_score_thresh, as with real detections.
+#include <random>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+struct ModelConfig {
+  const char* name;
+  int num_boxes;
+  int num_classes;
+  int num_keypoints;
+};
+
+constexpr ModelConfig kModelConfigs[] = {
+    {"BlazeFaceShortRange", 896, 1, 6},
+    {"BlazeFaceFullRange", 2304, 1, 6},
+    {"SsdMobileNet", 1917, 91, 0},
+    {"Ssd10kAnchors", 10000, 91, 0},
+};
+
+constexpr char kGraphTemplate[] = R"pb(
+  input_stream: "tensors"
+  input_side_packet: "anchors"
+  node {
+    calculator: "TensorsToDetectionsCalculator"
+    input_stream: "TENSORS:tensors"
+    input_side_packet: "ANCHORS:anchors"
+    output_stream: "DETECTIONS:detections"
+    options {
+      [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+        num_boxes: $0
+        num_classes: $1
+        num_coords: $2
+        num_keypoints: $3
+        num_values_per_keypoint: 2
+        box_coord_offset: 0
+        keypoint_coord_offset: 4
+        x_scale: 128.0
+        y_scale: 128.0
+        h_scale: 128.0
+        w_scale: 128.0
+        sigmoid_score: true
+        score_clipping_thresh: 100.0
+        min_score_thresh: 0.5
+      }
+    }
+  }
+)pb";
+
+Tensor MakeTensor(const std::vector<int>& dims, float mean, float stddev,
+                  std::mt19937* generator) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape(dims));
+  auto view = tensor.GetCpuWriteView();
+  float* buffer = view.buffer<float>();
+  std::normal_distribution<float> distribution(mean, stddev);
+  for (int i = 0; i < tensor.shape().num_elements(); ++i) {
+    buffer[i] = distribution(*generator);
+  }
+  return tensor;
+}
+
+void BM_TensorsToDetectionsCpu(benchmark::State& state) {
+  const ModelConfig& config = kModelConfigs[state.range(0)];
+  state.SetLabel(config.name);
+  const int num_coords = 4 + 2 * config.num_keypoints;
+
+  CalculatorGraph graph;
+  CHECK_OK(graph.Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(kGraphTemplate, config.num_boxes, config.num_classes,
+                       num_coords, config.num_keypoints))));
+  int64_t num_detections = 0;
+  CHECK_OK(graph.ObserveOutputStream("detections", [&](const Packet& packet) {
+    num_detections += packet.Get<std::vector<Detection>>().size();
+    return absl::OkStatus();
+  }));
+
+  std::vector<Anchor> anchors(config.num_boxes);
+  for (int i = 0; i < config.num_boxes; ++i) {
+    anchors[i].set_x_center((i % 32 + 0.5f) / 32);
+    anchors[i].set_y_center((i / 32 % 32 + 0.5f) / 32);
+    anchors[i].set_w(1.0f);
+    anchors[i].set_h(1.0f);
+  }
+  CHECK_OK(graph.StartRun(
+      {{"anchors", MakePacket<std::vector<Anchor>>(std::move(anchors))}}));
+
+  // The same tensors are sent at every timestamp.
+  std::mt19937 generator(/*seed=*/1);
+  std::vector<Tensor> tensors;
+  tensors.push_back(
+      MakeTensor({1, config.num_boxes, num_coords}, 0.0f, 8.0f, &generator));
+  tensors.push_back(MakeTensor({1, config.num_boxes, config.num_classes},
+                               -4.0f, 2.0f, &generator));
+  const Packet tensors_packet =
+      MakePacket<std::vector<Tensor>>(std::move(tensors));
+
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    CHECK_OK(graph.AddPacketToInputStream(
+        "tensors", tensors_packet.At(Timestamp(timestamp++))));
+    CHECK_OK(graph.WaitUntilIdle());
+  }
+  state.counters["detections"] =
+      benchmark::Counter(num_detections, benchmark::Counter::kAvgIterations);
+
+  CHECK_OK(graph.CloseAllInputStreams());
+  CHECK_OK(graph.WaitUntilDone());
+}
+BENCHMARK(BM_TensorsToDetectionsCpu)->DenseRange(0, 3);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
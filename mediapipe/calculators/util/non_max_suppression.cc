@@ -0,0 +1,445 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/non_max_suppression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/types/span.h"
+
+namespace mediapipe {
+
+void PackedBoxes::Clear() {
+  xmin.clear();
+  ymin.clear();
+  xmax.clear();
+  ymax.clear();
+}
+
+void PackedBoxes::Reserve(int num_boxes) {
+  xmin.reserve(num_boxes);
+  ymin.reserve(num_boxes);
+  xmax.reserve(num_boxes);
+  ymax.reserve(num_boxes);
+}
+
+void PackedBoxes::Add(float box_xmin, float box_ymin, float box_xmax,
+                      float box_ymax) {
+  xmin.push_back(box_xmin);
+  ymin.push_back(box_ymin);
+  xmax.push_back(box_xmax);
+  ymax.push_back(box_ymax);
+}
+
+namespace {
+
+// Average number of boxes per cell of a SpatialGrid.
+constexpr int kBoxesPerGridCell = 4;
+
+// A grid is only built once this many boxes are retained. Comparing each
+// retained box with all the following boxes is faster when few are retained,
+// e.g. in scenes with few objects and many overlapping candidates.
+constexpr int kMinRetainedBoxesForSpatialGrid = 16;
+
+bool SortBySecond(const std::pair<int, float>& indexed_score_0,
+                  const std::pair<int, float>& indexed_score_1) {
+  return (indexed_score_0.second > indexed_score_1.second);
+}
+
+// Boxes reordered by decreasing score, so that the boxes following a box are
+// contiguous in memory.
+struct SortedBoxes {
+  // The index of each box in the input PackedBoxes.
+  std::vector<int> index;
+  std::vector<float> score;
+  PackedBoxes boxes;
+  std::vector<float> area;
+
+  int size() const { return index.size(); }
+  bool IsEmpty(int i) const {
+    return boxes.xmin[i] > boxes.xmax[i] || boxes.ymin[i] > boxes.ymax[i];
+  }
+};
+
+SortedBoxes SortByScore(const PackedBoxes& boxes,
+                        absl::Span<const float> scores) {
+  std::vector<std::pair<int, float>> indexed_scores;
+  indexed_scores.reserve(boxes.size());
+  for (int i = 0; i < boxes.size(); ++i) {
+    indexed_scores.push_back(std::make_pair(i, scores[i]));
+  }
+  std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+
+  SortedBoxes sorted;
+  sorted.index.reserve(boxes.size());
+  sorted.score.reserve(boxes.size());
+  sorted.area.reserve(boxes.size());
+  sorted.boxes.Reserve(boxes.size());
+  for (const auto& indexed_score : indexed_scores) {
+    const int i = indexed_score.first;
+    sorted.index.push_back(i);
+    sorted.score.push_back(indexed_score.second);
+    sorted.boxes.Add(boxes.xmin[i], boxes.ymin[i], boxes.xmax[i],
+                     boxes.ymax[i]);
+    sorted.area.push_back((boxes.xmax[i] - boxes.xmin[i]) *
+                          (boxes.ymax[i] - boxes.ymin[i]));
+  }
+  return sorted;
+}
+
+// Returns the overlap of box "a" with box "b", where "b" is the box checked
+// for suppression.
+float Overlap(OverlapType overlap_type, const SortedBoxes& sorted, int a,
+              int b) {
+  if (sorted.IsEmpty(a) || sorted.IsEmpty(b)) return 0.0f;
+  const PackedBoxes& boxes = sorted.boxes;
+  const float intersection_width = std::min(boxes.xmax[a], boxes.xmax[b]) -
+                                   std::max(boxes.xmin[a], boxes.xmin[b]);
+  const float intersection_height = std::min(boxes.ymax[a], boxes.ymax[b]) -
+                                    std::max(boxes.ymin[a], boxes.ymin[b]);
+  if (intersection_width < 0.0f || intersection_height < 0.0f) return 0.0f;
+  const float intersection_area = intersection_width * intersection_height;
+  float normalization = 0.0f;
+  switch (overlap_type) {
+    case OverlapType::kJaccard:
+      normalization = (std::max(boxes.xmax[a], boxes.xmax[b]) -
+                       std::min(boxes.xmin[a], boxes.xmin[b])) *
+                      (std::max(boxes.ymax[a], boxes.ymax[b]) -
+                       std::min(boxes.ymin[a], boxes.ymin[b]));
+      break;
+    case OverlapType::kModifiedJaccard:
+      normalization = sorted.area[b];
+      break;
+    case OverlapType::kIntersectionOverUnion:
+      normalization = sorted.area[a] + sorted.area[b] - intersection_area;
+      break;
+  }
+  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
+}
+
+// Same as Overlap(), for box "box" and each box in [begin, end), writing the
+// overlaps to "overlaps". "box" takes the role of "a" if "box_is_first", and
+// of "b" otherwise. Unlike Overlap(), boxes that do not intersect may get an
+// overlap of NaN or -0 instead of 0. The results compare the same against a
+// non-negative threshold, and avoiding masks keeps the computation vectorized.
+void ComputeOverlaps(OverlapType overlap_type, const SortedBoxes& sorted,
+                     int box, bool box_is_first, int begin, int end,
+                     float* overlaps) {
+  using Array = Eigen::ArrayXf;
+  const int n = end - begin;
+  Eigen::Map<Array> result(overlaps, n);
+  if (sorted.IsEmpty(box)) {
+    result.setZero();
+    return;
+  }
+  const PackedBoxes& boxes = sorted.boxes;
+  const Eigen::Map<const Array> xmin(boxes.xmin.data() + begin, n);
+  const Eigen::Map<const Array> ymin(boxes.ymin.data() + begin, n);
+  const Eigen::Map<const Array> xmax(boxes.xmax.data() + begin, n);
+  const Eigen::Map<const Array> ymax(boxes.ymax.data() + begin, n);
+  const Eigen::Map<const Array> area(sorted.area.data() + begin, n);
+  const float box_xmin = boxes.xmin[box];
+  const float box_ymin = boxes.ymin[box];
+  const float box_xmax = boxes.xmax[box];
+  const float box_ymax = boxes.ymax[box];
+  const float box_area = sorted.area[box];
+
+  // The intersection is 0 for empty and non-intersecting boxes. Otherwise the
+  // normalization is at least the intersection, so is positive. Expressions
+  // are evaluated lazily, in a single pass into "result".
+  const auto intersection_width = xmax.min(box_xmax) - xmin.max(box_xmin);
+  const auto intersection_height = ymax.min(box_ymax) - ymin.max(box_ymin);
+  const auto intersection_area =
+      intersection_width.max(0.0f) * intersection_height.max(0.0f);
+  switch (overlap_type) {
+    case OverlapType::kJaccard:
+      result = intersection_area / ((xmax.max(box_xmax) - xmin.min(box_xmin)) *
+                                    (ymax.max(box_ymax) - ymin.min(box_ymin)));
+      break;
+    case OverlapType::kModifiedJaccard:
+      if (box_is_first) {
+        result = intersection_area / area;
+      } else {
+        result = intersection_area / box_area;
+      }
+      break;
+    case OverlapType::kIntersectionOverUnion:
+      result = intersection_area / ((area + box_area) - intersection_area);
+      break;
+  }
+}
+
+// Writes to "overlaps" the overlaps of box "box" with each box in
+// [begin, end), as ComputeOverlaps() if "threshold" is non-negative.
+void ComputeOverlaps(OverlapType overlap_type, const SortedBoxes& sorted,
+                     int box, bool box_is_first, int begin, int end,
+                     float threshold, float* overlaps) {
+  if (threshold >= 0.0f) {
+    ComputeOverlaps(overlap_type, sorted, box, box_is_first, begin, end,
+                    overlaps);
+    return;
+  }
+  for (int j = begin; j < end; ++j) {
+    overlaps[j - begin] = box_is_first ? Overlap(overlap_type, sorted, box, j)
+                                       : Overlap(overlap_type, sorted, j, box);
+  }
+}
+
+// Buckets the non-empty boxes among the first "num_boxes" sorted boxes into a
+// uniform grid spanning all of them. Boxes with a positive intersection share
+// at least one cell. Boxes with NaN coordinates, which overlap no other box, are
+// not bucketed.
+class SpatialGrid {
+ public:
+  // Returns false if the boxes cannot be bucketed, e.g. if some coordinates
+  // are not finite.
+  bool Build(const SortedBoxes& sorted, int num_boxes) {
+    const PackedBoxes& boxes = sorted.boxes;
+    float xmin = std::numeric_limits<float>::max();
+    float ymin = std::numeric_limits<float>::max();
+    float xmax = std::numeric_limits<float>::lowest();
+    float ymax = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < num_boxes; ++i) {
+      if (!IsBucketed(boxes, i)) continue;
+      xmin = std::min(xmin, boxes.xmin[i]);
+      ymin = std::min(ymin, boxes.ymin[i]);
+      xmax = std::max(xmax, boxes.xmax[i]);
+      ymax = std::max(ymax, boxes.ymax[i]);
+    }
+    if (!std::isfinite(xmin) || !std::isfinite(ymin) || !std::isfinite(xmax) ||
+        !std::isfinite(ymax) || !std::isfinite(xmax - xmin) ||
+        !std::isfinite(ymax - ymin)) {
+      return false;
+    }
+    cells_per_side_ = std::max(
+        1, static_cast<int>(std::sqrt(num_boxes / kBoxesPerGridCell)));
+    xmin_ = xmin;
+    ymin_ = ymin;
+    x_scale_ = xmax > xmin ? cells_per_side_ / (xmax - xmin) : 0.0f;
+    y_scale_ = ymax > ymin ? cells_per_side_ / (ymax - ymin) : 0.0f;
+
+    // Counting sort of (cell, box) pairs by cell.
+    const int num_cells = cells_per_side_ * cells_per_side_;
+    cell_begin_.assign(num_cells + 1, 0);
+    for (int i = 0; i < num_boxes; ++i) {
+      if (!IsBucketed(boxes, i)) continue;
+      ForEachCell(boxes, i, [this](int cell) { ++cell_begin_[cell + 1]; });
+    }
+    for (int cell = 0; cell < num_cells; ++cell) {
+      cell_begin_[cell + 1] += cell_begin_[cell];
+    }
+    cell_boxes_.resize(cell_begin_[num_cells]);
+    std::vector<int> cell_end(cell_begin_.begin(), cell_begin_.end() - 1);
+    for (int i = 0; i < num_boxes; ++i) {
+      if (!IsBucketed(boxes, i)) continue;
+      ForEachCell(boxes, i,
+                  [this, &cell_end, i](int cell) {
+                    cell_boxes_[cell_end[cell]++] = i;
+                  });
+    }
+    last_visit_.assign(num_boxes, -1);
+    return true;
+  }
+
+  // Calls "fn" once for each box sharing a cell with box "i", including "i"
+  // itself if it was bucketed.
+  template <typename Fn>
+  void ForEachNeighbor(const PackedBoxes& boxes, int i, Fn fn) {
+    if (!IsBucketed(boxes, i)) return;
+    ++num_visits_;
+    ForEachCell(boxes, i, [this, &fn](int cell) {
+      for (int k = cell_begin_[cell]; k < cell_begin_[cell + 1]; ++k) {
+        const int j = cell_boxes_[k];
+        if (last_visit_[j] == num_visits_) continue;
+        last_visit_[j] = num_visits_;
+        fn(j);
+      }
+    });
+  }
+
+ private:
+  static bool IsBucketed(const PackedBoxes& boxes, int i) {
+    return boxes.xmin[i] <= boxes.xmax[i] && boxes.ymin[i] <= boxes.ymax[i];
+  }
+
+  int CellCoordinate(float value, float origin, float scale) const {
+    const float cell = (value - origin) * scale;
+    return std::min(std::max(static_cast<int>(cell), 0), cells_per_side_ - 1);
+  }
+
+  template <typename Fn>
+  void ForEachCell(const PackedBoxes& boxes, int i, Fn fn) const {
+    const int x_begin = CellCoordinate(boxes.xmin[i], xmin_, x_scale_);
+    const int x_end = CellCoordinate(boxes.xmax[i], xmin_, x_scale_);
+    const int y_begin = CellCoordinate(boxes.ymin[i], ymin_, y_scale_);
+    const int y_end = CellCoordinate(boxes.ymax[i], ymin_, y_scale_);
+    for (int y = y_begin; y <= y_end; ++y) {
+      for (int x = x_begin; x <= x_end; ++x) {
+        fn(y * cells_per_side_ + x);
+      }
+    }
+  }
+
+  int cells_per_side_ = 0;
+  float xmin_ = 0.0f;
+  float ymin_ = 0.0f;
+  float x_scale_ = 0.0f;
+  float y_scale_ = 0.0f;
+  // Boxes in cell "c" are cell_boxes_[cell_begin_[c]..cell_begin_[c + 1]).
+  std::vector<int> cell_begin_;
+  std::vector<int> cell_boxes_;
+  // The number of calls to ForEachNeighbor, and the last call to visit each
+  // box.
+  int num_visits_ = 0;
+  std::vector<int> last_visit_;
+};
+
+// Whether a grid should be used for "num_boxes" boxes. The grid only reports
+// intersecting boxes, so it cannot be used if non-intersecting boxes can be
+// suppressed.
+bool UseSpatialGrid(const NonMaxSuppressionOptions& options, int num_boxes) {
+  return options.min_boxes_for_spatial_grid >= 0 &&
+         num_boxes >= options.min_boxes_for_spatial_grid &&
+         options.min_suppression_threshold >= 0.0f;
+}
+
+}  // namespace
+
+std::vector<int> NonMaxSuppression(const PackedBoxes& boxes,
+                                   absl::Span<const float> scores,
+                                   const NonMaxSuppressionOptions& options) {
+  const SortedBoxes sorted = SortByScore(boxes, scores);
+  // Boxes scoring lower than min_score_threshold are neither returned nor
+  // needed to suppress other boxes.
+  int num_boxes = sorted.size();
+  if (options.min_score_threshold > 0) {
+    num_boxes = std::lower_bound(sorted.score.begin(), sorted.score.end(),
+                                 options.min_score_threshold,
+                                 std::greater_equal<float>()) -
+                sorted.score.begin();
+  }
+  const int max_num_detections =
+      options.max_num_detections > -1 ? options.max_num_detections : num_boxes;
+
+  SpatialGrid grid;
+  bool use_grid = false;
+  std::vector<char> suppressed(num_boxes, false);
+  std::vector<float> overlaps;
+  std::vector<int> retained;
+  // A box is suppressed iff a retained box with a higher score overlaps it
+  // more than the threshold, so each retained box suppresses the overlapping
+  // boxes that follow it.
+  for (int i = 0; i < num_boxes; ++i) {
+    if (suppressed[i]) continue;
+    retained.push_back(sorted.index[i]);
+    if (static_cast<int>(retained.size()) >= max_num_detections) break;
+    if (retained.size() == kMinRetainedBoxesForSpatialGrid &&
+        UseSpatialGrid(options, num_boxes)) {
+      use_grid = grid.Build(sorted, num_boxes);
+    }
+    if (use_grid) {
+      grid.ForEachNeighbor(sorted.boxes, i, [&](int j) {
+        if (j > i && !suppressed[j] &&
+            Overlap(options.overlap_type, sorted, i, j) >
+                options.min_suppression_threshold) {
+          suppressed[j] = true;
+        }
+      });
+    } else {
+      overlaps.resize(num_boxes - i - 1);
+      ComputeOverlaps(options.overlap_type, sorted, i, /*box_is_first=*/true,
+                      i + 1, num_boxes, options.min_suppression_threshold,
+                      overlaps.data());
+      for (int j = i + 1; j < num_boxes; ++j) {
+        if (overlaps[j - i - 1] > options.min_suppression_threshold) {
+          suppressed[j] = true;
+        }
+      }
+    }
+  }
+  return retained;
+}
+
+std::vector<WeightedNonMaxSuppressionCluster> WeightedNonMaxSuppression(
+    const PackedBoxes& boxes, absl::Span<const float> scores,
+    const NonMaxSuppressionOptions& options) {
+  const SortedBoxes sorted = SortByScore(boxes, scores);
+  const int num_boxes = sorted.size();
+
+  SpatialGrid grid;
+  bool use_grid = false;
+  std::vector<char> removed(num_boxes, false);
+  std::vector<float> overlaps;
+  std::vector<int> members;
+  std::vector<WeightedNonMaxSuppressionCluster> clusters;
+  // Box "i" stays the highest scoring remaining box until it is removed.
+  for (int i = 0; i < num_boxes;) {
+    if (removed[i]) {
+      ++i;
+      continue;
+    }
+    if (options.min_score_threshold > 0 &&
+        sorted.score[i] < options.min_score_threshold) {
+      break;
+    }
+    // The cluster contains the remaining boxes, usually including "i" itself,
+    // that overlap box "i".
+    members.clear();
+    if (clusters.size() == kMinRetainedBoxesForSpatialGrid &&
+        UseSpatialGrid(options, num_boxes)) {
+      use_grid = grid.Build(sorted, num_boxes);
+    }
+    if (use_grid) {
+      grid.ForEachNeighbor(sorted.boxes, i, [&](int j) {
+        if (j >= i && !removed[j] &&
+            Overlap(options.overlap_type, sorted, j, i) >
+                options.min_suppression_threshold) {
+          members.push_back(j);
+        }
+      });
+      std::sort(members.begin(), members.end());
+    } else {
+      overlaps.resize(num_boxes - i);
+      ComputeOverlaps(options.overlap_type, sorted, i, /*box_is_first=*/false,
+                      i, num_boxes, options.min_suppression_threshold,
+                      overlaps.data());
+      for (int j = i; j < num_boxes; ++j) {
+        if (!removed[j] &&
+            overlaps[j - i] > options.min_suppression_threshold) {
+          members.push_back(j);
+        }
+      }
+    }
+
+    WeightedNonMaxSuppressionCluster cluster;
+    cluster.index = sorted.index[i];
+    cluster.members.reserve(members.size());
+    for (int j : members) {
+      removed[j] = true;
+      cluster.members.push_back(sorted.index[j]);
+    }
+    clusters.push_back(std::move(cluster));
+    // Nothing was removed, so the next iteration would find the same cluster.
+    if (members.empty()) break;
+  }
+  return clusters;
+}
+
+}  // namespace mediapipe
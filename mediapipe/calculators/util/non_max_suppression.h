@@ -0,0 +1,94 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+#define MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace mediapipe {
+
+// A set of axis-aligned boxes stored as a struct of arrays, so that the
+// overlap of one box with many others can be computed with SIMD instructions.
+struct PackedBoxes {
+  std::vector<float> xmin;
+  std::vector<float> ymin;
+  std::vector<float> xmax;
+  std::vector<float> ymax;
+
+  int size() const { return xmin.size(); }
+  void Clear();
+  void Reserve(int num_boxes);
+  // Adds a box given by its corners. A box with xmax < xmin or ymax < ymin is
+  // empty and overlaps no other box.
+  void Add(float xmin, float ymin, float xmax, float ymax);
+};
+
+// Overlap measures, matching NonMaxSuppressionCalculatorOptions::OverlapType.
+// For two boxes "a" and "b", with "b" the box being checked for suppression:
+enum class OverlapType {
+  // Intersection area over the area of the bounding box of "a" and "b".
+  kJaccard,
+  // Intersection area over the area of "b".
+  kModifiedJaccard,
+  // Intersection area over the area of the union of "a" and "b".
+  kIntersectionOverUnion,
+};
+
+struct NonMaxSuppressionOptions {
+  OverlapType overlap_type = OverlapType::kJaccard;
+  // A box is suppressed by a higher scoring box if their overlap is greater
+  // than this threshold.
+  float min_suppression_threshold = 1.0f;
+  // If positive, boxes scoring lower than this threshold are not returned.
+  float min_score_threshold = -1.0f;
+  // Maximum number of boxes to return, or -1 to return all of them. Ignored
+  // by WeightedNonMaxSuppression.
+  int max_num_detections = -1;
+  // If there are at least this many boxes, they are bucketed into a uniform
+  // grid once some boxes are retained, so that only nearby boxes are compared.
+  // Negative to never use a grid.
+  int min_boxes_for_spatial_grid = 128;
+};
+
+// Returns the indices of the boxes that are not suppressed, in order of
+// decreasing score. "scores" holds one score per box.
+std::vector<int> NonMaxSuppression(const PackedBoxes& boxes,
+                                   absl::Span<const float> scores,
+                                   const NonMaxSuppressionOptions& options);
+
+// A group of boxes merged by WeightedNonMaxSuppression.
+struct WeightedNonMaxSuppressionCluster {
+  // The highest scoring box of the cluster.
+  int index;
+  // The boxes whose overlap with "index" is greater than the suppression
+  // threshold, in order of decreasing score, usually including "index" itself.
+  // The output box is the score-weighted average of these boxes, or box
+  // "index" unchanged if this is empty.
+  std::vector<int> members;
+};
+
+// Repeatedly takes the highest scoring remaining box and removes it and all the
+// boxes that overlap it, returning one cluster per removal. Stops after a
+// cluster without members, or when the highest scoring box scores lower than a
+// positive min_score_threshold.
+std::vector<WeightedNonMaxSuppressionCluster> WeightedNonMaxSuppression(
+    const PackedBoxes& boxes, absl::Span<const float> scores,
+    const NonMaxSuppressionOptions& options);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
@@ -0,0 +1,161 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/non_max_suppression.h"
+
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(NonMaxSuppressionTest, SuppressesOverlappingBoxes) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 0.4f, 0.4f);
+  boxes.Add(0.05f, 0.0f, 0.45f, 0.4f);  // Overlaps box 0 by 0.8.
+  boxes.Add(0.6f, 0.6f, 0.8f, 0.8f);
+  NonMaxSuppressionOptions options;
+  options.min_suppression_threshold = 0.5f;
+
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.7f, 0.9f, 0.8f}, options),
+              ElementsAre(1, 2));
+
+  options.min_suppression_threshold = 0.9f;
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.7f, 0.9f, 0.8f}, options),
+              ElementsAre(1, 2, 0));
+}
+
+TEST(NonMaxSuppressionTest, AppliesScoreThresholdAndMaxNumDetections) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 0.1f, 0.1f);
+  boxes.Add(0.2f, 0.2f, 0.3f, 0.3f);
+  boxes.Add(0.4f, 0.4f, 0.5f, 0.5f);
+  NonMaxSuppressionOptions options;
+  options.min_suppression_threshold = 0.5f;
+
+  options.min_score_threshold = 0.5f;
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.6f, 0.4f, 0.8f}, options),
+              ElementsAre(2, 0));
+
+  options.min_score_threshold = -1.0f;
+  options.max_num_detections = 2;
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.6f, 0.4f, 0.8f}, options),
+              ElementsAre(2, 0));
+}
+
+TEST(NonMaxSuppressionTest, ModifiedJaccardNormalizesBySuppressedBox) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 1.0f, 1.0f);
+  boxes.Add(0.2f, 0.2f, 0.4f, 0.4f);  // Inside box 0.
+  NonMaxSuppressionOptions options;
+  options.min_suppression_threshold = 0.5f;
+
+  options.overlap_type = OverlapType::kModifiedJaccard;
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.9f, 0.8f}, options), ElementsAre(0));
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.8f, 0.9f}, options),
+              ElementsAre(1, 0));
+
+  options.overlap_type = OverlapType::kIntersectionOverUnion;
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.9f, 0.8f}, options),
+              ElementsAre(0, 1));
+}
+
+TEST(NonMaxSuppressionTest, EmptyBoxesAreNotSuppressed) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 0.4f, 0.4f);
+  boxes.Add(0.3f, 0.0f, 0.1f, 0.4f);  // xmax < xmin.
+  NonMaxSuppressionOptions options;
+  options.min_suppression_threshold = 0.0f;
+
+  EXPECT_THAT(NonMaxSuppression(boxes, {0.9f, 0.8f}, options),
+              ElementsAre(0, 1));
+}
+
+TEST(NonMaxSuppressionTest, SpatialGridMatchesComparingAllBoxes) {
+  std::mt19937 generator(/*seed=*/1);
+  std::uniform_real_distribution<float> position(0.0f, 1.0f);
+  std::uniform_real_distribution<float> size(0.0f, 0.05f);
+  PackedBoxes boxes;
+  std::vector<float> scores;
+  for (int i = 0; i < 2000; ++i) {
+    const float xmin = position(generator);
+    const float ymin = position(generator);
+    boxes.Add(xmin, ymin, xmin + size(generator), ymin + size(generator));
+    scores.push_back(position(generator));
+  }
+
+  for (auto overlap_type :
+       {OverlapType::kJaccard, OverlapType::kModifiedJaccard,
+        OverlapType::kIntersectionOverUnion}) {
+    NonMaxSuppressionOptions options;
+    options.overlap_type = overlap_type;
+    options.min_suppression_threshold = 0.3f;
+    options.min_boxes_for_spatial_grid = 0;
+    const std::vector<int> with_grid =
+        NonMaxSuppression(boxes, scores, options);
+    std::vector<WeightedNonMaxSuppressionCluster> weighted_with_grid =
+        WeightedNonMaxSuppression(boxes, scores, options);
+
+    options.min_boxes_for_spatial_grid = -1;
+    EXPECT_EQ(with_grid, NonMaxSuppression(boxes, scores, options));
+    std::vector<WeightedNonMaxSuppressionCluster> weighted =
+        WeightedNonMaxSuppression(boxes, scores, options);
+    ASSERT_EQ(weighted_with_grid.size(), weighted.size());
+    for (int i = 0; i < weighted.size(); ++i) {
+      EXPECT_EQ(weighted_with_grid[i].index, weighted[i].index);
+      EXPECT_EQ(weighted_with_grid[i].members, weighted[i].members);
+    }
+  }
+}
+
+TEST(WeightedNonMaxSuppressionTest, ClustersOverlappingBoxes) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 0.4f, 0.4f);
+  boxes.Add(0.6f, 0.6f, 0.8f, 0.8f);
+  boxes.Add(0.05f, 0.0f, 0.45f, 0.4f);
+  NonMaxSuppressionOptions options;
+  options.min_suppression_threshold = 0.5f;
+
+  const std::vector<WeightedNonMaxSuppressionCluster> clusters =
+      WeightedNonMaxSuppression(boxes, {0.7f, 0.8f, 0.9f}, options);
+  ASSERT_EQ(clusters.size(), 2);
+  EXPECT_EQ(clusters[0].index, 2);
+  EXPECT_THAT(clusters[0].members, ElementsAre(2, 0));
+  EXPECT_EQ(clusters[1].index, 1);
+  EXPECT_THAT(clusters[1].members, ElementsAre(1));
+}
+
+TEST(WeightedNonMaxSuppressionTest, StopsAfterClusterWithoutMembers) {
+  PackedBoxes boxes;
+  boxes.Add(0.0f, 0.0f, 0.4f, 0.4f);
+  boxes.Add(0.6f, 0.6f, 0.8f, 0.8f);
+  NonMaxSuppressionOptions options;
+  // No box overlaps another, or itself, by more than 1.
+  options.min_suppression_threshold = 1.0f;
+
+  const std::vector<WeightedNonMaxSuppressionCluster> clusters =
+      WeightedNonMaxSuppression(boxes, {0.7f, 0.8f}, options);
+  ASSERT_EQ(clusters.size(), 1);
+  EXPECT_EQ(clusters[0].index, 1);
+  EXPECT_THAT(clusters[0].members, IsEmpty());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -35,6 +35,7 @@
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/tool/options_util.h"
 #include "mediapipe/util/tracking/box_tracker.h"
+#include "mediapipe/util/tracking/parallel_invoker_service.h"
 #include "mediapipe/util/tracking/tracking.h"
 #include "mediapipe/util/tracking/tracking_visualization_utilities.h"
 
@@ -469,6 +470,8 @@ absl::Status BoxTrackerCalculator::GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kOptionsTag).Set<CalculatorOptions>();
   }
 
+  cc->UseService(kParallelInvokerExecutorService).Optional();
+
   return absl::OkStatus();
 }
 
@@ -521,7 +524,15 @@ absl::Status BoxTrackerCalculator::Open(CalculatorContext* cc) {
   if (cc->InputSidePackets().HasTag(kCacheDirTag)) {
     cache_dir_ = cc->InputSidePackets().Tag(kCacheDirTag).Get<std::string>();
     RET_CHECK(!cache_dir_.empty());
-    box_tracker_.reset(new BoxTracker(cache_dir_, options_.tracker_options()));
+    // Tracking runs on the graph's ParallelInvokerExecutor instead of on
+    // threads owned by the BoxTracker.
+    ParallelInvokerExecutor* executor = nullptr;
+    auto executor_service = cc->Service(kParallelInvokerExecutorService);
+    if (executor_service.IsAvailable()) {
+      executor = &executor_service.GetObject();
+    }
+    box_tracker_.reset(
+        new BoxTracker(cache_dir_, options_.tracker_options(), executor));
   } else {
     // Check that all boxes have a unique id.
     RET_CHECK(initial_pos_.box_size() == batch_track_ids_.size())
@@ -16,15 +16,19 @@
 
 #include <fstream>
 #include <memory>
+#include <string>
 
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/video/flow_packager_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/util/tracking/camera_motion.pb.h"
 #include "mediapipe/util/tracking/flow_packager.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+#include "mediapipe/util/tracking/parallel_invoker_service.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 
 namespace mediapipe {
@@ -72,8 +76,11 @@ class FlowPackagerCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
   absl::Status Close(CalculatorContext* cc) override;
 
-  // Writes passed chunk to disk.
-  void WriteChunk(const TrackingDataChunk& chunk) const;
+  // Writes passed chunk to disk. The chunk is serialized and written on the
+  // graph's ParallelInvokerExecutor, if available; Close() waits for all
+  // writes to finish.
+  void WriteChunk(const TrackingDataChunk& chunk)
+      ABSL_LOCKS_EXCLUDED(writes_mutex_);
 
   // Initializes next chunk for tracking beginning from last frame of
   // current chunk (Chunking is design with one frame overlap).
@@ -93,8 +100,39 @@ class FlowPackagerCalculator : public CalculatorBase {
 
   Timestamp prev_timestamp_;
   std::unique_ptr<FlowPackager> flow_packager_;
+
+  // Runs chunk writes while the next chunk is being packaged.
+  ParallelInvokerExecutor* executor_ = nullptr;
+  absl::Mutex writes_mutex_;
+  int num_pending_writes_ ABSL_GUARDED_BY(writes_mutex_) = 0;
 };
 
+namespace {
+
+// Serializes "chunk" to "chunk_file" through a temporary file in "cache_dir".
+void WriteChunkFile(const TrackingDataChunk& chunk,
+                    const std::string& cache_dir,
+                    const std::string& chunk_file) {
+  std::string data;
+  chunk.SerializeToString(&data);
+
+  const char* temp_filename = tempnam(cache_dir.c_str(), nullptr);
+  std::ofstream out_file(temp_filename);
+  if (!out_file) {
+    LOG(ERROR) << "Could not open " << temp_filename;
+  } else {
+    out_file.write(data.data(), data.size());
+  }
+
+  if (rename(temp_filename, chunk_file.c_str()) != 0) {
+    LOG(ERROR) << "Failed to rename to " << chunk_file;
+  }
+
+  LOG(INFO) << "Wrote chunk : " << chunk_file;
+}
+
+}  // namespace
+
 REGISTER_CALCULATOR(FlowPackagerCalculator);
 
 absl::Status FlowPackagerCalculator::GetContract(CalculatorContract* cc) {
@@ -121,6 +159,8 @@ absl::Status FlowPackagerCalculator::GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kCacheDirTag).Set<std::string>();
   }
 
+  cc->UseService(kParallelInvokerExecutorService).Optional();
+
   return absl::OkStatus();
 }
 
@@ -133,6 +173,10 @@ absl::Status FlowPackagerCalculator::Open(CalculatorContext* cc) {
   build_chunk_ = use_caching_ || cc->Outputs().HasTag(kTrackingChunkTag);
   if (use_caching_) {
     cache_dir_ = cc->InputSidePackets().Tag(kCacheDirTag).Get<std::string>();
+    auto executor_service = cc->Service(kParallelInvokerExecutorService);
+    if (executor_service.IsAvailable()) {
+      executor_ = &executor_service.GetObject();
+    }
   }
 
   return absl::OkStatus();
@@ -218,6 +262,13 @@ absl::Status FlowPackagerCalculator::Close(CalculatorContext* cc) {
     }
   }
 
+  {
+    absl::MutexLock lock(&writes_mutex_);
+    writes_mutex_.Await(absl::Condition(
+        +[](int* num_pending_writes) { return *num_pending_writes == 0; },
+        &num_pending_writes_));
+  }
+
   if (cc->Outputs().HasTag(kCompleteTag)) {
     cc->Outputs().Tag(kCompleteTag).Add(new bool(true), Timestamp::PreStream());
   }
@@ -225,7 +276,7 @@ absl::Status FlowPackagerCalculator::Close(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
-void FlowPackagerCalculator::WriteChunk(const TrackingDataChunk& chunk) const {
+void FlowPackagerCalculator::WriteChunk(const TrackingDataChunk& chunk) {
   if (chunk.item_size() == 0) {
     LOG(ERROR) << "Write chunk called with empty tracking data."
                << "This can only occur if the spacing between frames "
@@ -246,22 +297,21 @@ void FlowPackagerCalculator::WriteChunk(const TrackingDataChunk& chunk) const {
     chunk_file = cache_dir_ + "/" + absl::StrFormat("chunk_%04d", chunk_idx_);
   }
 
-  std::string data;
-  chunk.SerializeToString(&data);
-
-  const char* temp_filename = tempnam(cache_dir_.c_str(), nullptr);
-  std::ofstream out_file(temp_filename);
-  if (!out_file) {
-    LOG(ERROR) << "Could not open " << temp_filename;
-  } else {
-    out_file.write(data.data(), data.size());
+  if (executor_ == nullptr) {
+    WriteChunkFile(chunk, cache_dir_, chunk_file);
+    return;
   }
 
-  if (rename(temp_filename, chunk_file.c_str()) != 0) {
-    LOG(ERROR) << "Failed to rename to " << chunk_file;
+  {
+    absl::MutexLock lock(&writes_mutex_);
+    ++num_pending_writes_;
   }
-
-  LOG(INFO) << "Wrote chunk : " << chunk_file;
+  auto chunk_copy = std::make_shared<TrackingDataChunk>(chunk);
+  executor_->executor()->Schedule([this, chunk_copy, chunk_file]() {
+    WriteChunkFile(*chunk_copy, cache_dir_, chunk_file);
+    absl::MutexLock lock(&writes_mutex_);
+    --num_pending_writes_;
+  });
 }
 
 void FlowPackagerCalculator::PrepareCurrentForNextChunk(
@@ -35,6 +35,8 @@
 #include "mediapipe/util/tracking/motion_analysis.h"
 #include "mediapipe/util/tracking/motion_estimation.h"
 #include "mediapipe/util/tracking/motion_models.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+#include "mediapipe/util/tracking/parallel_invoker_service.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 
 namespace mediapipe {
@@ -198,6 +200,9 @@ class MotionAnalysisCalculator : public CalculatorBase {
   std::unique_ptr<MotionAnalysis> motion_analysis_;
 
   std::unique_ptr<MixtureRowWeights> row_weights_;
+
+  // Runs the parallel loops of the motion analysis.
+  ParallelInvokerExecutor* executor_ = nullptr;
 };
 
 REGISTER_CALCULATOR(MotionAnalysisCalculator);
@@ -259,6 +264,8 @@ absl::Status MotionAnalysisCalculator::GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kOptionsTag).Set<CalculatorOptions>();
   }
 
+  cc->UseService(kParallelInvokerExecutorService).Optional();
+
   return absl::OkStatus();
 }
 
@@ -267,6 +274,11 @@ absl::Status MotionAnalysisCalculator::Open(CalculatorContext* cc) {
       tool::RetrieveOptions(cc->Options<MotionAnalysisCalculatorOptions>(),
                             cc->InputSidePackets(), kOptionsTag);
 
+  auto executor_service = cc->Service(kParallelInvokerExecutorService);
+  if (executor_service.IsAvailable()) {
+    executor_ = &executor_service.GetObject();
+  }
+
   video_input_ = cc->Inputs().HasTag(kVideoTag);
   selection_input_ = cc->Inputs().HasTag(kSelectionTag);
   region_flow_feature_output_ = cc->Outputs().HasTag(kFlowTag);
@@ -421,6 +433,7 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
   if (options_.bypass_mode()) {
     return absl::OkStatus();
   }
+  ScopedParallelInvokerExecutor scoped_executor(executor_);
 
   InputStream* video_stream =
       video_input_ ? &(cc->Inputs().Tag(kVideoTag)) : nullptr;
@@ -464,8 +477,11 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
 
   if (motion_analysis_ == nullptr) {
     // We do not need MotionAnalysis when using just metadata.
+    // With analysis_options().estimation_lookahead_clips(), motion
+    // estimation of a clip overlaps with region flow of the following ones.
     motion_analysis_.reset(new MotionAnalysis(options_.analysis_options(),
-                                              frame_width_, frame_height_));
+                                              frame_width_, frame_height_,
+                                              executor_));
   }
 
   std::unique_ptr<FrameSelectionResult> frame_selection_result;
@@ -597,6 +613,7 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
 }
 
 absl::Status MotionAnalysisCalculator::Close(CalculatorContext* cc) {
+  ScopedParallelInvokerExecutor scoped_executor(executor_);
   // Guard against empty videos.
   if (motion_analysis_) {
     OutputMotionAnalyzedFrames(true, cc);
@@ -14,10 +14,18 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/video/opencv_video_decoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
@@ -33,6 +41,11 @@ constexpr char kVideoPrestreamTag[] = "VIDEO_PRESTREAM";
 constexpr char kVideoTag[] = "VIDEO";
 constexpr char kInputFilePathTag[] = "INPUT_FILE_PATH";
 
+// Number of output frames that are expected to be held by downstream
+// calculators at any time, and are kept in the frame pool in addition to the
+// read-ahead frames.
+constexpr int kPooledFramesInGraph = 4;
+
 // cv::VideoCapture set data type to unsigned char by default. Therefore, the
 // image format is only related to the number of channles the cv::Mat has.
 ImageFormat::Format GetImageFormat(int num_channels) {
@@ -90,8 +103,31 @@ ImageFormat::Format GetImageFormat(int num_channels) {
 //   output_stream: "VIDEO_PRESTREAM:video_header"
 // }
 //
+// Output frames are converted from BGR into pooled buffers, which are reused
+// once downstream calculators release them. With read_ahead_frames set in
+// OpenCvVideoDecoderCalculatorOptions, a background thread decodes frames
+// ahead of the graph, so that decoding overlaps with downstream processing.
+// For batch analytics, frame_stride and skip_mode select which frames are
+// decoded and output.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvVideoDecoderCalculator"
+//   input_side_packet: "INPUT_FILE_PATH:input_file_path"
+//   output_stream: "VIDEO:video_frames"
+//   options {
+//     [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] {
+//       read_ahead_frames: 4
+//       frame_stride: 30
+//       skip_mode: SKIP_SEEK
+//     }
+//   }
+// }
+//
 class OpenCvVideoDecoderCalculator : public CalculatorBase {
  public:
+  ~OpenCvVideoDecoderCalculator() override { StopReadAhead(); }
+
   static absl::Status GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kInputFilePathTag).Set<std::string>();
     cc->Outputs().Tag(kVideoTag).Set<ImageFrame>();
@@ -105,6 +141,13 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<OpenCvVideoDecoderCalculatorOptions>();
+    RET_CHECK_GE(options.read_ahead_frames(), 0);
+    RET_CHECK_GE(options.frame_stride(), 1);
+    read_ahead_frames_ = options.read_ahead_frames();
+    frame_stride_ = options.frame_stride();
+    skip_mode_ = options.skip_mode();
+
     const std::string& input_file_path =
         cc->InputSidePackets().Tag(kInputFilePathTag).Get<std::string>();
     cap_ = absl::make_unique<cv::VideoCapture>(input_file_path);
@@ -183,39 +226,30 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
                 "config.";
 #endif
     }
+
+    // Output frames keep the packed rows the decoder has always produced.
+    frame_pool_ = ImageFramePool::Create(
+        width_, height_, format_, read_ahead_frames_ + kPooledFramesInGraph,
+        /*alignment_boundary=*/1);
+    if (read_ahead_frames_ > 0) {
+      read_ahead_thread_ =
+          absl::make_unique<std::thread>([this] { ReadAhead(); });
+    }
     return absl::OkStatus();
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto image_frame = absl::make_unique<ImageFrame>(format_, width_, height_,
-                                                     /*alignment_boundary=*/1);
-    // Use microsecond as the unit of time.
-    Timestamp timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
-    if (format_ == ImageFormat::GRAY8) {
-      cv::Mat frame = formats::MatView(image_frame.get());
-      ReadFrame(frame);
-      if (frame.empty()) {
-        return tool::StatusStop();
-      }
-    } else {
-      cv::Mat tmp_frame;
-      ReadFrame(tmp_frame);
-      if (tmp_frame.empty()) {
-        return tool::StatusStop();
-      }
-      if (format_ == ImageFormat::SRGB) {
-        cv::cvtColor(tmp_frame, formats::MatView(image_frame.get()),
-                     cv::COLOR_BGR2RGB);
-      } else if (format_ == ImageFormat::SRGBA) {
-        cv::cvtColor(tmp_frame, formats::MatView(image_frame.get()),
-                     cv::COLOR_BGRA2RGBA);
-      }
+    DecodedFrame decoded =
+        read_ahead_thread_ ? PopReadAheadFrame() : DecodeFrame();
+    if (!decoded.image_frame) {
+      return tool::StatusStop();
     }
     // If the timestamp of the current frame is not greater than the one of the
     // previous frame, the new frame will be discarded.
-    if (prev_timestamp_ < timestamp) {
-      cc->Outputs().Tag(kVideoTag).Add(image_frame.release(), timestamp);
-      prev_timestamp_ = timestamp;
+    if (prev_timestamp_ < decoded.timestamp) {
+      cc->Outputs().Tag(kVideoTag).Add(decoded.image_frame.release(),
+                                       decoded.timestamp);
+      prev_timestamp_ = decoded.timestamp;
       decoded_frames_++;
     }
 
@@ -223,13 +257,16 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Close(CalculatorContext* cc) override {
+    StopReadAhead();
     if (cap_ && cap_->isOpened()) {
       cap_->release();
     }
-    if (decoded_frames_ != frame_count_) {
-      LOG(WARNING) << "Not all the frames are decoded (total frames: "
-                   << frame_count_ << " vs decoded frames: " << decoded_frames_
-                   << ").";
+    const int expected_frames =
+        (frame_count_ + frame_stride_ - 1) / frame_stride_;
+    if (decoded_frames_ != expected_frames) {
+      LOG(WARNING) << "Not all the frames are decoded (expected frames: "
+                   << expected_frames << " vs decoded frames: "
+                   << decoded_frames_ << ").";
     }
     return absl::OkStatus();
   }
@@ -243,6 +280,115 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
  private:
+  // A decoded frame, or the end of the video if image_frame is null.
+  struct DecodedFrame {
+    std::unique_ptr<ImageFrame> image_frame;
+    Timestamp timestamp;
+  };
+
+  // Decodes the next frame to output into a pooled buffer, skipping frames
+  // according to frame_stride_.
+  DecodedFrame DecodeFrame() {
+    DecodedFrame decoded;
+    if (next_frame_index_ > 0 && frame_stride_ > 1) {
+      if (skip_mode_ == OpenCvVideoDecoderCalculatorOptions::SKIP_SEEK) {
+        cap_->set(cv::CAP_PROP_POS_FRAMES, next_frame_index_);
+      } else {
+        for (int i = 1; i < frame_stride_; ++i) {
+          if (!cap_->grab()) {
+            return decoded;
+          }
+        }
+      }
+    }
+    next_frame_index_ += frame_stride_;
+
+    ImageFrameSharedPtr buffer = frame_pool_->GetBuffer();
+    // Use microsecond as the unit of time.
+    decoded.timestamp = Timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
+    if (format_ == ImageFormat::GRAY8) {
+      cv::Mat frame = formats::MatView(buffer.get());
+      ReadFrame(frame);
+      if (frame.empty()) {
+        return decoded;
+      }
+    } else {
+      // bgr_frame_ keeps its allocation across frames.
+      ReadFrame(bgr_frame_);
+      if (bgr_frame_.empty()) {
+        return decoded;
+      }
+      if (format_ == ImageFormat::SRGB) {
+        cv::cvtColor(bgr_frame_, formats::MatView(buffer.get()),
+                     cv::COLOR_BGR2RGB);
+      } else if (format_ == ImageFormat::SRGBA) {
+        cv::cvtColor(bgr_frame_, formats::MatView(buffer.get()),
+                     cv::COLOR_BGRA2RGBA);
+      }
+    }
+    // The output frame shares the pixels of the pooled buffer, which returns
+    // to the pool when the output frame is destroyed.
+    decoded.image_frame = absl::make_unique<ImageFrame>(
+        format_, width_, height_, buffer->WidthStep(),
+        buffer->MutablePixelData(),
+        [buffer](uint8*) mutable { buffer.reset(); });
+    return decoded;
+  }
+
+  // Runs on read_ahead_thread_ until the end of the video, or until
+  // StopReadAhead is called.
+  void ReadAhead() {
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(
+            this, &OpenCvVideoDecoderCalculator::CanReadAhead));
+        if (stop_read_ahead_) {
+          return;
+        }
+      }
+      DecodedFrame decoded = DecodeFrame();
+      const bool end_of_video = !decoded.image_frame;
+      {
+        absl::MutexLock lock(&mutex_);
+        read_ahead_queue_.push_back(std::move(decoded));
+      }
+      if (end_of_video) {
+        return;
+      }
+    }
+  }
+
+  bool CanReadAhead() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stop_read_ahead_ ||
+           static_cast<int>(read_ahead_queue_.size()) < read_ahead_frames_;
+  }
+
+  bool HasReadAheadFrame() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !read_ahead_queue_.empty();
+  }
+
+  DecodedFrame PopReadAheadFrame() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        this, &OpenCvVideoDecoderCalculator::HasReadAheadFrame));
+    DecodedFrame decoded = std::move(read_ahead_queue_.front());
+    read_ahead_queue_.pop_front();
+    return decoded;
+  }
+
+  void StopReadAhead() {
+    if (!read_ahead_thread_) {
+      return;
+    }
+    {
+      absl::MutexLock lock(&mutex_);
+      stop_read_ahead_ = true;
+    }
+    read_ahead_thread_->join();
+    read_ahead_thread_.reset();
+  }
+
   std::unique_ptr<cv::VideoCapture> cap_;
   int width_;
   int height_;
@@ -250,6 +396,20 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   int decoded_frames_ = 0;
   ImageFormat::Format format_;
   Timestamp prev_timestamp_ = Timestamp::Unset();
+
+  int read_ahead_frames_ = 0;
+  int frame_stride_ = 1;
+  OpenCvVideoDecoderCalculatorOptions::SkipMode skip_mode_ =
+      OpenCvVideoDecoderCalculatorOptions::SKIP_GRAB;
+  // Index of the next frame to output in the video.
+  int next_frame_index_ = 0;
+  cv::Mat bgr_frame_;
+  std::shared_ptr<ImageFramePool> frame_pool_;
+
+  absl::Mutex mutex_;
+  std::deque<DecodedFrame> read_ahead_queue_ ABSL_GUARDED_BY(mutex_);
+  bool stop_read_ahead_ ABSL_GUARDED_BY(mutex_) = false;
+  std::unique_ptr<std::thread> read_ahead_thread_;
 };
 
 REGISTER_CALCULATOR(OpenCvVideoDecoderCalculator);
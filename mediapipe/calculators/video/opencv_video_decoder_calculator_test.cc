@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+#include <vector>
+
+#include "mediapipe/calculators/video/opencv_video_decoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -168,5 +172,45 @@ TEST(OpenCvVideoDecoderCalculatorTest, TestMkvVp8Video) {
   }
 }
 
+TEST(OpenCvVideoDecoderCalculatorTest, ReadAheadWithFrameStride) {
+  const std::string video_path = file::JoinPath(
+      GetTestDataDir(kTestPackageRoot), "format_FLV_H264_AAC.video");
+  CalculatorRunner all_frames_runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "OpenCvVideoDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "VIDEO:video")pb"));
+  all_frames_runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(video_path);
+  MP_ASSERT_OK(all_frames_runner.Run());
+  const std::vector<Packet>& all_frames =
+      all_frames_runner.Outputs().Tag(kVideoTag).packets;
+  ASSERT_EQ(180, all_frames.size());
+
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "OpenCvVideoDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "VIDEO:video"
+        options {
+          [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] {
+            read_ahead_frames: 4
+            frame_stride: 3
+          }
+        })pb"));
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(video_path);
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& frames = runner.Outputs().Tag(kVideoTag).packets;
+  ASSERT_EQ(60, frames.size());
+  for (int i = 0; i < frames.size(); ++i) {
+    const Packet& expected = all_frames[3 * i];
+    EXPECT_EQ(expected.Timestamp(), frames[i].Timestamp());
+    const cv::Mat expected_mat = formats::MatView(&expected.Get<ImageFrame>());
+    const cv::Mat output_mat = formats::MatView(&frames[i].Get<ImageFrame>());
+    EXPECT_EQ(0, cv::norm(expected_mat, output_mat, cv::NORM_INF));
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -238,6 +238,8 @@ class Packet : public Packet<internal::Generic> {
   friend PacketBase;
   template <typename U, typename... Args>
   friend Packet<U> MakePacket(Args&&... args);
+  template <typename U, typename... Args>
+  friend Packet<U> MakePacketPooled(Args&&... args);
   template <typename U>
   friend Packet<U> PacketAdopting(const U* ptr);
   template <typename U>
@@ -454,6 +456,15 @@ Packet<T> MakePacket(Args&&... args) {
       new T(std::forward<Args>(args)...)));
 }
 
+// Like MakePacket, but allocates from a slab pool. See
+// mediapipe::MakePacketPooled.
+template <typename T, typename... Args>
+Packet<T> MakePacketPooled(Args&&... args) {
+  return Packet<T>(std::allocate_shared<packet_internal::PooledHolder<T>>(
+      SlabPoolAllocator<packet_internal::PooledHolder<T>>(),
+      std::forward<Args>(args)...));
+}
+
 template <typename T>
 Packet<T> PacketAdopting(const T* ptr) {
   return Packet<T>(std::make_shared<packet_internal::Holder<T>>(ptr));
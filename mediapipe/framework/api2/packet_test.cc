@@ -141,6 +141,21 @@ TEST(PacketTest, PacketRefCount) {
   EXPECT_FALSE(alive);
 }
 
+TEST(PacketTest, PooledPacketRefCount) {
+  bool alive = false;
+  Packet<LiveCheck> p = MakePacketPooled<LiveCheck>(&alive);
+  EXPECT_TRUE(alive);
+  auto p2 = p;
+  p = {};
+  EXPECT_TRUE(alive);
+  mediapipe::Packet old_packet = ToOldPacket(p2);
+  p2 = {};
+  EXPECT_TRUE(alive);
+  MP_EXPECT_OK(old_packet.ValidateAsType<LiveCheck>());
+  old_packet = {};
+  EXPECT_FALSE(alive);
+}
+
 TEST(PacketTest, PacketTimestamp) {
   auto p = MakePacket<int>(5);
   EXPECT_EQ(p.timestamp(), Timestamp::Unset());
@@ -180,6 +180,15 @@ absl::Status CalculatorGraph::InitializeStreams() {
     const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
     MP_RETURN_IF_ERROR(input_stream_managers_[index].Initialize(
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
+    // A stream fed by a calculator is only written by the output stream
+    // handler of that calculator, which serializes its writes, and is only
+    // read by its own node. Graph input streams may be written by any
+    // application thread, so they keep the lock.
+    if (edge_info.upstream >= 0 &&
+        validated_graph_->OutputStreamInfos()[edge_info.upstream]
+                .parent_node.type == NodeTypeInfo::NodeType::CALCULATOR) {
+      input_stream_managers_[index].EnableSingleProducer();
+    }
   }
 
   // Create and initialize the output streams.
@@ -817,6 +826,12 @@ absl::Status CalculatorGraph::PrepareForRun(
     (*stream)->SetMaxQueueSize(name_max.second);
   }
 
+  // Calculator-fed streams are accessed without a lock once nodes run, so
+  // their packet rings keep the size set above for the rest of the run.
+  for (int i = 0; i < validated_graph_->InputStreamInfos().size(); ++i) {
+    input_stream_managers_[i].FreezeQueueCapacity();
+  }
+
   for (auto& node : nodes_) {
     if (node->IsSource()) {
       scheduler_.AddUnopenedSourceNode(node.get());
@@ -1058,6 +1073,27 @@ void CalculatorGraph::RecordError(const absl::Status& error) {
                     "of memory.";
     }
   }
+  // Invoked without holding error_mutex_, so that the callback can call
+  // GetCombinedErrors().
+  if (error_callback_) {
+    error_callback_(error);
+  }
+}
+
+absl::Status CalculatorGraph::SetErrorCallback(
+    std::function<void(const absl::Status&)> error_callback) {
+  RET_CHECK(!initialized_)
+      << "SetErrorCallback can only be called before Initialize()";
+  error_callback_ = std::move(error_callback);
+  return absl::OkStatus();
+}
+
+absl::Status CalculatorGraph::SetIdleCallback(
+    std::function<void(bool idle)> idle_callback) {
+  RET_CHECK(!initialized_)
+      << "SetIdleCallback can only be called before Initialize()";
+  scheduler_.SetIdleCallback(std::move(idle_callback));
+  return absl::OkStatus();
 }
 
 bool CalculatorGraph::GetCombinedErrors(absl::Status* error_status) {
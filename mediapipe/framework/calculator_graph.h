@@ -245,6 +245,22 @@ class CalculatorGraph {
   // Quick non-locking means of checking if the graph has encountered an error.
   bool HasError() const { return has_error_; }
 
+  // Sets a callback that is invoked with each error encountered while running
+  // the graph, on the thread that encountered it. This allows a client that
+  // waits for outputs to be notified that they will not arrive, without
+  // polling HasError() or waiting until the graph is idle. Must be called
+  // before the graph is initialized.
+  absl::Status SetErrorCallback(
+      std::function<void(const absl::Status&)> error_callback);
+
+  // Sets a callback that is invoked with false when the running graph starts
+  // running calculators, and with true when it becomes idle, as defined by
+  // WaitUntilIdle(). This allows a client that waits for outputs to learn that
+  // they will not arrive, without blocking in WaitUntilIdle(). The callback is
+  // invoked with the scheduler locked, so it must not call into the graph.
+  // Must be called before the graph is initialized.
+  absl::Status SetIdleCallback(std::function<void(bool idle)> idle_callback);
+
   // Add a Packet to a graph input stream based on the graph input stream add
   // mode. If the mode is ADD_IF_NOT_FULL, the packet will not be added if any
   // queue exceeds max_queue_size specified by the graph config and will return
@@ -696,6 +712,9 @@ class CalculatorGraph {
   // Mutex for the vector of errors.
   absl::Mutex error_mutex_;
 
+  // Invoked by RecordError(), if set.
+  std::function<void(const absl::Status&)> error_callback_;
+
   // Status variable to indicate if the graph has encountered an error.
   std::atomic<bool> has_error_;
 
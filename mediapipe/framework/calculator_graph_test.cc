@@ -32,6 +32,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -1573,6 +1574,19 @@ TEST(CalculatorGraph, RunsCorrectlyWithMultipleExecutors) {
   RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
 }
 
+TEST(CalculatorGraph, RunsCorrectlyWithWorkStealingExecutor) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig proto = GetConfig();
+  ExecutorConfig* executor = proto.add_executor();
+  executor->set_type("ThreadPoolExecutor");
+  ThreadPoolExecutorOptions* extension =
+      executor->mutable_options()->MutableExtension(
+          ThreadPoolExecutorOptions::ext);
+  extension->set_num_threads(4);
+  extension->set_queue_type(ThreadPoolExecutorOptions::WORK_STEALING);
+  RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
+}
+
 // Packet generator for an arbitrary unit64 packet.
 class Uint64PacketGenerator : public PacketGenerator {
  public:
@@ -2060,6 +2074,64 @@ TEST(CalculatorGraph, HandlersRun) {
                    input_side_packets.at("unavailable_input_counter2")));
 }
 
+// Test that the error callback is invoked with the error of a failing node.
+TEST(CalculatorGraph, ErrorCallback) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node { calculator: "FailingSourceCalculator" output_stream: "output" }
+      )pb");
+  CalculatorGraph graph;
+  std::vector<absl::Status> errors;
+  MP_ASSERT_OK(graph.SetErrorCallback(
+      [&errors](const absl::Status& error) { errors.push_back(error); }));
+  MP_ASSERT_OK(graph.Initialize(config));
+  EXPECT_FALSE(graph.SetErrorCallback(nullptr).ok());
+  EXPECT_THAT(graph.Run().message(), testing::HasSubstr("this always fails."));
+  ASSERT_FALSE(errors.empty());
+  EXPECT_THAT(errors[0].message(), testing::HasSubstr("this always fails."));
+}
+
+TEST(CalculatorGraph, IdleCallback) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        }
+      )pb");
+  CalculatorGraph graph;
+  absl::Mutex mutex;
+  std::vector<bool> idle_states;
+  MP_ASSERT_OK(graph.SetIdleCallback([&mutex, &idle_states](bool idle) {
+    absl::MutexLock lock(&mutex);
+    idle_states.push_back(idle);
+  }));
+  MP_ASSERT_OK(graph.Initialize(config));
+  EXPECT_FALSE(graph.SetIdleCallback(nullptr).ok());
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  {
+    absl::MutexLock lock(&mutex);
+    ASSERT_FALSE(idle_states.empty());
+    EXPECT_TRUE(idle_states.back());
+    idle_states.clear();
+  }
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(1))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  {
+    absl::MutexLock lock(&mutex);
+    // The graph became busy running PassThroughCalculator, then idle again.
+    ASSERT_GE(idle_states.size(), 2);
+    EXPECT_FALSE(idle_states.front());
+    EXPECT_TRUE(idle_states.back());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 TEST(CalculatorGraph, CalculatorGraphConfigCopyElision) {
   CalculatorGraph graph;
   CalculatorGraphConfig config =
@@ -0,0 +1,181 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_CONCURRENT_PRIORITY_QUEUE_H_
+#define MEDIAPIPE_FRAMEWORK_CONCURRENT_PRIORITY_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+namespace internal {
+
+// Priority of an element of a ConcurrentPriorityQueue, compared
+// lexicographically. Larger keys are popped first. The all-zero key is
+// reserved to mean "no element".
+struct PriorityKey {
+  uint64_t high = 0;
+  uint64_t mid = 0;
+  uint64_t low = 0;
+
+  bool operator<(const PriorityKey& that) const {
+    return std::tie(high, mid, low) < std::tie(that.high, that.mid, that.low);
+  }
+  bool IsEmpty() const { return high == 0 && mid == 0 && low == 0; }
+};
+
+// A priority queue that supports concurrent Push and TryPop calls.
+//
+// Elements are spread over a fixed number of shards, each a small
+// std::priority_queue behind its own mutex, selected by a caller-provided
+// shard hint. Every shard publishes the key of its top element through a
+// seqlock, so TryPop finds the best shard without taking any lock and then
+// locks only that shard. Pushes and pops on different shards never contend.
+//
+// When no calls overlap, TryPop returns an element with the largest key, like
+// std::priority_queue. With overlapping calls, TryPop returns an element whose
+// key is at least as large as that of every element present for the whole
+// duration of the call.
+//
+// T must provide "PriorityKey Priority() const" returning a non-empty key.
+template <typename T>
+class ConcurrentPriorityQueue {
+ public:
+  explicit ConcurrentPriorityQueue(int num_shards = 16)
+      : shards_(num_shards) {}
+  ConcurrentPriorityQueue(const ConcurrentPriorityQueue&) = delete;
+  ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue&) = delete;
+
+  // Adds an element. Elements with the same "shard_hint" share a shard.
+  void Push(T value, uint64_t shard_hint) {
+    Shard& shard = shards_[shard_hint % shards_.size()];
+    const PriorityKey key = value.Priority();
+    {
+      absl::MutexLock lock(&shard.mutex);
+      shard.queue.push(Entry{key, std::move(value)});
+      shard.PublishTop();
+    }
+    size_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  // Removes and returns an element with the largest key, or returns
+  // std::nullopt if the queue is empty.
+  std::optional<T> TryPop() {
+    while (true) {
+      int best = -1;
+      PriorityKey best_key;
+      for (int i = 0; i < shards_.size(); ++i) {
+        const PriorityKey key = shards_[i].ReadTop();
+        if (!key.IsEmpty() && (best < 0 || best_key < key)) {
+          best = i;
+          best_key = key;
+        }
+      }
+      if (best < 0) {
+        // An element whose Push has returned is always visible to the scan,
+        // so an empty scan with a positive size means a concurrent TryPop has
+        // removed an element without decrementing size_ yet.
+        if (size_.load(std::memory_order_seq_cst) <= 0) return std::nullopt;
+        continue;
+      }
+      Shard& shard = shards_[best];
+      absl::MutexLock lock(&shard.mutex);
+      // Another TryPop may have taken the element seen by the scan. Only
+      // pop if the top is still at least as good, otherwise rescan.
+      if (shard.queue.empty() || shard.queue.top().key < best_key) continue;
+      // std::priority_queue::top() is const; the element is popped right
+      // after, so moving from it is safe.
+      std::optional<T> value(
+          std::move(const_cast<Entry&>(shard.queue.top()).value));
+      shard.queue.pop();
+      shard.PublishTop();
+      size_.fetch_sub(1, std::memory_order_seq_cst);
+      return value;
+    }
+  }
+
+  // Returns the number of elements. Only exact when no calls overlap.
+  int64_t Size() const { return size_.load(std::memory_order_seq_cst); }
+
+  bool Empty() const { return Size() <= 0; }
+
+  // Removes all elements. Must not overlap with other calls.
+  void Clear() {
+    for (Shard& shard : shards_) {
+      absl::MutexLock lock(&shard.mutex);
+      while (!shard.queue.empty()) shard.queue.pop();
+      shard.PublishTop();
+    }
+    size_.store(0, std::memory_order_seq_cst);
+  }
+
+ private:
+  struct Entry {
+    PriorityKey key;
+    T value;
+    bool operator<(const Entry& that) const { return key < that.key; }
+  };
+
+  // Aligned to avoid false sharing between shards.
+  struct alignas(64) Shard {
+    absl::Mutex mutex;
+    std::priority_queue<Entry> queue ABSL_GUARDED_BY(mutex);
+
+    // Seqlock-protected copy of the key of queue.top(); odd while updating.
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> top_high{0};
+    std::atomic<uint64_t> top_mid{0};
+    std::atomic<uint64_t> top_low{0};
+
+    void PublishTop() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      const PriorityKey key = queue.empty() ? PriorityKey() : queue.top().key;
+      const uint32_t s = sequence.load(std::memory_order_relaxed);
+      sequence.store(s + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      top_high.store(key.high, std::memory_order_relaxed);
+      top_mid.store(key.mid, std::memory_order_relaxed);
+      top_low.store(key.low, std::memory_order_relaxed);
+      sequence.store(s + 2, std::memory_order_release);
+    }
+
+    PriorityKey ReadTop() const {
+      PriorityKey key;
+      while (true) {
+        const uint32_t s1 = sequence.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        key.high = top_high.load(std::memory_order_relaxed);
+        key.mid = top_mid.load(std::memory_order_relaxed);
+        key.low = top_low.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == s1) return key;
+      }
+    }
+  };
+
+  std::vector<Shard> shards_;
+  std::atomic<int64_t> size_{0};
+};
+
+}  // namespace internal
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_CONCURRENT_PRIORITY_QUEUE_H_
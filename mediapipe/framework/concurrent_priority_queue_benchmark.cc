@@ -0,0 +1,108 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares the ready queue of SchedulerQueue, a ConcurrentPriorityQueue, with
+// the std::priority_queue behind a single mutex that it replaced. Every thread
+// pushes a batch of items, as a scheduler queue does when a node's outputs make
+// its successors ready, and then pops as many, as executor threads do.
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/concurrent_priority_queue.h"
+
+namespace mediapipe {
+namespace internal {
+namespace {
+
+constexpr int kBatchSize = 8;
+
+struct Item {
+  PriorityKey key;
+  PriorityKey Priority() const { return key; }
+};
+
+// The queue before ConcurrentPriorityQueue.
+class LockedPriorityQueue {
+ public:
+  void Push(Item item, uint64_t shard_hint) {
+    absl::MutexLock lock(&mutex_);
+    queue_.push(item);
+  }
+
+  std::optional<Item> TryPop() {
+    absl::MutexLock lock(&mutex_);
+    if (queue_.empty()) return std::nullopt;
+    Item item = queue_.top();
+    queue_.pop();
+    return item;
+  }
+
+ private:
+  struct Compare {
+    bool operator()(const Item& a, const Item& b) const {
+      return a.key < b.key;
+    }
+  };
+
+  absl::Mutex mutex_;
+  std::priority_queue<Item, std::vector<Item>, Compare> queue_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+template <typename Queue>
+void BM_PushPop(benchmark::State& state) {
+  static Queue* queue = nullptr;
+  if (state.thread_index() == 0) {
+    queue = new Queue();
+  }
+  // Like node ids, the shard hints of different threads differ.
+  const uint64_t shard_hint = state.thread_index();
+  uint64_t sequence = 0;
+  int64_t num_popped = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kBatchSize; ++i, ++sequence) {
+      // Keys mix a few layer priorities with decreasing timestamps.
+      queue->Push(Item{PriorityKey{1, sequence % 4, ~sequence}}, shard_hint);
+    }
+    for (int i = 0; i < kBatchSize; ++i) {
+      // A pop may find the queue empty if other threads took the items.
+      num_popped += queue->TryPop().has_value();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+  state.counters["popped"] =
+      benchmark::Counter(num_popped, benchmark::Counter::kAvgIterations);
+  if (state.thread_index() == 0) {
+    delete queue;
+    queue = nullptr;
+  }
+}
+BENCHMARK_TEMPLATE(BM_PushPop, LockedPriorityQueue)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, ConcurrentPriorityQueue<Item>)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace internal
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/concurrent_priority_queue.h"
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace internal {
+namespace {
+
+struct TestItem {
+  int priority;
+  PriorityKey Priority() const {
+    return PriorityKey{1, static_cast<uint64_t>(priority), 0};
+  }
+};
+
+TEST(ConcurrentPriorityQueueTest, PopsInPriorityOrder) {
+  ConcurrentPriorityQueue<TestItem> queue(4);
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.TryPop().has_value());
+  const std::vector<int> priorities = {5, 1, 9, 3, 7, 2, 8};
+  for (int i = 0; i < priorities.size(); ++i) {
+    queue.Push(TestItem{priorities[i]}, /*shard_hint=*/i);
+  }
+  EXPECT_EQ(priorities.size(), queue.Size());
+  std::vector<int> popped;
+  while (std::optional<TestItem> item = queue.TryPop()) {
+    popped.push_back(item->priority);
+  }
+  EXPECT_THAT(popped, testing::ElementsAre(9, 8, 7, 5, 3, 2, 1));
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(ConcurrentPriorityQueueTest, Clear) {
+  ConcurrentPriorityQueue<TestItem> queue(2);
+  queue.Push(TestItem{1}, 0);
+  queue.Push(TestItem{2}, 1);
+  queue.Clear();
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.TryPop().has_value());
+}
+
+TEST(ConcurrentPriorityQueueTest, ConcurrentPushAndPop) {
+  constexpr int kNumThreads = 8;
+  constexpr int kItemsPerThread = 10000;
+  ConcurrentPriorityQueue<TestItem> queue;
+  std::atomic<int> num_popped(0);
+  std::atomic<int64_t> sum_popped(0);
+  {
+    ThreadPool pool("test", kNumThreads);
+    pool.StartWorkers();
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&queue, &num_popped, &sum_popped, t] {
+        for (int i = 0; i < kItemsPerThread; ++i) {
+          queue.Push(TestItem{i}, t);
+          // Every pop is preceded by a push, so it must find an element.
+          std::optional<TestItem> item = queue.TryPop();
+          EXPECT_TRUE(item.has_value());
+          if (!item.has_value()) return;
+          num_popped.fetch_add(1);
+          sum_popped.fetch_add(item->priority);
+        }
+      });
+    }
+  }
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(kNumThreads * kItemsPerThread, num_popped.load());
+  EXPECT_EQ(int64_t{kNumThreads} * kItemsPerThread * (kItemsPerThread - 1) / 2,
+            sum_popped.load());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace mediapipe
@@ -0,0 +1,124 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/slab_pool.h"
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+constexpr int SlabPoolThreadCache::kBatchSize;
+constexpr int SlabPoolThreadCache::kCapacity;
+
+namespace {
+
+// Target size of a slab. Large blocks still get a few blocks per slab.
+constexpr size_t kSlabBytes = 16 * 1024;
+constexpr int kMinBlocksPerSlab = 4;
+
+size_t RoundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+SlabPool::SlabPool(size_t block_size, size_t alignment)
+    : block_size_(RoundUp(std::max(block_size, sizeof(FreeBlock)),
+                          std::max(alignment, alignof(FreeBlock)))),
+      alignment_(std::max(alignment, alignof(FreeBlock))),
+      blocks_per_slab_(std::max<int>(kMinBlocksPerSlab,
+                                     kSlabBytes / block_size_)) {
+  CHECK_EQ(alignment_ & (alignment_ - 1), 0)
+      << "alignment must be a power of two";
+}
+
+SlabPool::~SlabPool() {
+  absl::MutexLock lock(&mutex_);
+  CHECK_EQ(num_blocks_in_use_, 0) << "SlabPool destroyed with blocks in use";
+  for (void* slab : slabs_) {
+    ::operator delete(slab, std::align_val_t(alignment_));
+  }
+}
+
+void* SlabPool::Allocate() {
+  absl::MutexLock lock(&mutex_);
+  if (free_list_ == nullptr) {
+    AddSlab();
+  }
+  FreeBlock* block = free_list_;
+  free_list_ = block->next;
+  ++num_blocks_in_use_;
+  return block;
+}
+
+void SlabPool::Deallocate(void* block) {
+  absl::MutexLock lock(&mutex_);
+  auto* free_block = static_cast<FreeBlock*>(block);
+  free_block->next = free_list_;
+  free_list_ = free_block;
+  --num_blocks_in_use_;
+}
+
+void SlabPool::AllocateBatch(void** blocks, int n) {
+  absl::MutexLock lock(&mutex_);
+  for (int i = 0; i < n; ++i) {
+    if (free_list_ == nullptr) {
+      AddSlab();
+    }
+    blocks[i] = free_list_;
+    free_list_ = free_list_->next;
+  }
+  num_blocks_in_use_ += n;
+}
+
+void SlabPool::DeallocateBatch(void* const* blocks, int n) {
+  absl::MutexLock lock(&mutex_);
+  for (int i = 0; i < n; ++i) {
+    auto* free_block = static_cast<FreeBlock*>(blocks[i]);
+    free_block->next = free_list_;
+    free_list_ = free_block;
+  }
+  num_blocks_in_use_ -= n;
+}
+
+int64_t SlabPool::NumSlabs() const {
+  absl::MutexLock lock(&mutex_);
+  return slabs_.size();
+}
+
+int64_t SlabPool::NumBlocksInUse() const {
+  absl::MutexLock lock(&mutex_);
+  return num_blocks_in_use_;
+}
+
+void SlabPool::AddSlab() {
+  char* slab = static_cast<char*>(::operator new(
+      block_size_ * blocks_per_slab_, std::align_val_t(alignment_)));
+  slabs_.push_back(slab);
+  // Pushes the blocks in reverse so that they are handed out in address
+  // order.
+  for (int i = blocks_per_slab_ - 1; i >= 0; --i) {
+    auto* block = reinterpret_cast<FreeBlock*>(slab + i * block_size_);
+    block->next = free_list_;
+    free_list_ = block;
+  }
+}
+
+SlabPoolThreadCache::~SlabPoolThreadCache() {
+  pool_->DeallocateBatch(blocks_, size_);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,176 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_SLAB_POOL_H_
+#define MEDIAPIPE_DEPS_SLAB_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+
+namespace mediapipe {
+
+// A thread-safe pool of fixed-size memory blocks.
+//
+// Blocks are carved out of larger slabs obtained from the system allocator,
+// and freed blocks are kept on a free list for reuse. Slabs are only returned
+// to the system when the pool is destroyed, so steady-state allocation does
+// not call malloc or free at all.
+class SlabPool {
+ public:
+  // Creates a pool of blocks of at least "block_size" bytes, aligned to
+  // "alignment", which must be a power of two.
+  SlabPool(size_t block_size, size_t alignment);
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  // REQUIRES: every block has been returned to the pool.
+  ~SlabPool();
+
+  // Returns an uninitialized block.
+  void* Allocate() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns a block obtained from Allocate() to the pool.
+  void Deallocate(void* block) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Like Allocate() and Deallocate(), for "n" blocks at once under a single
+  // lock acquisition.
+  void AllocateBatch(void** blocks, int n) ABSL_LOCKS_EXCLUDED(mutex_);
+  void DeallocateBatch(void* const* blocks, int n) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of slabs obtained from the system allocator.
+  int64_t NumSlabs() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of blocks currently handed out, including blocks held
+  // by a SlabPoolThreadCache.
+  int64_t NumBlocksInUse() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  size_t block_size() const { return block_size_; }
+  int blocks_per_slab() const { return blocks_per_slab_; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Allocates a new slab and pushes its blocks onto the free list.
+  void AddSlab() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t block_size_;
+  const size_t alignment_;
+  const int blocks_per_slab_;
+
+  mutable absl::Mutex mutex_;
+  FreeBlock* free_list_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::vector<void*> slabs_ ABSL_GUARDED_BY(mutex_);
+  int64_t num_blocks_in_use_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// A per-thread front end to a SlabPool. Keeps a small stack of free blocks
+// and exchanges them with the pool in batches, so that most allocations and
+// deallocations do not take the pool lock. Blocks may be freed by a different
+// thread than the one that allocated them. Returns its blocks to the pool
+// when destroyed.
+class SlabPoolThreadCache {
+ public:
+  explicit SlabPoolThreadCache(SlabPool* pool) : pool_(pool) {}
+  SlabPoolThreadCache(const SlabPoolThreadCache&) = delete;
+  SlabPoolThreadCache& operator=(const SlabPoolThreadCache&) = delete;
+  ~SlabPoolThreadCache();
+
+  void* Allocate() {
+    if (size_ == 0) {
+      pool_->AllocateBatch(blocks_, kBatchSize);
+      size_ = kBatchSize;
+    }
+    return blocks_[--size_];
+  }
+
+  void Deallocate(void* block) {
+    if (size_ == kCapacity) {
+      size_ -= kBatchSize;
+      pool_->DeallocateBatch(blocks_ + size_, kBatchSize);
+    }
+    blocks_[size_++] = block;
+  }
+
+ private:
+  static constexpr int kBatchSize = 32;
+  static constexpr int kCapacity = 2 * kBatchSize;
+
+  SlabPool* const pool_;
+  int size_ = 0;
+  void* blocks_[kCapacity];
+};
+
+// A standard allocator that serves single-object allocations from a
+// SlabPool shared by all allocators of the same value_type, through a
+// per-thread cache. Arrays fall back to std::allocator. Intended for
+// std::allocate_shared(), which rebinds the allocator to a type combining the
+// control block and the object, so that both live in one pooled block.
+template <typename T>
+class SlabPoolAllocator {
+ public:
+  using value_type = T;
+
+  SlabPoolAllocator() = default;
+  template <typename U>
+  SlabPoolAllocator(const SlabPoolAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    if (n != 1) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(ThreadCache().Allocate());
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (n != 1) {
+      std::allocator<T>().deallocate(ptr, n);
+      return;
+    }
+    ThreadCache().Deallocate(ptr);
+  }
+
+  // Returns the pool backing allocations of T.
+  static SlabPool& Pool() {
+    static NoDestructor<SlabPool> pool(sizeof(T), alignof(T));
+    return *pool;
+  }
+
+  // Returns the calling thread's cache in front of Pool().
+  static SlabPoolThreadCache& ThreadCache() {
+    thread_local SlabPoolThreadCache cache(&Pool());
+    return cache;
+  }
+
+  template <typename U>
+  bool operator==(const SlabPoolAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SlabPoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_SLAB_POOL_H_
@@ -0,0 +1,114 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/slab_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "mediapipe/framework/deps/threadpool.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(SlabPoolTest, ReusesBlocks) {
+  SlabPool pool(24, 8);
+  EXPECT_EQ(0, pool.NumSlabs());
+  void* a = pool.Allocate();
+  void* b = pool.Allocate();
+  EXPECT_NE(a, b);
+  EXPECT_EQ(1, pool.NumSlabs());
+  EXPECT_EQ(2, pool.NumBlocksInUse());
+  pool.Deallocate(a);
+  EXPECT_EQ(a, pool.Allocate());
+  pool.Deallocate(a);
+  pool.Deallocate(b);
+  EXPECT_EQ(0, pool.NumBlocksInUse());
+}
+
+TEST(SlabPoolTest, GrowsAndAlignsBlocks) {
+  constexpr size_t kAlignment = 64;
+  SlabPool pool(100, kAlignment);
+  EXPECT_EQ(0, pool.block_size() % kAlignment);
+  std::set<void*> blocks;
+  for (int i = 0; i < 3 * pool.blocks_per_slab(); ++i) {
+    void* block = pool.Allocate();
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % kAlignment);
+    EXPECT_TRUE(blocks.insert(block).second);
+  }
+  EXPECT_EQ(3, pool.NumSlabs());
+  for (void* block : blocks) {
+    pool.Deallocate(block);
+  }
+  EXPECT_EQ(0, pool.NumBlocksInUse());
+}
+
+TEST(SlabPoolTest, ConcurrentAllocateAndDeallocate) {
+  constexpr int kNumThreads = 8;
+  constexpr int kIterations = 10000;
+  SlabPool pool(32, 8);
+  {
+    ThreadPool threads("test", kNumThreads);
+    threads.StartWorkers();
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.Schedule([&pool] {
+        std::vector<void*> blocks;
+        for (int i = 0; i < kIterations; ++i) {
+          blocks.push_back(pool.Allocate());
+          if (blocks.size() > 16) {
+            for (void* block : blocks) pool.Deallocate(block);
+            blocks.clear();
+          }
+        }
+        for (void* block : blocks) pool.Deallocate(block);
+      });
+    }
+  }
+  EXPECT_EQ(0, pool.NumBlocksInUse());
+}
+
+TEST(SlabPoolThreadCacheTest, ExchangesBlocksInBatches) {
+  SlabPool pool(16, 8);
+  std::vector<void*> blocks;
+  {
+    SlabPoolThreadCache cache(&pool);
+    blocks.push_back(cache.Allocate());
+    const int64_t batch = pool.NumBlocksInUse();
+    EXPECT_GT(batch, 1);
+    // Allocations served from the cache do not touch the pool.
+    for (int i = 1; i < batch; ++i) blocks.push_back(cache.Allocate());
+    EXPECT_EQ(batch, pool.NumBlocksInUse());
+    blocks.push_back(cache.Allocate());
+    EXPECT_EQ(2 * batch, pool.NumBlocksInUse());
+    for (void* block : blocks) cache.Deallocate(block);
+  }
+  EXPECT_EQ(0, pool.NumBlocksInUse());
+}
+
+TEST(SlabPoolAllocatorTest, WorksWithAllocateShared) {
+  struct Payload {
+    int64_t values[5];
+  };
+  using Allocator = SlabPoolAllocator<Payload>;
+  auto ptr = std::allocate_shared<Payload>(Allocator(), Payload{{1, 2}});
+  EXPECT_EQ(2, ptr->values[1]);
+  std::vector<int, SlabPoolAllocator<int>> vector = {1, 2, 3};
+  EXPECT_EQ(3, vector.size());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,255 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Capacity of each per-worker deque. Tasks that do not fit are sent to the
+// injection queue instead.
+constexpr int kDequeCapacity = 1024;
+
+// Identifies the worker running on the current thread, if any.
+struct CurrentWorker {
+  const WorkStealingThreadPool* pool = nullptr;
+  int index = -1;
+};
+thread_local CurrentWorker current_worker;
+
+// Returns the next value of a xorshift32 generator, used to pick steal
+// victims without any shared state.
+uint32_t NextRandom(uint32_t* state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+}  // namespace
+
+namespace internal {
+
+WorkStealingDeque::WorkStealingDeque(int capacity)
+    : mask_(capacity - 1), buffer_(new std::atomic<Task*>[capacity]) {
+  CHECK_GT(capacity, 0);
+  CHECK_EQ(capacity & (capacity - 1), 0) << "capacity must be a power of two";
+  for (int i = 0; i < capacity; ++i) {
+    buffer_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+bool WorkStealingDeque::Push(Task* task) {
+  const int64_t b = bottom_.load(std::memory_order_relaxed);
+  const int64_t t = top_.load(std::memory_order_acquire);
+  if (b - t > mask_) {
+    return false;
+  }
+  buffer_[b & mask_].store(task, std::memory_order_relaxed);
+  bottom_.store(b + 1, std::memory_order_release);
+  return true;
+}
+
+WorkStealingDeque::Task* WorkStealingDeque::Pop() {
+  const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top_.load(std::memory_order_relaxed);
+  if (t > b) {
+    // Empty.
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Task* task = buffer_[b & mask_].load(std::memory_order_relaxed);
+  if (t == b) {
+    // Last element: race against concurrent stealers.
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+WorkStealingDeque::Task* WorkStealingDeque::Steal() {
+  int64_t t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t b = bottom_.load(std::memory_order_acquire);
+  if (t >= b) {
+    return nullptr;
+  }
+  Task* task = buffer_[t & mask_].load(std::memory_order_relaxed);
+  if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return task;
+}
+
+bool WorkStealingDeque::Empty() const {
+  const int64_t t = top_.load(std::memory_order_acquire);
+  const int64_t b = bottom_.load(std::memory_order_acquire);
+  return t >= b;
+}
+
+}  // namespace internal
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::string& name_prefix,
+                                               int num_threads)
+    : WorkStealingThreadPool(ThreadOptions(), name_prefix, num_threads) {}
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    const ThreadOptions& thread_options, const std::string& name_prefix,
+    int num_threads)
+    : num_threads_((num_threads == 0) ? 1 : num_threads),
+      thread_options_(thread_options),
+      threads_(std::make_unique<ThreadPool>(thread_options, name_prefix,
+                                            num_threads_)) {
+  deques_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; ++i) {
+    deques_.push_back(
+        std::make_unique<internal::WorkStealingDeque>(kDequeCapacity));
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    absl::MutexLock lock(&sleep_mutex_);
+    stopped_ = true;
+    wake_condition_.SignalAll();
+  }
+  // Joins the workers, which exit only once every queue is drained.
+  threads_.reset();
+
+  // Only reachable if StartWorkers() was never called.
+  absl::MutexLock lock(&injection_mutex_);
+  for (Task* task : injected_tasks_) {
+    delete task;
+  }
+  injected_tasks_.clear();
+}
+
+void WorkStealingThreadPool::StartWorkers() {
+  threads_->StartWorkers();
+  for (int i = 0; i < num_threads_; ++i) {
+    threads_->Schedule([this, i] { RunWorker(i); });
+  }
+}
+
+void WorkStealingThreadPool::Schedule(std::function<void()> callback) {
+  auto* task = new Task(std::move(callback));
+  if (current_worker.pool != this ||
+      !deques_[current_worker.index]->Push(task)) {
+    Inject(task);
+  }
+  WakeOne();
+}
+
+int WorkStealingThreadPool::num_threads() const { return num_threads_; }
+
+const ThreadOptions& WorkStealingThreadPool::thread_options() const {
+  return thread_options_;
+}
+
+void WorkStealingThreadPool::Inject(Task* task) {
+  absl::MutexLock lock(&injection_mutex_);
+  injected_tasks_.push_back(task);
+  num_injected_tasks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WorkStealingThreadPool::WakeOne() {
+  // Pairs with the fence in RunWorker(): either this thread observes the
+  // sleeper, or the sleeper observes the task just published.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_sleeping_.load(std::memory_order_relaxed) > 0) {
+    absl::MutexLock lock(&sleep_mutex_);
+    wake_condition_.Signal();
+  }
+}
+
+bool WorkStealingThreadPool::HasPendingTasks() const {
+  if (num_injected_tasks_.load(std::memory_order_relaxed) > 0) {
+    return true;
+  }
+  for (const auto& deque : deques_) {
+    if (!deque->Empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::TakeTask(
+    int index, uint32_t* rng_state) {
+  if (Task* task = deques_[index]->Pop()) {
+    return task;
+  }
+  if (num_injected_tasks_.load(std::memory_order_relaxed) > 0) {
+    absl::MutexLock lock(&injection_mutex_);
+    if (!injected_tasks_.empty()) {
+      Task* task = injected_tasks_.front();
+      injected_tasks_.pop_front();
+      num_injected_tasks_.fetch_sub(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+  // Visit every other worker once, starting from a random victim.
+  const int start = NextRandom(rng_state) % num_threads_;
+  for (int i = 0; i < num_threads_; ++i) {
+    const int victim = (start + i) % num_threads_;
+    if (victim == index) continue;
+    if (Task* task = deques_[victim]->Steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingThreadPool::RunWorker(int index) {
+  current_worker.pool = this;
+  current_worker.index = index;
+  uint32_t rng_state = 2654435761u * (index + 1);
+  while (true) {
+    if (Task* task = TakeTask(index, &rng_state)) {
+      (*task)();
+      delete task;
+      continue;
+    }
+    absl::MutexLock lock(&sleep_mutex_);
+    num_sleeping_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // A steal may have failed only because it lost a race, so look again
+    // before sleeping.
+    if (!HasPendingTasks()) {
+      if (stopped_) {
+        num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        break;
+      }
+      wake_condition_.Wait(&sleep_mutex_);
+    }
+    num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  current_worker.pool = nullptr;
+  current_worker.index = -1;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,155 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
+#define MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/deps/threadpool.h"
+
+namespace mediapipe {
+
+namespace internal {
+
+// A bounded Chase-Lev work-stealing deque of task pointers.
+//
+// Only the owning worker thread may call Push() and Pop(), which operate on
+// the bottom end of the deque. Any thread may call Steal(), which takes from
+// the top end. None of the operations block or take a lock.
+class WorkStealingDeque {
+ public:
+  using Task = std::function<void()>;
+
+  // "capacity" must be a power of two.
+  explicit WorkStealingDeque(int capacity);
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Pushes a task at the bottom. Returns false if the deque is full, in which
+  // case ownership of "task" stays with the caller.
+  bool Push(Task* task);
+
+  // Pops the most recently pushed task, or returns nullptr if empty.
+  Task* Pop();
+
+  // Takes the least recently pushed task, or returns nullptr if the deque is
+  // empty or the steal lost a race with another thread.
+  Task* Steal();
+
+  // Returns true if the deque appears to be empty. The result may be stale by
+  // the time it is returned.
+  bool Empty() const;
+
+ private:
+  const int64_t mask_;
+  std::unique_ptr<std::atomic<Task*>[]> buffer_;
+  std::atomic<int64_t> top_{0};
+  std::atomic<int64_t> bottom_{0};
+};
+
+}  // namespace internal
+
+// A thread pool in which every worker owns a lock-free task deque.
+//
+// Tasks scheduled from a worker thread are pushed onto that worker's own
+// deque without taking any lock. Tasks scheduled from other threads go to a
+// shared injection queue. A worker that runs out of local work takes from the
+// injection queue and then tries to steal from the other workers' deques
+// before going to sleep.
+//
+// Unlike ThreadPool, no ordering is guaranteed between scheduled callbacks,
+// even with a single thread.
+//
+// The interface mirrors ThreadPool. The worker threads themselves are hosted
+// by a ThreadPool, so ThreadOptions (stack size, nice priority level, cpu set
+// and thread name prefix) are honored in the same way.
+class WorkStealingThreadPool {
+ public:
+  // Create a work-stealing thread pool with "num_threads" workers.
+  WorkStealingThreadPool(const std::string& name_prefix, int num_threads);
+
+  // Like above, and also applies "thread_options" to the worker threads.
+  WorkStealingThreadPool(const ThreadOptions& thread_options,
+                         const std::string& name_prefix, int num_threads);
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+  // Waits for closures (if any) to complete. May be called without
+  // having called StartWorkers().
+  ~WorkStealingThreadPool();
+
+  // REQUIRES: StartWorkers has not been called
+  // Actually start the worker threads.
+  void StartWorkers();
+
+  // REQUIRES: StartWorkers has been called
+  // Add specified callback to the pending callbacks. Eventually a worker
+  // thread will pick this callback up and execute it.
+  void Schedule(std::function<void()> callback);
+
+  // Provided for debugging and testing only.
+  int num_threads() const;
+
+  // Standard thread options.  Use this accessor to get them.
+  const ThreadOptions& thread_options() const;
+
+ private:
+  using Task = internal::WorkStealingDeque::Task;
+
+  // Runs the scheduling loop of the worker at "index".
+  void RunWorker(int index);
+
+  // Returns the next task for the worker at "index": from its own deque,
+  // then from the injection queue, then stolen from another worker.
+  Task* TakeTask(int index, uint32_t* rng_state);
+
+  // Returns true if any deque or the injection queue holds a task.
+  bool HasPendingTasks() const;
+
+  // Adds a task to the injection queue.
+  void Inject(Task* task);
+
+  // Wakes up one sleeping worker, if any.
+  void WakeOne();
+
+  const int num_threads_;
+  std::vector<std::unique_ptr<internal::WorkStealingDeque>> deques_;
+
+  absl::Mutex injection_mutex_;
+  std::deque<Task*> injected_tasks_ ABSL_GUARDED_BY(injection_mutex_);
+  std::atomic<int> num_injected_tasks_{0};
+
+  absl::Mutex sleep_mutex_;
+  absl::CondVar wake_condition_;
+  bool stopped_ ABSL_GUARDED_BY(sleep_mutex_) = false;
+  std::atomic<int> num_sleeping_{0};
+
+  ThreadOptions thread_options_;
+  // Hosts the worker threads; one long-running RunWorker() per thread.
+  std::unique_ptr<ThreadPool> threads_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
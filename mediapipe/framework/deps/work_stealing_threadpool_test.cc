@@ -0,0 +1,129 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
+
+#include <atomic>
+#include <functional>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingDequeTest, PopIsLifoAndStealIsFifo) {
+  internal::WorkStealingDeque deque(4);
+  std::function<void()> a, b, c;
+  EXPECT_TRUE(deque.Empty());
+  ASSERT_TRUE(deque.Push(&a));
+  ASSERT_TRUE(deque.Push(&b));
+  ASSERT_TRUE(deque.Push(&c));
+  EXPECT_FALSE(deque.Empty());
+  EXPECT_EQ(&c, deque.Pop());
+  EXPECT_EQ(&a, deque.Steal());
+  EXPECT_EQ(&b, deque.Pop());
+  EXPECT_EQ(nullptr, deque.Pop());
+  EXPECT_EQ(nullptr, deque.Steal());
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDequeTest, PushFailsWhenFull) {
+  internal::WorkStealingDeque deque(2);
+  std::function<void()> a, b, c;
+  ASSERT_TRUE(deque.Push(&a));
+  ASSERT_TRUE(deque.Push(&b));
+  EXPECT_FALSE(deque.Push(&c));
+  EXPECT_EQ(&a, deque.Steal());
+  EXPECT_TRUE(deque.Push(&c));
+}
+
+TEST(WorkStealingThreadPoolTest, DestroyWithoutStart) {
+  WorkStealingThreadPool thread_pool("testpool", 10);
+}
+
+TEST(WorkStealingThreadPoolTest, EmptyThread) {
+  WorkStealingThreadPool thread_pool("testpool", 0);
+  ASSERT_EQ(1, thread_pool.num_threads());
+  thread_pool.StartWorkers();
+}
+
+TEST(WorkStealingThreadPoolTest, SingleThread) {
+  absl::Mutex mu;
+  int n = 100;
+  {
+    WorkStealingThreadPool thread_pool("testpool", 1);
+    ASSERT_EQ(1, thread_pool.num_threads());
+    thread_pool.StartWorkers();
+
+    for (int i = 0; i < 100; ++i) {
+      thread_pool.Schedule([&n, &mu]() mutable {
+        absl::MutexLock l(&mu);
+        --n;
+      });
+    }
+  }
+
+  EXPECT_EQ(0, n);
+}
+
+TEST(WorkStealingThreadPoolTest, MultiThreads) {
+  absl::Mutex mu;
+  int n = 100;
+  {
+    WorkStealingThreadPool thread_pool("testpool", 10);
+    ASSERT_EQ(10, thread_pool.num_threads());
+    thread_pool.StartWorkers();
+
+    for (int i = 0; i < 100; ++i) {
+      thread_pool.Schedule([&n, &mu]() mutable {
+        absl::MutexLock l(&mu);
+        --n;
+      });
+    }
+  }
+
+  EXPECT_EQ(0, n);
+}
+
+// Tasks scheduled from worker threads go to the per-worker deques, including
+// more tasks than a single deque can hold.
+TEST(WorkStealingThreadPoolTest, NestedSchedule) {
+  constexpr int kFanOut = 4000;
+  std::atomic<int> n(0);
+  {
+    WorkStealingThreadPool thread_pool("testpool", 8);
+    thread_pool.StartWorkers();
+    for (int i = 0; i < 4; ++i) {
+      thread_pool.Schedule([&thread_pool, &n]() {
+        for (int j = 0; j < kFanOut; ++j) {
+          thread_pool.Schedule([&n]() { n.fetch_add(1); });
+        }
+      });
+    }
+  }
+
+  EXPECT_EQ(4 * kFanOut, n.load());
+}
+
+TEST(WorkStealingThreadPoolTest, CreateWithThreadOptions) {
+  ThreadOptions thread_options = ThreadOptions().set_nice_priority_level(-10);
+  WorkStealingThreadPool thread_pool(thread_options, "testpool", 10);
+  ASSERT_EQ(10, thread_pool.num_threads());
+  ASSERT_EQ(-10, thread_pool.thread_options().nice_priority_level());
+  thread_pool.StartWorkers();
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -40,6 +40,11 @@ bool Image::ConvertToGpu() const {
 #endif  // MEDIAPIPE_DISABLE_GPU
 }
 
+Image Image::CreateCpuView(int left, int top, int width, int height) const {
+  return Image(ImageFrameSharedPtr(ImageFrame::CreateView(
+      gpu_buffer_.GetReadView<ImageFrame>(), left, top, width, height)));
+}
+
 MEDIAPIPE_REGISTER_TYPE(mediapipe::Image, "::mediapipe::Image", nullptr,
                         nullptr);
 MEDIAPIPE_REGISTER_TYPE(std::vector<mediapipe::Image>,
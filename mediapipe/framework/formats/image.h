@@ -121,6 +121,12 @@ class Image {
     return gpu_buffer_;
   }
 
+  // Returns a CPU Image aliasing the width x height sub-rectangle of this
+  // image whose top left pixel is (left, top), without copying the pixels.
+  // The returned image is read-only and keeps this image's pixel data alive.
+  // GPU images are transferred to CPU first.
+  Image CreateCpuView(int left, int top, int width, int height) const;
+
   // Returns image properties.
   int width() const;
   int height() const;
@@ -85,19 +85,75 @@ ImageFrame& ImageFrame::operator=(ImageFrame&& move_from) {
   width_ = move_from.width_;
   height_ = move_from.height_;
   width_step_ = move_from.width_step_;
+  read_only_ = move_from.read_only_;
+  aliased_ = move_from.aliased_;
 
   move_from.format_ = ImageFormat::UNKNOWN;
   move_from.width_ = 0;
   move_from.height_ = 0;
   move_from.width_step_ = 0;
+  move_from.read_only_ = false;
+  move_from.aliased_ = false;
   return *this;
 }
 
+namespace {
+
+// Returns the address of pixel (left, top) of source after checking that the
+// width x height rectangle there is inside source.
+const uint8_t* SubRectPixelData(const ImageFrame& source, int left, int top,
+                                int width, int height) {
+  CHECK(!source.IsEmpty());
+  CHECK_GE(left, 0);
+  CHECK_GE(top, 0);
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CHECK_LE(left + width, source.Width());
+  CHECK_LE(top + height, source.Height());
+  return source.PixelData() + top * source.WidthStep() +
+         left * source.NumberOfChannels() * source.ByteDepth();
+}
+
+}  // namespace
+
+std::unique_ptr<ImageFrame> ImageFrame::CreateView(
+    std::shared_ptr<ImageFrame> source, int left, int top, int width,
+    int height) {
+  if (source->IsReadOnly()) {
+    return CreateView(std::shared_ptr<const ImageFrame>(std::move(source)),
+                      left, top, width, height);
+  }
+  auto view = std::make_unique<ImageFrame>();
+  // The view may write to the pixel data, so source is not accessed as const.
+  uint8_t* pixel_data = const_cast<uint8_t*>(
+      SubRectPixelData(*source, left, top, width, height));
+  const ImageFormat::Format format = source->Format();
+  const int width_step = source->WidthStep();
+  view->AliasPixelData(format, width, height, width_step, pixel_data,
+                       std::move(source));
+  return view;
+}
+
+std::unique_ptr<ImageFrame> ImageFrame::CreateView(
+    std::shared_ptr<const ImageFrame> source, int left, int top, int width,
+    int height) {
+  auto view = std::make_unique<ImageFrame>();
+  const uint8_t* pixel_data =
+      SubRectPixelData(*source, left, top, width, height);
+  const ImageFormat::Format format = source->Format();
+  const int width_step = source->WidthStep();
+  view->AliasReadOnlyPixelData(format, width, height, width_step, pixel_data,
+                               std::move(source));
+  return view;
+}
+
 void ImageFrame::Reset(ImageFormat::Format format, int width, int height,
                        uint32_t alignment_boundary) {
   format_ = format;
   width_ = width;
   height_ = height;
+  read_only_ = false;
+  aliased_ = false;
   CHECK_NE(ImageFormat::UNKNOWN, format_);
   CHECK(IsValidAlignmentNumber(alignment_boundary));
   width_step_ = width * NumberOfChannels() * ByteDepth();
@@ -123,6 +179,8 @@ void ImageFrame::AdoptPixelData(ImageFormat::Format format, int width,
   width_ = width;
   height_ = height;
   width_step_ = width_step;
+  read_only_ = false;
+  aliased_ = false;
 
   CHECK_NE(ImageFormat::UNKNOWN, format_);
   CHECK_GE(width_step_, width * NumberOfChannels() * ByteDepth());
@@ -130,6 +188,23 @@ void ImageFrame::AdoptPixelData(ImageFormat::Format format, int width,
   pixel_data_ = {pixel_data, deleter};
 }
 
+void ImageFrame::AliasPixelData(ImageFormat::Format format, int width,
+                                int height, int width_step, uint8_t* pixel_data,
+                                std::shared_ptr<const void> keep_alive) {
+  AdoptPixelData(format, width, height, width_step, pixel_data,
+                 [keep_alive = std::move(keep_alive)](uint8_t*) {});
+  aliased_ = true;
+}
+
+void ImageFrame::AliasReadOnlyPixelData(
+    ImageFormat::Format format, int width, int height, int width_step,
+    const uint8_t* pixel_data, std::shared_ptr<const void> keep_alive) {
+  // The const_cast is safe since read_only_ guards the pixel data.
+  AliasPixelData(format, width, height, width_step,
+                 const_cast<uint8_t*>(pixel_data), std::move(keep_alive));
+  read_only_ = true;
+}
+
 std::unique_ptr<uint8_t[], ImageFrame::Deleter> ImageFrame::Release() {
   return std::move(pixel_data_);
 }
@@ -178,15 +253,27 @@ void ImageFrame::InternalCopyToBuffer(int width_step, char* buffer) const {
 }
 
 void ImageFrame::SetToZero() {
-  if (pixel_data_) {
+  if (!pixel_data_) {
+    return;
+  }
+  CHECK(!read_only_) << "Pixel data of this ImageFrame is read-only.";
+  if (aliased_) {
+    // The row padding of an aliased frame may hold pixels of another image.
+    const int row_bytes = width_ * NumberOfChannels() * ByteDepth();
+    for (int row = 0; row < height_; ++row) {
+      std::fill_n(pixel_data_.get() + width_step_ * row, row_bytes, 0);
+    }
+  } else {
     std::fill_n(pixel_data_.get(), width_step_ * height_, 0);
   }
 }
 
 void ImageFrame::SetAlignmentPaddingAreas() {
-  if (!pixel_data_) {
+  // The row padding of an aliased frame may hold pixels of another image.
+  if (!pixel_data_ || aliased_) {
     return;
   }
+  CHECK(!read_only_) << "Pixel data of this ImageFrame is read-only.";
   CHECK_GE(width_, 1);
   CHECK_GE(height_, 1);
 
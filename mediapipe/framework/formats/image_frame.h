@@ -15,6 +15,11 @@
 // Get a cv::Mat view of the ImageFrame (this is efficient):
 //   ::mediapipe::formats::MatView(&frame);
 //
+// Get an ImageFrame view of a sub-rectangle of a shared ImageFrame, without
+// copying:
+//   std::unique_ptr<ImageFrame> roi =
+//       ImageFrame::CreateView(shared_frame, left, top, width, height);
+//
 // Copying data from raw data (stored contiguously):
 //   frame.CopyPixelData(format, width, height, raw_data_ptr,
 //                       ImageFrame::kDefaultAlignmentBoundary);
@@ -42,6 +47,7 @@
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/tool/type_util.h"
 
 #define IMAGE_FRAME_RAW_IMAGE MEDIAPIPE_HAS_RTTI
@@ -121,23 +127,40 @@ class ImageFrame {
   ImageFrame(ImageFrame&& move_from);
   ImageFrame& operator=(ImageFrame&& move_from);
 
+  // Returns an ImageFrame that aliases the width x height sub-rectangle of
+  // source whose top left pixel is (left, top), without copying. The view
+  // keeps source alive and has the same WidthStep() as source. It is
+  // read-only if source is.
+  static std::unique_ptr<ImageFrame> CreateView(
+      std::shared_ptr<ImageFrame> source, int left, int top, int width,
+      int height);
+  // Same as above, but the view is always read-only.
+  static std::unique_ptr<ImageFrame> CreateView(
+      std::shared_ptr<const ImageFrame> source, int left, int top, int width,
+      int height);
+
   // Returns true if the ImageFrame is unallocated.
   bool IsEmpty() const { return pixel_data_ == nullptr; }
 
   // Set the entire frame allocation to zero, including alignment
-  // padding areas.
+  // padding areas, unless the pixel data is aliased.
   void SetToZero();
   // Set the padding bytes at the end of each row (that are used for
   // alignment) to deterministic values.  This function should be called
   // to get deterministic behavior from functions that read the padding
   // areas (generally as part of highly optimized operations such as
-  // those in ffmpeg).
+  // those in ffmpeg).  Does nothing if the pixel data is aliased.
   void SetAlignmentPaddingAreas();
 
   // Returns true if the data is stored contiguously (without any
   // alignment padding areas).
   bool IsContiguous() const;
 
+  // Returns true if the pixel data must not be modified, because it is shared
+  // with a const ImageFrame or mapped read-only. MutablePixelData() CHECK-fails
+  // on such a frame; use CopyFrom() to get a modifiable copy.
+  bool IsReadOnly() const { return read_only_; }
+
   // Returns true if each row of the data is aligned to
   // alignment_boundary.  If IsAligned(16) is true then so are
   // IsAligned(8), IsAligned(4), IsAligned(2), and IsAligned(1).
@@ -171,7 +194,10 @@ class ImageFrame {
 
   // Get a mutable pointer to the underlying image data.  The ImageFrame
   // retains ownership.
-  uint8* MutablePixelData() { return pixel_data_.get(); }
+  uint8* MutablePixelData() {
+    CHECK(!read_only_) << "Pixel data of this ImageFrame is read-only.";
+    return pixel_data_.get();
+  }
   // Get a const pointer to the underlying image data.
   const uint8* PixelData() const { return pixel_data_.get(); }
 
@@ -190,6 +216,21 @@ class ImageFrame {
                       int width_step, uint8* pixel_data,
                       Deleter deleter = std::default_delete<uint8[]>());
 
+  // Initializes ImageFrame as a view of pixel data that it does not own,
+  // without copying.  keep_alive is held until the ImageFrame is reset or
+  // destroyed, and can be used to keep the owner of pixel_data alive, e.g.
+  // another ImageFrame or a memory mapping.  See the Constructor taking
+  // pixel_data for the requirements on width_step.
+  void AliasPixelData(ImageFormat::Format format, int width, int height,
+                      int width_step, uint8* pixel_data,
+                      std::shared_ptr<const void> keep_alive);
+  // Same as above, but for pixel data that must not be modified, e.g.
+  // read-only memory. The ImageFrame is read-only.
+  void AliasReadOnlyPixelData(ImageFormat::Format format, int width,
+                              int height, int width_step,
+                              const uint8* pixel_data,
+                              std::shared_ptr<const void> keep_alive);
+
   // Resets the ImageFrame and makes it a copy of the provided pixel
   // data, which is assumed to be stored contiguously.  The ImageFrame
   // will use the given alignment_boundary.
@@ -248,6 +289,9 @@ class ImageFrame {
   int width_;
   int height_;
   int width_step_;
+  bool read_only_ = false;
+  // True if the pixel data is not owned, see AliasPixelData().
+  bool aliased_ = false;
 
   std::unique_ptr<uint8[], Deleter> pixel_data_;
 };
@@ -0,0 +1,133 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_mapping.h"
+
+#include <errno.h>
+#include <fcntl.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+#ifdef _WIN32
+
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapImageFrame(
+    int fd, int64_t offset, ImageFormat::Format format, int width, int height,
+    int width_step, bool writable) {
+  return absl::UnimplementedError("Mapping ImageFrames is not supported.");
+}
+
+#else
+
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapImageFrame(
+    int fd, int64_t offset, ImageFormat::Format format, int width, int height,
+    int width_step, bool writable) {
+  if (format == ImageFormat::UNKNOWN || width <= 0 || height <= 0 ||
+      offset < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid image: format ", format, ", size ", width, "x",
+                     height, ", offset ", offset));
+  }
+  const int row_bytes = width * ImageFrame::NumberOfChannelsForFormat(format) *
+                        ImageFrame::ByteDepthForFormat(format);
+  if (width_step < row_bytes) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "width_step ", width_step, " is less than the row size ", row_bytes));
+  }
+  const int64_t size = static_cast<int64_t>(width_step) * height;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unable to get file size, errno=", errno));
+  }
+  if (offset + size > file_stat.st_size) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Image of ", size, " bytes at offset ", offset,
+                     " exceeds the file size ", file_stat.st_size));
+  }
+
+  // mmap requires the offset to be a multiple of the page size.
+  const int64_t page_size = sysconf(_SC_PAGE_SIZE);
+  const int64_t aligned_offset = offset / page_size * page_size;
+  const size_t mapped_size = offset - aligned_offset + size;
+  void* mapped =
+      mmap(/*addr=*/nullptr, mapped_size,
+           writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd,
+           aligned_offset);
+  if (mapped == MAP_FAILED) {
+    return absl::UnavailableError(
+        absl::StrCat("Unable to map image to memory, errno=", errno));
+  }
+  std::shared_ptr<void> mapping(
+      mapped, [mapped_size](void* data) { munmap(data, mapped_size); });
+  uint8_t* pixel_data =
+      static_cast<uint8_t*>(mapped) + (offset - aligned_offset);
+
+  auto frame = std::make_unique<ImageFrame>();
+  if (writable) {
+    frame->AliasPixelData(format, width, height, width_step, pixel_data,
+                          std::move(mapping));
+  } else {
+    frame->AliasReadOnlyPixelData(format, width, height, width_step,
+                                  pixel_data, std::move(mapping));
+  }
+  return frame;
+}
+
+#endif  // _WIN32
+
+#if defined(_WIN32) || defined(__ANDROID__)
+
+// Neither Windows nor Android provides shm_open().
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapSharedMemoryImageFrame(
+    const std::string& name, int64_t offset, ImageFormat::Format format,
+    int width, int height, int width_step, bool writable) {
+  return absl::UnimplementedError(
+      "Mapping shared memory ImageFrames is not supported.");
+}
+
+#else
+
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapSharedMemoryImageFrame(
+    const std::string& name, int64_t offset, ImageFormat::Format format,
+    int width, int height, int width_step, bool writable) {
+  const int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) {
+    return absl::NotFoundError(absl::StrCat(
+        "Unable to open shared memory object ", name, ", errno=", errno));
+  }
+  auto frame =
+      MapImageFrame(fd, offset, format, width, height, width_step, writable);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  return frame;
+}
+
+#endif  // defined(_WIN32) || defined(__ANDROID__)
+
+}  // namespace mediapipe
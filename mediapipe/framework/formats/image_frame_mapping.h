@@ -0,0 +1,60 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Creates ImageFrames backed by memory-mapped files or POSIX shared memory,
+// so that frames produced by another process can be fed to a graph without
+// copying, e.g.:
+//
+//   ASSIGN_OR_RETURN(std::unique_ptr<ImageFrame> frame,
+//                    MapSharedMemoryImageFrame("/camera0", slot * slot_size,
+//                                              ImageFormat::SRGB, 1280, 720,
+//                                              /*width_step=*/1280 * 3));
+//   graph.AddPacketToInputStream(
+//       "input_video", Adopt(frame.release()).At(timestamp));
+//
+// The mapping is released when the ImageFrame is destroyed. The producer must
+// not modify the mapped pixels while the frame is in use.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MAPPING_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MAPPING_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+
+namespace mediapipe {
+
+// Maps height rows of width_step bytes, starting at offset in the open file
+// fd, into memory and returns an ImageFrame aliasing them. The ImageFrame is
+// read-only unless writable is true, in which case fd must be open for
+// writing and changes to the pixels are written to the file. fd may be closed
+// once this returns.
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapImageFrame(
+    int fd, int64_t offset, ImageFormat::Format format, int width, int height,
+    int width_step, bool writable = false);
+
+// Same as above, for the POSIX shared memory object name, e.g. "/camera0", as
+// created with shm_open(). Returns an UnimplementedError on Android, which
+// does not support POSIX shared memory.
+absl::StatusOr<std::unique_ptr<ImageFrame>> MapSharedMemoryImageFrame(
+    const std::string& name, int64_t offset, ImageFormat::Format format,
+    int width, int height, int width_step, bool writable = false);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MAPPING_H_
@@ -0,0 +1,118 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_mapping.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 5;
+constexpr int kHeight = 3;
+constexpr int kWidthStep = 16;
+// Not a multiple of the page size, to exercise offset alignment.
+constexpr int kOffset = 100;
+
+class ImageFrameMappingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = absl::StrCat(getenv("TEST_TMPDIR"), "/image_frame_XXXXXX");
+    fd_ = mkstemp(&path_[0]);
+    ASSERT_GE(fd_, 0);
+    std::vector<uint8_t> contents(kOffset + kWidthStep * kHeight);
+    for (int i = 0; i < contents.size(); ++i) {
+      contents[i] = i % 256;
+    }
+    ASSERT_EQ(write(fd_, contents.data(), contents.size()), contents.size());
+  }
+
+  void TearDown() override {
+    close(fd_);
+    unlink(path_.c_str());
+  }
+
+  std::string path_;
+  int fd_ = -1;
+};
+
+TEST_F(ImageFrameMappingTest, MapsPixelsReadOnly) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ImageFrame> frame,
+      MapImageFrame(fd_, kOffset, ImageFormat::SRGB, kWidth, kHeight,
+                    kWidthStep));
+  EXPECT_TRUE(frame->IsReadOnly());
+  EXPECT_EQ(frame->Width(), kWidth);
+  EXPECT_EQ(frame->Height(), kHeight);
+  EXPECT_EQ(frame->WidthStep(), kWidthStep);
+  for (int row = 0; row < kHeight; ++row) {
+    for (int i = 0; i < kWidth * 3; ++i) {
+      EXPECT_EQ(frame->PixelData()[row * kWidthStep + i],
+                (kOffset + row * kWidthStep + i) % 256);
+    }
+  }
+
+  // Copies are owned and writable.
+  ImageFrame copy;
+  copy.CopyFrom(*frame, ImageFrame::kDefaultAlignmentBoundary);
+  EXPECT_FALSE(copy.IsReadOnly());
+}
+
+TEST_F(ImageFrameMappingTest, WritesThroughWritableMapping) {
+  {
+    MP_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ImageFrame> frame,
+        MapImageFrame(fd_, kOffset, ImageFormat::GRAY8, kWidth, kHeight,
+                      kWidthStep, /*writable=*/true));
+    EXPECT_FALSE(frame->IsReadOnly());
+    frame->MutablePixelData()[kWidthStep] = 255;
+  }
+  uint8_t value = 0;
+  ASSERT_EQ(pread(fd_, &value, 1, kOffset + kWidthStep), 1);
+  EXPECT_EQ(value, 255);
+}
+
+TEST_F(ImageFrameMappingTest, FailsIfImageExceedsFile) {
+  EXPECT_EQ(MapImageFrame(fd_, kOffset + 1, ImageFormat::SRGB, kWidth,
+                          kHeight, kWidthStep)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(ImageFrameMappingTest, FailsIfWidthStepIsTooSmall) {
+  EXPECT_EQ(MapImageFrame(fd_, kOffset, ImageFormat::SRGBA, kWidth, kHeight,
+                          kWidthStep)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace mediapipe
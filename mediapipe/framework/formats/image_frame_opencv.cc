@@ -14,7 +14,10 @@
 
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 
+#include <memory>
+
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/port/logging.h"
 
 namespace {
 // Maps ImageFrame format to OpenCV Mat type.
@@ -92,5 +95,19 @@ cv::Mat MatView(const ImageFrame* image) {
                  steps);
 }
 
+std::unique_ptr<ImageFrame> ImageFrameView(const cv::Mat& mat,
+                                           ImageFormat::Format format) {
+  CHECK_EQ(mat.dims, 2);
+  CHECK_EQ(mat.type(),
+           CV_MAKETYPE(GetMatType(format),
+                       ImageFrame::NumberOfChannelsForFormat(format)));
+  auto frame = std::make_unique<ImageFrame>();
+  // The copy of mat shares, and keeps alive, its data.
+  frame->AliasPixelData(format, mat.cols, mat.rows,
+                        static_cast<int>(mat.step[0]), mat.data,
+                        std::make_shared<cv::Mat>(mat));
+  return frame;
+}
+
 }  // namespace formats
 }  // namespace mediapipe
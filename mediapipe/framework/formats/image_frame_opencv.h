@@ -16,6 +16,9 @@
 #ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_OPENCV_H_
 #define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_OPENCV_H_
 
+#include <memory>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 
@@ -30,6 +33,13 @@ namespace formats {
 // even though the returned data is mutable.
 cv::Mat MatView(const ImageFrame* image);
 
+// Returns an ImageFrame that aliases the pixels of mat, without copying. The
+// ImageFrame holds a reference to mat's data, so the data stays alive if mat
+// allocated it. mat must be 2-dimensional, and its element type must match
+// format.
+std::unique_ptr<ImageFrame> ImageFrameView(const cv::Mat& mat,
+                                           ImageFormat::Format format);
+
 }  // namespace formats
 }  // namespace mediapipe
 
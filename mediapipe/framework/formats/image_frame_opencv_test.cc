@@ -14,6 +14,8 @@
 
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 
+#include <memory>
+
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -134,5 +136,20 @@ TEST(ImageFrameOpencvTest, ImageFormats) {
   EXPECT_EQ(mat_c4.type(), CV_8UC4);
 }
 
+TEST(ImageFrameOpencvTest, ImageFrameViewOfMat) {
+  cv::Mat mat(20, 30, CV_8UC3, cv::Scalar(1, 2, 3));
+  std::unique_ptr<ImageFrame> frame =
+      formats::ImageFrameView(mat(cv::Rect(5, 5, 10, 10)), ImageFormat::SRGB);
+  ASSERT_EQ(frame->Width(), 10);
+  ASSERT_EQ(frame->Height(), 10);
+  EXPECT_EQ(frame->WidthStep(), mat.step[0]);
+  EXPECT_EQ(frame->PixelData(), mat.ptr<uint8_t>(5, 5));
+
+  // The frame holds a reference to the pixels.
+  mat.release();
+  const cv::Mat frame_mat = formats::MatView(frame.get());
+  EXPECT_EQ(frame_mat.at<cv::Vec3b>(9, 9), cv::Vec3b(1, 2, 3));
+}
+
 }  // namespace
 }  // namespace mediapipe
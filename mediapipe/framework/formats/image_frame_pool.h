@@ -31,14 +31,16 @@ using ImageFrameSharedPtr = std::shared_ptr<ImageFrame>;
 class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
  public:
   // Creates a pool. This pool will manage buffers of the specified dimensions,
-  // and will keep keep_count buffers around for reuse.
+  // and will keep keep_count buffers around for reuse. Rows of the buffers are
+  // aligned to alignment_boundary bytes, by default 4 for best compatibility
+  // with OpenGL.
   // We enforce creation as a shared_ptr so that we can use a weak reference in
   // the buffers' deleters.
-  static std::shared_ptr<ImageFramePool> Create(int width, int height,
-                                                ImageFormat::Format format,
-                                                int keep_count) {
-    return std::shared_ptr<ImageFramePool>(
-        new ImageFramePool(width, height, format, keep_count));
+  static std::shared_ptr<ImageFramePool> Create(
+      int width, int height, ImageFormat::Format format, int keep_count,
+      uint32 alignment_boundary = ImageFrame::kGlDefaultAlignmentBoundary) {
+    return std::shared_ptr<ImageFramePool>(new ImageFramePool(
+        width, height, format, keep_count, alignment_boundary));
   }
 
   // Obtains a buffers. May either be reused or created anew.
@@ -53,7 +55,7 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
 
  private:
   ImageFramePool(int width, int height, ImageFormat::Format format,
-                 int keep_count);
+                 int keep_count, uint32 alignment_boundary);
 
   // Return a buffer to the pool.
   void Return(ImageFrame* buf);
@@ -67,6 +69,7 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
   const int height_;
   const ImageFormat::Format format_;
   const int keep_count_;
+  const uint32 alignment_boundary_;
 
   absl::Mutex mutex_;
   int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
@@ -99,5 +99,16 @@ TEST(ImageFrameBufferPoolStaticTest, BufferCanOutlivePool) {
   buffer = nullptr;
 }
 
+TEST(ImageFrameBufferPoolStaticTest, AlignmentBoundary) {
+  // 3 bytes per pixel, so rows are only packed without alignment.
+  auto packed_pool = ImageFramePool::Create(301, kHeight, ImageFormat::SRGB,
+                                            kKeepCount,
+                                            /*alignment_boundary=*/1);
+  EXPECT_EQ(packed_pool->GetBuffer()->WidthStep(), 903);
+  auto gl_pool =
+      ImageFramePool::Create(301, kHeight, ImageFormat::SRGB, kKeepCount);
+  EXPECT_EQ(gl_pool->GetBuffer()->WidthStep(), 904);
+}
+
 }  // anonymous namespace
 }  // namespace mediapipe
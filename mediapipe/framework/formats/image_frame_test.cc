@@ -0,0 +1,81 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns the number of pixels of the GRAY8 image_frame equal to value.
+int CountPixels(const ImageFrame& image_frame, uint8_t value) {
+  int count = 0;
+  for (int row = 0; row < image_frame.Height(); ++row) {
+    const uint8_t* pixel =
+        image_frame.PixelData() + row * image_frame.WidthStep();
+    for (int col = 0; col < image_frame.Width(); ++col) {
+      count += pixel[col] == value;
+    }
+  }
+  return count;
+}
+
+TEST(ImageFrameTest, CreateViewSharesPixels) {
+  auto frame = std::make_shared<ImageFrame>(ImageFormat::GRAY8, 64, 32);
+  frame->SetToZero();
+  std::unique_ptr<ImageFrame> view =
+      ImageFrame::CreateView(frame, /*left=*/8, /*top=*/4, /*width=*/16,
+                             /*height=*/10);
+  ASSERT_EQ(view->Width(), 16);
+  ASSERT_EQ(view->Height(), 10);
+  EXPECT_EQ(view->WidthStep(), frame->WidthStep());
+  EXPECT_EQ(view->PixelData(), frame->PixelData() + 4 * frame->WidthStep() + 8);
+  EXPECT_FALSE(view->IsReadOnly());
+
+  for (int row = 0; row < view->Height(); ++row) {
+    uint8_t* pixel = view->MutablePixelData() + row * view->WidthStep();
+    std::fill_n(pixel, view->Width(), 100);
+  }
+  EXPECT_EQ(CountPixels(*frame, 100), 16 * 10);
+  const int width_step = frame->WidthStep();
+  EXPECT_EQ(frame->PixelData()[4 * width_step + 8], 100);
+  EXPECT_EQ(frame->PixelData()[13 * width_step + 23], 100);
+  EXPECT_EQ(frame->PixelData()[14 * width_step + 23], 0);
+
+  // The view keeps the source pixels alive.
+  frame.reset();
+  EXPECT_EQ(CountPixels(*view, 100), 16 * 10);
+
+  std::shared_ptr<const ImageFrame> const_frame = std::move(view);
+  EXPECT_TRUE(ImageFrame::CreateView(const_frame, 0, 0, 4, 4)->IsReadOnly());
+}
+
+TEST(ImageFrameTest, ReadOnlyViewIsNotWritable) {
+  std::shared_ptr<const ImageFrame> frame =
+      std::make_shared<ImageFrame>(ImageFormat::GRAY8, 8, 8);
+  std::unique_ptr<ImageFrame> view = ImageFrame::CreateView(frame, 0, 0, 4, 4);
+  ASSERT_TRUE(view->IsReadOnly());
+  EXPECT_DEATH(view->MutablePixelData(), "read-only");
+  EXPECT_DEATH(view->SetToZero(), "read-only");
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -18,6 +18,7 @@
 #include <utility>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/logging.h"
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -405,6 +406,7 @@ void Tensor::Move(Tensor* src) {
   src->element_type_ = ElementType::kNone;  // Mark as invalidated.
   cpu_buffer_ = src->cpu_buffer_;
   src->cpu_buffer_ = nullptr;
+  cpu_buffer_allocator_ = std::move(src->cpu_buffer_allocator_);
   ahwb_tracking_key_ = src->ahwb_tracking_key_;
   mtl_resources_ = std::move(src->mtl_resources_);
   MoveAhwbStuff(src);
@@ -434,6 +436,14 @@ Tensor::Tensor(ElementType element_type, const Shape& shape,
       shape_(shape),
       quantization_parameters_(quantization_parameters),
       mtl_resources_(std::make_unique<MtlResources>()) {}
+Tensor::Tensor(ElementType element_type, const Shape& shape,
+               const QuantizationParameters& quantization_parameters,
+               std::shared_ptr<TensorCpuBufferAllocator> cpu_buffer_allocator)
+    : element_type_(element_type),
+      shape_(shape),
+      quantization_parameters_(quantization_parameters),
+      cpu_buffer_allocator_(std::move(cpu_buffer_allocator)),
+      mtl_resources_(std::make_unique<MtlResources>()) {}
 
 #if MEDIAPIPE_METAL_ENABLED
 void Tensor::Invalidate() {
@@ -519,10 +529,7 @@ void Tensor::Invalidate() {
   }
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 
-  if (cpu_buffer_) {
-    free(cpu_buffer_);
-  }
-  cpu_buffer_ = nullptr;
+  FreeCpuBuffer();
 }
 #endif  // MEDIAPIPE_METAL_ENABLED
 
@@ -637,9 +644,26 @@ void Tensor::AllocateCpuBuffer() const {
 #if MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = AllocateVirtualMemory(bytes());
 #else
-    cpu_buffer_ = malloc(bytes());
+    if (cpu_buffer_allocator_) {
+      cpu_buffer_ = cpu_buffer_allocator_->Allocate(bytes());
+    } else {
+      cpu_buffer_ = aligned_malloc(bytes(), kCpuBufferAlignment);
+    }
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 }
 
+#if !MEDIAPIPE_METAL_ENABLED
+void Tensor::FreeCpuBuffer() const {
+  if (cpu_buffer_) {
+    if (cpu_buffer_allocator_) {
+      cpu_buffer_allocator_->Deallocate(cpu_buffer_, bytes());
+    } else {
+      aligned_free(cpu_buffer_);
+    }
+  }
+  cpu_buffer_ = nullptr;
+}
+#endif  // !MEDIAPIPE_METAL_ENABLED
+
 }  // namespace mediapipe
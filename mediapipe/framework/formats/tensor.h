@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <numeric>
 #include <tuple>
 #include <type_traits>
@@ -87,6 +88,20 @@ namespace mediapipe {
 // float* pointer = view.buffer<float>();
 // ...reading the cpu memory...
 
+// Supplies the CPU memory of tensors, e.g. to recycle buffers across frames
+// instead of allocating them anew for each tensor. See TensorPool.
+// Implementations must be thread-safe.
+class TensorCpuBufferAllocator {
+ public:
+  virtual ~TensorCpuBufferAllocator() = default;
+
+  // Returns a buffer of at least "bytes" bytes, aligned to
+  // Tensor::kCpuBufferAlignment.
+  virtual void* Allocate(size_t bytes) = 0;
+  // Releases a buffer obtained from Allocate() with the same "bytes".
+  virtual void Deallocate(void* buffer, size_t bytes) = 0;
+};
+
 struct MtlResources;
 class Tensor {
   class View {
@@ -140,9 +155,19 @@ class Tensor {
     int zero_point = 0;
   };
 
+  // Alignment of the CPU buffer, in bytes. Suitable for SIMD loads and for
+  // XNNPACK.
+  static constexpr int kCpuBufferAlignment = 64;
+
   Tensor(ElementType element_type, const Shape& shape);
   Tensor(ElementType element_type, const Shape& shape,
          const QuantizationParameters& quantization_parameters);
+  // Takes the CPU buffer from "cpu_buffer_allocator", which is kept alive until
+  // the buffer is released. Not used when Metal is enabled, since the CPU
+  // buffer then backs an MTLBuffer.
+  Tensor(ElementType element_type, const Shape& shape,
+         const QuantizationParameters& quantization_parameters,
+         std::shared_ptr<TensorCpuBufferAllocator> cpu_buffer_allocator);
 
   // Non-copyable.
   Tensor(const Tensor&) = delete;
@@ -373,7 +398,9 @@ class Tensor {
   mutable absl::Mutex view_mutex_;
 
   mutable void* cpu_buffer_ = nullptr;
+  std::shared_ptr<TensorCpuBufferAllocator> cpu_buffer_allocator_;
   void AllocateCpuBuffer() const;
+  void FreeCpuBuffer() const;
   // Forward declaration of the MtlResources provides compile-time verification
   // of ODR if this header includes any actual code that uses MtlResources.
   mutable std::unique_ptr<MtlResources> mtl_resources_;
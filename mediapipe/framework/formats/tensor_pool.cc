@@ -0,0 +1,86 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe/framework/deps/aligned_malloc_and_free.h"
+
+namespace mediapipe {
+
+TensorPool::~TensorPool() {
+  absl::MutexLock lock(&mutex_);
+  for (auto& [bytes, buffers] : available_) {
+    for (void* buffer : buffers) {
+      aligned_free(buffer);
+    }
+  }
+}
+
+Tensor TensorPool::GetTensor(Tensor::ElementType element_type,
+                             const Tensor::Shape& shape) {
+  return GetTensor(element_type, shape, Tensor::QuantizationParameters());
+}
+
+Tensor TensorPool::GetTensor(
+    Tensor::ElementType element_type, const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  return Tensor(element_type, shape, quantization_parameters,
+                shared_from_this());
+}
+
+void* TensorPool::Allocate(size_t bytes) {
+  {
+    absl::MutexLock lock(&mutex_);
+    stats_.in_use_bytes += bytes;
+    stats_.high_water_bytes =
+        std::max(stats_.high_water_bytes, stats_.in_use_bytes);
+    auto it = available_.find(bytes);
+    if (it != available_.end() && !it->second.empty()) {
+      void* buffer = it->second.back();
+      it->second.pop_back();
+      stats_.available_bytes -= bytes;
+      ++stats_.num_reuses;
+      return buffer;
+    }
+    ++stats_.num_allocations;
+  }
+  // Allocate outside the lock; large buffers can take a while to map.
+  return aligned_malloc(bytes, Tensor::kCpuBufferAlignment);
+}
+
+void TensorPool::Deallocate(void* buffer, size_t bytes) {
+  {
+    absl::MutexLock lock(&mutex_);
+    stats_.in_use_bytes -= bytes;
+    std::vector<void*>& buffers = available_[bytes];
+    if (buffers.size() < options_.keep_count &&
+        stats_.available_bytes + bytes <= options_.max_available_bytes) {
+      buffers.push_back(buffer);
+      stats_.available_bytes += bytes;
+      return;
+    }
+  }
+  // The surplus buffer is released without holding the lock.
+  aligned_free(buffer);
+}
+
+TensorPool::Stats TensorPool::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace mediapipe
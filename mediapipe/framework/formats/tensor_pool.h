@@ -0,0 +1,108 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// A pool of CPU tensor buffers that are recycled across frames.
+//
+// Tensors created by GetTensor() take their CPU buffer from the pool and hand
+// it back when they are destroyed, so that a graph producing tensors of the
+// same sizes on every frame stops allocating after the first few frames.
+// Buffers are grouped by size in bytes, so tensors of different element types
+// or shapes share buffers as long as they have the same size, and all buffers
+// are aligned to Tensor::kCpuBufferAlignment.
+//
+// The pool is thread-safe. It is shared by the calculators of a graph through
+// kTensorPoolService.
+class TensorPool : public TensorCpuBufferAllocator,
+                   public std::enable_shared_from_this<TensorPool> {
+ public:
+  struct Options {
+    // Keep at most this many unused buffers of a given size.
+    int keep_count = 4;
+    // Free returned buffers instead of keeping them once this many bytes are
+    // kept unused.
+    int64_t max_available_bytes = 64 << 20;
+  };
+
+  // Usage statistics, in bytes unless noted otherwise.
+  struct Stats {
+    // Bytes held by tensors right now.
+    int64_t in_use_bytes = 0;
+    // Maximum of in_use_bytes since the pool was created.
+    int64_t high_water_bytes = 0;
+    // Bytes kept for reuse.
+    int64_t available_bytes = 0;
+    // Number of buffers allocated from the system.
+    int64_t num_allocations = 0;
+    // Number of buffers served from the pool.
+    int64_t num_reuses = 0;
+  };
+
+  // We enforce creation as a shared_ptr so that tensors can keep the pool
+  // alive until their buffers are returned.
+  static std::shared_ptr<TensorPool> Create() { return Create(Options()); }
+  static std::shared_ptr<TensorPool> Create(const Options& options) {
+    return std::shared_ptr<TensorPool>(new TensorPool(options));
+  }
+  ~TensorPool() override;
+
+  // Returns a tensor whose CPU buffer is taken from the pool. The buffer is
+  // allocated lazily, on the first CPU view.
+  Tensor GetTensor(Tensor::ElementType element_type,
+                   const Tensor::Shape& shape);
+  Tensor GetTensor(
+      Tensor::ElementType element_type, const Tensor::Shape& shape,
+      const Tensor::QuantizationParameters& quantization_parameters);
+
+  // TensorCpuBufferAllocator.
+  void* Allocate(size_t bytes) override ABSL_LOCKS_EXCLUDED(mutex_);
+  void Deallocate(void* buffer, size_t bytes) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  Stats GetStats() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  explicit TensorPool(const Options& options) : options_(options) {}
+
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  // Unused buffers, by size.
+  absl::flat_hash_map<size_t, std::vector<void*>> available_
+      ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Provides a TensorPool shared by all calculators in a graph. Created on
+// demand when a calculator requests it.
+inline constexpr GraphService<TensorPool> kTensorPoolService(
+    "TensorPoolService", GraphServiceBase::kAllowDefaultInitialization);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
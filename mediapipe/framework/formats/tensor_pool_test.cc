@@ -0,0 +1,96 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kKeepCount = 2;
+
+class TensorPoolTest : public ::testing::Test {
+ protected:
+  TensorPoolTest() {
+    TensorPool::Options options;
+    options.keep_count = kKeepCount;
+    pool_ = TensorPool::Create(options);
+  }
+
+  // Creates a tensor from the pool and allocates its CPU buffer.
+  Tensor GetTensor(const Tensor::Shape& shape) {
+    Tensor tensor = pool_->GetTensor(Tensor::ElementType::kFloat32, shape);
+    auto view = tensor.GetCpuWriteView();
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(view.buffer<float>()) %
+                     Tensor::kCpuBufferAlignment);
+    return tensor;
+  }
+
+  std::shared_ptr<TensorPool> pool_;
+};
+
+TEST_F(TensorPoolTest, ReusesBuffers) {
+  const float* buffer;
+  {
+    Tensor tensor = GetTensor({1, 8, 8, 3});
+    buffer = tensor.GetCpuReadView().buffer<float>();
+    EXPECT_EQ(8 * 8 * 3 * sizeof(float), pool_->GetStats().in_use_bytes);
+  }
+  TensorPool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(0, stats.in_use_bytes);
+  EXPECT_EQ(8 * 8 * 3 * sizeof(float), stats.available_bytes);
+
+  // A tensor of a different shape but the same size gets the same buffer.
+  Tensor tensor = GetTensor({192});
+  EXPECT_EQ(buffer, tensor.GetCpuReadView().buffer<float>());
+  stats = pool_->GetStats();
+  EXPECT_EQ(1, stats.num_allocations);
+  EXPECT_EQ(1, stats.num_reuses);
+}
+
+TEST_F(TensorPoolTest, KeepsLimitedBuffers) {
+  std::vector<Tensor> tensors;
+  for (int i = 0; i <= kKeepCount; ++i) {
+    tensors.push_back(GetTensor({16}));
+  }
+  EXPECT_EQ((kKeepCount + 1) * 16 * sizeof(float),
+            pool_->GetStats().high_water_bytes);
+  tensors.clear();
+  TensorPool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(kKeepCount * 16 * sizeof(float), stats.available_bytes);
+  EXPECT_EQ((kKeepCount + 1) * 16 * sizeof(float), stats.high_water_bytes);
+}
+
+TEST_F(TensorPoolTest, MovedTensorReturnsBuffer) {
+  Tensor tensor = GetTensor({4});
+  Tensor moved = std::move(tensor);
+  EXPECT_EQ(4 * sizeof(float), pool_->GetStats().in_use_bytes);
+  moved = Tensor(Tensor::ElementType::kFloat32, {4});
+  EXPECT_EQ(0, pool_->GetStats().in_use_bytes);
+}
+
+TEST_F(TensorPoolTest, TensorOutlivesPool) {
+  Tensor tensor = GetTensor({4});
+  pool_ = nullptr;
+  // The tensor keeps the pool alive until its buffer is returned.
+  tensor.GetCpuWriteView().buffer<float>()[0] = 1.0f;
+}
+
+}  // namespace
+}  // namespace mediapipe
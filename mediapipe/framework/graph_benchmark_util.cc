@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_benchmark_util.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+CalculatorGraphConfig MakePassThroughChainsConfig(int num_chains,
+                                                  int chain_length) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("input");
+  for (int i = 0; i < num_chains; ++i) {
+    std::string input = "input";
+    for (int j = 0; j < chain_length; ++j) {
+      auto* node = config.add_node();
+      node->set_calculator("PassThroughCalculator");
+      node->add_input_stream(input);
+      input = absl::StrCat("chain", i, "_", j);
+      node->add_output_stream(input);
+    }
+  }
+  return config;
+}
+
+void RunGraphBenchmark(benchmark::State& state,
+                       const CalculatorGraphConfig& config, int num_packets) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    CalculatorGraph graph;
+    CHECK_OK(graph.Initialize(config));
+    state.ResumeTiming();
+
+    CHECK_OK(graph.StartRun({}));
+    for (int i = 0; i < num_packets; ++i) {
+      CHECK_OK(graph.AddPacketToInputStream(
+          "input", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    CHECK_OK(graph.CloseAllInputStreams());
+    CHECK_OK(graph.WaitUntilDone());
+  }
+  const double invocations = static_cast<double>(state.iterations()) *
+                             num_packets * config.node_size();
+  state.SetItemsProcessed(invocations);
+  state.counters["time_per_invocation"] = benchmark::Counter(
+      invocations, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+}  // namespace mediapipe
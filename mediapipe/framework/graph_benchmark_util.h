@@ -0,0 +1,37 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_GRAPH_BENCHMARK_UTIL_H_
+#define MEDIAPIPE_FRAMEWORK_GRAPH_BENCHMARK_UTIL_H_
+
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe {
+
+// Returns a graph whose input stream "input" feeds "num_chains" parallel
+// chains of "chain_length" PassThroughCalculators. The nodes do almost no
+// work, so the time to run the graph is dominated by scheduling.
+CalculatorGraphConfig MakePassThroughChainsConfig(int num_chains,
+                                                  int chain_length);
+
+// Runs the graph "config" once per benchmark iteration, sending "num_packets"
+// packets into its input stream "input". Graph initialization is not timed.
+// Reports node invocations as items, and the time per invocation.
+void RunGraphBenchmark(benchmark::State& state,
+                       const CalculatorGraphConfig& config, int num_packets);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_GRAPH_BENCHMARK_UTIL_H_
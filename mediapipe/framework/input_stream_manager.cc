@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -27,6 +28,13 @@
 
 namespace mediapipe {
 
+namespace {
+
+// Packet ring capacity used when the stream has no maximum queue size.
+constexpr int kUnboundedRingCapacity = 64;
+
+}  // namespace
+
 absl::Status InputStreamManager::Initialize(const std::string& name,
                                             const PacketType* packet_type,
                                             bool back_edge) {
@@ -46,9 +54,14 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
+int InputStreamManager::RingCapacity(int max_queue_size) {
+  return max_queue_size == -1 ? kUnboundedRingCapacity : max_queue_size;
+}
+
 void InputStreamManager::PrepareForRun() {
   absl::MutexLock stream_lock(&stream_mutex_);
-  queue_.clear();
+  queue_.Reset(RingCapacity(max_queue_size_));
+  queue_capacity_frozen_ = false;
   last_reported_stream_full_ = false;
   num_packets_added_ = 0;
   next_timestamp_bound_ = Timestamp::PreStream();
@@ -58,16 +71,16 @@ void InputStreamManager::PrepareForRun() {
 }
 
 bool InputStreamManager::IsEmpty() const {
-  absl::MutexLock stream_lock(&stream_mutex_);
-  return queue_.empty();
+  absl::MutexLockMaybe stream_lock(StreamMutex());
+  return queue_.Empty();
 }
 
 Packet InputStreamManager::QueueHead() const {
-  absl::MutexLock stream_lock(&stream_mutex_);
-  if (queue_.empty()) {
+  absl::MutexLockMaybe stream_lock(StreamMutex());
+  if (queue_.Empty()) {
     return Packet();
   }
-  return queue_.front();
+  return queue_.Front();
 }
 
 absl::Status InputStreamManager::SetHeader(const Packet& header) {
@@ -98,15 +111,11 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
   bool queue_became_full = false;
   {
     // Scope to prevent locking the stream when notification is called.
-    absl::MutexLock stream_lock(&stream_mutex_);
+    absl::MutexLockMaybe stream_lock(StreamMutex());
     if (closed_) {
       return absl::OkStatus();
     }
-    // Check if the queue was full before packets came in.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-    // Check if the queue becomes non-empty.
-    queue_became_non_empty = queue_.empty() && !container.empty();
+    int num_packets_pushed = 0;
     for (auto& packet : container) {
       absl::Status result = packet_type_->Validate(packet);
       if (!result.ok()) {
@@ -135,12 +144,13 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                  << "\", a packet at Timestamp::PostStream() must be the only "
                     "Packet in an InputStream.";
         }
-        if (timestamp < next_timestamp_bound_) {
+        const Timestamp next_timestamp_bound = next_timestamp_bound_;
+        if (timestamp < next_timestamp_bound) {
           return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
                  << "Packet timestamp mismatch on a calculator receiving from "
                     "stream \""
                  << name_ << "\". Current minimum expected timestamp is "
-                 << next_timestamp_bound_.DebugString() << " but received "
+                 << next_timestamp_bound.DebugString() << " but received "
                  << timestamp.DebugString()
                  << ". Are you using a custom InputStreamHandler? Note that "
                     "some InputStreamHandlers allow timestamps that are not "
@@ -148,29 +158,45 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                     "ImmediateInputStreamHandler class comment.";
         }
       }
-      next_timestamp_bound_ = timestamp.NextAllowedInStream();
 
       // If the caller is MovePackets(), packet's underlying holder should be
       // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
       ++num_packets_added_;
       VLOG(3) << "Input stream:" << name_
-              << " has added packet at time: " << packet.Timestamp();
+              << " has added packet at time: " << timestamp;
       if (std::is_const<
               typename std::remove_reference<Container>::type>::value) {
-        queue_.emplace_back(packet);
+        queue_.Push(packet);
       } else {
-        queue_.emplace_back(std::move(packet));
+        queue_.Push(std::move(packet));
       }
+      ++num_packets_pushed;
+      // The bound is advanced after the packet is queued, so a consumer never
+      // sees a bound past a packet that it cannot see yet.
+      AdvanceNextTimestampBound(timestamp.NextAllowedInStream());
+    }
+    // The size is read after the packets are pushed. In single-producer mode
+    // the consumer may have popped some of them already, but a queue that
+    // held no other packet, or that was below the maximum before this call,
+    // is always detected. Spurious notifications are harmless.
+    if (single_producer_ && closed_) {
+      // The consumer closed the stream concurrently and no longer reads it.
+      return absl::OkStatus();
     }
-    queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
-                         queue_.size() >= max_queue_size_);
-    if (queue_.size() > 1) {
+    const int queue_size = queue_.Size();
+    const int max_queue_size = max_queue_size_;
+    queue_became_non_empty =
+        num_packets_pushed > 0 && queue_size <= num_packets_pushed;
+    queue_became_full = max_queue_size != -1 &&
+                        queue_size - num_packets_pushed < max_queue_size &&
+                        queue_size >= max_queue_size;
+    if (queue_size > 1) {
       VLOG(3) << "Queue size greater than 1: stream name: " << name_
-              << " queue_size: " << queue_.size();
+              << " queue_size: " << queue_size;
     }
     VLOG(3) << "Input stream:" << name_
             << " becomes non-empty status:" << queue_became_non_empty
-            << " Size: " << queue_.size();
+            << " Size: " << queue_size;
   }
   if (queue_became_full) {
     VLOG(3) << "Queue became full: " << Name();
@@ -185,28 +211,31 @@ absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
   *notify = false;
   {
     // Scope to prevent locking the stream when notification is called.
-    absl::MutexLock stream_lock(&stream_mutex_);
+    absl::MutexLockMaybe stream_lock(StreamMutex());
     if (closed_) {
       return absl::OkStatus();
     }
 
-    if (enable_timestamps_ && bound < next_timestamp_bound_) {
+    const Timestamp next_timestamp_bound = next_timestamp_bound_;
+    if (enable_timestamps_ && bound < next_timestamp_bound) {
       return mediapipe::UnknownErrorBuilder(MEDIAPIPE_LOC)
              << "SetNextTimestampBound must be called with a timestamp greater "
                 "than or equal to the current bound. In stream \""
              << name_ << "\". Current minimum expected timestamp is "
-             << next_timestamp_bound_.DebugString() << " but received "
+             << next_timestamp_bound.DebugString() << " but received "
              << bound.DebugString();
     }
 
     // Even if enable_timestamps_ is false, Timestamp::Done() is used to
     // indicate the end of stream. So this code is common to both timed and
     // untimed scheduling policies.
-    if (bound > next_timestamp_bound_) {
-      next_timestamp_bound_ = bound;
+    if (bound > next_timestamp_bound) {
+      AdvanceNextTimestampBound(bound);
       VLOG(3) << "Next timestamp bound for input " << name_ << " is "
-              << next_timestamp_bound_;
-      if (queue_.empty()) {
+              << next_timestamp_bound_.load();
+      // The emptiness check comes after the bound update, so a consumer that
+      // found the queue empty either sees the new bound or is notified.
+      if (queue_.Empty()) {
         // If the queue was not empty then a change to the next_timestamp_bound_
         // is not detectable by the consumer.
         *notify = true;
@@ -216,10 +245,31 @@ absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
   return absl::OkStatus();
 }
 
+void InputStreamManager::AdvanceNextTimestampBound(Timestamp bound) {
+  if (!single_producer_) {
+    next_timestamp_bound_ = bound;
+    return;
+  }
+  // In single-producer mode the consumer may concurrently raise the bound in
+  // PopPacketAtTimestamp() or set it to Timestamp::Done() in Close().
+  Timestamp current = next_timestamp_bound_.load();
+  while (current != Timestamp::Done() &&
+         (!enable_timestamps_ || current < bound) &&
+         !next_timestamp_bound_.compare_exchange_weak(current, bound)) {
+  }
+}
+
 void InputStreamManager::DisableTimestamps() { enable_timestamps_ = false; }
 
+void InputStreamManager::EnableSingleProducer() { single_producer_ = true; }
+
+void InputStreamManager::FreezeQueueCapacity() {
+  absl::MutexLock lock(&stream_mutex_);
+  queue_capacity_frozen_ = true;
+}
+
 void InputStreamManager::Close() {
-  absl::MutexLock stream_lock(&stream_mutex_);
+  absl::MutexLockMaybe stream_lock(StreamMutex());
   if (closed_) {
     return;
   }
@@ -229,16 +279,31 @@ void InputStreamManager::Close() {
 }
 
 Timestamp InputStreamManager::MinTimestampOrBound(bool* is_empty) const {
-  absl::MutexLock stream_lock(&stream_mutex_);
+  absl::MutexLockMaybe stream_lock(StreamMutex());
+  bool queue_is_empty;
+  const Timestamp result = MinTimestampOrBoundHelper(&queue_is_empty);
   if (is_empty) {
-    *is_empty = queue_.empty();
+    *is_empty = queue_is_empty;
   }
-  return MinTimestampOrBoundHelper();
+  return result;
 }
 
-Timestamp InputStreamManager::MinTimestampOrBoundHelper() const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_) {
-  return queue_.empty() ? next_timestamp_bound_ : queue_.front().Timestamp();
+Timestamp InputStreamManager::MinTimestampOrBoundHelper(bool* is_empty) const {
+  while (true) {
+    const Timestamp front_timestamp = queue_.FrontTimestamp();
+    if (front_timestamp != Timestamp::Unset()) {
+      *is_empty = false;
+      return front_timestamp;
+    }
+    // The producer queues a packet before advancing the bound past it, so if
+    // the queue is still empty after the bound is read, no packet below the
+    // bound can show up later.
+    const Timestamp bound = next_timestamp_bound_;
+    if (queue_.Empty()) {
+      *is_empty = true;
+      return bound;
+    }
+  }
 }
 
 Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
@@ -250,45 +315,48 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
   bool queue_became_non_full = false;
   Packet packet;
   {
-    absl::MutexLock stream_lock(&stream_mutex_);
+    absl::MutexLockMaybe stream_lock(StreamMutex());
     // Make sure timestamp didn't decrease from last time.
-    CHECK_LE(last_select_timestamp_, timestamp);
+    CHECK_LE(last_select_timestamp_.load(), timestamp);
     last_select_timestamp_ = timestamp;
 
     // Make sure AddPacket and SetNextTimestampBound are not called with
     // timestamps we have already passed.
-    if (next_timestamp_bound_ <= timestamp) {
-      next_timestamp_bound_ = timestamp.NextAllowedInStream();
+    if (next_timestamp_bound_.load() <= timestamp) {
+      AdvanceNextTimestampBound(timestamp.NextAllowedInStream());
     }
 
     VLOG(3) << "Input stream " << name_
             << " selecting at timestamp:" << timestamp.Value()
-            << " next timestamp bound: " << next_timestamp_bound_;
+            << " next timestamp bound: " << next_timestamp_bound_.load();
 
     // Advances time to timestamp.
     Timestamp current_timestamp = Timestamp::Unset();
 
-    // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-
-    while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
-      packet = std::move(queue_.front());
-      queue_.pop_front();
+    int num_packets_popped = 0;
+    while (!queue_.Empty() && queue_.Front().Timestamp() <= timestamp) {
+      packet = queue_.Pop();
       current_timestamp = packet.Timestamp();
+      ++num_packets_popped;
       ++(*num_packets_dropped);
     }
     // Clear value_ if it doesn't have exactly the right timestamp.
     if (current_timestamp != timestamp) {
       // The timestamp bound reported when no packet is sent.
-      Timestamp bound = MinTimestampOrBoundHelper();
+      bool is_empty;
+      Timestamp bound = MinTimestampOrBoundHelper(&is_empty);
       packet = Packet().At(bound.PreviousAllowedInStream());
       ++(*num_packets_dropped);
     }
 
+    const int queue_size = queue_.Size();
     VLOG(3) << "Input stream removed packets:" << name_
-            << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+            << " Size:" << queue_size;
+    // Checks if the queue was full before the packets were popped.
+    const int max_queue_size = max_queue_size_;
+    queue_became_non_full = max_queue_size != -1 &&
+                            queue_size + num_packets_popped >= max_queue_size &&
+                            queue_size < max_queue_size;
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -304,24 +372,26 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   bool queue_became_non_full = false;
   Packet packet;
   {
-    absl::MutexLock stream_lock(&stream_mutex_);
+    absl::MutexLockMaybe stream_lock(StreamMutex());
 
     VLOG(3) << "Input stream " << name_ << " selecting at queue head";
 
-    // Check if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-
-    if (!queue_.empty()) {
-      packet = std::move(queue_.front());
-      queue_.pop_front();
+    int num_packets_popped = 0;
+    if (!queue_.Empty()) {
+      packet = queue_.Pop();
+      num_packets_popped = 1;
     } else {
       packet = Packet();
     }
 
+    const int queue_size = queue_.Size();
     VLOG(3) << "Input stream removed a packet:" << name_
-            << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+            << " Size:" << queue_size;
+    // Check if the queue was full before the packet was popped.
+    const int max_queue_size = max_queue_size_;
+    queue_became_non_full = max_queue_size != -1 &&
+                            queue_size + num_packets_popped >= max_queue_size &&
+                            queue_size < max_queue_size;
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -331,29 +401,35 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   return packet;
 }
 
-int InputStreamManager::NumPacketsAdded() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return num_packets_added_;
-}
+int InputStreamManager::NumPacketsAdded() const { return num_packets_added_; }
 
 int InputStreamManager::QueueSize() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return static_cast<int>(queue_.size());
+  absl::MutexLockMaybe lock(StreamMutex());
+  return queue_.Size();
 }
 
-int InputStreamManager::MaxQueueSize() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_;
-}
+int InputStreamManager::MaxQueueSize() const { return max_queue_size_; }
 
 void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   bool was_full;
   bool is_full;
   {
+    // Held even in single-producer mode, to serialize the callers and guard
+    // queue_capacity_frozen_. It does not exclude the producer and consumer.
     absl::MutexLock lock(&stream_mutex_);
-    was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    const int queue_size = queue_.Size();
+    was_full = (max_queue_size_ != -1 && queue_size >= max_queue_size_);
     max_queue_size_ = max_queue_size;
-    is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    is_full = (max_queue_size_ != -1 && queue_size >= max_queue_size_);
+    if (!queue_capacity_frozen_) {
+      DCHECK(!single_producer_ || num_packets_added_ == 0)
+          << "Packets were added to single-producer stream \"" << name_
+          << "\" before FreezeQueueCapacity().";
+      if (num_packets_added_ == 0 && queue_size == 0) {
+        // No producer has started yet, so the ring can still be replaced.
+        queue_.Reset(RingCapacity(max_queue_size));
+      }
+    }
   }
 
   // QueueSizeCallback is called with no mutexes held.
@@ -367,33 +443,38 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
 }
 
 bool InputStreamManager::IsFull() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
+  absl::MutexLockMaybe lock(StreamMutex());
+  const int max_queue_size = max_queue_size_;
+  return max_queue_size != -1 && queue_.Size() >= max_queue_size;
 }
 
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
-  absl::MutexLock lock(&stream_mutex_);
-  if (queue_.empty()) {
+  absl::MutexLockMaybe lock(StreamMutex());
+  const int queue_size = queue_.Size();
+  if (queue_size == 0) {
     return Timestamp::Unset();
   }
-  return (queue_.cend() - std::min((size_t)n, queue_.size()))->Timestamp();
+  return queue_.TimestampAt(queue_size - std::min(n, queue_size));
 }
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
   bool queue_became_non_full = false;
   {
-    absl::MutexLock lock(&stream_mutex_);
-    // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-
-    while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
-      queue_.pop_front();
+    absl::MutexLockMaybe lock(StreamMutex());
+    int num_packets_popped = 0;
+    while (!queue_.Empty() && queue_.Front().Timestamp() < timestamp) {
+      queue_.Pop();
+      ++num_packets_popped;
     }
 
+    const int queue_size = queue_.Size();
     VLOG(3) << "Input stream removed packets:" << name_
-            << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+            << " Size:" << queue_size;
+    // Checks if the queue was full before the packets were popped.
+    const int max_queue_size = max_queue_size_;
+    queue_became_non_full = max_queue_size != -1 &&
+                            queue_size + num_packets_popped >= max_queue_size &&
+                            queue_size < max_queue_size;
   }
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
@@ -402,7 +483,9 @@ void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
 }
 
 bool InputStreamManager::IsDone() const {
-  return queue_.empty() && next_timestamp_bound_ == Timestamp::Done();
+  // The bound is read first: once it is Timestamp::Done(), every packet the
+  // producer added is visible to the emptiness check.
+  return next_timestamp_bound_.load() == Timestamp::Done() && queue_.Empty();
 }
 
 }  // namespace mediapipe
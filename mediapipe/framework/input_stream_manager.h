@@ -15,7 +15,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
-#include <deque>
+#include <atomic>
 #include <functional>
 #include <list>
 #include <string>
@@ -27,6 +27,7 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/spsc_packet_queue.h"
 #include "mediapipe/framework/timestamp.h"
 
 namespace mediapipe {
@@ -43,6 +44,10 @@ namespace mediapipe {
 // An input stream is written to by exactly one output stream and is read by a
 // single node. None of its methods should hold a lock when they invoke a
 // callback in the scheduler.
+//
+// By default every method locks the stream. If EnableSingleProducer() is
+// called, the stream relies on the producer and consumer sides each being
+// serialized, and exchanges packets through a lock-free ring buffer instead.
 class InputStreamManager {
  public:
   // Function type for becomes_full_callback and becomes_not_full_callback.
@@ -117,6 +122,24 @@ class InputStreamManager {
   // Turns off the use of packet timestamps.
   void DisableTimestamps();
 
+  // Declares that AddPackets(), MovePackets() and SetNextTimestampBound() are
+  // never called concurrently with each other, and that the remaining
+  // mutating methods are only called by the consumer node, one at a time.
+  // The stream then stops taking stream_mutex_; packets are passed through a
+  // lock-free single-producer/single-consumer ring sized from the max queue
+  // size, and the timestamp bound is updated atomically. Must be called
+  // before the graph starts running.
+  void EnableSingleProducer();
+
+  // Returns true if EnableSingleProducer() has been called.
+  bool SingleProducer() const { return single_producer_; }
+
+  // Stops SetMaxQueueSize() from resizing the packet ring until the next
+  // PrepareForRun(). Must be called before any producer or consumer can
+  // access the stream, since in single-producer mode they access the ring
+  // without stream_mutex_.
+  void FreezeQueueCapacity() ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns true iff the queue is empty.
   bool IsEmpty() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
@@ -156,7 +179,9 @@ class InputStreamManager {
 
   // Sets the maximum queue size for the stream. Used to determine when the
   // callbacks for becomes_full and becomes_not_full should be invoked. A value
-  // of -1 means that there is no maximum queue size.
+  // of -1 means that there is no maximum queue size. Until
+  // FreezeQueueCapacity() is called, and if no packet has been added since
+  // PrepareForRun(), the packet ring is also resized to match.
   void SetMaxQueueSize(int max_queue_size) ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // If there are equal to or more than n packets in the queue, this function
@@ -190,23 +215,43 @@ class InputStreamManager {
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // Returns true if the next timestamp bound reaches Timestamp::Done().
-  bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+  bool IsDone() const;
+
+  // Returns the smallest timestamp at which this stream might see an input,
+  // and sets "is_empty" to whether the queue was empty.
+  Timestamp MinTimestampOrBoundHelper(bool* is_empty) const;
+
+  // Raises next_timestamp_bound_ to "bound" unless it is already at least as
+  // large, or the stream is done when timestamps are disabled.
+  void AdvanceNextTimestampBound(Timestamp bound);
+
+  // Returns the mutex to hold while accessing the stream, or nullptr in
+  // single-producer mode.
+  absl::Mutex* StreamMutex() const {
+    return single_producer_ ? nullptr : &stream_mutex_;
+  }
 
-  // Returns the smallest timestamp at which this stream might see an input.
-  Timestamp MinTimestampOrBoundHelper() const;
+  // Returns the packet ring capacity for "max_queue_size".
+  static int RingCapacity(int max_queue_size);
 
+  // Held by every method unless single_producer_ is true. The fields below
+  // are atomic so that they can also be shared without it.
   mutable absl::Mutex stream_mutex_;
-  std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
+  internal::SpscPacketQueue queue_;
   // The number of packets added to queue_.  Used to verify a packet at
   // Timestamp::PostStream() is the only Packet in the stream.
-  int64 num_packets_added_ ABSL_GUARDED_BY(stream_mutex_);
-  Timestamp next_timestamp_bound_ ABSL_GUARDED_BY(stream_mutex_);
+  std::atomic<int64> num_packets_added_{0};
+  std::atomic<Timestamp> next_timestamp_bound_;
   // The |timestamp| argument passed to the last SelectAtTimestamp() call.
   // Ignored if enable_timestamps_ is false.
-  Timestamp last_select_timestamp_ ABSL_GUARDED_BY(stream_mutex_);
-  bool closed_ ABSL_GUARDED_BY(stream_mutex_);
+  std::atomic<Timestamp> last_select_timestamp_;
+  std::atomic<bool> closed_{false};
   // True if packet timestamps are used.
   bool enable_timestamps_ = true;
+  // True if the stream is accessed without stream_mutex_.
+  bool single_producer_ = false;
+  // True once the packet ring may no longer be resized.
+  bool queue_capacity_frozen_ ABSL_GUARDED_BY(stream_mutex_) = false;
   std::string name_;
   const PacketType* packet_type_;
   bool back_edge_;
@@ -214,7 +259,7 @@ class InputStreamManager {
   Packet header_;
 
   // The maximum queue size for this stream if set.
-  int max_queue_size_ ABSL_GUARDED_BY(stream_mutex_) = -1;
+  std::atomic<int> max_queue_size_{-1};
 
   // Callback to notify the framework that we have hit the maximum queue size.
   QueueSizeCallback becomes_full_callback_;
@@ -23,6 +23,7 @@
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
 
 namespace mediapipe {
 namespace {
@@ -924,5 +925,88 @@ TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
   EXPECT_TRUE(notify_);
 }
 
+// Runs a producer and a consumer on separate threads in single-producer mode.
+// The consumer settles every timestamp below the reported bound, as the
+// default input stream handler does, so a bound that ran ahead of a queued
+// packet would show up as a dropped packet.
+TEST_F(InputStreamManagerTest, SingleProducerConcurrentAddAndPop) {
+  constexpr int kNumPackets = 20000;
+  input_stream_manager_->EnableSingleProducer();
+  input_stream_manager_->PrepareForRun();
+  int num_popped = 0;
+  int num_dropped = 0;
+  {
+    ThreadPool pool("test", 2);
+    pool.StartWorkers();
+    pool.Schedule([this] {
+      bool notify;
+      for (int i = 0; i < kNumPackets; ++i) {
+        std::list<Packet> packets;
+        packets.push_back(MakePacket<std::string>("x").At(Timestamp(2 * i)));
+        MP_EXPECT_OK(input_stream_manager_->MovePackets(&packets, &notify));
+        if (i % 8 == 0) {
+          MP_EXPECT_OK(input_stream_manager_->SetNextTimestampBound(
+              Timestamp(2 * i + 2), &notify));
+        }
+      }
+      MP_EXPECT_OK(input_stream_manager_->SetNextTimestampBound(
+          Timestamp::Done(), &notify));
+    });
+    pool.Schedule([this, &num_popped, &num_dropped] {
+      bool stream_is_done = false;
+      while (!stream_is_done) {
+        bool is_empty;
+        const Timestamp min_timestamp =
+            input_stream_manager_->MinTimestampOrBound(&is_empty);
+        if (min_timestamp == Timestamp::PreStream()) continue;
+        const Timestamp settled = is_empty
+                                      ? min_timestamp.PreviousAllowedInStream()
+                                      : min_timestamp;
+        int num_packets_dropped = 0;
+        Packet packet = input_stream_manager_->PopPacketAtTimestamp(
+            settled, &num_packets_dropped, &stream_is_done);
+        num_dropped += num_packets_dropped;
+        if (!packet.IsEmpty()) {
+          EXPECT_EQ(Timestamp(2 * num_popped), packet.Timestamp());
+          ++num_popped;
+        }
+      }
+    });
+  }
+  EXPECT_EQ(kNumPackets, num_popped);
+  EXPECT_EQ(0, num_dropped);
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+}
+
+// Raising the max queue size of a running single-producer stream, as deadlock
+// resolution does, keeps the packet ring and the packets spilled past it.
+TEST_F(InputStreamManagerTest, SingleProducerFrozenQueueCapacity) {
+  input_stream_manager_->EnableSingleProducer();
+  input_stream_manager_->PrepareForRun();
+  input_stream_manager_->SetMaxQueueSize(2);
+  input_stream_manager_->FreezeQueueCapacity();
+
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+
+  input_stream_manager_->SetMaxQueueSize(4);
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+  EXPECT_EQ(3, input_stream_manager_->QueueSize());
+  for (int i = 1; i <= 3; ++i) {
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        Timestamp(10 * i), &num_packets_dropped_, &stream_is_done_);
+    EXPECT_EQ(Timestamp(10 * i), popped_packet_.Timestamp());
+    EXPECT_EQ(0, num_packets_dropped_);
+  }
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+
+  expected_queue_becomes_full_count_ = 1;
+  expected_queue_becomes_not_full_count_ = 1;
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -29,6 +29,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/deps/slab_pool.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -47,6 +48,8 @@ class Packet;
 
 namespace packet_internal {
 class HolderBase;
+template <typename T>
+class PooledHolder;
 
 Packet Create(HolderBase* holder);
 Packet Create(HolderBase* holder, Timestamp timestamp);
@@ -325,6 +328,22 @@ Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
       new T{std::forward<typename std::remove_extent<T>::type>(args)...}));
 }
 
+// Like MakePacket, but allocates the payload, its holder and the reference
+// count together as one block from a slab pool dedicated to T, instead of
+// making separate heap allocations. Pooled blocks are recycled when the last
+// packet referring to them is destroyed. Use it for types created at a high
+// rate, e.g. once per frame on many streams.
+template <typename T,
+          typename std::enable_if<!std::is_array<T>::value>::type* = nullptr,
+          typename... Args>
+Packet MakePacketPooled(Args&&... args) {  // NOLINT(build/c++11)
+  return packet_internal::Create(
+      std::allocate_shared<packet_internal::PooledHolder<T>>(
+          SlabPoolAllocator<packet_internal::PooledHolder<T>>(),
+          std::forward<Args>(args)...),
+      Timestamp::Unset());
+}
+
 // Returns a mutable pointer to the data in a unique_ptr in a packet. This
 // is useful in combination with AdoptAsUniquePtr.  The caller must
 // exercise caution when mutating the retrieved data, since the data
@@ -499,6 +518,9 @@ class Holder : public HolderBase, private HolderPayloadRegistrator<T> {
       return InternalError(
           "Foreign holder can't release data ptr without ownership.");
     }
+    if (HasInlinePayload()) {
+      return ReleaseInlinePayload();
+    }
     // Casts away constness to make the data mutable after the release.
     std::unique_ptr<T> data_ptr(const_cast<T*>(ptr_));
     ptr_ = nullptr;
@@ -529,6 +551,15 @@ class Holder : public HolderBase, private HolderPayloadRegistrator<T> {
   // Holder itself may be shared by several Packets.
   const T* ptr_;
 
+  // Returns true if the data is stored inside the holder, in which case ptr_
+  // does not own a separate allocation.
+  virtual bool HasInlinePayload() const { return false; }
+
+  // Moves inline data into a new allocation for Release().
+  virtual absl::StatusOr<std::unique_ptr<T>> ReleaseInlinePayload() {
+    return absl::InternalError("Holder has no inline payload to release.");
+  }
+
   // Returns the MessageLite pointer to the data, if the underlying object type
   // is protocol buffer, otherwise, nullptr is returned.
   const proto_ns::MessageLite* GetProtoMessageLite() override {
@@ -575,6 +606,43 @@ class ForeignHolder : public Holder<T> {
   bool HasForeignOwner() const final { return true; }
 };
 
+// Like Holder, but stores the data in the holder itself. Created by
+// MakePacketPooled() together with the shared_ptr control block in a single
+// block from a per-type SlabPool, so creating and releasing the packet does
+// not go through malloc or free.
+template <typename T>
+class PooledHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit PooledHolder(Args&&... args) : Holder<T>(nullptr) {
+    this->ptr_ = new (&storage_) T(std::forward<Args>(args)...);
+  }
+  ~PooledHolder() override {
+    reinterpret_cast<T*>(&storage_)->~T();
+    // Null out ptr_ so it doesn't get deleted by ~Holder.
+    this->ptr_ = nullptr;
+  }
+
+ protected:
+  bool HasInlinePayload() const final { return true; }
+
+  absl::StatusOr<std::unique_ptr<T>> ReleaseInlinePayload() final {
+    if constexpr (std::is_move_constructible<T>::value) {
+      // The moved-from object is destroyed along with the holder.
+      auto data_ptr = absl::make_unique<T>(
+          std::move(*reinterpret_cast<T*>(&storage_)));
+      this->ptr_ = nullptr;
+      return std::move(data_ptr);
+    } else {
+      return absl::InternalError(
+          "Pooled holder can't release a payload that is not movable.");
+    }
+  }
+
+ private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+};
+
 template <typename T>
 Holder<T>* HolderBase::As() {
   if (PayloadIsOfType<T>()) {
@@ -0,0 +1,108 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares MakePacket and MakePacketPooled on a simulated frame: one packet is
+// created on each of kNumStreams streams, copied to two consumers, and
+// released. Reports heap allocations per frame, counted by replacing the
+// global operator new.
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/packet.h"
+
+namespace {
+
+std::atomic<int64_t> num_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t align = static_cast<size_t>(alignment);
+  if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumStreams = 200;
+
+// A small fixed-size payload, typical of per-frame metadata.
+struct Rect {
+  float x_center = 0;
+  float y_center = 0;
+  float width = 0;
+  float height = 0;
+  float rotation = 0;
+  int64_t rect_id = 0;
+};
+
+template <typename T, bool kPooled>
+Packet MakeFramePacket() {
+  if constexpr (kPooled) {
+    return MakePacketPooled<T>();
+  } else {
+    return MakePacket<T>();
+  }
+}
+
+template <typename T, bool kPooled>
+void BM_PacketsPerFrame(benchmark::State& state) {
+  std::vector<Packet> consumers(2 * kNumStreams);
+  int64_t frame = 0;
+  const int64_t allocations_before = num_allocations.load();
+  for (auto _ : state) {
+    for (int i = 0; i < kNumStreams; ++i) {
+      Packet packet = MakeFramePacket<T, kPooled>().At(Timestamp(frame));
+      consumers[2 * i] = packet;
+      consumers[2 * i + 1] = std::move(packet);
+    }
+    for (Packet& packet : consumers) {
+      benchmark::DoNotOptimize(packet.Get<T>());
+      packet = Packet();
+    }
+    ++frame;
+  }
+  state.counters["allocs_per_frame"] = benchmark::Counter(
+      static_cast<double>(num_allocations.load() - allocations_before) /
+      state.iterations());
+  state.SetItemsProcessed(state.iterations() * kNumStreams);
+}
+
+BENCHMARK_TEMPLATE(BM_PacketsPerFrame, int64_t, false);
+BENCHMARK_TEMPLATE(BM_PacketsPerFrame, int64_t, true);
+BENCHMARK_TEMPLATE(BM_PacketsPerFrame, Rect, false);
+BENCHMARK_TEMPLATE(BM_PacketsPerFrame, Rect, true);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -517,5 +517,60 @@ TEST(PacketTest, SharedPtrWithPacketOwnership) {
   EXPECT_EQ(exist, false);
 }
 
+TEST(PacketTest, MakePacketPooled) {
+  bool exist = false;
+  const MyClass* payload = nullptr;
+  {
+    Packet packet = MakePacketPooled<MyClass>(&exist).At(Timestamp(1));
+    EXPECT_TRUE(exist);
+    payload = &packet.Get<MyClass>();
+    MP_EXPECT_OK(packet.ValidateAsType<MyClass>());
+    EXPECT_EQ(0, packet.Get<MyClass>().value());
+    Packet packet_copy = packet;
+    EXPECT_EQ(packet, packet_copy);
+    // SharedPtrWithPacket keeps the pooled holder alive.
+    std::shared_ptr<const MyClass> ptr = SharedPtrWithPacket<MyClass>(packet);
+    packet = {};
+    packet_copy = {};
+    EXPECT_TRUE(exist);
+    EXPECT_EQ(0, ptr->value());
+  }
+  EXPECT_FALSE(exist);
+  // The released block is reused by the next packet on this thread.
+  Packet packet = MakePacketPooled<MyClass>(&exist);
+  EXPECT_EQ(payload, &packet.Get<MyClass>());
+}
+
+TEST(PacketTest, PooledPacketConsume) {
+  Packet packet1 = MakePacketPooled<std::string>("pooled");
+  Packet packet_copy = packet1;
+  EXPECT_EQ(packet_copy.Consume<std::string>().status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  packet_copy = {};
+
+  // The sole owner moves the payload out of the pooled holder.
+  absl::StatusOr<std::unique_ptr<std::string>> result =
+      packet1.Consume<std::string>();
+  MP_ASSERT_OK(result);
+  EXPECT_EQ("pooled", *result.value());
+  EXPECT_TRUE(packet1.IsEmpty());
+
+  Packet packet2 = MakePacketPooled<std::string>("copied");
+  Packet packet2_copy = packet2;
+  bool was_copied = false;
+  result = packet2_copy.ConsumeOrCopy<std::string>(&was_copied);
+  MP_ASSERT_OK(result);
+  EXPECT_TRUE(was_copied);
+  EXPECT_EQ("copied", *result.value());
+  EXPECT_EQ("copied", packet2.Get<std::string>());
+
+  // MyClass is not movable, so it can only be shared, not consumed.
+  bool exist = false;
+  Packet packet3 = MakePacketPooled<MyClass>(&exist);
+  EXPECT_FALSE(packet3.Consume<MyClass>().ok());
+  EXPECT_FALSE(packet3.IsEmpty());
+  EXPECT_TRUE(exist);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/profiler/graph_profiler.h"
 
+#include <algorithm>
 #include <fstream>
 #include <list>
 
@@ -67,6 +68,14 @@ bool IsProfilerEnabled(const ProfilerConfig& profiler_config) {
   return profiler_config.enable_profiler();
 }
 
+// Returns the precision of the log-bucketed histograms.
+int GetLogHistogramPrecisionBits(const ProfilerConfig& profiler_config) {
+  int precision_bits = profiler_config.log_histogram_precision_bits();
+  precision_bits =
+      precision_bits ? precision_bits : kDefaultLogHistogramPrecisionBits;
+  return std::clamp(precision_bits, 1, kMaxLogHistogramPrecisionBits);
+}
+
 // Returns true if trace events are recorded.
 bool IsTracerEnabled(const ProfilerConfig& profiler_config) {
   return profiler_config.trace_enabled();
@@ -188,6 +197,9 @@ void GraphProfiler::Initialize(
       InitializeInputStreams(node_config, interval_size_usec, num_intervals,
                              &profile);
     }
+    if (profiler_config_.use_log_histograms()) {
+      InitializeLogHistograms(&profile);
+    }
 
     auto iter = calculator_profiles_.insert({node_name, profile});
     CHECK(iter.second) << absl::Substitute(
@@ -236,6 +248,17 @@ void GraphProfiler::Reset() {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
     }
   }
+  for (auto& entry : calculator_histograms_) {
+    CalculatorHistograms* histograms = entry.second.get();
+    histograms->process_runtime.Clear();
+    histograms->process_input_latency.Clear();
+    histograms->process_output_latency.Clear();
+    for (auto& latency : histograms->input_stream_latencies) {
+      if (latency) {
+        latency->Clear();
+      }
+    }
+  }
 }
 
 // Begins profiling for a single graph run.
@@ -337,6 +360,26 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
       << "GetCalculatorProfiles can only be called after Initialize()";
   for (auto& entry : calculator_profiles_) {
     profiles->push_back(entry.second);
+    auto histograms_iter = calculator_histograms_.find(entry.first);
+    if (histograms_iter == calculator_histograms_.end()) {
+      continue;
+    }
+    // Merges the samples of the log-bucketed histograms.
+    const CalculatorHistograms& histograms = *histograms_iter->second;
+    CalculatorProfile& profile = profiles->back();
+    histograms.process_runtime.ToProto(profile.mutable_process_runtime());
+    if (profiler_config_.enable_stream_latency()) {
+      histograms.process_input_latency.ToProto(
+          profile.mutable_process_input_latency());
+      histograms.process_output_latency.ToProto(
+          profile.mutable_process_output_latency());
+      for (int i = 0; i < histograms.input_stream_latencies.size(); ++i) {
+        if (histograms.input_stream_latencies[i]) {
+          histograms.input_stream_latencies[i]->ToProto(
+              profile.mutable_input_stream_profiles(i)->mutable_latency());
+        }
+      }
+    }
   }
   return absl::OkStatus();
 }
@@ -372,6 +415,33 @@ void GraphProfiler::InitializeInputStreams(
   }
 }
 
+void GraphProfiler::InitializeLogHistograms(
+    CalculatorProfile* calculator_profile) {
+  const int precision_bits = GetLogHistogramPrecisionBits(profiler_config_);
+  auto histograms = std::make_unique<CalculatorHistograms>(precision_bits);
+  auto set_log_scale = [precision_bits](TimeHistogram* histogram) {
+    histogram->Clear();
+    histogram->set_scale(TimeHistogram::LOG);
+    histogram->set_precision_bits(precision_bits);
+  };
+  set_log_scale(calculator_profile->mutable_process_runtime());
+  if (calculator_profile->has_process_input_latency()) {
+    set_log_scale(calculator_profile->mutable_process_input_latency());
+  }
+  if (calculator_profile->has_process_output_latency()) {
+    set_log_scale(calculator_profile->mutable_process_output_latency());
+  }
+  for (auto& input_stream_profile :
+       *calculator_profile->mutable_input_stream_profiles()) {
+    set_log_scale(input_stream_profile.mutable_latency());
+    histograms->input_stream_latencies.push_back(
+        input_stream_profile.back_edge()
+            ? nullptr
+            : std::make_unique<LogHistogram>(precision_bits));
+  }
+  calculator_histograms_[calculator_profile->name()] = std::move(histograms);
+}
+
 std::set<int> GraphProfiler::GetBackEdgeIds(
     const CalculatorGraphConfig::Node& node_config,
     const TagMap& input_tag_map) {
@@ -424,10 +494,11 @@ void GraphProfiler::AddPacketInfoForOutputPackets(
 
 int64 GraphProfiler::AddStreamLatencies(
     const CalculatorContext& calculator_context, int64 start_time_usec,
-    int64 end_time_usec, CalculatorProfile* calculator_profile) {
+    int64 end_time_usec, CalculatorProfile* calculator_profile,
+    CalculatorHistograms* histograms) {
   // Update input streams profiles.
   int64 min_source_process_start_usec = AddInputStreamTimeSamples(
-      calculator_context, start_time_usec, calculator_profile);
+      calculator_context, start_time_usec, calculator_profile, histograms);
 
   // Update output production times.
   AddPacketInfoForOutputPackets(calculator_context.Outputs(), end_time_usec,
@@ -452,8 +523,12 @@ void GraphProfiler::SetOpenRuntime(const CalculatorContext& calculator_context,
   calculator_profile->set_open_runtime(time_usec);
 
   if (profiler_config_.enable_stream_latency()) {
+    CalculatorHistograms* histograms =
+        profiler_config_.use_log_histograms()
+            ? GetCalculatorHistograms(calculator_context)
+            : nullptr;
     AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
-                       calculator_profile);
+                       calculator_profile, histograms);
   }
 }
 
@@ -474,8 +549,12 @@ void GraphProfiler::SetCloseRuntime(const CalculatorContext& calculator_context,
   calculator_profile->set_close_runtime(time_usec);
 
   if (profiler_config_.enable_stream_latency()) {
+    CalculatorHistograms* histograms =
+        profiler_config_.use_log_histograms()
+            ? GetCalculatorHistograms(calculator_context)
+            : nullptr;
     AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
-                       calculator_profile);
+                       calculator_profile, histograms);
   }
 }
 
@@ -497,18 +576,33 @@ void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
   histogram->set_count(interval_index, histogram->count(interval_index) + 1);
 }
 
+void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
+                                  LogHistogram* histogram) {
+  if (end_time_usec < start_time_usec) {
+    LOG(ERROR) << absl::Substitute(
+        "end_time_usec ($0) is < start_time_usec ($1)", end_time_usec,
+        start_time_usec);
+    return;
+  }
+  histogram->Add(end_time_usec - start_time_usec);
+}
+
 int64 GraphProfiler::AddInputStreamTimeSamples(
     const CalculatorContext& calculator_context, int64 start_time_usec,
-    CalculatorProfile* calculator_profile) {
+    CalculatorProfile* calculator_profile, CalculatorHistograms* histograms) {
   int64 input_timestamp_usec = calculator_context.InputTimestamp().Value();
   int64 min_source_process_start_usec = start_time_usec;
   int64 input_stream_counter = -1;
   for (CollectionItemId id = calculator_context.Inputs().BeginId();
        id < calculator_context.Inputs().EndId(); ++id) {
     ++input_stream_counter;
-    if (calculator_context.Inputs().Get(id).Value().IsEmpty() ||
-        calculator_profile->input_stream_profiles(input_stream_counter)
-            .back_edge()) {
+    bool back_edge =
+        histograms
+            ? histograms->input_stream_latencies[input_stream_counter] ==
+                  nullptr
+            : calculator_profile->input_stream_profiles(input_stream_counter)
+                  .back_edge();
+    if (calculator_context.Inputs().Get(id).Value().IsEmpty() || back_edge) {
       continue;
     }
 
@@ -523,10 +617,16 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
                                << PacketIdToString(packet_id);
       continue;
     }
-    AddTimeSample(
-        packet_info->production_time_usec, start_time_usec,
-        calculator_profile->mutable_input_stream_profiles(input_stream_counter)
-            ->mutable_latency());
+    if (histograms) {
+      AddTimeSample(
+          packet_info->production_time_usec, start_time_usec,
+          histograms->input_stream_latencies[input_stream_counter].get());
+    } else {
+      AddTimeSample(packet_info->production_time_usec, start_time_usec,
+                    calculator_profile
+                        ->mutable_input_stream_profiles(input_stream_counter)
+                        ->mutable_latency());
+    }
 
     min_source_process_start_usec = std::min(
         min_source_process_start_usec, packet_info->source_process_start_usec);
@@ -543,6 +643,25 @@ void GraphProfiler::AddProcessSample(
     return;
   }
 
+  if (profiler_config_.use_log_histograms()) {
+    // Only the log-bucketed histograms are updated, which does not lock the
+    // calculator profile.
+    CalculatorHistograms* histograms =
+        GetCalculatorHistograms(calculator_context);
+    AddTimeSample(start_time_usec, end_time_usec,
+                  &histograms->process_runtime);
+    if (profiler_config_.enable_stream_latency()) {
+      int64 min_source_process_start_usec =
+          AddStreamLatencies(calculator_context, start_time_usec,
+                             end_time_usec, nullptr, histograms);
+      AddTimeSample(min_source_process_start_usec, start_time_usec,
+                    &histograms->process_input_latency);
+      AddTimeSample(min_source_process_start_usec, end_time_usec,
+                    &histograms->process_output_latency);
+    }
+    return;
+  }
+
   const std::string& node_name = calculator_context.NodeName();
   auto profile_iter = calculator_profiles_.find(node_name);
   CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
@@ -555,8 +674,9 @@ void GraphProfiler::AddProcessSample(
                 calculator_profile->mutable_process_runtime());
 
   if (profiler_config_.enable_stream_latency()) {
-    int64 min_source_process_start_usec = AddStreamLatencies(
-        calculator_context, start_time_usec, end_time_usec, calculator_profile);
+    int64 min_source_process_start_usec =
+        AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
+                           calculator_profile, nullptr);
     // Update input and output trace latencies.
     AddTimeSample(min_source_process_start_usec, start_time_usec,
                   calculator_profile->mutable_process_input_latency());
@@ -565,6 +685,15 @@ void GraphProfiler::AddProcessSample(
   }
 }
 
+GraphProfiler::CalculatorHistograms* GraphProfiler::GetCalculatorHistograms(
+    const CalculatorContext& calculator_context) const {
+  auto iter = calculator_histograms_.find(calculator_context.NodeName());
+  CHECK(iter != calculator_histograms_.end()) << absl::Substitute(
+      "Calculator \"$0\" has not been added during initialization.",
+      calculator_context.NodeName());
+  return iter->second.get();
+}
+
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
   if (!IsTracerEnabled(profiler_config_)) {
     return nullptr;
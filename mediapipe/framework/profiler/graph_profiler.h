@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -31,6 +32,7 @@
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/log_histogram.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
@@ -91,6 +93,11 @@ enum class PopulateGraphConfig { kNo, kFull };
 //     enable_profiler: true
 //   }
 //
+// With use_log_histograms, the histograms are log-bucketed instead and their
+// percentiles are reported by GetCalculatorProfiles(). Their samples are then
+// counted in per-thread atomic counters rather than under the lock of the
+// calculator profile, and merged when the profiles are read.
+//
 // Because the graph definition affects the stream profiling and the profiler is
 // singleton, the profiler can not be used with more than one graph. Thus the
 // profiler disables itself and returns an empty stub if Initialize() is called
@@ -241,6 +248,20 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   uint64_t GetGraphId() { return graph_id_; }
 
  private:
+  // The log-bucketed histograms of a calculator, with the same layout as its
+  // CalculatorProfile.
+  struct CalculatorHistograms {
+    explicit CalculatorHistograms(int precision_bits)
+        : process_runtime(precision_bits),
+          process_input_latency(precision_bits),
+          process_output_latency(precision_bits) {}
+    LogHistogram process_runtime;
+    LogHistogram process_input_latency;
+    LogHistogram process_output_latency;
+    // One histogram per input stream, or nullptr for back edges.
+    std::vector<std::unique_ptr<LogHistogram>> input_stream_latencies;
+  };
+
   // This can be used to add packet info for the input streams to the graph.
   // It treats the stream defined by |stream_name| as a stream produced by a
   // source calculator and thus uses |timestamp_usec| for the packet production
@@ -256,6 +277,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Add a sample to a time histogram.
   static void AddTimeSample(int64 start_time_usec, int64 end_time_usec,
                             TimeHistogram* histogram);
+  static void AddTimeSample(int64 start_time_usec, int64 end_time_usec,
+                            LogHistogram* histogram);
 
   // Add output streams to the stream consumer count map.
   // This is neeeded in case an output stream is not consumed by any calculator.
@@ -268,6 +291,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   void InitializeInputStreams(const CalculatorGraphConfig::Node& node_config,
                               int64 interval_size_usec, int64 num_intervals,
                               CalculatorProfile* calculator_profile);
+  // Adds the log-bucketed histograms of a calculator and switches its profile
+  // to the LOG scale, after the profile has been initialized.
+  void InitializeLogHistograms(CalculatorProfile* calculator_profile);
   // Returns the input stream back edges for a calculator.
   std::set<int> GetBackEdgeIds(const CalculatorGraphConfig::Node& node_config,
                                const tool::TagMap& input_tag_map);
@@ -281,9 +307,12 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
       int64 production_time_usec, int64 source_process_start_usec);
 
   // Updates the production time for outputs and the stream profile for inputs.
+  // The log-bucketed |histograms| are updated if not null, and otherwise the
+  // |calculator_profile|.
   int64 AddStreamLatencies(const CalculatorContext& calculator_context,
                            int64 start_time_usec, int64 end_time_usec,
-                           CalculatorProfile* calculator_profile);
+                           CalculatorProfile* calculator_profile,
+                           CalculatorHistograms* histograms);
 
   void SetOpenRuntime(const CalculatorContext& calculator_context,
                       int64 start_time_usec, int64 end_time_usec)
@@ -297,7 +326,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // packets and back-edge packets. Returns -1 if there is no input packets.
   int64 AddInputStreamTimeSamples(const CalculatorContext& calculator_context,
                                   int64 start_time_usec,
-                                  CalculatorProfile* calculator_profile);
+                                  CalculatorProfile* calculator_profile,
+                                  CalculatorHistograms* histograms);
+
+  // Returns the log-bucketed histograms of a calculator. Only valid with
+  // use_log_histograms.
+  CalculatorHistograms* GetCalculatorHistograms(
+      const CalculatorContext& calculator_context) const;
 
   // Updates the Process() data for calculator.
   // Requires ReaderLock for is_profiling_.
@@ -330,6 +365,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
+  // Stores the log-bucketed histograms with the calculator name as the key,
+  // if use_log_histograms is set. Only modified by Initialize(), so that
+  // samples are added without locking.
+  absl::flat_hash_map<std::string, std::unique_ptr<CalculatorHistograms>>
+      calculator_histograms_;
   // Stores the production time of a packet, based on profiler's clock.
   using PacketInfoMap =
       ShardedMap<std::string, std::list<std::pair<int64, PacketInfo>>>;
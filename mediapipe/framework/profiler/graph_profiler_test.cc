@@ -1160,6 +1160,102 @@ TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
   ASSERT_NE(GetPacketInfo(GetPacketsInfoMap(), {"stream_1", 100}), nullptr);
 }
 
+// Tests that AddProcessSample() updates the log-bucketed histograms and that
+// GetCalculatorProfiles() reports their percentiles when use_log_histograms is
+// enabled.
+TEST_F(GraphProfilerTestPeer, AddProcessSampleWithLogHistograms) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+      enable_stream_latency: true
+      use_log_histograms: true
+    }
+    node {
+      calculator: "DummyTestCalculator"
+      name: "source_calc"
+      output_stream: "stream_0"
+      output_stream: "stream_1"
+    }
+    node {
+      calculator: "DummyTestCalculator"
+      name: "consumer_calc"
+      input_stream: "stream_0"
+      input_stream: "stream_1"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+
+  TestContextBuilder source_context("source_calc", /*node_id=*/0, {},
+                                    {"stream_0", "stream_1"});
+  source_context.AddInputs({});
+  source_context.AddOutputs(
+      {{}, {MakePacket<std::string>("15").At(Timestamp(100))}});
+  simulation_clock->SleepUntil(absl::FromUnixMicros(1000));
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS,
+                                        source_context.get(), &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(150));
+  }
+
+  TestContextBuilder consumer_context("consumer_calc", /*node_id=*/0,
+                                      {"stream_0", "stream_1"}, {});
+  consumer_context.AddInputs(
+      {Packet(), MakePacket<std::string>("15").At(Timestamp(100))});
+  simulation_clock->SleepUntil(absl::FromUnixMicros(2000));
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS,
+                                        consumer_context.get(), &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(250));
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  simulation_clock->ThreadFinish();
+
+  ASSERT_EQ(profiles.size(), 2);
+  CalculatorProfile source_profile =
+      GetProfileWithName(profiles, "source_calc");
+  const TimeHistogram& runtime = source_profile.process_runtime();
+  EXPECT_EQ(runtime.scale(), TimeHistogram::LOG);
+  EXPECT_EQ(runtime.precision_bits(), kDefaultLogHistogramPrecisionBits);
+  EXPECT_EQ(runtime.total(), 150);
+  EXPECT_EQ(runtime.max(), 150);
+  EXPECT_EQ(runtime.count_size(), LogHistogramBucket(150, 6) + 1);
+  EXPECT_EQ(runtime.count(runtime.count_size() - 1), 1);
+  ASSERT_EQ(runtime.percentiles_size(), 4);
+  EXPECT_EQ(runtime.percentiles(0).percentile(), 50);
+  EXPECT_EQ(runtime.percentiles(0).value(), 150);
+  EXPECT_EQ(runtime.percentiles(3).percentile(), 99.9);
+  EXPECT_EQ(runtime.percentiles(3).value(), 150);
+
+  // The latencies are the same as in AddProcessSampleWithStreamLatency.
+  CalculatorProfile consumer_profile =
+      GetProfileWithName(profiles, "consumer_calc");
+  EXPECT_EQ(consumer_profile.process_runtime().total(), 250);
+  EXPECT_EQ(consumer_profile.process_input_latency().total(), 1000);
+  EXPECT_EQ(consumer_profile.process_output_latency().max(), 1250);
+  ASSERT_EQ(consumer_profile.input_stream_profiles_size(), 2);
+  const TimeHistogram& latency_0 =
+      consumer_profile.input_stream_profiles(0).latency();
+  EXPECT_EQ(latency_0.scale(), TimeHistogram::LOG);
+  EXPECT_EQ(latency_0.count_size(), 0);
+  EXPECT_EQ(latency_0.percentiles_size(), 0);
+  const TimeHistogram& latency_1 =
+      consumer_profile.input_stream_profiles(1).latency();
+  EXPECT_EQ(latency_1.total(), 850);
+  ASSERT_EQ(latency_1.percentiles_size(), 4);
+  EXPECT_EQ(latency_1.percentiles(2).value(), 850);
+
+  // Reset() clears the log-bucketed histograms.
+  profiler_.Reset();
+  profiles = Profiles();
+  source_profile = GetProfileWithName(profiles, "source_calc");
+  EXPECT_EQ(source_profile.process_runtime().total(), 0);
+  EXPECT_EQ(source_profile.process_runtime().count_size(), 0);
+  EXPECT_EQ(source_profile.process_runtime().percentiles_size(), 0);
+}
+
 // This test shows that CalculatorGraph::GetCalculatorProfiles and
 // GraphProfiler::AddProcessSample() can be called in parallel.
 // Without the GraphProfiler::profiler_mutex_ this test should
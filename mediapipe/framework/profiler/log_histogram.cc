@@ -0,0 +1,201 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/log_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Larger values, about 12 days in microseconds, are counted in the last
+// bucket, which bounds the number of buckets.
+constexpr int64_t kMaxValue = (int64_t{1} << 40) - 1;
+
+// Returns the index of the shard used by the calling thread. Threads are
+// assigned shards round-robin, so that the threads of an executor rarely
+// share one.
+int ThreadShardIndex(int num_shards) {
+  static std::atomic<int> next_index{0};
+  thread_local const int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index % num_shards;
+}
+
+}  // namespace
+
+int LogHistogramBucket(int64_t value, int precision_bits) {
+  value = std::clamp<int64_t>(value, 0, kMaxValue);
+  if (value < (int64_t{1} << precision_bits)) {
+    return value;
+  }
+  // Keeps the precision_bits most significant bits of the value, the first of
+  // which is always 1.
+  const int shift =
+      absl::bit_width(static_cast<uint64_t>(value)) - precision_bits;
+  return (shift << (precision_bits - 1)) + (value >> shift);
+}
+
+int LogHistogramNumBuckets(int precision_bits) {
+  return LogHistogramBucket(kMaxValue, precision_bits) + 1;
+}
+
+int64_t LogHistogramBucketLowerBound(int bucket, int precision_bits) {
+  if (bucket < (1 << precision_bits)) {
+    return bucket;
+  }
+  const int shift = (bucket >> (precision_bits - 1)) - 1;
+  const int64_t mantissa = bucket - (shift << (precision_bits - 1));
+  return mantissa << shift;
+}
+
+int64_t LogHistogramBucketUpperBound(int bucket, int precision_bits) {
+  return LogHistogramBucketLowerBound(bucket + 1, precision_bits) - 1;
+}
+
+int64_t LogHistogramPercentile(absl::Span<const int64_t> counts,
+                               int precision_bits, double percentile) {
+  int64_t num_samples = 0;
+  for (int64_t count : counts) {
+    num_samples += count;
+  }
+  if (num_samples == 0) {
+    return 0;
+  }
+  // The rank of the sample at the percentile, starting from 1.
+  const int64_t rank = std::clamp<int64_t>(
+      std::ceil(percentile / 100.0 * num_samples), 1, num_samples);
+  int64_t cumulative_count = 0;
+  for (int bucket = 0; bucket < counts.size(); ++bucket) {
+    cumulative_count += counts[bucket];
+    if (cumulative_count >= rank) {
+      return LogHistogramBucketUpperBound(bucket, precision_bits);
+    }
+  }
+  return LogHistogramBucketUpperBound(counts.size() - 1, precision_bits);
+}
+
+LogHistogram::Shard::Shard(int num_buckets)
+    : counts(new std::atomic<int64_t>[num_buckets]) {
+  for (int i = 0; i < num_buckets; ++i) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LogHistogram::LogHistogram(int precision_bits)
+    : precision_bits_(
+          std::clamp(precision_bits, 1, kMaxLogHistogramPrecisionBits)),
+      num_buckets_(LogHistogramNumBuckets(precision_bits_)) {}
+
+LogHistogram::~LogHistogram() {
+  for (auto& shard : shards_) {
+    delete shard.load(std::memory_order_relaxed);
+  }
+}
+
+LogHistogram::Shard* LogHistogram::GetShard() {
+  std::atomic<Shard*>& slot = shards_[ThreadShardIndex(kNumShards)];
+  Shard* shard = slot.load(std::memory_order_acquire);
+  if (shard == nullptr) {
+    auto new_shard = std::make_unique<Shard>(num_buckets_);
+    // If another thread installed a shard first, this one is dropped and
+    // "shard" is set to the other one.
+    if (slot.compare_exchange_strong(shard, new_shard.get(),
+                                     std::memory_order_acq_rel)) {
+      shard = new_shard.release();
+    }
+  }
+  return shard;
+}
+
+void LogHistogram::Add(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  Shard* shard = GetShard();
+  shard->counts[LogHistogramBucket(value, precision_bits_)].fetch_add(
+      1, std::memory_order_relaxed);
+  shard->total.fetch_add(value, std::memory_order_relaxed);
+  int64_t max = shard->max.load(std::memory_order_relaxed);
+  while (value > max && !shard->max.compare_exchange_weak(
+                            max, value, std::memory_order_relaxed)) {
+  }
+}
+
+void LogHistogram::Clear() {
+  for (auto& slot : shards_) {
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) continue;
+    for (int i = 0; i < num_buckets_; ++i) {
+      shard->counts[i].store(0, std::memory_order_relaxed);
+    }
+    shard->total.store(0, std::memory_order_relaxed);
+    shard->max.store(0, std::memory_order_relaxed);
+  }
+}
+
+int64_t LogHistogram::count() const {
+  int64_t result = 0;
+  for (auto& slot : shards_) {
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) continue;
+    for (int i = 0; i < num_buckets_; ++i) {
+      result += shard->counts[i].load(std::memory_order_relaxed);
+    }
+  }
+  return result;
+}
+
+void LogHistogram::ToProto(TimeHistogram* histogram) const {
+  std::vector<int64_t> counts(num_buckets_, 0);
+  int64_t total = 0;
+  int64_t max = 0;
+  for (auto& slot : shards_) {
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) continue;
+    for (int i = 0; i < num_buckets_; ++i) {
+      counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+    }
+    total += shard->total.load(std::memory_order_relaxed);
+    max = std::max(max, shard->max.load(std::memory_order_relaxed));
+  }
+  // Only the buckets up to the last non-empty one are stored.
+  int num_counts = num_buckets_;
+  while (num_counts > 0 && counts[num_counts - 1] == 0) {
+    --num_counts;
+  }
+  counts.resize(num_counts);
+
+  histogram->set_scale(TimeHistogram::LOG);
+  histogram->set_precision_bits(precision_bits_);
+  histogram->set_total(total);
+  histogram->set_max(max);
+  histogram->mutable_count()->Assign(counts.begin(), counts.end());
+  histogram->clear_percentiles();
+  if (num_counts == 0) {
+    return;
+  }
+  for (double percentile : kLogHistogramPercentiles) {
+    auto* entry = histogram->add_percentiles();
+    entry->set_percentile(percentile);
+    // The bucket bound may exceed the largest sample, e.g. for the last one.
+    entry->set_value(std::min(
+        max, LogHistogramPercentile(counts, precision_bits_, percentile)));
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_LOG_HISTOGRAM_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_LOG_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "absl/types/span.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+
+// The precision used when ProfilerConfig.log_histogram_precision_bits is 0,
+// and the highest precision supported.
+constexpr int kDefaultLogHistogramPrecisionBits = 6;
+constexpr int kMaxLogHistogramPrecisionBits = 10;
+
+// The percentiles reported in TimeHistogram.percentiles.
+constexpr double kLogHistogramPercentiles[] = {50.0, 90.0, 99.0, 99.9};
+
+// Returns the bucket holding "value" in a log-bucketed histogram with
+// "precision_bits" bits of precision, between 1 and
+// kMaxLogHistogramPrecisionBits. Values below 2^precision_bits have a bucket
+// of their own. Above that, each power of two is split into
+// 2^(precision_bits - 1) buckets, so all the values in a bucket are within
+// 2^(1 - precision_bits) of each other, e.g. about 3% for 6 bits.
+// Negative values are counted as 0, and values above 2^40 in the last bucket.
+int LogHistogramBucket(int64_t value, int precision_bits);
+
+// Returns the number of buckets of a log-bucketed histogram.
+int LogHistogramNumBuckets(int precision_bits);
+
+// Returns the smallest and the largest value counted in "bucket".
+int64_t LogHistogramBucketLowerBound(int bucket, int precision_bits);
+int64_t LogHistogramBucketUpperBound(int bucket, int precision_bits);
+
+// Returns the value below which "percentile" percent of the values counted
+// in "counts" fall, as the upper bound of the bucket holding it, or 0 if
+// "counts" is empty.
+int64_t LogHistogramPercentile(absl::Span<const int64_t> counts,
+                               int precision_bits, double percentile);
+
+// A log-bucketed histogram of time samples, in the manner of HdrHistogram,
+// which bounds the relative error of any percentile rather than the absolute
+// error of a fixed interval size.
+//
+// Add() is lock-free and wait-free in the common case: each thread counts its
+// samples in one of a few shards of atomic counters, which are only merged
+// when the histogram is read. Shards are allocated on first use.
+class LogHistogram {
+ public:
+  // "precision_bits" is clamped between 1 and kMaxLogHistogramPrecisionBits.
+  explicit LogHistogram(int precision_bits = kDefaultLogHistogramPrecisionBits);
+  ~LogHistogram();
+  LogHistogram(const LogHistogram&) = delete;
+  LogHistogram& operator=(const LogHistogram&) = delete;
+
+  // Counts a single sample.
+  void Add(int64_t value);
+
+  // Clears all the samples. Samples added concurrently may or may not be kept.
+  void Clear();
+
+  // Returns the number of samples.
+  int64_t count() const;
+
+  // Stores the merged samples in "histogram" with the LOG scale, replacing
+  // its counts, total, max and percentiles.
+  void ToProto(TimeHistogram* histogram) const;
+
+  int precision_bits() const { return precision_bits_; }
+
+ private:
+  static constexpr int kNumShards = 8;
+
+  struct Shard {
+    explicit Shard(int num_buckets);
+    std::unique_ptr<std::atomic<int64_t>[]> counts;
+    std::atomic<int64_t> total{0};
+    std::atomic<int64_t> max{0};
+  };
+
+  // Returns the shard of the calling thread, allocating it if needed.
+  Shard* GetShard();
+
+  const int precision_bits_;
+  const int num_buckets_;
+  std::atomic<Shard*> shards_[kNumShards] = {};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_LOG_HISTOGRAM_H_
@@ -0,0 +1,140 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/log_histogram.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(LogHistogramTest, BucketsAreContiguous) {
+  for (int precision_bits = 1; precision_bits <= kMaxLogHistogramPrecisionBits;
+       ++precision_bits) {
+    const int num_buckets = LogHistogramNumBuckets(precision_bits);
+    EXPECT_EQ(LogHistogramBucketLowerBound(0, precision_bits), 0);
+    for (int bucket = 0; bucket < num_buckets - 1; ++bucket) {
+      const int64_t lower =
+          LogHistogramBucketLowerBound(bucket, precision_bits);
+      const int64_t upper =
+          LogHistogramBucketUpperBound(bucket, precision_bits);
+      ASSERT_LE(lower, upper);
+      ASSERT_EQ(LogHistogramBucketLowerBound(bucket + 1, precision_bits),
+                upper + 1);
+      ASSERT_EQ(LogHistogramBucket(lower, precision_bits), bucket);
+      ASSERT_EQ(LogHistogramBucket(upper, precision_bits), bucket);
+    }
+  }
+}
+
+TEST(LogHistogramTest, BucketsBoundRelativeError) {
+  const int precision_bits = 6;
+  // Small values are counted exactly.
+  for (int64_t value = 0; value < 64; ++value) {
+    EXPECT_EQ(LogHistogramBucket(value, precision_bits), value);
+  }
+  for (int64_t value = 64; value < 100000000; value = value * 5 / 4 + 1) {
+    const int bucket = LogHistogramBucket(value, precision_bits);
+    const int64_t lower = LogHistogramBucketLowerBound(bucket, precision_bits);
+    const int64_t upper = LogHistogramBucketUpperBound(bucket, precision_bits);
+    EXPECT_LE(lower, value);
+    EXPECT_GE(upper, value);
+    EXPECT_LT(upper - lower, lower / 32.0) << value;
+  }
+}
+
+TEST(LogHistogramTest, ClampsValues) {
+  const int num_buckets = LogHistogramNumBuckets(6);
+  EXPECT_EQ(LogHistogramBucket(-5, 6), 0);
+  EXPECT_EQ(LogHistogramBucket(int64_t{1} << 50, 6), num_buckets - 1);
+}
+
+TEST(LogHistogramTest, Percentile) {
+  // 90 samples of 10 and 10 samples of 1000, which is in [992, 1007].
+  std::vector<int64_t> counts(LogHistogramBucket(1000, 6) + 1, 0);
+  counts[10] = 90;
+  counts.back() = 10;
+  EXPECT_EQ(LogHistogramPercentile(counts, 6, 50), 10);
+  EXPECT_EQ(LogHistogramPercentile(counts, 6, 90), 10);
+  EXPECT_EQ(LogHistogramPercentile(counts, 6, 90.5), 1007);
+  EXPECT_EQ(LogHistogramPercentile(counts, 6, 100), 1007);
+  EXPECT_EQ(LogHistogramPercentile(counts, 6, 0), 10);
+  EXPECT_EQ(LogHistogramPercentile({}, 6, 50), 0);
+}
+
+TEST(LogHistogramTest, ToProto) {
+  LogHistogram histogram(6);
+  for (int64_t value = 1; value <= 1000; ++value) {
+    histogram.Add(value);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+
+  TimeHistogram proto;
+  histogram.ToProto(&proto);
+  EXPECT_EQ(proto.scale(), TimeHistogram::LOG);
+  EXPECT_EQ(proto.precision_bits(), 6);
+  EXPECT_EQ(proto.total(), 500500);
+  EXPECT_EQ(proto.max(), 1000);
+  EXPECT_EQ(proto.count_size(), LogHistogramBucket(1000, 6) + 1);
+  ASSERT_EQ(proto.percentiles_size(), 4);
+  EXPECT_EQ(proto.percentiles(0).percentile(), 50);
+  EXPECT_EQ(proto.percentiles(3).percentile(), 99.9);
+  // Each percentile is within 2^-5 above the exact one.
+  const int64_t expected[] = {500, 900, 990, 999};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_GE(proto.percentiles(i).value(), expected[i]);
+    EXPECT_LE(proto.percentiles(i).value(), expected[i] * 33 / 32);
+  }
+  // The largest bucket ends at 1007, above the largest sample.
+  EXPECT_EQ(proto.percentiles(3).value(), 1000);
+
+  histogram.Clear();
+  histogram.ToProto(&proto);
+  EXPECT_EQ(proto.total(), 0);
+  EXPECT_EQ(proto.max(), 0);
+  EXPECT_EQ(proto.count_size(), 0);
+  EXPECT_EQ(proto.percentiles_size(), 0);
+}
+
+TEST(LogHistogramTest, ParallelAdd) {
+  LogHistogram histogram;
+  {
+    mediapipe::ThreadPool pool(12);
+    pool.StartWorkers();
+    for (int t = 0; t < 12; ++t) {
+      pool.Schedule([&histogram, t]() {
+        for (int i = 0; i < 1000; ++i) {
+          histogram.Add(t * 1000 + i);
+        }
+      });
+    }
+  }
+  TimeHistogram proto;
+  histogram.ToProto(&proto);
+  int64_t count = 0;
+  for (int64_t bucket_count : proto.count()) {
+    count += bucket_count;
+  }
+  EXPECT_EQ(count, 12000);
+  EXPECT_EQ(proto.total(), 12000 * 11999 / 2);
+  EXPECT_EQ(proto.max(), 11999);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -76,6 +76,22 @@ absl::btree_map<std::string,
          [](const CalculatorData& d) -> const std::string {
            return ToString(d.time_stat.total());
          }},
+        {"time_p50",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.time_stat.Percentile(50));
+         }},
+        {"time_p90",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.time_stat.Percentile(90));
+         }},
+        {"time_p99",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.time_stat.Percentile(99));
+         }},
+        {"time_p999",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.time_stat.Percentile(99.9));
+         }},
         {"time_percent",
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.time_percent);
@@ -84,6 +100,22 @@ absl::btree_map<std::string,
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.input_latency_stat.mean());
          }},
+        {"input_latency_p50",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.input_latency_stat.Percentile(50));
+         }},
+        {"input_latency_p90",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.input_latency_stat.Percentile(90));
+         }},
+        {"input_latency_p99",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.input_latency_stat.Percentile(99));
+         }},
+        {"input_latency_p999",
+         [](const CalculatorData& d) -> const std::string {
+           return ToString(d.input_latency_stat.Percentile(99.9));
+         }},
         {"input_latency_stddev",
          [](const CalculatorData& d) -> const std::string {
            return ToStringF(d.input_latency_stat.stddev());
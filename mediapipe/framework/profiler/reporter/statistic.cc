@@ -1,9 +1,11 @@
 #include "mediapipe/framework/profiler/reporter/statistic.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/profiler/log_histogram.h"
 
 namespace mediapipe {
 namespace reporter {
@@ -16,13 +18,22 @@ void Statistic::Push(double x) {
     mean_ = x;
     ssd_ = 0.0;
     total_impl_ = x;
+    max_ = x;
   } else {
     // Implementing Welford’s algorithm for computing variance.
     auto old_mean = mean_;
     mean_ = mean_ + (x - mean_) / counter_;
     ssd_ = ssd_ + (x - mean_) * (x - old_mean);
     total_impl_ += x;
+    max_ = std::max(max_, x);
   }
+
+  const int bucket = LogHistogramBucket(std::llround(x),
+                                        kDefaultLogHistogramPrecisionBits);
+  if (bucket >= log_counts_.size()) {
+    log_counts_.resize(bucket + 1, 0);
+  }
+  ++log_counts_[bucket];
 }
 
 // Returns the number of data points used to calculator the mean and
@@ -42,5 +53,16 @@ double Statistic::stddev() const { return std::sqrt(variance()); }
 
 double Statistic::total() const { return total_impl_; }
 
+// Returns the given percentile of the data pushed into this statistic.
+double Statistic::Percentile(double percentile) const {
+  if (counter_ == 0) {
+    return 0.0;
+  }
+  return std::min<double>(
+      max_, LogHistogramPercentile(log_counts_,
+                                   kDefaultLogHistogramPrecisionBits,
+                                   percentile));
+}
+
 }  // namespace reporter
 }  // namespace mediapipe
@@ -1,20 +1,26 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_STATISTIC_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_STATISTIC_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
 
 namespace mediapipe {
 namespace reporter {
 
-// Allows the user to push data and maintains a counter, mean, and stddev of
-// that data.
+// Allows the user to push data and maintains a counter, mean, stddev, and
+// log-bucketed histogram of that data.
 class Statistic {
  public:
   Statistic() : counter_(0) {}
 
   // Clears the current statistic.
-  void Clear() { counter_ = 0; }
+  void Clear() {
+    counter_ = 0;
+    log_counts_.clear();
+  }
 
   // Pushes a single value into the statistic, updating mean and stddev.
   void Push(double x);
@@ -34,9 +40,18 @@ class Statistic {
   // Returns the sum of values of this statistic.
   double total() const;
 
+  // Returns the value below which "percentile" percent of the data pushed into
+  // this statistic falls, rounded up to its log-bucketed histogram interval.
+  double Percentile(double percentile) const;
+
  private:
   int counter_;
   double total_impl_;
+  double max_;
+
+  // The number of values in each interval of a log-bucketed histogram, see
+  // LogHistogramBucket().
+  std::vector<int64_t> log_counts_;
 
   // Welford's algorithm allows us to keep a running standard deviation. We need
   // to hang onto the mean and sum of squared differences in between calls to
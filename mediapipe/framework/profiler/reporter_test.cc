@@ -98,6 +98,8 @@ TEST(Reporter, ReportColumnsWithWildcards) {
   MEDIAPIPE_CHECK_OK(reporter->set_columns({"*_m??n", "*l?t*cy*"}));
   EXPECT_THAT(reporter->Report()->headers(),
               ElementsAre("calculator", "input_latency_mean", "time_mean",
+                          "input_latency_p50", "input_latency_p90",
+                          "input_latency_p99", "input_latency_p999",
                           "input_latency_stddev", "input_latency_total"));
 }
 
@@ -108,8 +110,10 @@ TEST(Reporter, AggregatesAreRecorded) {
   const auto& lines = report->lines();
   EXPECT_EQ(lines.size(), 3);
   EXPECT_THAT(lines[2],
-              ElementsAre("OpenCvWriteTextCalculator", "13823.77", "100.00",
-                          "5541.47", "1976799", "245.13", "464.27", "35054"));
+              ElementsAre("OpenCvWriteTextCalculator", "13823.77", "11519",
+                          "21503", "34815", "38635", "100.00", "5541.47",
+                          "1976799", "245.13", "215", "251", "367", "5730",
+                          "464.27", "35054"));
 }
 
 TEST(Reporter, JoinsFiles) {
@@ -122,8 +126,10 @@ TEST(Reporter, JoinsFiles) {
   const auto& lines = report->lines();
   EXPECT_EQ(lines.size(), 3);
   EXPECT_THAT(lines[2],
-              ElementsAre("OpenCvWriteTextCalculator", "14707.77", "100.00",
-                          "5630.52", "3000385", "237.50", "389.35", "48449"));
+              ElementsAre("OpenCvWriteTextCalculator", "14707.77", "13311",
+                          "23039", "34815", "38635", "100.00", "5630.52",
+                          "3000385", "237.50", "219", "251", "343", "5730",
+                          "389.35", "48449"));
 }
 
 TEST(Reporter, PrintAllColumns) {
@@ -194,6 +200,14 @@ TEST(Reporter, ProcessCalculatedCorrectly) {
               testing::DoubleNear(70.71, 0.01));
   EXPECT_THAT(report->calculator_data().at("ACalculator").time_stat.total(),
               testing::DoubleEq(900));
+  // The percentiles are rounded up to the log-bucketed interval of 400, which
+  // is [400, 407], and at most the largest value.
+  EXPECT_THAT(
+      report->calculator_data().at("ACalculator").time_stat.Percentile(50),
+      testing::DoubleEq(407));
+  EXPECT_THAT(
+      report->calculator_data().at("ACalculator").time_stat.Percentile(99),
+      testing::DoubleEq(500));
   EXPECT_THAT(report->calculator_data().at("BCalculator").time_percent,
               testing::DoubleEq(25));
   EXPECT_THAT(report->calculator_data().at("BCalculator").time_stat.mean(),
@@ -226,6 +240,10 @@ TEST(Reporter, LatencyCalculatedCorrectly) {
   EXPECT_THAT(
       report->calculator_data().at("BCalculator").input_latency_stat.total(),
       testing::DoubleEq(1500));
+  EXPECT_THAT(report->calculator_data()
+                  .at("BCalculator")
+                  .input_latency_stat.Percentile(99.9),
+              testing::DoubleEq(900));
 }
 
 }  // namespace mediapipe
@@ -83,7 +83,7 @@ struct TraceEvent {
     this->is_finish = is_finish;
     return *this;
   }
-  inline TraceEvent& set_event_data(int data) {
+  inline TraceEvent& set_event_data(int64 data) {
     this->event_data = data;
     return *this;
   }
@@ -112,6 +112,7 @@ struct TraceEvent {
       GraphTrace::GPU_TASK_INVOKE_ADVANCED;
   static constexpr EventType TPU_TASK_INVOKE_ASYNC =
       GraphTrace::TPU_TASK_INVOKE_ASYNC;
+  static constexpr EventType TENSOR_POOL_USAGE = GraphTrace::TENSOR_POOL_USAGE;
 };
 
 // Packet trace log buffer.
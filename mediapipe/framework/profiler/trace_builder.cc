@@ -92,6 +92,9 @@ void BasicTraceEventTypes(TraceEventRegistry* result) {
        "interpreter."},
       {TraceEvent::TPU_TASK_INVOKE_ASYNC,
        "CPU timing for async initiation of a TPU task."},
+      {TraceEvent::TENSOR_POOL_USAGE,
+       "The peak bytes of pooled tensor memory when a tensor is created.",
+       true, false, false},
   };
   for (const TraceEventType& t : basic_types) {
     (*result)[t.event_type()] = t;
@@ -439,6 +442,7 @@ const TraceEvent::EventType         //
     TraceEvent::DSP_TASK,           //
     TraceEvent::TPU_TASK,           //
     TraceEvent::GPU_CALIBRATION,    //
-    TraceEvent::PACKET_QUEUED;
+    TraceEvent::PACKET_QUEUED,      //
+    TraceEvent::TENSOR_POOL_USAGE;
 
 }  // namespace mediapipe
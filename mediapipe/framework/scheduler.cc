@@ -175,6 +175,9 @@ void Scheduler::HandleIdle() {
   }
 
   handling_idle_ = 0;
+  if (idle_callback_ && IsIdle()) {
+    idle_callback_(true);
+  }
 }
 
 // Note: state_mutex_ is held when this function is entered or exited.
@@ -446,8 +449,16 @@ void Scheduler::AssignNodeToSchedulerQueue(CalculatorNode* node) {
   node->SetSchedulerQueue(queue);
 }
 
+void Scheduler::SetIdleCallback(std::function<void(bool)> idle_callback) {
+  absl::MutexLock lock(&state_mutex_);
+  idle_callback_ = std::move(idle_callback);
+}
+
 void Scheduler::QueueIdleStateChanged(bool idle) {
   absl::MutexLock lock(&state_mutex_);
+  if (!idle && IsIdle() && idle_callback_) {
+    idle_callback_(false);
+  }
   non_idle_queue_count_ += (idle ? -1 : 1);
   VLOG(2) << "active queues: " << non_idle_queue_count_;
   if (non_idle_queue_count_ == 0) {
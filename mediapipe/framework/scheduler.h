@@ -121,6 +121,13 @@ class Scheduler {
 
   void QueueIdleStateChanged(bool idle);
 
+  // Sets a callback that is invoked with false when the scheduler starts
+  // running nodes, and with true when it has nothing left to run, as in
+  // WaitUntilIdle(). The callback is invoked with state_mutex_ held, so it must
+  // not call back into the scheduler. Must be called before Start().
+  void SetIdleCallback(std::function<void(bool)> idle_callback)
+      ABSL_LOCKS_EXCLUDED(state_mutex_);
+
   // Called by DelegatingExecutor to add an application thread task.
   void AddApplicationThreadTask(std::function<void()> task);
 
@@ -314,6 +321,9 @@ class Scheduler {
   //   and Mutex's TryLock is not guaranteed to work.
   int handling_idle_ ABSL_GUARDED_BY(state_mutex_) = 0;
 
+  // Invoked when the scheduler becomes busy or idle, if set.
+  std::function<void(bool)> idle_callback_ ABSL_GUARDED_BY(state_mutex_);
+
   // Mutex for the scheduler state and related things.
   // Note: state_ is declared as atomic so that its getter methods don't need
   // to acquire state_mutex_.
@@ -0,0 +1,46 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures the scheduling overhead per node invocation. The graph consists of
+// parallel chains of PassThroughCalculators, which do almost no work, so the
+// time per invocation is dominated by the scheduler and the executor.
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/graph_benchmark_util.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 200;
+constexpr int kNumChains = 8;
+constexpr int kChainLength = 8;
+
+// Arg: number of threads of the default executor.
+void BM_SchedulingOverhead(benchmark::State& state) {
+  CalculatorGraphConfig config =
+      MakePassThroughChainsConfig(kNumChains, kChainLength);
+  config.set_num_threads(state.range(0));
+  RunGraphBenchmark(state, config, kNumPackets);
+}
+BENCHMARK(BM_SchedulingOverhead)
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
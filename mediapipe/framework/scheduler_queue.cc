@@ -15,10 +15,9 @@
 #include "mediapipe/framework/scheduler_queue.h"
 
 #include <memory>
-#include <queue>
+#include <optional>
 #include <utility>
 
-#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -86,25 +85,47 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   }
 }
 
+PriorityKey SchedulerQueue::Item::Priority() const {
+  // Each field is mapped to an unsigned value that preserves its order, and
+  // inverted when lower values run first.
+  auto ordered32 = [](int value) -> uint64_t {
+    return static_cast<uint32_t>(value) ^ 0x80000000u;
+  };
+  auto ordered64 = [](int64 value) -> uint64_t {
+    return static_cast<uint64_t>(value) ^ 0x8000000000000000ull;
+  };
+  constexpr uint64_t kSourceClass = uint64_t{1} << 32;
+  constexpr uint64_t kNonSourceClass = uint64_t{2} << 32;
+  constexpr uint64_t kOpenNodeClass = uint64_t{3} << 32;
+  PriorityKey key;
+  if (is_open_node_) {
+    // OpenNode() runs first, lower ids first.
+    key.high = kOpenNodeClass | (0xFFFFFFFFu - ordered32(id_));
+  } else if (!is_source_) {
+    // Non-sources run before sources, higher ids first.
+    key.high = kNonSourceClass | ordered32(id_);
+  } else {
+    // Sources run lower layers, then lower SourceProcessOrder values, then
+    // lower ids first.
+    key.high = kSourceClass | (0xFFFFFFFFu - ordered32(layer_));
+    key.mid = ~ordered64(source_process_order_);
+    key.low = 0xFFFFFFFFu - ordered32(id_);
+  }
+  return key;
+}
+
 void SchedulerQueue::Reset() {
-  absl::MutexLock lock(&mutex_);
-  num_pending_tasks_ = 0;
+  num_active_items_ = 0;
   num_tasks_to_add_ = 0;
   running_count_ = 0;
 }
 
 void SchedulerQueue::SetExecutor(Executor* executor) { executor_ = executor; }
 
-bool SchedulerQueue::IsIdle() {
-  VLOG(3) << "Scheduler queue empty: " << queue_.empty()
-          << ", # of pending tasks: " << num_pending_tasks_;
-  return queue_.empty() && num_pending_tasks_ == 0;
-}
-
 void SchedulerQueue::SetRunning(bool running) {
-  absl::MutexLock lock(&mutex_);
-  running_count_ += running ? 1 : -1;
-  DCHECK_LE(running_count_, 1);
+  const int delta = running ? 1 : -1;
+  const int running_count = running_count_.fetch_add(delta) + delta;
+  DCHECK_LE(running_count, 1);
 }
 
 void SchedulerQueue::AddNode(CalculatorNode* node, CalculatorContext* cc) {
@@ -132,40 +153,32 @@ void SchedulerQueue::AddNodeForOpen(CalculatorNode* node) {
 
 void SchedulerQueue::AddItemToQueue(Item&& item) {
   const CalculatorNode* node = item.Node();
-  bool was_idle;
-  int tasks_to_add = 0;
-  {
-    absl::MutexLock lock(&mutex_);
-    was_idle = IsIdle();
-    queue_.push(item);
-    ++num_tasks_to_add_;
-    VLOG(4) << node->DebugName() << " was added to the scheduler queue.";
-
-    // Now grab the tasks to execute while still holding the lock. This will
-    // gather any waiting tasks, in addition to the one we just added.
-    if (running_count_ > 0) {
-      tasks_to_add = GetTasksToSubmitToExecutor();
-    }
-  }
+  const bool was_idle = num_active_items_.fetch_add(1) == 0;
+  queue_.Push(std::move(item), node->Id());
+  VLOG(4) << node->DebugName() << " was added to the scheduler queue.";
   if (was_idle && idle_callback_) {
     // Became not idle.
     idle_callback_(false);
   }
-  // Note: this should be done after calling idle_callback_(false) above.
-  // This ensures that we never get an idle_callback_(true) that is not
-  // preceded by the corresponding idle_callback_(false). See the comments on
+  // Note: the task for this item must only become claimable after calling
+  // idle_callback_(false) above, so that no thread can run it first. This
+  // ensures that we never get an idle_callback_(true) that is not preceded by
+  // the corresponding idle_callback_(false). See the comments on
   // SetIdleCallback for details.
-  while (tasks_to_add > 0) {
-    executor_->AddTask(this);
-    --tasks_to_add;
+  num_tasks_to_add_.fetch_add(1);
+  // Grab the tasks to execute. This will gather any waiting tasks, in
+  // addition to the one we just added.
+  if (running_count_ > 0) {
+    int tasks_to_add = GetTasksToSubmitToExecutor();
+    while (tasks_to_add > 0) {
+      executor_->AddTask(this);
+      --tasks_to_add;
+    }
   }
 }
 
 int SchedulerQueue::GetTasksToSubmitToExecutor() {
-  int tasks_to_add = num_tasks_to_add_;
-  num_tasks_to_add_ = 0;
-  num_pending_tasks_ += tasks_to_add;
-  return tasks_to_add;
+  return num_tasks_to_add_.exchange(0);
 }
 
 void SchedulerQueue::SubmitWaitingTasksToExecutor() {
@@ -173,11 +186,8 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
   // we do not immediately submit tasks to the executor. Here we check for any
   // such waiting tasks, and submit them.
   int tasks_to_add = 0;
-  {
-    absl::MutexLock lock(&mutex_);
-    if (running_count_ > 0) {
-      tasks_to_add = GetTasksToSubmitToExecutor();
-    }
+  if (running_count_ > 0) {
+    tasks_to_add = GetTasksToSubmitToExecutor();
   }
   while (tasks_to_add > 0) {
     executor_->AddTask(this);
@@ -186,23 +196,16 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
 }
 
 void SchedulerQueue::RunNextTask() {
-  CalculatorNode* node;
-  CalculatorContext* calculator_context;
-  bool is_open_node;
-  {
-    absl::MutexLock lock(&mutex_);
-
-    CHECK(!queue_.empty()) << "Called RunNextTask when the queue is empty. "
-                              "This should not happen.";
-
-    node = queue_.top().Node();
-    calculator_context = queue_.top().Context();
-    is_open_node = queue_.top().IsOpenNode();
-    queue_.pop();
-
-    CHECK(!node->Closed())
-        << "Scheduled a node that was closed. This should not happen.";
-  }
+  // Every task is submitted after its item was pushed, so an item is always
+  // available here.
+  std::optional<Item> item = queue_.TryPop();
+  CHECK(item.has_value()) << "Called RunNextTask when the queue is empty. "
+                             "This should not happen.";
+  CalculatorNode* node = item->Node();
+  CalculatorContext* calculator_context = item->Context();
+  const bool is_open_node = item->IsOpenNode();
+  CHECK(!node->Closed())
+      << "Scheduled a node that was closed. This should not happen.";
 
   // On iOS, calculators may rely on the existence of an autorelease pool
   // (either directly, or because system code they call does). We do not
@@ -218,14 +221,11 @@ void SchedulerQueue::RunNextTask() {
     }
   }
 
-  bool is_idle;
-  {
-    absl::MutexLock lock(&mutex_);
-    DCHECK_GT(num_pending_tasks_, 0);
-    --num_pending_tasks_;
-    is_idle = IsIdle();
-  }
-  if (is_idle && idle_callback_) {
+  const int num_active_items = num_active_items_.fetch_sub(1) - 1;
+  DCHECK_GE(num_active_items, 0);
+  VLOG(3) << "Scheduler queue size: " << queue_.Size()
+          << ", # of active items: " << num_active_items;
+  if (num_active_items == 0 && idle_callback_) {
     // Became idle.
     idle_callback_(true);
   }
@@ -295,17 +295,15 @@ void SchedulerQueue::OpenCalculatorNode(CalculatorNode* node) {
 }
 
 void SchedulerQueue::CleanupAfterRun() {
-  bool was_idle;
-  {
-    absl::MutexLock lock(&mutex_);
-    was_idle = IsIdle();
-    CHECK_EQ(num_pending_tasks_, 0);
-    CHECK_EQ(num_tasks_to_add_, queue_.size());
-    num_tasks_to_add_ = 0;
-    while (!queue_.empty()) {
-      queue_.pop();
-    }
-  }
+  // No tasks are running at this point, so the remaining items are exactly
+  // the ones waiting to be submitted.
+  const int num_active_items = num_active_items_.load();
+  const bool was_idle = num_active_items == 0;
+  CHECK_EQ(num_active_items, num_tasks_to_add_.load());
+  CHECK_EQ(num_active_items, queue_.Size());
+  num_tasks_to_add_ = 0;
+  num_active_items_ = 0;
+  queue_.Clear();
   if (!was_idle && idle_callback_) {
     // Became idle.
     idle_callback_(true);
@@ -18,12 +18,11 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <queue>
 #include <utility>
 
 #include "absl/base/macros.h"
-#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/concurrent_priority_queue.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/scheduler_shared.h"
@@ -35,6 +34,10 @@ class CalculatorNode;
 namespace internal {
 
 // Manages a priority queue of nodes to be run on the associated executor.
+//
+// The queue is safe to use from multiple threads without a queue-wide lock:
+// nodes are kept in a ConcurrentPriorityQueue and the bookkeeping counters
+// are atomic.
 class SchedulerQueue : public TaskQueue {
  public:
   // Callback to be invoked when the queue's idle state changes.
@@ -66,6 +69,11 @@ class SchedulerQueue : public TaskQueue {
     //   are closer to the leaves.
     bool operator<(const Item& that) const;
 
+    // Encodes the ordering of operator< into a key for
+    // ConcurrentPriorityQueue: a.Priority() < b.Priority() iff a < b, except
+    // that items comparing equal map to equal keys.
+    PriorityKey Priority() const;
+
    private:
     int64 source_process_order_ = 0;
     CalculatorNode* node_;
@@ -105,45 +113,39 @@ class SchedulerQueue : public TaskQueue {
   // NOTE: After calling SetRunning(true), the caller must call
   // SubmitWaitingTasksToExecutor since tasks may have been added while the
   // queue was not running.
-  void SetRunning(bool running) ABSL_LOCKS_EXCLUDED(mutex_);
+  void SetRunning(bool running);
 
-  // Gets the number of tasks that need to be submitted to the executor, and
-  // updates num_pending_tasks_. If this method is called and returns a
-  // non-zero value, the executor's AddTask method *must* be called for each
-  // task returned, but it can be called without holding the lock.
-  int GetTasksToSubmitToExecutor() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Claims the tasks that need to be submitted to the executor. If this
+  // method returns a non-zero value, the executor's AddTask method *must* be
+  // called for each task returned.
+  int GetTasksToSubmitToExecutor();
 
   // Submits tasks that are waiting (e.g. that were added while the queue was
   // not running) if the queue is running. The caller must not hold any mutex.
-  void SubmitWaitingTasksToExecutor() ABSL_LOCKS_EXCLUDED(mutex_);
+  void SubmitWaitingTasksToExecutor();
 
   // Adds a node and a calculator context to the scheduler queue if the node is
   // not already running. Note that if the node was running, then it will be
   // rescheduled upon completion (after checking dependencies), so this call is
   // not lost.
-  void AddNode(CalculatorNode* node, CalculatorContext* cc)
-      ABSL_LOCKS_EXCLUDED(mutex_);
+  void AddNode(CalculatorNode* node, CalculatorContext* cc);
 
   // Adds a node to the scheduler queue for an OpenNode() call.
-  void AddNodeForOpen(CalculatorNode* node) ABSL_LOCKS_EXCLUDED(mutex_);
+  void AddNodeForOpen(CalculatorNode* node);
 
   // Adds an Item to queue_.
   void AddItemToQueue(Item&& item);
 
-  void CleanupAfterRun() ABSL_LOCKS_EXCLUDED(mutex_);
+  void CleanupAfterRun();
 
  private:
   // Used internally by RunNextTask. Invokes ProcessNode or CloseNode, followed
   // by EndScheduling.
-  void RunCalculatorNode(CalculatorNode* node, CalculatorContext* cc)
-      ABSL_LOCKS_EXCLUDED(mutex_);
+  void RunCalculatorNode(CalculatorNode* node, CalculatorContext* cc);
 
   // Used internally by RunNextTask. Invokes OpenNode, followed by
   // CheckIfBecameReady.
-  void OpenCalculatorNode(CalculatorNode* node) ABSL_LOCKS_EXCLUDED(mutex_);
-
-  // Checks whether the queue has no queued nodes or pending tasks.
-  bool IsIdle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void OpenCalculatorNode(CalculatorNode* node);
 
   Executor* executor_ = nullptr;
 
@@ -154,20 +156,20 @@ class SchedulerQueue : public TaskQueue {
   // decrements it. The queue is running if running_count_ > 0. A running
   // queue will submit tasks to the executor.
   // Invariant: running_count_ <= 1.
-  int running_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::atomic<int> running_count_{0};
 
-  // Number of tasks added to the Executor and not yet complete.
-  int num_pending_tasks_ ABSL_GUARDED_BY(mutex_);
+  // Number of items added to queue_ whose executor task has not completed.
+  // Every item added is matched by exactly one task, so the queue is idle
+  // (no queued nodes and no pending tasks) iff this is zero.
+  std::atomic<int> num_active_items_{0};
 
   // Number of tasks that need to be added to the Executor.
-  int num_tasks_to_add_ ABSL_GUARDED_BY(mutex_);
+  std::atomic<int> num_tasks_to_add_{0};
 
   // Queue of nodes that need to be run.
-  std::priority_queue<Item> queue_ ABSL_GUARDED_BY(mutex_);
+  ConcurrentPriorityQueue<Item> queue_;
 
   SchedulerShared* const shared_;
-
-  absl::Mutex mutex_;
 };
 
 }  // namespace internal
@@ -0,0 +1,151 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/spsc_packet_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+namespace internal {
+
+constexpr int SpscPacketQueue::kMinCapacity;
+constexpr int SpscPacketQueue::kMaxCapacity;
+
+void SpscPacketQueue::Reset(int capacity) {
+  int rounded = kMinCapacity;
+  while (rounded < std::min(capacity, kMaxCapacity)) {
+    rounded *= 2;
+  }
+  if (ring_ == nullptr || rounded != RingCapacity()) {
+    mask_ = rounded - 1;
+    ring_ = std::make_unique<Packet[]>(rounded);
+    ring_timestamps_ = std::make_unique<std::atomic<int64_t>[]>(rounded);
+  } else {
+    for (int64_t i = head_.load(std::memory_order_relaxed);
+         i < tail_.load(std::memory_order_relaxed); ++i) {
+      ring_[i & mask_] = Packet();
+    }
+  }
+  head_.store(0, std::memory_order_relaxed);
+  tail_.store(0, std::memory_order_relaxed);
+  absl::MutexLock lock(&overflow_mutex_);
+  overflow_.clear();
+  overflow_size_.store(0, std::memory_order_relaxed);
+}
+
+void SpscPacketQueue::Push(Packet packet) {
+  // Packets go to the ring only while the overflow is empty, so that every
+  // packet in the overflow is newer than every packet in the ring.
+  if (overflow_size_.load(std::memory_order_acquire) == 0) {
+    const int64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) <= mask_) {
+      ring_timestamps_[tail & mask_].store(packet.Timestamp().Value(),
+                                           std::memory_order_relaxed);
+      ring_[tail & mask_] = std::move(packet);
+      tail_.store(tail + 1, std::memory_order_seq_cst);
+      return;
+    }
+  }
+  absl::MutexLock lock(&overflow_mutex_);
+  overflow_.push_back(std::move(packet));
+  overflow_size_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+const Packet& SpscPacketQueue::Front() const {
+  const int64_t head = head_.load(std::memory_order_relaxed);
+  if (head < tail_.load(std::memory_order_acquire)) {
+    return ring_[head & mask_];
+  }
+  absl::MutexLock lock(&overflow_mutex_);
+  // The producer may have refilled the ring and started a new overflow since
+  // tail_ was read. Once the overflow is locked and non-empty, tail_ is
+  // stable, so read it again.
+  if (head < tail_.load(std::memory_order_acquire)) {
+    return ring_[head & mask_];
+  }
+  CHECK(!overflow_.empty());
+  // std::deque::push_back() does not invalidate references, and only the
+  // consumer removes packets, so the reference outlives the lock.
+  return overflow_.front();
+}
+
+Packet SpscPacketQueue::Pop() {
+  const int64_t head = head_.load(std::memory_order_relaxed);
+  if (head < tail_.load(std::memory_order_acquire)) {
+    return PopFromRing(head);
+  }
+  absl::MutexLock lock(&overflow_mutex_);
+  // See Front().
+  if (head < tail_.load(std::memory_order_acquire)) {
+    return PopFromRing(head);
+  }
+  CHECK(!overflow_.empty());
+  Packet packet = std::move(overflow_.front());
+  overflow_.pop_front();
+  overflow_size_.fetch_sub(1, std::memory_order_seq_cst);
+  return packet;
+}
+
+Packet SpscPacketQueue::PopFromRing(int64_t head) {
+  Packet packet = std::move(ring_[head & mask_]);
+  head_.store(head + 1, std::memory_order_seq_cst);
+  return packet;
+}
+
+Timestamp SpscPacketQueue::TimestampAt(int index) const {
+  const int64_t head = head_.load(std::memory_order_relaxed);
+  int64_t ring_size = tail_.load(std::memory_order_acquire) - head;
+  if (index < ring_size) {
+    return ring_[(head + index) & mask_].Timestamp();
+  }
+  absl::MutexLock lock(&overflow_mutex_);
+  // See Front().
+  ring_size = tail_.load(std::memory_order_acquire) - head;
+  if (index < ring_size) {
+    return ring_[(head + index) & mask_].Timestamp();
+  }
+  CHECK_LT(index - ring_size, overflow_.size());
+  return overflow_[index - ring_size].Timestamp();
+}
+
+Timestamp SpscPacketQueue::FrontTimestamp() const {
+  const int64_t head = head_.load(std::memory_order_seq_cst);
+  if (head < tail_.load(std::memory_order_seq_cst)) {
+    return Timestamp::CreateNoErrorChecking(
+        ring_timestamps_[head & mask_].load(std::memory_order_relaxed));
+  }
+  absl::MutexLock lock(&overflow_mutex_);
+  // See Front().
+  if (head < tail_.load(std::memory_order_seq_cst)) {
+    return Timestamp::CreateNoErrorChecking(
+        ring_timestamps_[head & mask_].load(std::memory_order_relaxed));
+  }
+  if (overflow_.empty()) {
+    return Timestamp::Unset();
+  }
+  return overflow_.front().Timestamp();
+}
+
+int SpscPacketQueue::Size() const {
+  const int64_t head = head_.load(std::memory_order_seq_cst);
+  const int64_t tail = tail_.load(std::memory_order_seq_cst);
+  return static_cast<int>(tail - head +
+                          overflow_size_.load(std::memory_order_seq_cst));
+}
+
+}  // namespace internal
+}  // namespace mediapipe
@@ -0,0 +1,111 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_SPSC_PACKET_QUEUE_H_
+#define MEDIAPIPE_FRAMEWORK_SPSC_PACKET_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace internal {
+
+// A FIFO queue of packets for one producer thread and one consumer thread.
+//
+// Packets are kept in a bounded ring buffer indexed by atomic head and tail
+// counters, so Push() and Pop() do not take any lock while the ring has room.
+// When the ring is full, Push() appends to a mutex-guarded overflow deque
+// instead, and keeps doing so until the consumer has drained the overflow.
+// The queue is therefore unbounded, and the ring capacity only decides how
+// many packets can be buffered without locking.
+//
+// Push() may only be called by the producer. Front(), Pop() and TimestampAt()
+// may only be called by the consumer. Size(), Empty() and FrontTimestamp()
+// may be called from any thread, but the result may be stale by the time it
+// is returned unless the caller is the consumer. Reset() must not overlap with
+// any other call.
+//
+// All updates of the head and tail counters are sequentially consistent, so
+// that a producer that reads Size() after Push() and a consumer that reads
+// Empty() after Pop() cannot both miss each other's update.
+class SpscPacketQueue {
+ public:
+  SpscPacketQueue() { Reset(kMinCapacity); }
+  SpscPacketQueue(const SpscPacketQueue&) = delete;
+  SpscPacketQueue& operator=(const SpscPacketQueue&) = delete;
+
+  // Removes all packets and resizes the ring to hold at least "capacity"
+  // packets, rounded up to a power of two and clamped to
+  // [kMinCapacity, kMaxCapacity].
+  void Reset(int capacity);
+
+  // Appends a packet at the back of the queue.
+  void Push(Packet packet);
+
+  // Returns the packet at the front of the queue. REQUIRES: !Empty().
+  const Packet& Front() const;
+
+  // Removes and returns the packet at the front of the queue.
+  // REQUIRES: !Empty().
+  Packet Pop();
+
+  // Returns the timestamp of the "index"-th packet from the front.
+  // REQUIRES: index < Size().
+  Timestamp TimestampAt(int index) const;
+
+  // Returns the timestamp of the packet at the front of the queue, or
+  // Timestamp::Unset() if the queue is empty.
+  Timestamp FrontTimestamp() const;
+
+  int Size() const;
+  bool Empty() const { return Size() == 0; }
+
+  // Returns the number of packets the ring holds before spilling over.
+  int RingCapacity() const { return mask_ + 1; }
+
+  static constexpr int kMinCapacity = 16;
+  static constexpr int kMaxCapacity = 1024;
+
+ private:
+  // Removes and returns the packet at "head" in the ring.
+  Packet PopFromRing(int64_t head);
+
+  int64_t mask_ = 0;
+  std::unique_ptr<Packet[]> ring_;
+  // Timestamps of the packets in ring_, readable from any thread.
+  std::unique_ptr<std::atomic<int64_t>[]> ring_timestamps_;
+
+  // Read and written by the consumer, read by the producer.
+  alignas(64) std::atomic<int64_t> head_{0};
+  // Read and written by the producer, read by the consumer.
+  alignas(64) std::atomic<int64_t> tail_{0};
+
+  // Packets that did not fit in the ring. All of them are newer than the
+  // packets in the ring.
+  mutable absl::Mutex overflow_mutex_;
+  std::deque<Packet> overflow_ ABSL_GUARDED_BY(overflow_mutex_);
+  std::atomic<int64_t> overflow_size_{0};
+};
+
+}  // namespace internal
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_SPSC_PACKET_QUEUE_H_
@@ -0,0 +1,110 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/spsc_packet_queue.h"
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace internal {
+namespace {
+
+TEST(SpscPacketQueueTest, ResetRoundsCapacity) {
+  SpscPacketQueue queue;
+  queue.Reset(100);
+  EXPECT_EQ(128, queue.RingCapacity());
+  queue.Reset(1);
+  EXPECT_EQ(SpscPacketQueue::kMinCapacity, queue.RingCapacity());
+  queue.Reset(1 << 20);
+  EXPECT_EQ(SpscPacketQueue::kMaxCapacity, queue.RingCapacity());
+}
+
+// Pushes more packets than the ring holds, so that some spill into the
+// overflow, and checks that FIFO order is kept across both.
+TEST(SpscPacketQueueTest, KeepsOrderAcrossOverflow) {
+  SpscPacketQueue queue;
+  queue.Reset(SpscPacketQueue::kMinCapacity);
+  const int num_packets = 3 * queue.RingCapacity();
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(Timestamp::Unset(), queue.FrontTimestamp());
+  for (int i = 0; i < num_packets; ++i) {
+    queue.Push(MakePacket<int>(i).At(Timestamp(i)));
+  }
+  EXPECT_EQ(num_packets, queue.Size());
+  EXPECT_EQ(Timestamp(0), queue.FrontTimestamp());
+  EXPECT_EQ(Timestamp(num_packets - 1), queue.TimestampAt(num_packets - 1));
+  EXPECT_EQ(Timestamp(queue.RingCapacity()),
+            queue.TimestampAt(queue.RingCapacity()));
+
+  // Pops half, then pushes again while the overflow is still non-empty.
+  int next = 0;
+  for (; next < num_packets / 2; ++next) {
+    ASSERT_EQ(next, queue.Front().Get<int>());
+    ASSERT_EQ(next, queue.Pop().Get<int>());
+  }
+  for (int i = num_packets; i < 2 * num_packets; ++i) {
+    queue.Push(MakePacket<int>(i).At(Timestamp(i)));
+  }
+  for (; next < 2 * num_packets; ++next) {
+    ASSERT_EQ(Timestamp(next), queue.FrontTimestamp());
+    ASSERT_EQ(next, queue.Pop().Get<int>());
+  }
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SpscPacketQueueTest, ResetClearsPackets) {
+  SpscPacketQueue queue;
+  for (int i = 0; i < 100; ++i) {
+    queue.Push(MakePacket<int>(i).At(Timestamp(i)));
+  }
+  queue.Reset(SpscPacketQueue::kMinCapacity);
+  EXPECT_TRUE(queue.Empty());
+  queue.Push(MakePacket<int>(7).At(Timestamp(7)));
+  EXPECT_EQ(1, queue.Size());
+  EXPECT_EQ(7, queue.Pop().Get<int>());
+}
+
+TEST(SpscPacketQueueTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumPackets = 100000;
+  SpscPacketQueue queue;
+  queue.Reset(SpscPacketQueue::kMinCapacity);
+  int num_popped = 0;
+  {
+    ThreadPool pool("test", 2);
+    pool.StartWorkers();
+    pool.Schedule([&queue] {
+      for (int i = 0; i < kNumPackets; ++i) {
+        queue.Push(MakePacket<int>(i).At(Timestamp(i)));
+      }
+    });
+    pool.Schedule([&queue, &num_popped] {
+      while (num_popped < kNumPackets) {
+        if (queue.Empty()) continue;
+        Packet packet = queue.Pop();
+        EXPECT_EQ(num_popped, packet.Get<int>());
+        EXPECT_EQ(Timestamp(num_popped), packet.Timestamp());
+        ++num_popped;
+      }
+    });
+  }
+  EXPECT_EQ(kNumPackets, num_popped);
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace mediapipe
@@ -15,7 +15,10 @@
 #ifndef MEDIAPIPE_FRAMEWORK_THREAD_POOL_EXECUTOR_H_
 #define MEDIAPIPE_FRAMEWORK_THREAD_POOL_EXECUTOR_H_
 
+#include <memory>
+
 #include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/framework/port/threadpool.h"
@@ -23,6 +26,10 @@
 namespace mediapipe {
 
 // A multithreaded executor based on a thread pool.
+//
+// By default the workers share a single task queue (mediapipe::ThreadPool).
+// With ThreadPoolExecutorOptions.queue_type set to WORK_STEALING, each worker
+// owns a lock-free deque instead (mediapipe::WorkStealingThreadPool).
 class ThreadPoolExecutor : public Executor {
  public:
   static absl::StatusOr<Executor*> Create(
@@ -33,20 +40,25 @@ class ThreadPoolExecutor : public Executor {
   void Schedule(std::function<void()> task) override;
 
   // For testing.
-  int num_threads() const { return thread_pool_.num_threads(); }
+  int num_threads() const;
+  // Returns true if this executor uses a WorkStealingThreadPool.
+  bool work_stealing() const { return work_stealing_pool_ != nullptr; }
   // Returns the thread stack size (in bytes).
   size_t stack_size() const { return stack_size_; }
 
  private:
-  ThreadPoolExecutor(const ThreadOptions& thread_options, int num_threads);
+  ThreadPoolExecutor(const ThreadOptions& thread_options, int num_threads,
+                     bool work_stealing);
 
   // Saves the value of the stack size option and starts the thread pool.
   void Start();
 
-  mediapipe::ThreadPool thread_pool_;
+  // Exactly one of these is set.
+  std::unique_ptr<mediapipe::ThreadPool> thread_pool_;
+  std::unique_ptr<mediapipe::WorkStealingThreadPool> work_stealing_pool_;
 
   // Records the stack size in ThreadOptions right before we call
-  // thread_pool_.StartWorkers().
+  // StartWorkers().
   //
   // The actual stack size passed to pthread_attr_setstacksize() for the
   // worker threads differs from the stack size we specified. It includes the
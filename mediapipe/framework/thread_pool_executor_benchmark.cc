@@ -0,0 +1,56 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compares the SHARED_QUEUE and WORK_STEALING queue types of
+// ThreadPoolExecutor on wide fan-out graphs: a single input stream feeds many
+// independent PassThroughCalculator chains, so scheduling overhead dominates.
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/graph_benchmark_util.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 100;
+constexpr int kChainLength = 4;
+
+// Args: {fan_out, num_threads, queue_type}.
+void BM_FanOutGraph(benchmark::State& state) {
+  const auto queue_type =
+      static_cast<ThreadPoolExecutorOptions::QueueType>(state.range(2));
+  CalculatorGraphConfig config =
+      MakePassThroughChainsConfig(state.range(0), kChainLength);
+  auto* executor_options =
+      config.add_executor()->mutable_options()->MutableExtension(
+          ThreadPoolExecutorOptions::ext);
+  executor_options->set_num_threads(state.range(1));
+  executor_options->set_queue_type(queue_type);
+  RunGraphBenchmark(state, config, kNumPackets);
+  state.SetLabel(queue_type == ThreadPoolExecutorOptions::WORK_STEALING
+                     ? "work_stealing"
+                     : "shared_queue");
+}
+BENCHMARK(BM_FanOutGraph)
+    ->ArgsProduct({{16, 64, 256},
+                   {4, 16, 32},
+                   {ThreadPoolExecutorOptions::SHARED_QUEUE,
+                    ThreadPoolExecutorOptions::WORK_STEALING}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
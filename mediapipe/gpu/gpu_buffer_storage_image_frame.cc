@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "mediapipe/framework/formats/frame_buffer.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/logging.h"
 
 namespace mediapipe {
 
@@ -39,6 +40,8 @@ FrameBuffer::Format FrameBufferFormatForImageFrameFormat(
   }
 }
 
+// Returns a FrameBuffer that aliases the pixel data of image_frame and keeps
+// image_frame alive.
 std::shared_ptr<FrameBuffer> ImageFrameToFrameBuffer(
     std::shared_ptr<ImageFrame> image_frame) {
   FrameBuffer::Format format =
@@ -51,13 +54,25 @@ std::shared_ptr<FrameBuffer> ImageFrameToFrameBuffer(
       /*row_stride_bytes=*/image_frame->WidthStep(),
       /*pixel_stride_bytes=*/image_frame->ByteDepth() *
           image_frame->NumberOfChannels()};
+  // The FrameBuffer is only written to through write views, which are not
+  // created for read-only frames.
   const std::vector<FrameBuffer::Plane> planes{
-      {image_frame->MutablePixelData(), stride}};
-  return std::make_shared<FrameBuffer>(planes, dimension, format);
+      {const_cast<uint8_t*>(image_frame->PixelData()), stride}};
+  return std::shared_ptr<FrameBuffer>(
+      new FrameBuffer(planes, dimension, format),
+      [image_frame = std::move(image_frame)](FrameBuffer* frame_buffer) {
+        delete frame_buffer;
+      });
 }
 
 }  // namespace
 
+std::shared_ptr<ImageFrame> GpuBufferStorageImageFrame::GetWriteView(
+    internal::types<ImageFrame>) {
+  CHECK(!image_frame_->IsReadOnly()) << "Cannot write to a read-only image.";
+  return image_frame_;
+}
+
 std::shared_ptr<const FrameBuffer> GpuBufferStorageImageFrame::GetReadView(
     internal::types<FrameBuffer>) const {
   return ImageFrameToFrameBuffer(image_frame_);
@@ -65,6 +80,7 @@ std::shared_ptr<const FrameBuffer> GpuBufferStorageImageFrame::GetReadView(
 
 std::shared_ptr<FrameBuffer> GpuBufferStorageImageFrame::GetWriteView(
     internal::types<FrameBuffer>) {
+  CHECK(!image_frame_->IsReadOnly()) << "Cannot write to a read-only image.";
   return ImageFrameToFrameBuffer(image_frame_);
 }
 
@@ -51,9 +51,7 @@ class GpuBufferStorageImageFrame
     return image_frame_;
   }
   std::shared_ptr<ImageFrame> GetWriteView(
-      internal::types<ImageFrame>) override {
-    return image_frame_;
-  }
+      internal::types<ImageFrame>) override;
   std::shared_ptr<const FrameBuffer> GetReadView(
       internal::types<FrameBuffer>) const override;
   std::shared_ptr<FrameBuffer> GetWriteView(
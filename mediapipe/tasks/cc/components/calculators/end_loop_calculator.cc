@@ -18,6 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
 
 // Specialized EndLoopCalculator for Tasks specific types.
 namespace mediapipe::tasks {
@@ -27,4 +28,9 @@ typedef EndLoopCalculator<
     EndLoopClassificationResultCalculator;
 REGISTER_CALCULATOR(::mediapipe::tasks::EndLoopClassificationResultCalculator);
 
+typedef EndLoopCalculator<
+    std::vector<components::containers::proto::EmbeddingResult>>
+    EndLoopEmbeddingResultCalculator;
+REGISTER_CALCULATOR(::mediapipe::tasks::EndLoopEmbeddingResultCalculator);
+
 }  // namespace mediapipe::tasks
@@ -15,6 +15,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/text_preprocessing_graph.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/tasks/cc/text/utils/text_model_utils.h"
+#include "mediapipe/util/graph_builder_utils.h"
 
 namespace mediapipe::tasks::components::processors {
 namespace {
@@ -38,9 +40,9 @@ namespace {
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
 using ::mediapipe::api2::SideInput;
+using ::mediapipe::api2::builder::GenericNode;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::SideSource;
-using ::mediapipe::api2::builder::Source;
 using ::mediapipe::tasks::components::processors::proto::TextModelType;
 using ::mediapipe::tasks::components::processors::proto::
     TextPreprocessingGraphOptions;
@@ -49,6 +51,7 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 using ::mediapipe::tasks::text::utils::GetModelType;
 
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kTensorsTag[] = "TENSORS";
 
@@ -205,12 +208,20 @@ absl::Status ConfigureTextPreprocessingGraph(
   return absl::OkStatus();
 }
 
+bool SupportsBatchedInput(const TextPreprocessingGraphOptions& options) {
+  return options.model_type() == TextModelType::BERT_MODEL ||
+         options.model_type() == TextModelType::REGEX_MODEL;
+}
+
 // A TextPreprocessingGraph performs text preprocessing.
 // - Accepts a std::string input and outputs CPU tensors.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The text to preprocess.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of texts to preprocess into a single set of input tensors, with
+//     a batch entry per text. Only supported for BERT and regex models.
 // Side inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the TFLite model. Used to determine the order
@@ -226,21 +237,37 @@ class TextPreprocessingGraph : public mediapipe::Subgraph {
  public:
   absl::StatusOr<mediapipe::CalculatorGraphConfig> GetConfig(
       mediapipe::SubgraphContext* sc) override {
+    const auto& options = sc->Options<TextPreprocessingGraphOptions>();
     Graph graph;
-    ASSIGN_OR_RETURN(
-        Source<std::vector<Tensor>> tensors_in,
-        BuildTextPreprocessing(
-            sc->Options<TextPreprocessingGraphOptions>(),
-            graph[Input<std::string>(kTextTag)],
-            graph[SideInput<ModelMetadataExtractor>(kMetadataExtractorTag)],
-            graph));
-    tensors_in >> graph[Output<std::vector<Tensor>>(kTensorsTag)];
+    ASSIGN_OR_RETURN(GenericNode * text_preprocessor,
+                     BuildTextPreprocessing(
+                         options,
+                         graph[SideInput<ModelMetadataExtractor>(
+                             kMetadataExtractorTag)],
+                         graph));
+    if (HasInput(sc->OriginalNode(), kTextsTag)) {
+      if (!SupportsBatchedInput(options)) {
+        return CreateStatusWithPayload(
+            absl::StatusCode::kInvalidArgument,
+            "Batched text preprocessing is only supported for BERT and regex "
+            "models.",
+            MediaPipeTasksStatus::kInvalidArgumentError);
+      }
+      graph[Input<std::vector<std::string>>(kTextsTag)] >>
+          text_preprocessor->In(kTextsTag);
+    } else {
+      graph[Input<std::string>(kTextTag)] >> text_preprocessor->In(kTextTag);
+    }
+    text_preprocessor->Out(kTensorsTag) >>
+        graph[Output<std::vector<Tensor>>(kTensorsTag)];
     return graph.GetConfig();
   }
 
  private:
-  absl::StatusOr<Source<std::vector<Tensor>>> BuildTextPreprocessing(
-      const TextPreprocessingGraphOptions& options, Source<std::string> text_in,
+  // Adds the preprocessor calculator for the model type, without connecting
+  // its text input.
+  absl::StatusOr<GenericNode*> BuildTextPreprocessing(
+      const TextPreprocessingGraphOptions& options,
       SideSource<ModelMetadataExtractor> metadata_extractor_in, Graph& graph) {
     ASSIGN_OR_RETURN(std::string preprocessor_name,
                      GetCalculatorNameFromModelType(options.model_type()));
@@ -260,6 +287,8 @@ class TextPreprocessingGraph : public mediapipe::Subgraph {
             .set_bert_max_seq_len(options.max_seq_len());
         text_preprocessor.GetOptions<BertPreprocessorCalculatorOptions>()
             .set_has_dynamic_input_tensors(options.has_dynamic_input_tensors());
+        text_preprocessor.GetOptions<BertPreprocessorCalculatorOptions>()
+            .set_num_threads(options.num_threads());
         metadata_extractor_in >>
             text_preprocessor.SideIn(kMetadataExtractorTag);
         break;
@@ -267,13 +296,14 @@ class TextPreprocessingGraph : public mediapipe::Subgraph {
       case TextModelType::REGEX_MODEL: {
         text_preprocessor.GetOptions<RegexPreprocessorCalculatorOptions>()
             .set_max_seq_len(options.max_seq_len());
+        text_preprocessor.GetOptions<RegexPreprocessorCalculatorOptions>()
+            .set_num_threads(options.num_threads());
         metadata_extractor_in >>
             text_preprocessor.SideIn(kMetadataExtractorTag);
         break;
       }
     }
-    text_in >> text_preprocessor.In(kTextTag);
-    return text_preprocessor[Output<std::vector<Tensor>>(kTensorsTag)];
+    return &text_preprocessor;
   }
 };
 REGISTER_MEDIAPIPE_GRAPH(
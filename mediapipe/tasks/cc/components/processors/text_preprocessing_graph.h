@@ -39,8 +39,12 @@ namespace processors {
 //
 // The resulting TextPreprocessingGraph has the following I/O:
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The text to preprocess.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of texts to preprocess into a single set of input tensors, with
+//     a batch entry per text. Only supported if SupportsBatchedInput() is true.
+//     Exactly one of TEXT and TEXTS must be connected.
 // Side inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the TFLite model. Used to determine the order
@@ -52,6 +56,11 @@ absl::Status ConfigureTextPreprocessingGraph(
     const core::ModelResources& model_resources,
     proto::TextPreprocessingGraphOptions& options);
 
+// Returns whether a TextPreprocessingGraph configured with `options` accepts
+// the TEXTS input, i.e. whether the model takes int32 input tensors that can be
+// batched. Models taking string input tensors have to be run text by text.
+bool SupportsBatchedInput(const proto::TextPreprocessingGraphOptions& options);
+
 }  // namespace processors
 }  // namespace components
 }  // namespace tasks
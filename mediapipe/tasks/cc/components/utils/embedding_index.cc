@@ -0,0 +1,447 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/tasks/cc/common.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+#include "mediapipe/tasks/cc/core/external_file_handler.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+namespace {
+
+using ::mediapipe::tasks::components::containers::Embedding;
+using ::mediapipe::tasks::core::ExternalFileHandler;
+using ::mediapipe::tasks::core::proto::ExternalFile;
+
+// The number of embeddings scored at once. Small enough for the scores of a
+// batch of queries to stay in cache, large enough to amortize the overhead of
+// the matrix products.
+constexpr int64_t kBlockSize = 1024;
+
+// Layout of the files written by Save(). The header is followed by the
+// embeddings, one row of dimension values per embedding, and, for quantized
+// embeddings with cosine similarity scores, by their inverse L2-norms, aligned
+// to 4 bytes. All values are little-endian.
+constexpr char kFileMagic[4] = {'M', 'P', 'E', 'I'};
+constexpr uint32_t kFileVersion = 1;
+constexpr uint32_t kQuantizedFlag = 1;
+constexpr uint32_t kL2NormalizeFlag = 2;
+
+struct FileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t dimension;
+  uint32_t flags;
+  uint64_t size;
+  // Keeps the embeddings aligned for SIMD loads once mapped.
+  char reserved[40];
+};
+static_assert(sizeof(FileHeader) == 64, "Unexpected FileHeader size");
+
+int64_t RoundUpTo4(int64_t value) { return (value + 3) / 4 * 4; }
+
+absl::Status InvalidArgumentError(const std::string& message) {
+  return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument, message,
+                                 MediaPipeTasksStatus::kInvalidArgumentError);
+}
+
+// Returns the size in bytes of the embeddings and, if any, inverse norms
+// stored after the header.
+int64_t GetDataSize(int64_t size, int dimension, bool quantized,
+                    bool l2_normalize) {
+  if (!quantized) {
+    return size * dimension * sizeof(float);
+  }
+  int64_t data_size = size * dimension;
+  if (l2_normalize) {
+    data_size = RoundUpTo4(data_size) + size * sizeof(float);
+  }
+  return data_size;
+}
+
+// Returns the embedding values as floats, checking their type and size.
+absl::StatusOr<Eigen::VectorXf> GetEmbeddingValues(const Embedding& embedding,
+                                                   int dimension,
+                                                   bool quantized) {
+  if (quantized != embedding.float_embedding.empty()) {
+    return InvalidArgumentError(quantized ? "Expected a quantized embedding"
+                                          : "Expected a float embedding");
+  }
+  const int size = quantized ? embedding.quantized_embedding.size()
+                             : embedding.float_embedding.size();
+  if (size != dimension) {
+    return InvalidArgumentError(
+        absl::StrFormat("Expected an embedding of size %d, got %d instead",
+                        dimension, size));
+  }
+  if (quantized) {
+    return Eigen::VectorXf(
+        Eigen::Map<const Eigen::Matrix<int8_t, Eigen::Dynamic, 1>>(
+            reinterpret_cast<const int8_t*>(
+                embedding.quantized_embedding.data()),
+            dimension)
+            .cast<float>());
+  }
+  return Eigen::VectorXf(Eigen::Map<const Eigen::VectorXf>(
+      embedding.float_embedding.data(), dimension));
+}
+
+}  // namespace
+
+// The k highest scoring neighbors seen so far, for one query.
+class EmbeddingIndex::TopK {
+ public:
+  explicit TopK(int k) : k_(k) {}
+
+  void Add(int64_t index, float score) {
+    if (static_cast<int>(heap_.size()) < k_) {
+      heap_.push({index, score});
+    } else if (IsBetter({index, score}, heap_.top())) {
+      heap_.pop();
+      heap_.push({index, score});
+    }
+  }
+
+  // Returns the neighbors, best first, and clears them.
+  std::vector<EmbeddingIndexNeighbor> Release() {
+    std::vector<EmbeddingIndexNeighbor> neighbors(heap_.size());
+    for (auto it = neighbors.rbegin(); it != neighbors.rend(); ++it) {
+      *it = heap_.top();
+      heap_.pop();
+    }
+    return neighbors;
+  }
+
+ private:
+  static bool IsBetter(const EmbeddingIndexNeighbor& a,
+                       const EmbeddingIndexNeighbor& b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+  }
+  struct IsBetterThan {
+    bool operator()(const EmbeddingIndexNeighbor& a,
+                    const EmbeddingIndexNeighbor& b) const {
+      return IsBetter(a, b);
+    }
+  };
+
+  const int k_;
+  // The worst of the neighbors is at the top.
+  std::priority_queue<EmbeddingIndexNeighbor,
+                      std::vector<EmbeddingIndexNeighbor>, IsBetterThan>
+      heap_;
+};
+
+EmbeddingIndex::EmbeddingIndex(int dimension, bool quantized,
+                               bool l2_normalize, int num_threads)
+    : dimension_(dimension),
+      quantized_(quantized),
+      l2_normalize_(l2_normalize) {
+  if (num_threads > 1) {
+    thread_pool_ =
+        std::make_unique<ThreadPool>("embedding_index", num_threads);
+    thread_pool_->StartWorkers();
+  }
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::Create(
+    int dimension, bool quantized, const EmbeddingIndexOptions& options) {
+  if (dimension <= 0) {
+    return InvalidArgumentError(
+        absl::StrFormat("Invalid embedding dimension %d", dimension));
+  }
+  return std::unique_ptr<EmbeddingIndex>(new EmbeddingIndex(
+      dimension, quantized, options.l2_normalize, options.num_threads));
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::Load(
+    std::unique_ptr<ExternalFile> file, const EmbeddingIndexOptions& options) {
+  ASSIGN_OR_RETURN(auto file_handler,
+                   ExternalFileHandler::CreateFromExternalFile(file.get()));
+  const absl::string_view content = file_handler->GetFileContent();
+  FileHeader header;
+  if (content.size() < sizeof(header)) {
+    return InvalidArgumentError("Embedding index file is truncated");
+  }
+  std::memcpy(&header, content.data(), sizeof(header));
+  if (std::memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+      header.version != kFileVersion) {
+    return InvalidArgumentError("Not an embedding index file");
+  }
+  const bool quantized = header.flags & kQuantizedFlag;
+  const bool l2_normalize = header.flags & kL2NormalizeFlag;
+  if (header.dimension == 0 || header.dimension > INT32_MAX ||
+      static_cast<int64_t>(content.size() - sizeof(header)) !=
+          GetDataSize(header.size, header.dimension, quantized,
+                      l2_normalize)) {
+    return InvalidArgumentError(
+        absl::StrFormat("Embedding index file of %d bytes does not hold %d "
+                        "embeddings of size %d",
+                        content.size(), header.size, header.dimension));
+  }
+  auto index = std::unique_ptr<EmbeddingIndex>(
+      new EmbeddingIndex(header.dimension, quantized, l2_normalize,
+                         options.num_threads));
+  index->size_ = header.size;
+  index->file_ = std::move(file);
+  index->file_handler_ = std::move(file_handler);
+  const char* data = content.data() + sizeof(header);
+  index->mapped_values_ = data;
+  if (quantized && l2_normalize) {
+    index->mapped_inverse_norms_ = reinterpret_cast<const float*>(
+        data + RoundUpTo4(header.size * header.dimension));
+  }
+  // Mapped files are page aligned, but file contents provided in memory may
+  // not be aligned for float loads.
+  if (reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) {
+    index->CopyMappedEmbeddings();
+  }
+  return index;
+}
+
+absl::Status EmbeddingIndex::Add(const Embedding& embedding) {
+  ASSIGN_OR_RETURN(Eigen::VectorXf values,
+                   GetEmbeddingValues(embedding, dimension_, quantized_));
+  float inverse_norm = 1.0f;
+  if (l2_normalize_) {
+    const float norm = values.norm();
+    if (norm <= 0.0f) {
+      return InvalidArgumentError(
+          "Cannot add an embedding with 0 norm to an index of cosine "
+          "similarities");
+    }
+    inverse_norm = 1.0f / norm;
+  }
+  if (file_handler_ != nullptr) {
+    CopyMappedEmbeddings();
+  }
+  if (quantized_) {
+    const auto* data =
+        reinterpret_cast<const int8_t*>(embedding.quantized_embedding.data());
+    quantized_values_.insert(quantized_values_.end(), data, data + dimension_);
+    if (l2_normalize_) {
+      inverse_norms_.push_back(inverse_norm);
+    }
+  } else {
+    values *= inverse_norm;
+    float_values_.insert(float_values_.end(), values.data(),
+                         values.data() + dimension_);
+  }
+  ++size_;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<EmbeddingIndexNeighbor>> EmbeddingIndex::Search(
+    const Embedding& query, int k) const {
+  ASSIGN_OR_RETURN(auto neighbors, Search(std::vector<Embedding>{query}, k));
+  return std::move(neighbors[0]);
+}
+
+absl::StatusOr<std::vector<std::vector<EmbeddingIndexNeighbor>>>
+EmbeddingIndex::Search(const std::vector<Embedding>& queries, int k) const {
+  if (k <= 0) {
+    return InvalidArgumentError(
+        absl::StrFormat("Expected k to be positive, got %d", k));
+  }
+  ASSIGN_OR_RETURN(Eigen::MatrixXf query_matrix, GetQueryMatrix(queries));
+  const int num_queries = queries.size();
+  // Each thread scans a range of at least kBlockSize embeddings.
+  const int num_ranges =
+      thread_pool_ == nullptr
+          ? 1
+          : std::max<int64_t>(
+                1, std::min<int64_t>(thread_pool_->num_threads(),
+                                     size_ / kBlockSize));
+  std::vector<std::vector<TopK>> top_k(num_ranges,
+                                       std::vector<TopK>(num_queries, TopK(k)));
+  if (num_ranges == 1) {
+    Scan(0, size_, query_matrix, &top_k[0]);
+  } else {
+    absl::BlockingCounter counter(num_ranges);
+    for (int range = 0; range < num_ranges; ++range) {
+      const int64_t begin = size_ * range / num_ranges;
+      const int64_t end = size_ * (range + 1) / num_ranges;
+      thread_pool_->Schedule(
+          [this, begin, end, &query_matrix, &top_k, range, &counter] {
+            Scan(begin, end, query_matrix, &top_k[range]);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+  }
+  std::vector<std::vector<EmbeddingIndexNeighbor>> neighbors(num_queries);
+  for (int query = 0; query < num_queries; ++query) {
+    for (int range = 1; range < num_ranges; ++range) {
+      for (const auto& neighbor : top_k[range][query].Release()) {
+        top_k[0][query].Add(neighbor.index, neighbor.score);
+      }
+    }
+    neighbors[query] = top_k[0][query].Release();
+  }
+  return neighbors;
+}
+
+absl::StatusOr<Eigen::MatrixXf> EmbeddingIndex::GetQueryMatrix(
+    const std::vector<Embedding>& queries) const {
+  Eigen::MatrixXf query_matrix(dimension_, queries.size());
+  for (int i = 0; i < queries.size(); ++i) {
+    ASSIGN_OR_RETURN(query_matrix.col(i),
+                     GetEmbeddingValues(queries[i], dimension_, quantized_));
+    if (l2_normalize_) {
+      const float norm = query_matrix.col(i).norm();
+      if (norm <= 0.0f) {
+        return InvalidArgumentError(
+            "Cannot compute cosine similarity on embedding with 0 norm");
+      }
+      query_matrix.col(i) /= norm;
+    }
+  }
+  return query_matrix;
+}
+
+void EmbeddingIndex::Scan(int64_t begin, int64_t end,
+                          const Eigen::MatrixXf& queries,
+                          std::vector<TopK>* top_k) const {
+  using FloatRows = Eigen::Map<const ScoreMatrix>;
+  using QuantizedRows = Eigen::Map<const Eigen::Matrix<
+      int8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+  ScoreMatrix scores;
+  ScoreMatrix block;
+  for (int64_t block_begin = begin; block_begin < end;
+       block_begin += kBlockSize) {
+    const int64_t block_size = std::min(kBlockSize, end - block_begin);
+    if (quantized_) {
+      block = QuantizedRows(quantized_data() + block_begin * dimension_,
+                            block_size, dimension_)
+                  .cast<float>();
+      scores.noalias() = block * queries;
+      if (l2_normalize_) {
+        scores.array().colwise() *=
+            Eigen::Map<const Eigen::ArrayXf>(inverse_norms() + block_begin,
+                                             block_size);
+      }
+    } else {
+      scores.noalias() =
+          FloatRows(float_data() + block_begin * dimension_, block_size,
+                    dimension_) *
+          queries;
+    }
+    for (int64_t row = 0; row < block_size; ++row) {
+      for (int query = 0; query < scores.cols(); ++query) {
+        (*top_k)[query].Add(block_begin + row, scores(row, query));
+      }
+    }
+  }
+}
+
+absl::Status EmbeddingIndex::Save(const std::string& path) const {
+  FileHeader header = {};
+  std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+  header.version = kFileVersion;
+  header.dimension = dimension_;
+  header.flags = (quantized_ ? kQuantizedFlag : 0) |
+                 (l2_normalize_ ? kL2NormalizeFlag : 0);
+  header.size = size_;
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (quantized_) {
+    const int64_t num_values = size_ * dimension_;
+    file.write(reinterpret_cast<const char*>(quantized_data()), num_values);
+    if (l2_normalize_) {
+      const char padding[4] = {};
+      file.write(padding, RoundUpTo4(num_values) - num_values);
+      file.write(reinterpret_cast<const char*>(inverse_norms()),
+                 size_ * sizeof(float));
+    }
+  } else {
+    file.write(reinterpret_cast<const char*>(float_data()),
+               size_ * dimension_ * sizeof(float));
+  }
+  file.close();
+  if (!file) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kUnknown,
+        absl::StrFormat("Unable to write embedding index to %s", path),
+        MediaPipeTasksStatus::kError);
+  }
+  return absl::OkStatus();
+}
+
+void EmbeddingIndex::CopyMappedEmbeddings() {
+  if (quantized_) {
+    const int8_t* data = quantized_data();
+    quantized_values_.assign(data, data + size_ * dimension_);
+    if (l2_normalize_) {
+      // The inverse norms may not be aligned either.
+      inverse_norms_.resize(size_);
+      std::memcpy(inverse_norms_.data(), mapped_inverse_norms_,
+                  size_ * sizeof(float));
+    }
+  } else {
+    float_values_.resize(size_ * dimension_);
+    std::memcpy(float_values_.data(), mapped_values_,
+                float_values_.size() * sizeof(float));
+  }
+  mapped_values_ = nullptr;
+  mapped_inverse_norms_ = nullptr;
+  file_handler_.reset();
+  file_.reset();
+}
+
+const float* EmbeddingIndex::float_data() const {
+  return mapped_values_ != nullptr ? static_cast<const float*>(mapped_values_)
+                                   : float_values_.data();
+}
+
+const int8_t* EmbeddingIndex::quantized_data() const {
+  return mapped_values_ != nullptr ? static_cast<const int8_t*>(mapped_values_)
+                                   : quantized_values_.data();
+}
+
+const float* EmbeddingIndex::inverse_norms() const {
+  return mapped_inverse_norms_ != nullptr ? mapped_inverse_norms_
+                                          : inverse_norms_.data();
+}
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,164 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+#define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+#include "mediapipe/tasks/cc/core/external_file_handler.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+// Options for EmbeddingIndex.
+struct EmbeddingIndexOptions {
+  // If true, the search scores are cosine similarities, as computed by
+  // CosineSimilarity(). Float embeddings are normalized when they are added,
+  // so that searching only computes dot products. If false, the scores are
+  // the dot products of the embeddings. Ignored by EmbeddingIndex::Load(),
+  // which uses the value the index was created with.
+  bool l2_normalize = true;
+
+  // The number of threads scanning the index in Search().
+  int num_threads = 1;
+};
+
+// An embedding found by EmbeddingIndex::Search().
+struct EmbeddingIndexNeighbor {
+  // The position of the embedding in the index, i.e. the number of embeddings
+  // added before it.
+  int64_t index;
+  // The cosine similarity or dot product of the embedding and the query.
+  float score;
+};
+
+// In-memory index of embeddings, for exact k-nearest-neighbor search.
+//
+// The embeddings are stored contiguously, and Search() scores them against
+// batches of queries with matrix products, which Eigen vectorizes, so that
+// exhaustive search is practical for millions of embeddings. The index can be
+// saved to a file and loaded back without copying the embeddings, as the file
+// is memory-mapped.
+//
+// Search() may be called from multiple threads concurrently. Add() must not
+// be called concurrently with any other method.
+class EmbeddingIndex {
+ public:
+  // Creates an empty index of embeddings with `dimension` values, which are
+  // scalar-quantized if `quantized` is true and floats otherwise.
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> Create(
+      int dimension, bool quantized,
+      const EmbeddingIndexOptions& options = EmbeddingIndexOptions());
+
+  // Loads an index written by Save() from `file`. The embeddings are not
+  // copied if the file is provided by path or file descriptor.
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> Load(
+      std::unique_ptr<core::proto::ExternalFile> file,
+      const EmbeddingIndexOptions& options = EmbeddingIndexOptions());
+
+  EmbeddingIndex(const EmbeddingIndex&) = delete;
+  EmbeddingIndex& operator=(const EmbeddingIndex&) = delete;
+
+  // Appends `embedding` to the index. Returns an InvalidArgumentError if its
+  // type or size does not match the index, or if it has an L2-norm of 0 and
+  // the scores are cosine similarities.
+  absl::Status Add(const containers::Embedding& embedding);
+
+  // Returns the (at most) k embeddings with the highest scores for `query`,
+  // highest first. Ties are broken by lowest index.
+  absl::StatusOr<std::vector<EmbeddingIndexNeighbor>> Search(
+      const containers::Embedding& query, int k) const;
+
+  // Same as above, for a batch of queries, which are all scored in a single
+  // scan of the index.
+  absl::StatusOr<std::vector<std::vector<EmbeddingIndexNeighbor>>> Search(
+      const std::vector<containers::Embedding>& queries, int k) const;
+
+  // Writes the index to the file at `path`.
+  absl::Status Save(const std::string& path) const;
+
+  // The number of embeddings in the index.
+  int64_t size() const { return size_; }
+  int dimension() const { return dimension_; }
+  bool quantized() const { return quantized_; }
+  bool l2_normalize() const { return l2_normalize_; }
+
+ private:
+  using ScoreMatrix =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  class TopK;
+
+  EmbeddingIndex(int dimension, bool quantized, bool l2_normalize,
+                 int num_threads);
+
+  // Returns the queries as the columns of a dimension x num_queries matrix,
+  // normalized if l2_normalize_ is true.
+  absl::StatusOr<Eigen::MatrixXf> GetQueryMatrix(
+      const std::vector<containers::Embedding>& queries) const;
+
+  // Scores the embeddings in [begin, end) against `queries` and adds them to
+  // the per-query `top_k`.
+  void Scan(int64_t begin, int64_t end, const Eigen::MatrixXf& queries,
+            std::vector<TopK>* top_k) const;
+
+  // Copies the embeddings of a loaded index to owned memory, so that more
+  // can be added.
+  void CopyMappedEmbeddings();
+
+  const float* float_data() const;
+  const int8_t* quantized_data() const;
+  const float* inverse_norms() const;
+
+  const int dimension_;
+  const bool quantized_;
+  const bool l2_normalize_;
+  int64_t size_ = 0;
+
+  // Owned embeddings, one row of dimension_ values per embedding. Only the
+  // vector matching quantized_ is used.
+  std::vector<float> float_values_;
+  std::vector<int8_t> quantized_values_;
+  // Inverse L2-norms of the quantized embeddings, if l2_normalize_ is true.
+  // Float embeddings are normalized instead.
+  std::vector<float> inverse_norms_;
+
+  // If the index was loaded from a file, the file and pointers to the
+  // embeddings in it, which are used instead of the owned embeddings.
+  std::unique_ptr<core::proto::ExternalFile> file_;
+  std::unique_ptr<core::ExternalFileHandler> file_handler_;
+  const void* mapped_values_ = nullptr;
+  const float* mapped_inverse_norms_ = nullptr;
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
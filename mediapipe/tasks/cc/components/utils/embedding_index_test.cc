@@ -0,0 +1,245 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+#include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+namespace {
+
+using ::mediapipe::tasks::components::containers::Embedding;
+using ::mediapipe::tasks::core::proto::ExternalFile;
+using ::testing::HasSubstr;
+
+constexpr int kDimension = 16;
+
+// Helper function to generate float Embedding.
+Embedding BuildFloatEmbedding(std::vector<float> values) {
+  Embedding embedding;
+  embedding.float_embedding = values;
+  return embedding;
+}
+
+// Helper function to generate quantized Embedding.
+Embedding BuildQuantizedEmbedding(std::vector<int8_t> values) {
+  Embedding embedding;
+  uint8_t* data = reinterpret_cast<uint8_t*>(values.data());
+  embedding.quantized_embedding = {data, data + values.size()};
+  return embedding;
+}
+
+std::vector<Embedding> BuildRandomEmbeddings(int count, bool quantized,
+                                             int seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(-127, 127);
+  std::vector<Embedding> embeddings;
+  for (int i = 0; i < count; ++i) {
+    std::vector<int8_t> values(kDimension);
+    for (auto& value : values) {
+      value = distribution(generator);
+    }
+    embeddings.push_back(quantized
+                             ? BuildQuantizedEmbedding(values)
+                             : BuildFloatEmbedding(std::vector<float>(
+                                   values.begin(), values.end())));
+  }
+  return embeddings;
+}
+
+// Returns the indices of the k embeddings most similar to query, computed
+// with CosineSimilarity().
+std::vector<int64_t> ExactNearestNeighbors(
+    const std::vector<Embedding>& embeddings, const Embedding& query, int k) {
+  std::vector<std::pair<double, int64_t>> similarities;
+  for (int64_t i = 0; i < embeddings.size(); ++i) {
+    similarities.push_back(
+        {-CosineSimilarity(embeddings[i], query).value(), i});
+  }
+  std::sort(similarities.begin(), similarities.end());
+  std::vector<int64_t> indices;
+  for (int i = 0; i < k; ++i) {
+    indices.push_back(similarities[i].second);
+  }
+  return indices;
+}
+
+std::vector<int64_t> GetIndices(
+    const std::vector<EmbeddingIndexNeighbor>& neighbors) {
+  std::vector<int64_t> indices;
+  for (const auto& neighbor : neighbors) {
+    indices.push_back(neighbor.index);
+  }
+  return indices;
+}
+
+class EmbeddingIndexTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(EmbeddingIndexTest, SearchesCosineSimilarity) {
+  const bool quantized = GetParam();
+  MP_ASSERT_OK_AND_ASSIGN(auto index,
+                          EmbeddingIndex::Create(kDimension, quantized));
+  const auto embeddings = BuildRandomEmbeddings(100, quantized, /*seed=*/1);
+  for (const auto& embedding : embeddings) {
+    MP_ASSERT_OK(index->Add(embedding));
+  }
+  EXPECT_EQ(index->size(), 100);
+  const auto queries = BuildRandomEmbeddings(3, quantized, /*seed=*/2);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors, index->Search(queries, 5));
+
+  ASSERT_EQ(neighbors.size(), 3);
+  for (int i = 0; i < queries.size(); ++i) {
+    EXPECT_EQ(GetIndices(neighbors[i]),
+              ExactNearestNeighbors(embeddings, queries[i], 5));
+    for (const auto& neighbor : neighbors[i]) {
+      EXPECT_NEAR(neighbor.score,
+                  CosineSimilarity(embeddings[neighbor.index], queries[i])
+                      .value(),
+                  1e-5);
+    }
+  }
+}
+
+TEST_P(EmbeddingIndexTest, SearchesWithMultipleThreads) {
+  const bool quantized = GetParam();
+  EmbeddingIndexOptions options;
+  options.num_threads = 4;
+  MP_ASSERT_OK_AND_ASSIGN(auto index,
+                          EmbeddingIndex::Create(kDimension, quantized,
+                                                 options));
+  // Enough embeddings for each thread to scan several blocks.
+  const auto embeddings = BuildRandomEmbeddings(10000, quantized, /*seed=*/1);
+  for (const auto& embedding : embeddings) {
+    MP_ASSERT_OK(index->Add(embedding));
+  }
+  const auto query = BuildRandomEmbeddings(1, quantized, /*seed=*/2)[0];
+
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors, index->Search(query, 10));
+
+  EXPECT_EQ(GetIndices(neighbors),
+            ExactNearestNeighbors(embeddings, query, 10));
+}
+
+TEST_P(EmbeddingIndexTest, SavesAndLoads) {
+  const bool quantized = GetParam();
+  MP_ASSERT_OK_AND_ASSIGN(auto index,
+                          EmbeddingIndex::Create(kDimension, quantized));
+  const auto embeddings = BuildRandomEmbeddings(101, quantized, /*seed=*/1);
+  for (const auto& embedding : embeddings) {
+    MP_ASSERT_OK(index->Add(embedding));
+  }
+  const std::string path = absl::StrCat(getenv("TEST_TMPDIR"), "/index_",
+                                        quantized ? "quantized" : "float");
+  MP_ASSERT_OK(index->Save(path));
+  auto file = std::make_unique<ExternalFile>();
+  file->set_file_name(path);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto loaded_index,
+                          EmbeddingIndex::Load(std::move(file)));
+
+  EXPECT_EQ(loaded_index->size(), 101);
+  EXPECT_EQ(loaded_index->dimension(), kDimension);
+  EXPECT_EQ(loaded_index->quantized(), quantized);
+  const auto query = BuildRandomEmbeddings(1, quantized, /*seed=*/2)[0];
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors, index->Search(query, 5));
+  MP_ASSERT_OK_AND_ASSIGN(auto loaded_neighbors,
+                          loaded_index->Search(query, 5));
+  EXPECT_EQ(GetIndices(loaded_neighbors), GetIndices(neighbors));
+
+  // Embeddings can still be added to the loaded index.
+  MP_ASSERT_OK(loaded_index->Add(query));
+  MP_ASSERT_OK_AND_ASSIGN(loaded_neighbors, loaded_index->Search(query, 1));
+  EXPECT_EQ(loaded_neighbors[0].index, 101);
+  EXPECT_NEAR(loaded_neighbors[0].score, 1.0f, 1e-5);
+}
+
+INSTANTIATE_TEST_SUITE_P(EmbeddingIndexTests, EmbeddingIndexTest,
+                         ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Quantized" : "Float";
+                         });
+
+TEST(EmbeddingIndex, SearchesDotProduct) {
+  EmbeddingIndexOptions options;
+  options.l2_normalize = false;
+  MP_ASSERT_OK_AND_ASSIGN(auto index,
+                          EmbeddingIndex::Create(2, false, options));
+  MP_ASSERT_OK(index->Add(BuildFloatEmbedding({1.0, 0.0})));
+  MP_ASSERT_OK(index->Add(BuildFloatEmbedding({3.0, 1.0})));
+  MP_ASSERT_OK(index->Add(BuildFloatEmbedding({0.0, 0.0})));
+
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors,
+                          index->Search(BuildFloatEmbedding({2.0, 0.0}), 5));
+
+  ASSERT_EQ(neighbors.size(), 3);
+  EXPECT_EQ(neighbors[0].index, 1);
+  EXPECT_FLOAT_EQ(neighbors[0].score, 6.0);
+  EXPECT_EQ(neighbors[1].index, 0);
+  EXPECT_FLOAT_EQ(neighbors[1].score, 2.0);
+  EXPECT_EQ(neighbors[2].index, 2);
+  EXPECT_FLOAT_EQ(neighbors[2].score, 0.0);
+}
+
+TEST(EmbeddingIndex, FailsWithMismatchedEmbeddings) {
+  MP_ASSERT_OK_AND_ASSIGN(auto index, EmbeddingIndex::Create(2, false));
+
+  auto status = index->Add(BuildQuantizedEmbedding({1, 2}));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("Expected a float embedding"));
+
+  status = index->Add(BuildFloatEmbedding({1.0, 2.0, 3.0}));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("Expected an embedding of size 2"));
+
+  status = index->Add(BuildFloatEmbedding({0.0, 0.0}));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("0 norm"));
+}
+
+TEST(EmbeddingIndex, FailsToLoadInvalidFile) {
+  auto file = std::make_unique<ExternalFile>();
+  file->set_file_content(std::string(100, 'x'));
+
+  auto status = EmbeddingIndex::Load(std::move(file)).status();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("Not an embedding index file"));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -21,6 +21,7 @@ limitations under the License.
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -138,12 +139,25 @@ absl::Status TaskRunner::Initialize(
     mediapipe::tool::AddMultiStreamCallback(
         output_stream_names_,
         [this](const std::vector<Packet>& packets) {
-          status_or_output_packets_ =
-              GenerateOutputPacketMap(packets, output_stream_names_);
+          SetProcessResults(packets);
           return;
         },
         &config, &input_side_packets, /*observe_timestamp_bounds=*/true);
+    MP_RETURN_IF_ERROR(graph_.SetErrorCallback(
+        [this](const absl::Status& error) { FailProcessResults(error); }));
+    MP_RETURN_IF_ERROR(
+        graph_.SetIdleCallback([this](bool idle) { SetGraphIdle(idle); }));
   }
+#ifdef __EMSCRIPTEN__
+  run_on_calling_thread_ = true;
+#else
+  run_on_calling_thread_ = std::any_of(
+      config.executor().begin(), config.executor().end(),
+      [](const ExecutorConfig& executor) {
+        return executor.name().empty() &&
+               executor.type() == "ApplicationThreadExecutor";
+      });
+#endif  // __EMSCRIPTEN__
   auto model_resources_cache =
       std::make_shared<ModelResourcesCache>(std::move(op_resolver));
   MP_RETURN_IF_ERROR(
@@ -174,6 +188,12 @@ absl::Status TaskRunner::Start() {
     absl::MutexLock lock(&mutex_);
     last_seen_ = Timestamp::Unset();
   }
+  {
+    absl::MutexLock lock(&results_mutex_);
+    graph_failed_ = false;
+    graph_idle_ = true;
+    last_added_ = Timestamp::Unset();
+  }
   MP_RETURN_IF_ERROR(
       AddPayload(graph_.StartRun({}),
                  "MediaPipe CalculatorGraph is not successfully started.",
@@ -204,50 +224,154 @@ absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
   }
   ASSIGN_OR_RETURN(auto input_timestamp, ValidateAndGetPacketTimestamp(inputs));
   // MediaPipe reports runtime errors through CalculatorGraph::WaitUntilIdle or
-  // WaitUntilDone without indicating the exact packet timestamp.
-  // To ensure that the TaskRunner::Process reports errors per invocation,
-  // the rest of the method is guarded by a lock, which guarantees that only one
-  // invocation can be processed in the graph concurrently.
-  // TODO: Switches back to the original high performance implementation
-  // when the MediaPipe CalculatorGraph can report errors in output streams.
-  absl::MutexLock lock(&mutex_);
-  // Assigns an internal synthetic timestamp when the input packets has no
-  // assigned timestamp (packets are with the default Timestamp::Unset()).
-  // Using Timestamp increment one second is to avoid interfering with the other
-  // synthetic timestamps, such as those defined by BeginLoopCalculator.
+  // WaitUntilDone without indicating the exact packet timestamp. Instead, each
+  // invocation waits for the graph output streams to settle at its timestamp,
+  // and fails if the graph fails before then. The lock only orders the input
+  // packets, so that invocations from multiple threads are pipelined.
   bool use_synthetic_timestamp = input_timestamp == Timestamp::Unset();
-  if (use_synthetic_timestamp) {
-    input_timestamp = last_seen_ == Timestamp::Unset()
-                          ? Timestamp(0)
-                          : last_seen_ + Timestamp::kTimestampUnitsPerSecond;
-  } else if (input_timestamp <= last_seen_) {
-    return CreateStatusWithPayload(
-        absl::StatusCode::kInvalidArgument,
-        "Input timestamp must be monotonically increasing.",
-        MediaPipeTasksStatus::kRunnerInvalidTimestampError);
+  {
+    absl::MutexLock lock(&mutex_);
+    // Assigns an internal synthetic timestamp when the input packets has no
+    // assigned timestamp (packets are with the default Timestamp::Unset()).
+    // Using Timestamp increment one second is to avoid interfering with the
+    // other synthetic timestamps, such as those defined by
+    // BeginLoopCalculator.
+    if (use_synthetic_timestamp) {
+      input_timestamp = last_seen_ == Timestamp::Unset()
+                            ? Timestamp(0)
+                            : last_seen_ + Timestamp::kTimestampUnitsPerSecond;
+    } else if (input_timestamp <= last_seen_) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "Input timestamp must be monotonically increasing.",
+          MediaPipeTasksStatus::kRunnerInvalidTimestampError);
+    }
+    {
+      absl::MutexLock results_lock(&results_mutex_);
+      if (graph_failed_) {
+        absl::Status graph_status;
+        graph_.GetCombinedErrors(&graph_status);
+        return graph_status;
+      }
+      // Registered before the packets are added, as the outputs may be set
+      // before AddPacketToInputStream returns.
+      process_results_.emplace(input_timestamp, std::nullopt);
+    }
+    for (auto& [stream_name, packet] : inputs) {
+      absl::Status status = graph_.AddPacketToInputStream(
+          stream_name, std::move(packet).At(input_timestamp));
+      if (!status.ok()) {
+        absl::MutexLock results_lock(&results_mutex_);
+        process_results_.erase(input_timestamp);
+        return AddPayload(
+            status,
+            absl::StrCat("Failed to add packet to the graph input stream: ",
+                         stream_name),
+            MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+      }
+    }
+    last_seen_ = input_timestamp;
+    {
+      absl::MutexLock results_lock(&results_mutex_);
+      last_added_ = input_timestamp;
+      // If the packets made no calculator runnable, the outputs that are still
+      // missing will not arrive.
+      if (graph_idle_) {
+        CompleteIdleProcessResults();
+      }
+    }
+    if (run_on_calling_thread_) {
+      // The results are set through the graph callbacks while it runs.
+      graph_.WaitUntilIdle().IgnoreError();
+    }
   }
-  for (auto& [stream_name, packet] : inputs) {
-    MP_RETURN_IF_ERROR(AddPayload(
-        graph_.AddPacketToInputStream(stream_name,
-                                      std::move(packet).At(input_timestamp)),
-        absl::StrCat("Failed to add packet to the graph input stream: ",
-                     stream_name),
-        MediaPipeTasksStatus::kRunnerUnexpectedInputError));
+  absl::StatusOr<PacketMap> status_or_output_packets;
+  {
+    absl::MutexLock results_lock(&results_mutex_);
+    auto it = process_results_.find(input_timestamp);
+    results_mutex_.Await(absl::Condition(
+        +[](std::optional<absl::StatusOr<PacketMap>>* result) {
+          return result->has_value();
+        },
+        &it->second));
+    status_or_output_packets = *std::move(it->second);
+    process_results_.erase(it);
   }
-  last_seen_ = input_timestamp;
-  if (!graph_.WaitUntilIdle().ok()) {
-    absl::Status graph_status;
-    graph_.GetCombinedErrors(&graph_status);
+  // Reports all the graph errors, as the error that failed this invocation
+  // may have been caused by an earlier one.
+  absl::Status graph_status;
+  if (!status_or_output_packets.ok() &&
+      graph_.GetCombinedErrors(&graph_status)) {
     return graph_status;
   }
-  // When a synthetic timestamp is used, uses the timestamp of the first
-  // output packet as the last seen timestamp if there is any output packet.
-  if (use_synthetic_timestamp && status_or_output_packets_.ok()) {
-    for (auto& kv : status_or_output_packets_.value()) {
-      last_seen_ = std::max(kv.second.Timestamp(), last_seen_);
+  return status_or_output_packets;
+}
+
+void TaskRunner::SetProcessResults(const std::vector<Packet>& packets) {
+  // The packets of the output streams with outputs carry the timestamp at
+  // which the streams settled. The empty packets of the other streams carry
+  // their own timestamp bounds, which may be later, so the settled timestamp is
+  // the earliest one.
+  Timestamp timestamp = Timestamp::Max();
+  for (const Packet& packet : packets) {
+    timestamp = std::min(timestamp, packet.Timestamp());
+  }
+  absl::MutexLock lock(&results_mutex_);
+  // The packets belong to the last invocation at or before their timestamp.
+  // Earlier invocations whose timestamps the output streams skipped have no
+  // outputs.
+  auto end = process_results_.upper_bound(timestamp);
+  for (auto it = process_results_.begin(); it != end; ++it) {
+    if (it->second.has_value()) {
+      continue;
+    }
+    it->second = GenerateOutputPacketMap(
+        std::next(it) == end ? packets : std::vector<Packet>(packets.size()),
+        output_stream_names_);
+  }
+}
+
+void TaskRunner::FailProcessResults(const absl::Status& error) {
+  {
+    absl::MutexLock lock(&results_mutex_);
+    graph_failed_ = true;
+  }
+  FailPendingProcessResults(error);
+}
+
+void TaskRunner::SetGraphIdle(bool idle) {
+  absl::MutexLock lock(&results_mutex_);
+  graph_idle_ = idle;
+  if (idle) {
+    CompleteIdleProcessResults();
+  }
+}
+
+void TaskRunner::CompleteIdleProcessResults() {
+  // The graph has processed all the packets added so far, so the outputs of
+  // the invocations whose packets were all added, which are still missing,
+  // will not arrive. This happens when a calculator neither sends a packet
+  // nor advances the timestamp bound of an output stream.
+  if (last_added_ == Timestamp::Unset()) {
+    return;
+  }
+  auto end = process_results_.upper_bound(last_added_);
+  for (auto it = process_results_.begin(); it != end; ++it) {
+    if (!it->second.has_value()) {
+      it->second = GenerateOutputPacketMap(
+          std::vector<Packet>(output_stream_names_.size()),
+          output_stream_names_);
+    }
+  }
+}
+
+void TaskRunner::FailPendingProcessResults(const absl::Status& error) {
+  absl::MutexLock lock(&results_mutex_);
+  for (auto& [timestamp, result] : process_results_) {
+    if (!result.has_value()) {
+      result = error;
     }
   }
-  return status_or_output_packets_;
 }
 
 absl::Status TaskRunner::Send(PacketMap inputs) {
@@ -300,13 +424,20 @@ absl::Status TaskRunner::Close() {
         MediaPipeTasksStatus::kRunnerFailsToCloseError);
   }
   is_running_ = false;
-  MP_RETURN_IF_ERROR(
+  absl::Status status =
       AddPayload(graph_.CloseAllInputStreams(), "Fail to close input streams",
-                 MediaPipeTasksStatus::kRunnerFailsToCloseError));
-  MP_RETURN_IF_ERROR(AddPayload(
-      graph_.WaitUntilDone(), "Fail to shutdown the MediaPipe graph.",
+                 MediaPipeTasksStatus::kRunnerFailsToCloseError);
+  if (status.ok()) {
+    status = AddPayload(graph_.WaitUntilDone(),
+                        "Fail to shutdown the MediaPipe graph.",
+                        MediaPipeTasksStatus::kRunnerFailsToCloseError);
+  }
+  // The Process() invocations still in flight will get no outputs from the
+  // closed graph.
+  FailPendingProcessResults(CreateStatusWithPayload(
+      absl::StatusCode::kCancelled, "Task runner was closed.",
       MediaPipeTasksStatus::kRunnerFailsToCloseError));
-  return absl::OkStatus();
+  return status;
 }
 
 absl::Status TaskRunner::Restart() {
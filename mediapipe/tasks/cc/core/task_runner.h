@@ -24,6 +24,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -86,10 +87,13 @@ class TaskRunner {
   // If the input packets have no timestamp, an internal timestamp will be
   // assigned per invocation. Otherwise, when the timestamp is set in the
   // input packets, the caller must ensure that the input packet timestamps are
-  // greater than the timestamps of the previous invocation. This method is
-  // thread-unsafe and it is the caller's responsibility to synchronize access
-  // to this method across multiple threads and to ensure that the input packet
-  // timestamps are in order.
+  // greater than the timestamps of the previous invocation.
+  // This method is thread-safe. Invocations from multiple threads are
+  // processed concurrently, pipelined through the graph, and each of them only
+  // waits for the graph outputs at its own timestamp. If the graph fails, the
+  // invocations whose outputs are not complete yet return the graph errors.
+  // If the graph becomes idle before an output stream settles at the
+  // timestamp of an invocation, the invocation gets an empty packet for it.
   absl::StatusOr<PacketMap> Process(PacketMap inputs);
 
   // An asynchronous method that is designed for handling live streaming data
@@ -132,15 +136,51 @@ class TaskRunner {
   // indicate that the runner isn't started successfully.
   absl::Status Start();
 
+  // Sets the results of the Process() invocations that the output packets
+  // complete. Invoked by the graph output callback in the synchronous mode.
+  void SetProcessResults(const std::vector<Packet>& packets);
+
+  // Fails the Process() invocations in flight. Invoked by the graph when it
+  // encounters an error.
+  void FailProcessResults(const absl::Status& error);
+
+  // Records whether the graph is idle, and if so, completes the results of the
+  // Process() invocations that the graph will not produce outputs for.
+  // Invoked by the graph when it becomes busy or idle.
+  void SetGraphIdle(bool idle);
+
+  // Sets empty outputs as the missing results of the Process() invocations
+  // whose input packets were all added to the idle graph.
+  void CompleteIdleProcessResults()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(results_mutex_);
+
+  // Fails the Process() invocations in flight without marking the graph as
+  // failed. Invoked when the task runner is closed.
+  void FailPendingProcessResults(const absl::Status& error);
+
   PacketsCallback packets_callback_;
   std::vector<std::string> output_stream_names_;
   CalculatorGraph graph_;
   bool initialized_ = false;
   std::atomic_bool is_running_ = false;
+  // True if the graph only runs in WaitUntilIdle(), on the calling thread.
+  bool run_on_calling_thread_ = false;
 
-  absl::StatusOr<PacketMap> status_or_output_packets_;
+  // Orders the packets added to the graph.
   Timestamp last_seen_ ABSL_GUARDED_BY(mutex_);
   absl::Mutex mutex_;
+
+  // The results of the Process() invocations in flight, by input timestamp.
+  // A result is unset until the graph output streams settle at or after its
+  // timestamp, or the graph fails.
+  std::map<Timestamp, std::optional<absl::StatusOr<PacketMap>>>
+      process_results_ ABSL_GUARDED_BY(results_mutex_);
+  bool graph_failed_ ABSL_GUARDED_BY(results_mutex_) = false;
+  // Whether the graph has nothing left to run.
+  bool graph_idle_ ABSL_GUARDED_BY(results_mutex_) = true;
+  // The timestamp of the last invocation whose packets were all added.
+  Timestamp last_added_ ABSL_GUARDED_BY(results_mutex_);
+  absl::Mutex results_mutex_ ABSL_ACQUIRED_AFTER(mutex_);
 };
 
 }  // namespace core
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/notification.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -78,6 +79,130 @@ CalculatorGraphConfig GetErrorCalculatorGraphConfig() {
         })pb");
 }
 
+// Notified by BlockingPassThroughCalculator once it blocks, and by
+// ReleasingPassThroughCalculator to unblock it.
+absl::Notification* blocked_notification = nullptr;
+absl::Notification* release_notification = nullptr;
+
+// A calculator that blocks on the packet with value 1 until
+// ReleasingPassThroughCalculator receives the packet with value 2.
+class BlockingPassThroughCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    if (cc->Inputs().Index(0).Get<int>() == 1) {
+      blocked_notification->Notify();
+      release_notification->WaitForNotification();
+    }
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BlockingPassThroughCalculator);
+
+class ReleasingPassThroughCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    if (cc->Inputs().Index(0).Get<int>() == 2) {
+      release_notification->Notify();
+    }
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(ReleasingPassThroughCalculator);
+
+CalculatorGraphConfig GetBlockingGraphConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        output_stream: "out"
+        output_stream: "released"
+        # One thread for each calculator, as one of them blocks.
+        num_threads: 2
+        node {
+          calculator: "BlockingPassThroughCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        }
+        node {
+          calculator: "ReleasingPassThroughCalculator"
+          input_stream: "in"
+          output_stream: "released"
+        })pb");
+}
+
+// A calculator that sends no packets, and advances the timestamp bound of its
+// output stream well past each input timestamp.
+class LeadingBoundCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    cc->Outputs().Index(0).SetNextTimestampBound(
+        cc->InputTimestamp() + 10 * Timestamp::kTimestampUnitsPerSecond);
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(LeadingBoundCalculator);
+
+// The output stream "ahead" settles long before the blocked "out" stream.
+CalculatorGraphConfig GetBlockingGraphWithLeadingBoundConfig() {
+  CalculatorGraphConfig config = GetBlockingGraphConfig();
+  config.mutable_output_stream()->Clear();
+  config.add_output_stream("ahead");
+  config.add_output_stream("out");
+  config.add_output_stream("released");
+  auto* node = config.add_node();
+  node->set_calculator("LeadingBoundCalculator");
+  node->add_input_stream("in");
+  node->add_output_stream("ahead");
+  return config;
+}
+
+// A calculator that neither sends packets nor advances the timestamp bound of
+// its output stream, which never settles.
+class SilentCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SilentCalculator);
+
+CalculatorGraphConfig GetSilentGraphConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        output_stream: "out"
+        node {
+          calculator: "SilentCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        })pb");
+}
+
 CalculatorGraphConfig GetModelSidePacketsToStreamPacketsGraphConfig(
     const std::string& model_resources_tag) {
   return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
@@ -254,6 +379,68 @@ TEST_F(TaskRunnerTest, MultiThreadSyncAPICallsWithoutTimestamp) {
   MP_ASSERT_OK(runner->Close());
 }
 
+TEST_F(TaskRunnerTest, PipelinedSyncAPICalls) {
+  absl::Notification blocked;
+  absl::Notification release;
+  blocked_notification = &blocked;
+  release_notification = &release;
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetBlockingGraphConfig()));
+  // The first call blocks in the graph until the packets of the second call
+  // reach it, so the second call must not wait for the first one.
+  std::thread thread([&runner]() {
+    auto status_or_result = runner->Process({{"in", MakePacket<int>(1)}});
+    ASSERT_TRUE(status_or_result.ok());
+    EXPECT_EQ(1, status_or_result.value()["out"].Get<int>());
+  });
+  blocked.WaitForNotification();
+  auto status_or_result = runner->Process({{"in", MakePacket<int>(2)}});
+  ASSERT_TRUE(status_or_result.ok());
+  EXPECT_EQ(2, status_or_result.value()["out"].Get<int>());
+  EXPECT_EQ(2, status_or_result.value()["released"].Get<int>());
+  thread.join();
+  MP_ASSERT_OK(runner->Close());
+}
+
+TEST_F(TaskRunnerTest, PipelinedSyncAPICallsWithUnevenTimestampBounds) {
+  absl::Notification blocked;
+  absl::Notification release;
+  blocked_notification = &blocked;
+  release_notification = &release;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner, TaskRunner::Create(GetBlockingGraphWithLeadingBoundConfig()));
+  // While the first call blocks, the "ahead" output stream settles past the
+  // timestamps of both calls, but each call must still get its own outputs.
+  std::thread thread([&runner]() {
+    auto status_or_result = runner->Process({{"in", MakePacket<int>(1)}});
+    ASSERT_TRUE(status_or_result.ok());
+    EXPECT_TRUE(status_or_result.value()["ahead"].IsEmpty());
+    EXPECT_EQ(1, status_or_result.value()["out"].Get<int>());
+    EXPECT_EQ(1, status_or_result.value()["released"].Get<int>());
+  });
+  blocked.WaitForNotification();
+  auto status_or_result = runner->Process({{"in", MakePacket<int>(2)}});
+  ASSERT_TRUE(status_or_result.ok());
+  EXPECT_TRUE(status_or_result.value()["ahead"].IsEmpty());
+  EXPECT_EQ(2, status_or_result.value()["out"].Get<int>());
+  EXPECT_EQ(2, status_or_result.value()["released"].Get<int>());
+  thread.join();
+  MP_ASSERT_OK(runner->Close());
+}
+
+TEST_F(TaskRunnerTest, SyncAPICallsWithUnsettledOutputStream) {
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetSilentGraphConfig()));
+  // The output stream never settles, so each call returns once the graph is
+  // idle, with an empty packet.
+  for (int i = 0; i < 10; ++i) {
+    auto status_or_result = runner->Process({{"in", MakePacket<int>(i)}});
+    ASSERT_TRUE(status_or_result.ok());
+    EXPECT_TRUE(status_or_result.value()["out"].IsEmpty());
+  }
+  MP_ASSERT_OK(runner->Close());
+}
+
 TEST_F(TaskRunnerTest, AsyncAPICalls) {
   std::function<void(absl::StatusOr<PacketMap>)> callback(
       [](absl::StatusOr<PacketMap> status_or_packets) {
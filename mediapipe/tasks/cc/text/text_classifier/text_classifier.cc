@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/proto/classifier_options.pb.h"
 #include "mediapipe/tasks/cc/core/task_api_factory.h"
 #include "mediapipe/tasks/cc/text/text_classifier/proto/text_classifier_graph_options.pb.h"
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 
 namespace mediapipe {
@@ -43,21 +45,32 @@ using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
 
 constexpr char kTextStreamName[] = "text_in";
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kClassificationsStreamName[] = "classifications_out";
 constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
+constexpr char kBatchedClassificationsTag[] = "BATCHED_CLASSIFICATIONS";
 constexpr char kSubgraphTypeName[] =
     "mediapipe.tasks.text.text_classifier.TextClassifierGraph";
 
 // Creates a MediaPipe graph config that only contains a single subgraph node of
-// type "TextClassifierGraph".
+// type "TextClassifierGraph". With `batched`, the graph takes batches of texts,
+// which both Classify() and ClassifyBatch() send, so that it has a single input
+// stream. Otherwise it takes single texts.
 CalculatorGraphConfig CreateGraphConfig(
-    std::unique_ptr<proto::TextClassifierGraphOptions> options) {
+    std::unique_ptr<proto::TextClassifierGraphOptions> options, bool batched) {
   api2::builder::Graph graph;
   auto& subgraph = graph.AddNode(kSubgraphTypeName);
   subgraph.GetOptions<proto::TextClassifierGraphOptions>().Swap(options.get());
-  graph.In(kTextTag).SetName(kTextStreamName) >> subgraph.In(kTextTag);
-  subgraph.Out(kClassificationsTag).SetName(kClassificationsStreamName) >>
-      graph.Out(kClassificationsTag);
+  if (batched) {
+    graph.In(kTextsTag).SetName(kTextStreamName) >> subgraph.In(kTextsTag);
+    subgraph.Out(kBatchedClassificationsTag)
+            .SetName(kClassificationsStreamName) >>
+        graph.Out(kBatchedClassificationsTag);
+  } else {
+    graph.In(kTextTag).SetName(kTextStreamName) >> subgraph.In(kTextTag);
+    subgraph.Out(kClassificationsTag).SetName(kClassificationsStreamName) >>
+        graph.Out(kClassificationsTag);
+  }
   return graph.GetConfig();
 }
 
@@ -75,6 +88,8 @@ ConvertTextClassifierOptionsToProto(TextClassifierOptions* options) {
               &(options->classifier_options)));
   options_proto->mutable_classifier_options()->Swap(
       classifier_options_proto.get());
+  options_proto->set_num_tokenizer_threads(
+      options->batch_options.num_tokenizer_threads);
   return options_proto;
 }
 
@@ -83,14 +98,30 @@ ConvertTextClassifierOptionsToProto(TextClassifierOptions* options) {
 absl::StatusOr<std::unique_ptr<TextClassifier>> TextClassifier::Create(
     std::unique_ptr<TextClassifierOptions> options) {
   auto options_proto = ConvertTextClassifierOptionsToProto(options.get());
-  return core::TaskApiFactory::Create<TextClassifier,
-                                      proto::TextClassifierGraphOptions>(
-      CreateGraphConfig(std::move(options_proto)),
-      std::move(options->base_options.op_resolver));
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<TextClassifier> classifier,
+      (core::TaskApiFactory::Create<TextClassifier,
+                                    proto::TextClassifierGraphOptions>(
+          CreateGraphConfig(
+              std::move(options_proto),
+              utils::UsesBatchedInference(options->batch_options)),
+          std::move(options->base_options.op_resolver))));
+  classifier->batch_options_ = options->batch_options;
+  return classifier;
 }
 
 absl::StatusOr<TextClassifierResult> TextClassifier::Classify(
     absl::string_view text) {
+  if (utils::UsesBatchedInference(batch_options_)) {
+    ASSIGN_OR_RETURN(
+        auto output_packets,
+        runner_->Process({{kTextStreamName,
+                           MakePacket<std::vector<std::string>>(
+                               std::vector<std::string>{std::string(text)})}}));
+    return ConvertToClassificationResult(
+        output_packets[kClassificationsStreamName]
+            .Get<std::vector<ClassificationResult>>()[0]);
+  }
   ASSIGN_OR_RETURN(
       auto output_packets,
       runner_->Process(
@@ -99,6 +130,36 @@ absl::StatusOr<TextClassifierResult> TextClassifier::Classify(
       output_packets[kClassificationsStreamName].Get<ClassificationResult>());
 }
 
+absl::StatusOr<std::vector<TextClassifierResult>>
+TextClassifier::ClassifyBatch(const std::vector<std::string>& texts) {
+  std::vector<TextClassifierResult> results(texts.size());
+  if (!utils::UsesBatchedInference(batch_options_)) {
+    for (int i = 0; i < texts.size(); ++i) {
+      ASSIGN_OR_RETURN(results[i], Classify(texts[i]));
+    }
+    return results;
+  }
+  for (const std::vector<int>& batch :
+       utils::SplitIntoBatches(texts, batch_options_)) {
+    std::vector<std::string> batch_texts;
+    batch_texts.reserve(batch.size());
+    for (int index : batch) {
+      batch_texts.push_back(texts[index]);
+    }
+    ASSIGN_OR_RETURN(
+        auto output_packets,
+        runner_->Process({{kTextStreamName,
+                           MakePacket<std::vector<std::string>>(
+                               std::move(batch_texts))}}));
+    const auto& batch_results = output_packets[kClassificationsStreamName]
+                                    .Get<std::vector<ClassificationResult>>();
+    for (int i = 0; i < batch.size(); ++i) {
+      results[batch[i]] = ConvertToClassificationResult(batch_results[i]);
+    }
+  }
+  return results;
+}
+
 }  // namespace text_classifier
 }  // namespace text
 }  // namespace tasks
@@ -17,6 +17,8 @@ limitations under the License.
 #define MEDIAPIPE_TASKS_CC_TEXT_TEXT_CLASSIFIER_TEXT_CLASSIFIER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/classifier_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/core/base_task_api.h"
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -44,6 +47,10 @@ struct TextClassifierOptions {
   // Options for configuring the classifier behavior, such as score threshold,
   // number of results, etc.
   components::processors::ClassifierOptions classifier_options;
+
+  // Options for running ClassifyBatch(), such as the maximum number of texts
+  // run through the model in one inference.
+  text::utils::TextBatchOptions batch_options;
 };
 
 // Performs classification on text.
@@ -65,6 +72,12 @@ struct TextClassifierOptions {
 //   or (kTfLiteString)
 //    - 1 input tensor that is shapeless or has shape [1] containing the input
 //      string
+// With `batch_options.max_batch_size` other than 1, models with int32 input
+// tensors run the texts of a ClassifyBatch() call in batches of up to that
+// size, which requires their input tensors to be resizable along the batch
+// dimension, and Classify() runs a batch of one. Models with string input
+// tensors run texts one at a time. By default, texts are classified one at a
+// time with the single text graph.
 // At least one output tensor with:
 //   (kTfLiteFloat32/kBool)
 //    - `[1 x N]` array with `N` represents the number of categories.
@@ -87,8 +100,17 @@ class TextClassifier : core::BaseTaskApi {
   // Performs classification on the input `text`.
   absl::StatusOr<TextClassifierResult> Classify(absl::string_view text);
 
+  // Performs classification on each of the input `texts`, running them through
+  // the model in batches as configured by `batch_options`. Returns one result
+  // per text, in the order of `texts`.
+  absl::StatusOr<std::vector<TextClassifierResult>> ClassifyBatch(
+      const std::vector<std::string>& texts);
+
   // Shuts down the TextClassifier when all the work is done.
   absl::Status Close() { return runner_->Close(); }
+
+ private:
+  text::utils::TextBatchOptions batch_options_;
 };
 
 }  // namespace text_classifier
@@ -15,6 +15,7 @@ limitations under the License.
 #include <cstdint>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -22,6 +23,7 @@ limitations under the License.
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
 #include "mediapipe/tasks/cc/components/processors/classification_postprocessing_graph.h"
 #include "mediapipe/tasks/cc/components/processors/proto/classification_postprocessing_graph_options.pb.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/model_task_graph.h"
 #include "mediapipe/tasks/cc/core/proto/model_resources_calculator.pb.h"
 #include "mediapipe/tasks/cc/text/text_classifier/proto/text_classifier_graph_options.pb.h"
+#include "mediapipe/util/graph_builder_utils.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -44,10 +47,14 @@ using ::mediapipe::api2::Output;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
 using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
+using ::mediapipe::tasks::components::processors::proto::
+    TextPreprocessingGraphOptions;
 using ::mediapipe::tasks::core::ModelResources;
 
 constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
+constexpr char kBatchedClassificationsTag[] = "BATCHED_CLASSIFICATIONS";
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kTensorsTag[] = "TENSORS";
 
@@ -58,12 +65,20 @@ constexpr char kTensorsTag[] = "TENSORS";
 // - Accepts input text and outputs classification results on CPU.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     Input text to perform classification on.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts to perform classification on. Texts are run
+//     through the model as a single batch if the model takes token ids, i.e.
+//     for BERT and regex models, and one at a time otherwise. Exactly one of
+//     TEXT and TEXTS must be connected.
 //
 // Outputs:
 //   CLASSIFICATIONS - ClassificationResult @Optional
-//     The classification results aggregated by classifier head.
+//     The classification results aggregated by classifier head. Only
+//     available with the TEXT input.
+//   BATCHED_CLASSIFICATIONS - std::vector<ClassificationResult> @Optional
+//     The classification results of each text of the TEXTS input, in order.
 //
 // Example:
 // node {
@@ -89,6 +104,18 @@ class TextClassifierGraph : public core::ModelTaskGraph {
         const ModelResources* model_resources,
         CreateModelResources<proto::TextClassifierGraphOptions>(sc));
     Graph graph;
+    if (HasInput(sc->OriginalNode(), kTextsTag)) {
+      ASSIGN_OR_RETURN(
+          auto batched_classifications,
+          BuildBatchedTextClassifierTask(
+              sc->Options<proto::TextClassifierGraphOptions>(),
+              *model_resources,
+              graph[Input<std::vector<std::string>>(kTextsTag)], graph));
+      batched_classifications >>
+          graph[Output<std::vector<ClassificationResult>>(
+              kBatchedClassificationsTag)];
+      return graph.GetConfig();
+    }
     ASSIGN_OR_RETURN(
         auto classifications,
         BuildTextClassifierTask(
@@ -132,7 +159,90 @@ class TextClassifierGraph : public core::ModelTaskGraph {
         preprocessing.SideIn(kMetadataExtractorTag);
     preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
 
-    // Adds postprocessing calculators and connects them to the graph output.
+    return BuildClassificationPostprocessing(
+        task_options, model_resources,
+        inference[Output<std::vector<Tensor>>(kTensorsTag)], graph);
+  }
+
+  // Adds a mediapipe TextClassifier task graph classifying a batch of texts
+  // into the provided builder::Graph instance. BERT and regex models run the
+  // whole batch in a single inference, whose outputs are then postprocessed
+  // text by text. Other models run the single text task on each text in turn.
+  //
+  // task_options: the mediapipe tasks TextClassifierGraphOptions proto.
+  // model_resources: the ModelResources object initialized from a
+  //   TextClassifier model file with model metadata.
+  // texts_in: (std::vector<std::string>) stream to run text classification
+  //   on.
+  // graph: the mediapipe builder::Graph instance to be updated.
+  absl::StatusOr<Source<std::vector<ClassificationResult>>>
+  BuildBatchedTextClassifierTask(
+      const proto::TextClassifierGraphOptions& task_options,
+      const ModelResources& model_resources,
+      Source<std::vector<std::string>> texts_in, Graph& graph) {
+    TextPreprocessingGraphOptions preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureTextPreprocessingGraph(
+        model_resources, preprocessing_options));
+    auto& end_loop = graph.AddNode(
+        "mediapipe.tasks.EndLoopClassificationResultCalculator");
+
+    if (!components::processors::SupportsBatchedInput(preprocessing_options)) {
+      auto& begin_loop = graph.AddNode("BeginLoopStringCalculator");
+      texts_in >> begin_loop.In("ITERABLE");
+      begin_loop.Out("BATCH_END") >> end_loop.In("BATCH_END");
+      ASSIGN_OR_RETURN(
+          auto classifications,
+          BuildTextClassifierTask(task_options, model_resources,
+                                  begin_loop[Output<std::string>("ITEM")],
+                                  graph));
+      classifications >> end_loop.In("ITEM");
+      return end_loop[Output<std::vector<ClassificationResult>>("ITERABLE")];
+    }
+
+    // Tokenizes all texts into input tensors with a batch entry per text.
+    auto& preprocessing = graph.AddNode(
+        "mediapipe.tasks.components.processors.TextPreprocessingGraph");
+    preprocessing_options.set_num_threads(task_options.num_tokenizer_threads());
+    preprocessing.GetOptions<TextPreprocessingGraphOptions>().CopyFrom(
+        preprocessing_options);
+    texts_in >> preprocessing.In(kTextsTag);
+
+    auto& inference = AddInference(
+        model_resources, task_options.base_options().acceleration(), graph);
+    inference.SideOut(kMetadataExtractorTag) >>
+        preprocessing.SideIn(kMetadataExtractorTag);
+    preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
+
+    // Loops over the indices of the texts, which are also the batch indices of
+    // the output tensors, to postprocess the outputs of each text.
+    auto& text_indices = graph.AddNode("StringVectorIndicesCalculator");
+    texts_in >> text_indices.In("VECTOR");
+    auto& begin_loop = graph.AddNode("BeginLoopIntCalculator");
+    text_indices.Out("INDICES") >> begin_loop.In("ITERABLE");
+    inference.Out(kTensorsTag) >> begin_loop.In("CLONE");
+    begin_loop.Out("BATCH_END") >> end_loop.In("BATCH_END");
+
+    auto& get_output_tensors = graph.AddNode("GetTensorsBatchItemCalculator");
+    begin_loop.Out("CLONE") >> get_output_tensors.In(kTensorsTag);
+    begin_loop.Out("ITEM") >> get_output_tensors.In("INDEX");
+
+    ASSIGN_OR_RETURN(
+        auto classifications,
+        BuildClassificationPostprocessing(
+            task_options, model_resources,
+            get_output_tensors[Output<std::vector<Tensor>>(kTensorsTag)],
+            graph));
+    classifications >> end_loop.In("ITEM");
+    return end_loop[Output<std::vector<ClassificationResult>>("ITERABLE")];
+  }
+
+  // Adds the postprocessing of the model outputs in tensors_in into a
+  // classification result.
+  absl::StatusOr<Source<ClassificationResult>>
+  BuildClassificationPostprocessing(
+      const proto::TextClassifierGraphOptions& task_options,
+      const ModelResources& model_resources,
+      Source<std::vector<Tensor>> tensors_in, Graph& graph) {
     auto& postprocessing = graph.AddNode(
         "mediapipe.tasks.components.processors."
         "ClassificationPostprocessingGraph");
@@ -142,7 +252,7 @@ class TextClassifierGraph : public core::ModelTaskGraph {
             &postprocessing
                  .GetOptions<components::processors::proto::
                                  ClassificationPostprocessingGraphOptions>()));
-    inference.Out(kTensorsTag) >> postprocessing.In(kTensorsTag);
+    tensors_in >> postprocessing.In(kTensorsTag);
 
     // Outputs the aggregated classification result as the subgraph output
     // stream.
@@ -19,6 +19,7 @@ limitations under the License.
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
@@ -231,6 +232,55 @@ TEST_F(TextClassifierTest, TextClassifierWithStringToBool) {
   MP_ASSERT_OK(classifier->Close());
 }
 
+TEST_F(TextClassifierTest, ClassifyBatchMatchesClassify) {
+  const std::vector<std::string> texts = {
+      "unflinchingly bleak and desperate",
+      "it's a charming and often affecting journey",
+      "What a waste of my time.",
+      "This is the best movie I’ve seen in recent years.",
+      "meh"};
+  for (const char* model_path : {kTestBertModelPath, kTestRegexModelPath}) {
+    auto options = std::make_unique<TextClassifierOptions>();
+    options->base_options.model_asset_path = GetFullPath(model_path);
+    options->batch_options.max_batch_size = 2;
+    options->batch_options.bucket_by_length = true;
+    options->batch_options.num_tokenizer_threads = 2;
+    MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextClassifier> classifier,
+                            TextClassifier::Create(std::move(options)));
+
+    MP_ASSERT_OK_AND_ASSIGN(std::vector<TextClassifierResult> results,
+                            classifier->ClassifyBatch(texts));
+
+    ASSERT_EQ(results.size(), texts.size());
+    for (int i = 0; i < texts.size(); ++i) {
+      MP_ASSERT_OK_AND_ASSIGN(TextClassifierResult expected,
+                              classifier->Classify(texts[i]));
+      ExpectApproximatelyEqual(results[i], expected);
+    }
+    MP_ASSERT_OK(classifier->Close());
+  }
+}
+
+TEST_F(TextClassifierTest, ClassifyBatchWithStringToBool) {
+  auto options = std::make_unique<TextClassifierOptions>();
+  options->base_options.model_asset_path = GetFullPath(kStringToBoolModelPath);
+  options->base_options.op_resolver = CreateCustomResolver();
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextClassifier> classifier,
+                          TextClassifier::Create(std::move(options)));
+
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<TextClassifierResult> results,
+                          classifier->ClassifyBatch({"hello", "hi", "hey"}));
+
+  ASSERT_EQ(results.size(), 3);
+  for (const TextClassifierResult& result : results) {
+    ASSERT_EQ(result.classifications.size(), 1);
+    ASSERT_EQ(result.classifications[0].categories.size(), 3);
+  }
+  MP_ASSERT_OK_AND_ASSIGN(results, classifier->ClassifyBatch({}));
+  EXPECT_TRUE(results.empty());
+  MP_ASSERT_OK(classifier->Close());
+}
+
 TEST_F(TextClassifierTest, BertLongPositive) {
   std::stringstream ss_for_positive_review;
   ss_for_positive_review
@@ -16,6 +16,9 @@ limitations under the License.
 #include "mediapipe/tasks/cc/text/text_embedder/text_embedder.h"
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
@@ -30,12 +33,15 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/proto/base_options.pb.h"
 #include "mediapipe/tasks/cc/core/task_api_factory.h"
 #include "mediapipe/tasks/cc/text/text_embedder/proto/text_embedder_graph_options.pb.h"
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
 
 namespace mediapipe::tasks::text::text_embedder {
 namespace {
 
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kEmbeddingsTag[] = "EMBEDDINGS";
+constexpr char kBatchedEmbeddingsTag[] = "BATCHED_EMBEDDINGS";
 constexpr char kTextInStreamName[] = "text_in";
 constexpr char kEmbeddingsStreamName[] = "embeddings_out";
 constexpr char kGraphTypeName[] =
@@ -45,16 +51,25 @@ using ::mediapipe::tasks::components::containers::ConvertToEmbeddingResult;
 using ::mediapipe::tasks::components::containers::proto::EmbeddingResult;
 
 // Creates a MediaPipe graph config that contains a single node of type
-// "mediapipe.tasks.text.text_embedder.TextEmbedderGraph".
+// "mediapipe.tasks.text.text_embedder.TextEmbedderGraph". With `batched`, the
+// graph takes batches of texts, which both Embed() and EmbedBatch() send, so
+// that it has a single input stream. Otherwise it takes single texts.
 CalculatorGraphConfig CreateGraphConfig(
-    std::unique_ptr<proto::TextEmbedderGraphOptions> options_proto) {
+    std::unique_ptr<proto::TextEmbedderGraphOptions> options_proto,
+    bool batched) {
   api2::builder::Graph graph;
   auto& task_graph = graph.AddNode(kGraphTypeName);
   task_graph.GetOptions<proto::TextEmbedderGraphOptions>().Swap(
       options_proto.get());
-  graph.In(kTextTag).SetName(kTextInStreamName) >> task_graph.In(kTextTag);
-  task_graph.Out(kEmbeddingsTag).SetName(kEmbeddingsStreamName) >>
-      graph.Out(kEmbeddingsTag);
+  if (batched) {
+    graph.In(kTextsTag).SetName(kTextInStreamName) >> task_graph.In(kTextsTag);
+    task_graph.Out(kBatchedEmbeddingsTag).SetName(kEmbeddingsStreamName) >>
+        graph.Out(kBatchedEmbeddingsTag);
+  } else {
+    graph.In(kTextTag).SetName(kTextInStreamName) >> task_graph.In(kTextTag);
+    task_graph.Out(kEmbeddingsTag).SetName(kEmbeddingsStreamName) >>
+        graph.Out(kEmbeddingsTag);
+  }
   return graph.GetConfig();
 }
 
@@ -71,6 +86,8 @@ ConvertTextEmbedderOptionsToProto(TextEmbedderOptions* options) {
           components::processors::ConvertEmbedderOptionsToProto(
               &(options->embedder_options)));
   options_proto->mutable_embedder_options()->Swap(embedder_options_proto.get());
+  options_proto->set_num_tokenizer_threads(
+      options->batch_options.num_tokenizer_threads);
   return options_proto;
 }
 
@@ -80,13 +97,29 @@ absl::StatusOr<std::unique_ptr<TextEmbedder>> TextEmbedder::Create(
     std::unique_ptr<TextEmbedderOptions> options) {
   std::unique_ptr<proto::TextEmbedderGraphOptions> options_proto =
       ConvertTextEmbedderOptionsToProto(options.get());
-  return core::TaskApiFactory::Create<TextEmbedder,
-                                      proto::TextEmbedderGraphOptions>(
-      CreateGraphConfig(std::move(options_proto)),
-      std::move(options->base_options.op_resolver));
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<TextEmbedder> embedder,
+      (core::TaskApiFactory::Create<TextEmbedder,
+                                    proto::TextEmbedderGraphOptions>(
+          CreateGraphConfig(
+              std::move(options_proto),
+              utils::UsesBatchedInference(options->batch_options)),
+          std::move(options->base_options.op_resolver))));
+  embedder->batch_options_ = options->batch_options;
+  return embedder;
 }
 
 absl::StatusOr<TextEmbedderResult> TextEmbedder::Embed(absl::string_view text) {
+  if (utils::UsesBatchedInference(batch_options_)) {
+    ASSIGN_OR_RETURN(
+        auto output_packets,
+        runner_->Process({{kTextInStreamName,
+                           MakePacket<std::vector<std::string>>(
+                               std::vector<std::string>{std::string(text)})}}));
+    return ConvertToEmbeddingResult(
+        output_packets[kEmbeddingsStreamName]
+            .Get<std::vector<EmbeddingResult>>()[0]);
+  }
   ASSIGN_OR_RETURN(
       auto output_packets,
       runner_->Process(
@@ -95,6 +128,36 @@ absl::StatusOr<TextEmbedderResult> TextEmbedder::Embed(absl::string_view text) {
       output_packets[kEmbeddingsStreamName].Get<EmbeddingResult>());
 }
 
+absl::StatusOr<std::vector<TextEmbedderResult>> TextEmbedder::EmbedBatch(
+    const std::vector<std::string>& texts) {
+  std::vector<TextEmbedderResult> results(texts.size());
+  if (!utils::UsesBatchedInference(batch_options_)) {
+    for (int i = 0; i < texts.size(); ++i) {
+      ASSIGN_OR_RETURN(results[i], Embed(texts[i]));
+    }
+    return results;
+  }
+  for (const std::vector<int>& batch :
+       utils::SplitIntoBatches(texts, batch_options_)) {
+    std::vector<std::string> batch_texts;
+    batch_texts.reserve(batch.size());
+    for (int index : batch) {
+      batch_texts.push_back(texts[index]);
+    }
+    ASSIGN_OR_RETURN(
+        auto output_packets,
+        runner_->Process({{kTextInStreamName,
+                           MakePacket<std::vector<std::string>>(
+                               std::move(batch_texts))}}));
+    const auto& batch_results = output_packets[kEmbeddingsStreamName]
+                                    .Get<std::vector<EmbeddingResult>>();
+    for (int i = 0; i < batch.size(); ++i) {
+      results[batch[i]] = ConvertToEmbeddingResult(batch_results[i]);
+    }
+  }
+  return results;
+}
+
 absl::StatusOr<double> TextEmbedder::CosineSimilarity(
     const components::containers::Embedding& u,
     const components::containers::Embedding& v) {
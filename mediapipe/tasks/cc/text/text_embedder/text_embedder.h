@@ -17,6 +17,8 @@ limitations under the License.
 #define MEDIAPIPE_TASKS_CC_TEXT_TEXT_EMBEDDER_TEXT_EMBEDDER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/embedder_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/core/base_task_api.h"
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
 
 namespace mediapipe::tasks::text::text_embedder {
 
@@ -41,6 +44,10 @@ struct TextEmbedderOptions {
   // Options for configuring the embedder behavior, such as L2-normalization or
   // scalar-quantization.
   components::processors::EmbedderOptions embedder_options;
+
+  // Options for running EmbedBatch(), such as the maximum number of texts run
+  // through the model in one inference.
+  text::utils::TextBatchOptions batch_options;
 };
 
 // Performs embedding extraction on text.
@@ -70,6 +77,13 @@ struct TextEmbedderOptions {
 //    - 2 output tensors with names "query_encoding" and "response_encoding" of
 //      type kTfLiteFloat32. The "query_encoding" is filtered and only the other
 //      output tensor is used for the embedding.
+//
+// With `batch_options.max_batch_size` other than 1, BERT and regex-based models
+// run the texts of an EmbedBatch() call in batches of up to that size, which
+// requires their input tensors to be resizable along the batch dimension, and
+// Embed() runs a batch of one. UniversalSentenceEncoder-based models run texts
+// one at a time. By default, texts are embedded one at a time with the single
+// text graph.
 class TextEmbedder : core::BaseTaskApi {
  public:
   using BaseTaskApi::BaseTaskApi;
@@ -83,6 +97,12 @@ class TextEmbedder : core::BaseTaskApi {
   // Performs embedding extraction on the input `text`.
   absl::StatusOr<TextEmbedderResult> Embed(absl::string_view text);
 
+  // Performs embedding extraction on each of the input `texts`, running them
+  // through the model in batches as configured by `batch_options`. Returns one
+  // result per text, in the order of `texts`.
+  absl::StatusOr<std::vector<TextEmbedderResult>> EmbedBatch(
+      const std::vector<std::string>& texts);
+
   // Shuts down the TextEmbedder when all the work is done.
   absl::Status Close() { return runner_->Close(); }
 
@@ -95,6 +115,9 @@ class TextEmbedder : core::BaseTaskApi {
   static absl::StatusOr<double> CosineSimilarity(
       const components::containers::Embedding& u,
       const components::containers::Embedding& v);
+
+ private:
+  text::utils::TextBatchOptions batch_options_;
 };
 
 }  // namespace mediapipe::tasks::text::text_embedder
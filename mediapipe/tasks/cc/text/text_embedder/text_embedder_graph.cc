@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -21,6 +24,7 @@ limitations under the License.
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/tasks/cc/components/calculators/tensors_to_embeddings_calculator.pb.h"
 #include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
 #include "mediapipe/tasks/cc/components/processors/embedding_postprocessing_graph.h"
@@ -33,6 +37,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/proto/model_resources_calculator.pb.h"
 #include "mediapipe/tasks/cc/text/text_embedder/proto/text_embedder_graph_options.pb.h"
 #include "mediapipe/tasks/cc/text/utils/text_model_utils.h"
+#include "mediapipe/util/graph_builder_utils.h"
 
 namespace mediapipe::tasks::text::text_embedder {
 namespace {
@@ -43,11 +48,15 @@ using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
 using ::mediapipe::tasks::components::containers::proto::EmbeddingResult;
 using ::mediapipe::tasks::components::processors::proto::TextModelType;
+using ::mediapipe::tasks::components::processors::proto::
+    TextPreprocessingGraphOptions;
 using ::mediapipe::tasks::core::ModelResources;
 using ::mediapipe::tasks::text::utils::GetModelType;
 
 constexpr char kEmbeddingsTag[] = "EMBEDDINGS";
+constexpr char kBatchedEmbeddingsTag[] = "BATCHED_EMBEDDINGS";
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kTensorsTag[] = "TENSORS";
 
@@ -60,12 +69,19 @@ constexpr char kUSEQueryTensorName[] = "query_encoding";
 // - Accepts input text and outputs embeddings on CPU.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     Input text to perform embedding extraction on.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts to perform embedding extraction on. Texts are run
+//     through the model as a single batch if the model takes token ids, i.e.
+//     for BERT and regex models, and one at a time otherwise. Exactly one of
+//     TEXT and TEXTS must be connected.
 //
 // Outputs:
-//   EMBEDDINGS - EmbeddingResult
-//     The embedding result.
+//   EMBEDDINGS - EmbeddingResult @Optional
+//     The embedding result. Only available with the TEXT input.
+//   BATCHED_EMBEDDINGS - std::vector<EmbeddingResult> @Optional
+//     The embedding results of each text of the TEXTS input, in order.
 //
 // Example:
 // node {
@@ -90,6 +106,16 @@ class TextEmbedderGraph : public core::ModelTaskGraph {
     ASSIGN_OR_RETURN(const ModelResources* model_resources,
                      CreateModelResources<proto::TextEmbedderGraphOptions>(sc));
     Graph graph;
+    if (HasInput(sc->OriginalNode(), kTextsTag)) {
+      ASSIGN_OR_RETURN(
+          Source<std::vector<EmbeddingResult>> embedding_results_out,
+          BuildBatchedTextEmbedderTask(
+              sc->Options<proto::TextEmbedderGraphOptions>(), *model_resources,
+              graph[Input<std::vector<std::string>>(kTextsTag)], graph));
+      embedding_results_out >>
+          graph[Output<std::vector<EmbeddingResult>>(kBatchedEmbeddingsTag)];
+      return graph.GetConfig();
+    }
     ASSIGN_OR_RETURN(
         Source<EmbeddingResult> embedding_result_out,
         BuildTextEmbedderTask(sc->Options<proto::TextEmbedderGraphOptions>(),
@@ -132,8 +158,90 @@ class TextEmbedderGraph : public core::ModelTaskGraph {
         preprocessing.SideIn(kMetadataExtractorTag);
     preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
 
-    // Adds postprocessing calculators and connects its input stream to the
-    // inference results.
+    return BuildEmbeddingPostprocessing(
+        task_options, model_resources,
+        inference[Output<std::vector<Tensor>>(kTensorsTag)], graph);
+  }
+
+  // Adds a mediapipe TextEmbedder task graph extracting the embeddings of a
+  // batch of texts into the provided builder::Graph instance. BERT and regex
+  // models run the whole batch in a single inference, whose outputs are then
+  // postprocessed text by text. Other models run the single text task on each
+  // text in turn.
+  //
+  // task_options: the mediapipe tasks TextEmbedderGraphOptions proto.
+  // model_resources: the ModelResources object initialized from a
+  //   TextEmbedder model file with model metadata.
+  // texts_in: (std::vector<std::string>) stream to run embedding extraction
+  //   on.
+  // graph: the mediapipe builder::Graph instance to be updated.
+  absl::StatusOr<Source<std::vector<EmbeddingResult>>>
+  BuildBatchedTextEmbedderTask(
+      const proto::TextEmbedderGraphOptions& task_options,
+      const ModelResources& model_resources,
+      Source<std::vector<std::string>> texts_in, Graph& graph) {
+    TextPreprocessingGraphOptions preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureTextPreprocessingGraph(
+        model_resources, preprocessing_options));
+    auto& end_loop =
+        graph.AddNode("mediapipe.tasks.EndLoopEmbeddingResultCalculator");
+
+    if (!components::processors::SupportsBatchedInput(preprocessing_options)) {
+      auto& begin_loop = graph.AddNode("BeginLoopStringCalculator");
+      texts_in >> begin_loop.In("ITERABLE");
+      begin_loop.Out("BATCH_END") >> end_loop.In("BATCH_END");
+      ASSIGN_OR_RETURN(
+          Source<EmbeddingResult> embedding_result,
+          BuildTextEmbedderTask(task_options, model_resources,
+                                begin_loop[Output<std::string>("ITEM")],
+                                graph));
+      embedding_result >> end_loop.In("ITEM");
+      return end_loop[Output<std::vector<EmbeddingResult>>("ITERABLE")];
+    }
+
+    // Tokenizes all texts into input tensors with a batch entry per text.
+    auto& preprocessing = graph.AddNode(
+        "mediapipe.tasks.components.processors.TextPreprocessingGraph");
+    preprocessing_options.set_num_threads(task_options.num_tokenizer_threads());
+    preprocessing.GetOptions<TextPreprocessingGraphOptions>().CopyFrom(
+        preprocessing_options);
+    texts_in >> preprocessing.In(kTextsTag);
+
+    auto& inference = AddInference(
+        model_resources, task_options.base_options().acceleration(), graph);
+    inference.SideOut(kMetadataExtractorTag) >>
+        preprocessing.SideIn(kMetadataExtractorTag);
+    preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
+
+    // Loops over the indices of the texts, which are also the batch indices of
+    // the output tensors, to postprocess the outputs of each text.
+    auto& text_indices = graph.AddNode("StringVectorIndicesCalculator");
+    texts_in >> text_indices.In("VECTOR");
+    auto& begin_loop = graph.AddNode("BeginLoopIntCalculator");
+    text_indices.Out("INDICES") >> begin_loop.In("ITERABLE");
+    inference.Out(kTensorsTag) >> begin_loop.In("CLONE");
+    begin_loop.Out("BATCH_END") >> end_loop.In("BATCH_END");
+
+    auto& get_output_tensors = graph.AddNode("GetTensorsBatchItemCalculator");
+    begin_loop.Out("CLONE") >> get_output_tensors.In(kTensorsTag);
+    begin_loop.Out("ITEM") >> get_output_tensors.In("INDEX");
+
+    ASSIGN_OR_RETURN(
+        Source<EmbeddingResult> embedding_result,
+        BuildEmbeddingPostprocessing(
+            task_options, model_resources,
+            get_output_tensors[Output<std::vector<Tensor>>(kTensorsTag)],
+            graph));
+    embedding_result >> end_loop.In("ITEM");
+    return end_loop[Output<std::vector<EmbeddingResult>>("ITERABLE")];
+  }
+
+  // Adds the postprocessing of the model outputs in tensors_in into an
+  // embedding result.
+  absl::StatusOr<Source<EmbeddingResult>> BuildEmbeddingPostprocessing(
+      const proto::TextEmbedderGraphOptions& task_options,
+      const ModelResources& model_resources,
+      Source<std::vector<Tensor>> tensors_in, Graph& graph) {
     auto& postprocessing = graph.AddNode(
         "mediapipe.tasks.components.processors.EmbeddingPostprocessingGraph");
     auto* postprocessing_options = &postprocessing.GetOptions<
@@ -152,7 +260,7 @@ class TextEmbedderGraph : public core::ModelTaskGraph {
         components::processors::ConfigureEmbeddingPostprocessingGraph(
             model_resources, task_options.embedder_options(),
             postprocessing_options));
-    inference.Out(kTensorsTag) >> postprocessing.In(kTensorsTag);
+    tensors_in >> postprocessing.In(kTensorsTag);
 
     // Outputs the embedding result.
     return postprocessing[Output<EmbeddingResult>(kEmbeddingsTag)];
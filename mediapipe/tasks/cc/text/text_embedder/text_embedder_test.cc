@@ -16,6 +16,8 @@ limitations under the License.
 #include "mediapipe/tasks/cc/text/text_embedder/text_embedder.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
@@ -241,5 +243,42 @@ TEST_F(EmbedderTest, SucceedsWithUSEAndDifferentThemes) {
   MP_ASSERT_OK(text_embedder->Close());
 }
 
+TEST_F(EmbedderTest, EmbedBatchMatchesEmbed) {
+  const std::vector<std::string> texts = {
+      "it's a charming and often affecting journey",
+      "what a great and fantastic trip",
+      "Let's make a plan to steal the declaration of independence.",
+      "meh"};
+  for (const char* model :
+       {kMobileBert, kRegexOneEmbeddingModel, kUniversalSentenceEncoderModel}) {
+    auto options = std::make_unique<TextEmbedderOptions>();
+    options->base_options.model_asset_path =
+        JoinPath("./", kTestDataDirectory, model);
+    options->batch_options.max_batch_size = 3;
+    options->batch_options.bucket_by_length = true;
+    options->batch_options.num_tokenizer_threads = 2;
+    MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextEmbedder> text_embedder,
+                            TextEmbedder::Create(std::move(options)));
+
+    MP_ASSERT_OK_AND_ASSIGN(std::vector<TextEmbedderResult> results,
+                            text_embedder->EmbedBatch(texts));
+
+    ASSERT_EQ(results.size(), texts.size());
+    for (int i = 0; i < texts.size(); ++i) {
+      MP_ASSERT_OK_AND_ASSIGN(TextEmbedderResult expected,
+                              text_embedder->Embed(texts[i]));
+      ASSERT_EQ(results[i].embeddings.size(), expected.embeddings.size());
+      // Texts batched with longer ones are padded, which may slightly change
+      // the outputs of the model.
+      MP_ASSERT_OK_AND_ASSIGN(
+          double similarity,
+          TextEmbedder::CosineSimilarity(results[i].embeddings[0],
+                                         expected.embeddings[0]));
+      EXPECT_NEAR(similarity, 1.0, kEpsilon) << model << ": " << texts[i];
+    }
+    MP_ASSERT_OK(text_embedder->Close());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe::tasks::text::text_embedder
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "tensorflow_text/core/kernels/regex_split.h"
 
@@ -22,6 +23,62 @@ namespace mediapipe {
 namespace tasks {
 namespace text {
 namespace tokenizers {
+namespace {
+
+// Appends the wordpieces of `token`, which starts at `offset` in the input, to
+// `result` and returns their number. The wordpieces are the same as with
+// tensorflow::text::WordpieceTokenize(), but each one is found by walking the
+// trie once instead of looking up all its candidate lengths.
+int TokenizeWord(absl::string_view token, int offset,
+                 const WordpieceTrie& vocab,
+                 const BertTokenizerOptions& options,
+                 WordpieceTokenizerResult* result) {
+  if (token.size() > options.max_bytes_per_token) {
+    result->wp_begin_offset.push_back(offset);
+    if (options.use_unknown_token) {
+      result->subwords.push_back(options.unknown_token);
+      result->wp_end_offset.push_back(offset + options.unknown_token.size());
+    } else {
+      result->subwords.emplace_back(token);
+      result->wp_end_offset.push_back(offset + token.size());
+    }
+    return 1;
+  }
+
+  const int num_subwords = result->subwords.size();
+  for (int begin = 0; begin < token.size();) {
+    const absl::string_view prefix =
+        begin > 0 ? absl::string_view(options.suffix_indicator) : "";
+    const absl::string_view rest = token.substr(begin);
+    int length =
+        vocab.LongestMatch(prefix, rest, options.max_chars_per_subtoken);
+    if (length > 0) {
+      result->subwords.push_back(absl::StrCat(prefix, rest.substr(0, length)));
+    } else if (options.split_unknown_chars) {
+      length = Utf8CharLength(rest, 0);
+      result->subwords.push_back(absl::StrCat(
+          prefix, options.use_unknown_token ? options.unknown_token
+                                            : rest.substr(0, length)));
+    } else {
+      // The whole token is unknown.
+      result->subwords.resize(num_subwords);
+      result->wp_begin_offset.resize(num_subwords);
+      result->wp_end_offset.resize(num_subwords);
+      result->subwords.push_back(options.use_unknown_token
+                                     ? options.unknown_token
+                                     : std::string(token));
+      result->wp_begin_offset.push_back(offset);
+      result->wp_end_offset.push_back(offset + token.size());
+      return 1;
+    }
+    result->wp_begin_offset.push_back(offset + begin);
+    result->wp_end_offset.push_back(offset + begin + length);
+    begin += length;
+  }
+  return result->subwords.size() - num_subwords;
+}
+
+}  // namespace
 
 FlatHashMapBackedWordpiece::FlatHashMapBackedWordpiece(
     const std::vector<std::string>& vocab)
@@ -63,10 +120,6 @@ TokenizerResult BertTokenizer::Tokenize(const std::string& input) {
 WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
     const std::string& input) const {
   WordpieceTokenizerResult result;
-  std::vector<std::string>& subwords = result.subwords;
-  std::vector<int>& wp_absolute_begin_offset = result.wp_begin_offset;
-  std::vector<int>& wp_absolute_end_offset = result.wp_end_offset;
-
   std::vector<absl::string_view> tokens;
   std::vector<long long> begin_offsets;
   std::vector<long long> end_offsets;
@@ -76,28 +129,9 @@ WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
                                &tokens, &begin_offsets, &end_offsets);
 
   for (int token_index = 0; token_index < tokens.size(); token_index++) {
-    auto& token = tokens[token_index];
-    int num_word_pieces = 0;
-    tensorflow::text::LookupStatus status = WordpieceTokenize(
-        token, options_.max_bytes_per_token, options_.max_chars_per_subtoken,
-        options_.suffix_indicator, options_.use_unknown_token,
-        options_.unknown_token, options_.split_unknown_chars, &vocab_,
-        &subwords, &wp_absolute_begin_offset, &wp_absolute_end_offset,
-        &num_word_pieces);
-
-    result.row_lengths.emplace_back(num_word_pieces);
-    // for the last num_word_pieces added into wp_absolute_begin_offset and
-    // wp_absolute_end_offset, offset them with begin_offsets[token_index]
-    int absolute_offset_size = wp_absolute_begin_offset.size();
-    for (int i = num_word_pieces; i > 0; i--) {
-      wp_absolute_begin_offset[absolute_offset_size - i] +=
-          begin_offsets[token_index];
-      wp_absolute_end_offset[absolute_offset_size - i] +=
-          begin_offsets[token_index];
-    }
-    if (!status.success) {
-      return result;
-    }
+    result.row_lengths.push_back(TokenizeWord(tokens[token_index],
+                                              begin_offsets[token_index],
+                                              vocab_, options_, &result));
   }
 
   return result;
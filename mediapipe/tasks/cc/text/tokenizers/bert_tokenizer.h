@@ -19,12 +19,13 @@ limitations under the License.
 #include <cstddef>
 #include <fstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
-#include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
 #include "re2/re2.h"
 #include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
 
@@ -92,25 +93,30 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
   // Initialize the tokenizer from vocab vector and tokenizer configs.
   explicit BertTokenizer(const std::vector<std::string>& vocab,
                          const BertTokenizerOptions& options = {})
-      : vocab_{FlatHashMapBackedWordpiece(vocab)},
-        options_{options},
-        delim_re_{options.delim_str},
-        include_delim_re_{options.include_delim_str} {}
+      : BertTokenizer(WordpieceTrie(vocab), options) {}
 
   // Initialize the tokenizer from file path to vocab and tokenizer configs.
   explicit BertTokenizer(const std::string& path_to_vocab,
                          const BertTokenizerOptions& options = {})
-      : BertTokenizer(mediapipe::tasks::text::LoadVocabFromFile(path_to_vocab),
-                      options) {}
+      : BertTokenizer(WordpieceTrie::FromFile(path_to_vocab), options) {}
 
   // Initialize the tokenizer from buffer and size of vocab and tokenizer
-  // configs.
+  // configs. The buffer is copied.
   BertTokenizer(const char* vocab_buffer_data, size_t vocab_buffer_size,
                 const BertTokenizerOptions& options = {})
-      : BertTokenizer(mediapipe::tasks::text::LoadVocabFromBuffer(
-                          vocab_buffer_data, vocab_buffer_size),
+      : BertTokenizer(WordpieceTrie::FromBuffer(absl::string_view(
+                          vocab_buffer_data, vocab_buffer_size)),
                       options) {}
 
+  // Initialize the tokenizer from a vocab trie and tokenizer configs, e.g. a
+  // trie referencing the vocab in the model metadata, which avoids copying it.
+  explicit BertTokenizer(WordpieceTrie vocab,
+                         const BertTokenizerOptions& options = {})
+      : vocab_{std::move(vocab)},
+        options_{options},
+        delim_re_{options.delim_str},
+        include_delim_re_{options.include_delim_str} {}
+
   // Perform tokenization, return tokenized results containing the subwords.
   TokenizerResult Tokenize(const std::string& input) override;
 
@@ -137,7 +143,7 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
   int VocabularySize() const { return vocab_.VocabularySize(); }
 
  private:
-  mediapipe::tasks::text::tokenizers::FlatHashMapBackedWordpiece vocab_;
+  WordpieceTrie vocab_;
   BertTokenizerOptions options_;
   RE2 delim_re_;
   RE2 include_delim_re_;
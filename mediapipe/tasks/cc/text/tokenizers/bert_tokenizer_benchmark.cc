@@ -0,0 +1,152 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures BertTokenizer creation from the MobileBERT vocab and tokenization
+// throughput, against a FlatHashMapBackedWordpiece with
+// tensorflow::text::WordpieceTokenize() as a baseline. Run it with
+// `bazel run -c opt` so that the vocab is found in the runfiles.
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "mediapipe/tasks/cc/core/utils.h"
+#include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
+#include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
+#include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+namespace {
+
+constexpr char kVocabPath[] =
+    "mediapipe/tasks/testdata/text/mobilebert_vocab.txt";
+
+// Returns about `size` bytes of text made of vocab words, half of which are
+// glued to the next word so that they are split into several wordpieces.
+std::string MakeText(const std::vector<std::string>& vocab, int size) {
+  std::mt19937 generator(/*seed=*/1);
+  std::uniform_int_distribution<int> word_distribution(0, vocab.size() - 1);
+  std::bernoulli_distribution glue_distribution(0.5);
+  std::string text;
+  while (text.size() < size) {
+    const std::string& word = vocab[word_distribution(generator)];
+    // Skips the suffixes and special tokens like [CLS].
+    if (word.empty() || word[0] == '#' || word[0] == '[') continue;
+    text += word;
+    if (!glue_distribution(generator)) {
+      text += ' ';
+    }
+  }
+  return text;
+}
+
+void BM_CreateFromBuffer(benchmark::State& state) {
+  const std::string buffer = core::LoadBinaryContent(kVocabPath);
+  for (auto _ : state) {
+    BertTokenizer tokenizer(WordpieceTrie::FromUnownedBuffer(buffer));
+    benchmark::DoNotOptimize(tokenizer.VocabularySize());
+  }
+}
+BENCHMARK(BM_CreateFromBuffer);
+
+void BM_CreateFlatHashMapFromBuffer(benchmark::State& state) {
+  const std::string buffer = core::LoadBinaryContent(kVocabPath);
+  for (auto _ : state) {
+    FlatHashMapBackedWordpiece vocab(
+        LoadVocabFromBuffer(buffer.data(), buffer.size()));
+    benchmark::DoNotOptimize(vocab.VocabularySize());
+  }
+}
+BENCHMARK(BM_CreateFlatHashMapFromBuffer);
+
+void BM_Tokenize(benchmark::State& state) {
+  BertTokenizer tokenizer(kVocabPath);
+  const std::string text =
+      MakeText(LoadVocabFromFile(kVocabPath), state.range(0));
+  for (auto _ : state) {
+    auto result = tokenizer.TokenizeWordpiece(text);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Tokenize)->Arg(128)->Arg(4096);
+
+// Splits words already split on whitespace into wordpieces, to isolate the
+// vocab lookups from the regex splitting.
+void BM_WordpieceTrie(benchmark::State& state) {
+  const std::vector<std::string> vocab = LoadVocabFromFile(kVocabPath);
+  WordpieceTrie trie(vocab);
+  const std::string text = MakeText(vocab, state.range(0));
+  const std::vector<absl::string_view> words = absl::StrSplit(
+      text, ' ', absl::SkipEmpty());
+  for (auto _ : state) {
+    std::vector<std::string> subwords;
+    for (absl::string_view word : words) {
+      for (int begin = 0; begin < word.size();) {
+        const absl::string_view prefix = begin > 0 ? "##" : "";
+        const int length = trie.LongestMatch(prefix, word.substr(begin),
+                                             kDefaultMaxCharsPerSubToken);
+        if (length == 0) {
+          subwords.push_back(kDefaultUnknownToken);
+          break;
+        }
+        subwords.push_back(absl::StrCat(prefix, word.substr(begin, length)));
+        begin += length;
+      }
+    }
+    benchmark::DoNotOptimize(subwords);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_WordpieceTrie)->Arg(4096);
+
+void BM_WordpieceFlatHashMap(benchmark::State& state) {
+  const std::vector<std::string> vocab = LoadVocabFromFile(kVocabPath);
+  FlatHashMapBackedWordpiece vocab_map(vocab);
+  const std::string text = MakeText(vocab, state.range(0));
+  const std::vector<absl::string_view> words = absl::StrSplit(
+      text, ' ', absl::SkipEmpty());
+  for (auto _ : state) {
+    std::vector<std::string> subwords;
+    std::vector<int> begin_offsets;
+    std::vector<int> end_offsets;
+    for (absl::string_view word : words) {
+      int num_pieces = 0;
+      tensorflow::text::WordpieceTokenize(
+          word, kDefaultMaxBytesPerToken, kDefaultMaxCharsPerSubToken,
+          kDefaultSuffixIndicator, kDefaultUseUnknownToken,
+          kDefaultUnknownToken, kDefaultSplitUnknownChars, &vocab_map,
+          &subwords, &begin_offsets, &end_offsets, &num_pieces);
+    }
+    benchmark::DoNotOptimize(subwords);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_WordpieceFlatHashMap)->Arg(4096);
+
+}  // namespace
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
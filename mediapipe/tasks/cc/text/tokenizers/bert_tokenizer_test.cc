@@ -18,6 +18,10 @@ limitations under the License.
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/tasks/cc/core/utils.h"
+#include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
+#include "re2/re2.h"
+#include "tensorflow_text/core/kernels/regex_split.h"
+#include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -30,6 +34,39 @@ using ::testing::ElementsAre;
 namespace {
 constexpr char kTestVocabPath[] =
     "mediapipe/tasks/testdata/text/mobilebert_vocab.txt";
+
+// Tokenizes `input` with tensorflow::text::WordpieceTokenize() and a
+// FlatHashMapBackedWordpiece, as BertTokenizer did before using a trie.
+WordpieceTokenizerResult ReferenceTokenizeWordpiece(
+    const std::string& input, const std::vector<std::string>& vocab,
+    const BertTokenizerOptions& options) {
+  FlatHashMapBackedWordpiece vocab_map(vocab);
+  RE2 delim_re(options.delim_str);
+  RE2 include_delim_re(options.include_delim_str);
+  std::vector<absl::string_view> tokens;
+  std::vector<long long> begin_offsets;
+  std::vector<long long> end_offsets;
+  tensorflow::text::RegexSplit(input, delim_re, true, include_delim_re,
+                               &tokens, &begin_offsets, &end_offsets);
+
+  WordpieceTokenizerResult result;
+  for (int token_index = 0; token_index < tokens.size(); token_index++) {
+    const int num_offsets = result.wp_begin_offset.size();
+    int num_word_pieces = 0;
+    WordpieceTokenize(tokens[token_index], options.max_bytes_per_token,
+                      options.max_chars_per_subtoken, options.suffix_indicator,
+                      options.use_unknown_token, options.unknown_token,
+                      options.split_unknown_chars, &vocab_map,
+                      &result.subwords, &result.wp_begin_offset,
+                      &result.wp_end_offset, &num_word_pieces);
+    result.row_lengths.push_back(num_word_pieces);
+    for (int i = num_offsets; i < result.wp_begin_offset.size(); ++i) {
+      result.wp_begin_offset[i] += begin_offsets[token_index];
+      result.wp_end_offset[i] += begin_offsets[token_index];
+    }
+  }
+  return result;
+}
 }  // namespace
 
 void AssertTokenizerResults(std::unique_ptr<BertTokenizer> tokenizer) {
@@ -106,6 +143,43 @@ TEST(TokenizerTest, TestTokenizerUnknownTokens) {
   EXPECT_THAT(results.row_lengths, ElementsAre(1, 1, 1, 1));
 }
 
+TEST(TokenizerTest, TestTokenizerMatchesReference) {
+#ifdef _WIN32
+  // TODO: Investigate why these tests are failing
+  GTEST_SKIP("Unexpected result on Windows");
+#endif  // _WIN32
+  const std::vector<std::string> vocab = LoadVocabFromFile(kTestVocabPath);
+  const std::vector<std::string> inputs = {
+      "i'm questionansweraskask",
+      "The quick brown fox jumps over the lazy dog.",
+      "unaffable, hyperparameterization and antidisestablishmentarianism",
+      "caf\xC3\xA9 na\xC3\xAFve \xE4\xBD\xA0\xE5\xA5\xBD "
+      "\xF0\x9F\x98\x80 fa\xC3\xA7" "ade",
+      "invalid \xC3 utf\x80-8 \xE2\x82 bytes\xFF",
+      "xqzvwk supercalifragilisticexpialidocious",
+  };
+  std::vector<BertTokenizerOptions> all_options(5);
+  all_options[1].split_unknown_chars = true;
+  all_options[2].use_unknown_token = false;
+  all_options[3].split_unknown_chars = true;
+  all_options[3].use_unknown_token = false;
+  all_options[4].max_bytes_per_token = 12;
+  all_options[4].max_chars_per_subtoken = 4;
+
+  for (const BertTokenizerOptions& options : all_options) {
+    BertTokenizer tokenizer(vocab, options);
+    for (const std::string& input : inputs) {
+      auto expected = ReferenceTokenizeWordpiece(input, vocab, options);
+      auto results = tokenizer.TokenizeWordpiece(input);
+
+      EXPECT_EQ(results.subwords, expected.subwords) << input;
+      EXPECT_EQ(results.wp_begin_offset, expected.wp_begin_offset) << input;
+      EXPECT_EQ(results.wp_end_offset, expected.wp_end_offset) << input;
+      EXPECT_EQ(results.row_lengths, expected.row_lengths) << input;
+    }
+  }
+}
+
 TEST(TokenizerTest, TestLookupId) {
   std::vector<std::string> vocab;
   vocab.emplace_back("i");
@@ -34,7 +34,8 @@ struct TokenizerResult {
 // Interface of general tokenizer.
 class Tokenizer {
  public:
-  // Perform tokenization to get tokenized results.
+  // Perform tokenization to get tokenized results. May be called concurrently
+  // from several threads.
   virtual TokenizerResult Tokenize(const std::string& input) = 0;
 
   // Find the id of a string token.
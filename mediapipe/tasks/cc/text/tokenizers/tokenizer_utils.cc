@@ -28,6 +28,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
 #include "mediapipe/tasks/cc/text/tokenizers/sentencepiece_tokenizer.h"
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
 
 namespace mediapipe {
@@ -111,8 +112,8 @@ absl::StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizerFromProcessUnit(
       ASSIGN_OR_RETURN(absl::string_view vocab_buffer,
                        CheckAndLoadFirstAssociatedFile(options->vocab_file(),
                                                        metadata_extractor));
-      return std::make_unique<BertTokenizer>(vocab_buffer.data(),
-                                             vocab_buffer.size());
+      return std::make_unique<BertTokenizer>(
+          WordpieceTrie::FromUnownedBuffer(vocab_buffer));
     }
     case tflite::ProcessUnitOptions_SentencePieceTokenizerOptions: {
       const tflite::SentencePieceTokenizerOptions* options =
@@ -35,6 +35,8 @@ absl::StatusOr<std::unique_ptr<RegexTokenizer>> CreateRegexTokenizerFromOptions(
     const metadata::ModelMetadataExtractor* metadata_extractor);
 
 // Create a Tokenizer by extracting vocab / model files from the metadata.
+// A BertTokenizer references its vocab in the metadata without copying it, so
+// `metadata_extractor` must outlive the returned Tokenizer.
 absl::StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizerFromProcessUnit(
     const tflite::ProcessUnit* tokenizer_process_unit,
     const metadata::ModelMetadataExtractor* metadata_extractor);
@@ -0,0 +1,417 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "mediapipe/util/resource_util.h"
+#include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+namespace {
+
+constexpr int32_t kFree = -1;
+constexpr int32_t kRoot = 0;
+// The number of positions FindBase() may try for several labels before later
+// searches skip them.
+constexpr int kMaxTries = 16;
+
+// Builds the double-array of a WordpieceTrie from its words.
+class DoubleArrayBuilder {
+ public:
+  DoubleArrayBuilder(const std::vector<absl::string_view>& words,
+                     std::vector<int32_t>* base, std::vector<int32_t>* check,
+                     std::vector<int32_t>* value)
+      : words_(words), base_(*base), check_(*check), value_(*value) {}
+
+  void Build() {
+    // Sorting the words groups them by prefix, so that the children of each
+    // node are found in a single pass. Duplicate words are sorted by id, so
+    // that the last one wins, as in FlatHashMapBackedWordpiece.
+    std::vector<int> sorted_ids = SortWords();
+
+    Resize(256);
+    Claim(kRoot);
+    check_[kRoot] = kRoot - 2;  // Occupied, and not the child of any node.
+    BuildNode(kRoot, /*depth=*/0, sorted_ids, 0, sorted_ids.size());
+
+    // Positions past the last child are never looked up.
+    int size = check_.size();
+    while (size > kRoot + 1 && check_[size - 1] == kFree) {
+      --size;
+    }
+    base_.resize(size);
+    check_.resize(size);
+    value_.resize(size);
+    base_.shrink_to_fit();
+    check_.shrink_to_fit();
+    value_.shrink_to_fit();
+  }
+
+ private:
+  // Returns the first 8 bytes of `word`, padded with zeros, in an integer
+  // which orders the words as their bytes.
+  static uint64_t Prefix(absl::string_view word) {
+    uint64_t prefix = 0;
+    for (int i = 0; i < 8; ++i) {
+      prefix <<= 8;
+      if (i < word.size()) {
+        prefix |= static_cast<uint8_t>(word[i]);
+      }
+    }
+    return prefix;
+  }
+
+  // Returns the ids of the words in increasing order of words, then ids.
+  std::vector<int> SortWords() const {
+    // Most words differ in their first 8 bytes, so they are radix-sorted by
+    // those, which is stable, and only words sharing them are compared.
+    const int num_words = words_.size();
+    std::vector<std::pair<uint64_t, int>> keys(num_words);
+    for (int id = 0; id < num_words; ++id) {
+      keys[id] = {Prefix(words_[id]), id};
+    }
+    std::vector<std::pair<uint64_t, int>> sorted_keys(num_words);
+    for (int shift = 0; shift < 64; shift += 8) {
+      int counts[257] = {0};
+      for (const auto& key : keys) {
+        ++counts[((key.first >> shift) & 0xFF) + 1];
+      }
+      for (int i = 1; i < 257; ++i) {
+        counts[i] += counts[i - 1];
+      }
+      for (const auto& key : keys) {
+        sorted_keys[counts[(key.first >> shift) & 0xFF]++] = key;
+      }
+      keys.swap(sorted_keys);
+    }
+
+    std::vector<int> sorted_ids(num_words);
+    for (int i = 0; i < num_words; ++i) {
+      sorted_ids[i] = keys[i].second;
+    }
+    for (int begin = 0; begin < num_words;) {
+      int end = begin + 1;
+      while (end < num_words && keys[end].first == keys[begin].first) {
+        ++end;
+      }
+      if (end - begin > 1) {
+        std::sort(sorted_ids.begin() + begin, sorted_ids.begin() + end,
+                  [this](int a, int b) {
+                    const int order = words_[a].compare(words_[b]);
+                    return order < 0 || (order == 0 && a < b);
+                  });
+      }
+      begin = end;
+    }
+    return sorted_ids;
+  }
+
+  // Adds the children of `node` for the words in sorted_ids[begin, end),
+  // which all share their first `depth` bytes.
+  void BuildNode(int node, int depth, const std::vector<int>& sorted_ids,
+                 int begin, int end) {
+    // Words ending at this node sort before the longer ones.
+    while (begin < end && words_[sorted_ids[begin]].size() == depth) {
+      value_[node] = sorted_ids[begin++];
+    }
+    if (begin == end) return;
+
+    absl::InlinedVector<uint8_t, 16> labels;
+    absl::InlinedVector<int, 17> child_begins;
+    for (int i = begin; i < end; ++i) {
+      const uint8_t label = words_[sorted_ids[i]][depth];
+      if (labels.empty() || labels.back() != label) {
+        labels.push_back(label);
+        child_begins.push_back(i);
+      }
+    }
+    child_begins.push_back(end);
+
+    const int base = FindBase(labels);
+    base_[node] = base;
+    // Claims all the children before building any of their subtrees.
+    for (uint8_t label : labels) {
+      Claim(base + label);
+      check_[base + label] = node;
+    }
+    for (int i = 0; i < labels.size(); ++i) {
+      BuildNode(base + labels[i], depth + 1, sorted_ids, child_begins[i],
+                child_begins[i + 1]);
+    }
+  }
+
+  // Returns a base at which all `labels` can be placed, trying only the bases
+  // that put the first label at a free position.
+  int FindBase(absl::Span<const uint8_t> labels) {
+    // Any free position fits a single label. Other nodes start from
+    // multi_label_start_, which skips the holes where they rarely fit, as in
+    // Darts, so that building stays linear in practice.
+    if (first_free_ == kFree) {
+      Resize(check_.size() + 1);
+    }
+    int pos = labels.size() == 1 || multi_label_start_ == kFree
+                  ? first_free_
+                  : multi_label_start_;
+    for (int num_tries = 1;; ++num_tries, pos = next_free_[pos]) {
+      // The base may be negative, as the labels are sorted.
+      const int base = pos - labels.front();
+      Resize(base + labels.back() + 1);
+      bool fits = true;
+      for (int i = 1; i < labels.size(); ++i) {
+        if (check_[base + labels[i]] != kFree) {
+          fits = false;
+          break;
+        }
+      }
+      if (fits) {
+        if (num_tries > kMaxTries) {
+          multi_label_start_ = pos;
+        }
+        return base;
+      }
+      if (next_free_[pos] == kFree) {
+        Resize(check_.size() + 1);
+      }
+    }
+  }
+
+  // Removes the free position `pos` from the free list.
+  void Claim(int pos) {
+    const int prev = prev_free_[pos];
+    const int next = next_free_[pos];
+    if (pos == multi_label_start_) {
+      multi_label_start_ = next;
+    }
+    if (prev == kFree) {
+      first_free_ = next;
+    } else {
+      next_free_[prev] = next;
+    }
+    if (next == kFree) {
+      last_free_ = prev;
+    } else {
+      prev_free_[next] = prev;
+    }
+  }
+
+  // Grows the arrays to at least `size` positions, which are all free.
+  void Resize(int size) {
+    const int old_size = check_.size();
+    if (size <= old_size) return;
+    size = std::max(size, 2 * old_size);
+    base_.resize(size, 0);
+    check_.resize(size, kFree);
+    value_.resize(size, -1);
+    next_free_.resize(size, kFree);
+    prev_free_.resize(size, kFree);
+    for (int pos = old_size; pos < size; ++pos) {
+      prev_free_[pos] = last_free_;
+      if (last_free_ == kFree) {
+        first_free_ = pos;
+      } else {
+        next_free_[last_free_] = pos;
+      }
+      last_free_ = pos;
+    }
+  }
+
+  const std::vector<absl::string_view>& words_;
+  std::vector<int32_t>& base_;
+  std::vector<int32_t>& check_;
+  std::vector<int32_t>& value_;
+  // The free positions, as a doubly-linked list in increasing order.
+  std::vector<int32_t> next_free_;
+  std::vector<int32_t> prev_free_;
+  int first_free_ = kFree;
+  int last_free_ = kFree;
+  // Where FindBase() starts looking for a base for several labels.
+  int multi_label_start_ = kFree;
+};
+
+}  // namespace
+
+int Utf8CharLength(absl::string_view text, int i) {
+  const uint8_t lead = text[i];
+  int length;
+  // Valid range of the byte following the lead byte.
+  uint8_t min = 0x80;
+  uint8_t max = 0xBF;
+  if (lead < 0x80) {
+    return 1;
+  } else if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    if (lead == 0xE0) {
+      min = 0xA0;  // Overlong encodings.
+    } else if (lead == 0xED) {
+      max = 0x9F;  // Surrogates.
+    }
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    if (lead == 0xF0) {
+      min = 0x90;  // Overlong encodings.
+    } else if (lead == 0xF4) {
+      max = 0x8F;  // Code points above U+10FFFF.
+    }
+  } else {
+    return 1;
+  }
+  int n = 1;
+  for (; n < length && i + n < text.size(); ++n) {
+    const uint8_t byte = text[i + n];
+    if (byte < min || byte > max) break;
+    min = 0x80;
+    max = 0xBF;
+  }
+  return n;
+}
+
+WordpieceTrie::WordpieceTrie(const std::vector<std::string>& vocab) {
+  size_t size = 0;
+  for (const std::string& word : vocab) {
+    size += word.size();
+  }
+  buffer_ = std::make_unique<char[]>(size);
+  words_.reserve(vocab.size());
+  char* data = buffer_.get();
+  for (const std::string& word : vocab) {
+    std::memcpy(data, word.data(), word.size());
+    words_.emplace_back(data, word.size());
+    data += word.size();
+  }
+  Build();
+}
+
+WordpieceTrie WordpieceTrie::FromBuffer(absl::string_view vocab_buffer) {
+  WordpieceTrie trie;
+  trie.buffer_ = std::make_unique<char[]>(vocab_buffer.size());
+  std::memcpy(trie.buffer_.get(), vocab_buffer.data(), vocab_buffer.size());
+  trie.Init(absl::string_view(trie.buffer_.get(), vocab_buffer.size()));
+  return trie;
+}
+
+WordpieceTrie WordpieceTrie::FromUnownedBuffer(absl::string_view vocab_buffer) {
+  WordpieceTrie trie;
+  trie.Init(vocab_buffer);
+  return trie;
+}
+
+WordpieceTrie WordpieceTrie::FromFile(const std::string& path_to_vocab) {
+  std::string file_name = *PathToResourceAsFile(path_to_vocab);
+  std::ifstream in(file_name.c_str(), std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+  return FromBuffer(contents);
+}
+
+void WordpieceTrie::Init(absl::string_view vocab_buffer) {
+  // Skips empty lines and strips "\r" like LoadVocabFromBuffer().
+  words_.reserve(
+      std::count(vocab_buffer.begin(), vocab_buffer.end(), '\n') + 1);
+  size_t begin = 0;
+  while (begin < vocab_buffer.size()) {
+    size_t end = vocab_buffer.find('\n', begin);
+    if (end == absl::string_view::npos) {
+      end = vocab_buffer.size();
+    }
+    absl::string_view line = vocab_buffer.substr(begin, end - begin);
+    begin = end + 1;
+    if (line.empty()) continue;
+    if (line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    words_.push_back(line);
+  }
+  Build();
+}
+
+void WordpieceTrie::Build() {
+  DoubleArrayBuilder(words_, &base_, &check_, &value_).Build();
+}
+
+int WordpieceTrie::Find(absl::string_view key) const {
+  int node = kRoot;
+  for (const char c : key) {
+    node = Child(node, c);
+    if (node < 0) return -1;
+  }
+  return node;
+}
+
+tensorflow::text::LookupStatus WordpieceTrie::Contains(absl::string_view key,
+                                                       bool* value) const {
+  int id;
+  *value = LookupId(key, &id);
+  return tensorflow::text::LookupStatus();
+}
+
+bool WordpieceTrie::LookupId(absl::string_view key, int* result) const {
+  const int node = Find(key);
+  if (node < 0 || value_[node] < 0) {
+    return false;
+  }
+  *result = value_[node];
+  return true;
+}
+
+bool WordpieceTrie::LookupWord(int vocab_id, absl::string_view* result) const {
+  if (vocab_id >= words_.size() || vocab_id < 0) {
+    return false;
+  }
+  *result = words_[vocab_id];
+  return true;
+}
+
+int WordpieceTrie::LongestMatch(absl::string_view prefix,
+                                absl::string_view text, int max_chars) const {
+  int node = Find(prefix);
+  if (node < 0) return 0;
+  int match = 0;
+  int num_chars = 0;
+  for (int i = 0; i < text.size();) {
+    const int char_end = i + Utf8CharLength(text, i);
+    for (; i < char_end; ++i) {
+      node = Child(node, text[i]);
+      if (node < 0) return match;
+    }
+    if (value_[node] >= 0) {
+      match = char_end;
+    }
+    if (++num_chars == max_chars) break;
+  }
+  return match;
+}
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
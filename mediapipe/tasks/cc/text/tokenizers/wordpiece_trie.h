@@ -0,0 +1,112 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+
+// Returns the number of bytes of the UTF-8 character starting at text[i].
+// Ill-formed sequences are split as by ICU's U8_NEXT, which WordPiece
+// tokenization in TF.Text uses: each maximal prefix of a well-formed sequence
+// counts as one character, and so does any other byte.
+int Utf8CharLength(absl::string_view text, int i);
+
+// A WordpieceVocab stored as a double-array trie over the words, which are
+// referenced in a single buffer rather than copied into individual strings.
+//
+// Besides exact lookups, the trie supports finding the longest word starting
+// at some position of a token in a single pass over its bytes, which is what
+// WordPiece tokenization spends most of its time on.
+class WordpieceTrie : public tensorflow::text::WordpieceVocab {
+ public:
+  // Builds the trie from a vector of words, indexed by position.
+  explicit WordpieceTrie(const std::vector<std::string>& vocab);
+
+  // Builds the trie from a vocab with one word per line, as parsed by
+  // LoadVocabFromBuffer(). The buffer is copied.
+  static WordpieceTrie FromBuffer(absl::string_view vocab_buffer);
+
+  // Same as above, but the words are referenced in `vocab_buffer` directly,
+  // e.g. in the memory-mapped model metadata, so it must outlive the trie.
+  static WordpieceTrie FromUnownedBuffer(absl::string_view vocab_buffer);
+
+  // Builds the trie from a vocab file with one word per line, as parsed by
+  // LoadVocabFromFile().
+  static WordpieceTrie FromFile(const std::string& path_to_vocab);
+
+  WordpieceTrie(WordpieceTrie&&) = default;
+  WordpieceTrie& operator=(WordpieceTrie&&) = default;
+
+  tensorflow::text::LookupStatus Contains(absl::string_view key,
+                                          bool* value) const override;
+  bool LookupId(absl::string_view key, int* result) const;
+  bool LookupWord(int vocab_id, absl::string_view* result) const;
+  int VocabularySize() const { return words_.size(); }
+
+  // Returns the length of the longest prefix of `text` which ends on a UTF-8
+  // character boundary and is a word of the vocab once appended to `prefix`,
+  // or 0 if there is none. Only the first `max_chars` characters of `text`
+  // are considered, unless `max_chars` is not positive.
+  int LongestMatch(absl::string_view prefix, absl::string_view text,
+                   int max_chars) const;
+
+ private:
+  WordpieceTrie() = default;
+
+  // Splits `vocab_buffer` into words_ and builds the trie.
+  void Init(absl::string_view vocab_buffer);
+  void Build();
+
+  // Returns the node reached from `node` by `label`, or -1.
+  int Child(int node, uint8_t label) const {
+    // Bases may be negative, in which case so may be the child.
+    const int child = base_[node] + label;
+    return static_cast<uint32_t>(child) < check_.size() && check_[child] == node
+               ? child
+               : -1;
+  }
+  // Returns the node reached from the root by `key`, or -1.
+  int Find(absl::string_view key) const;
+
+  // Owns the words if they are not referenced in an external buffer.
+  std::unique_ptr<char[]> buffer_;
+  std::vector<absl::string_view> words_;
+
+  // The double-array: the child of node n by label c is base_[n] + c if
+  // check_[base_[n] + c] == n. value_[n] is the id of the word ending at n,
+  // or -1.
+  std::vector<int32_t> base_;
+  std::vector<int32_t> check_;
+  std::vector<int32_t> value_;
+};
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
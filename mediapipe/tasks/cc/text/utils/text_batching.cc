@@ -0,0 +1,44 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace mediapipe::tasks::text::utils {
+
+std::vector<std::vector<int>> SplitIntoBatches(
+    const std::vector<std::string>& texts, const TextBatchOptions& options) {
+  std::vector<int> indices(texts.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  if (options.bucket_by_length) {
+    std::stable_sort(indices.begin(), indices.end(), [&texts](int a, int b) {
+      return texts[a].size() < texts[b].size();
+    });
+  }
+  const int max_batch_size =
+      options.max_batch_size > 0 ? options.max_batch_size : indices.size();
+  std::vector<std::vector<int>> batches;
+  for (int begin = 0; begin < indices.size(); begin += max_batch_size) {
+    const int end = std::min<int>(begin + max_batch_size, indices.size());
+    batches.emplace_back(indices.begin() + begin, indices.begin() + end);
+  }
+  return batches;
+}
+
+}  // namespace mediapipe::tasks::text::utils
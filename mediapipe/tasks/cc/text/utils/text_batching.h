@@ -0,0 +1,55 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_BATCHING_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_BATCHING_H_
+
+#include <string>
+#include <vector>
+
+namespace mediapipe::tasks::text::utils {
+
+// Options for running text tasks on batches of texts.
+struct TextBatchOptions {
+  // The maximum number of texts run through the model in one inference, or 0
+  // for no limit. Values other than 1 require a model whose input tensors can
+  // be resized along the batch dimension.
+  int max_batch_size = 1;
+
+  // Whether to batch texts of similar lengths together rather than in input
+  // order. This reduces padding for models with dynamic input tensors, whose
+  // inputs are padded to the longest text of each batch.
+  bool bucket_by_length = false;
+
+  // The number of threads tokenizing the texts of a batch.
+  int num_tokenizer_threads = 1;
+};
+
+// Returns whether texts are run through the model in batches of more than one
+// text, in which case the task graph takes batches of texts as input.
+inline bool UsesBatchedInference(const TextBatchOptions& options) {
+  return options.max_batch_size != 1;
+}
+
+// Splits the indices of `texts` into batches of at most
+// `options.max_batch_size` indices. With `options.bucket_by_length`, the
+// indices are sorted by the byte length of their text first, as a proxy for
+// their number of tokens.
+std::vector<std::vector<int>> SplitIntoBatches(
+    const std::vector<std::string>& texts, const TextBatchOptions& options);
+
+}  // namespace mediapipe::tasks::text::utils
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_BATCHING_H_
@@ -0,0 +1,73 @@
+/* Copyright 2023 The MediaPipe Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/utils/text_batching.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe::tasks::text::utils {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(TextBatchingTest, SplitsInInputOrder) {
+  const std::vector<std::string> texts = {"ccc", "a", "bb", "dddd", "e"};
+  TextBatchOptions options;
+  options.max_batch_size = 2;
+
+  EXPECT_THAT(SplitIntoBatches(texts, options),
+              ElementsAre(ElementsAre(0, 1), ElementsAre(2, 3),
+                          ElementsAre(4)));
+}
+
+TEST(TextBatchingTest, SplitsByLength) {
+  const std::vector<std::string> texts = {"ccc", "a", "bb", "dddd", "e"};
+  TextBatchOptions options;
+  options.max_batch_size = 2;
+  options.bucket_by_length = true;
+
+  // Texts of the same length keep their input order.
+  EXPECT_THAT(SplitIntoBatches(texts, options),
+              ElementsAre(ElementsAre(1, 4), ElementsAre(2, 0),
+                          ElementsAre(3)));
+}
+
+TEST(TextBatchingTest, SplitsWithoutLimit) {
+  const std::vector<std::string> texts = {"ccc", "a", "bb"};
+  TextBatchOptions options;
+  options.max_batch_size = 0;
+
+  EXPECT_THAT(SplitIntoBatches(texts, options),
+              ElementsAre(ElementsAre(0, 1, 2)));
+  EXPECT_THAT(SplitIntoBatches({}, options), IsEmpty());
+}
+
+TEST(TextBatchingTest, DefaultsToSingleTexts) {
+  TextBatchOptions options;
+  EXPECT_FALSE(UsesBatchedInference(options));
+  EXPECT_THAT(SplitIntoBatches({"a", "b"}, options),
+              ElementsAre(ElementsAre(0), ElementsAre(1)));
+
+  options.max_batch_size = 0;
+  EXPECT_TRUE(UsesBatchedInference(options));
+}
+
+}  // namespace
+}  // namespace mediapipe::tasks::text::utils
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <array>
 #include <memory>
 #include <optional>
 #include <type_traits>
@@ -22,6 +23,8 @@ limitations under the License.
 #include "mediapipe/calculators/core/get_vector_item_calculator.h"
 #include "mediapipe/calculators/core/get_vector_item_calculator.pb.h"
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
+#include "mediapipe/calculators/image/image_clone_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_floats_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/calculators/util/detections_to_rects_calculator.pb.h"
@@ -60,6 +63,7 @@ using ::mediapipe::NormalizedRect;
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
 using ::mediapipe::api2::builder::Graph;
+using ::mediapipe::api2::builder::Source;
 using ::mediapipe::api2::builder::Stream;
 using ::mediapipe::tasks::components::utils::AllowIf;
 
@@ -85,6 +89,10 @@ constexpr char kBlendshapesTag[] = "BLENDSHAPES";
 constexpr char kNormFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kSizeTag[] = "SIZE";
 constexpr char kVectorTag[] = "VECTOR";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
+constexpr char kLetterboxPaddingsTag[] = "LETTERBOX_PADDINGS";
+constexpr char kIndicesTag[] = "INDICES";
+constexpr char kIndexTag[] = "INDEX";
 
 // a landmarks tensor and a scores tensor
 constexpr int kFaceLandmarksOutputTensorsNum = 2;
@@ -166,6 +174,110 @@ void ConfigureLandmarksSmoothingCalculator(
   options.mutable_one_euro_filter()->set_derivate_cutoff(1.0f);
 }
 
+// Decodes the face landmark model outputs for the face in face_rect and
+// projects the results back to the image.
+//
+// output_tensors: the model outputs for a single face.
+// letterbox_padding: the letterbox padding of the model input for the face.
+// image_size: the size of the image the face is detected in.
+SingleFaceLandmarksOutputs DecodeFaceLandmarks(
+    const proto::FaceLandmarksDetectorGraphOptions& subgraph_options,
+    const ImageTensorSpecs& image_tensor_specs,
+    Stream<std::vector<Tensor>> output_tensors,
+    Stream<std::array<float, 4>> letterbox_padding,
+    Stream<std::pair<int, int>> image_size, Stream<NormalizedRect> face_rect,
+    Graph& graph) {
+  // Split model output tensors to multiple streams.
+  auto& split_tensors_vector = graph.AddNode("SplitTensorVectorCalculator");
+  ConfigureSplitTensorVectorCalculator(
+      &split_tensors_vector
+           .GetOptions<mediapipe::SplitVectorCalculatorOptions>());
+  output_tensors >> split_tensors_vector.In("");
+  auto landmark_tensors = split_tensors_vector.Out(0);
+  auto presence_flag_tensors = split_tensors_vector.Out(1);
+
+  // Decodes the landmark tensors into a list of landmarks, where the landmark
+  // coordinates are normalized by the size of the input image to the model.
+  auto& tensors_to_face_landmarks = graph.AddNode(
+      "mediapipe.tasks.vision.face_landmarker.TensorsToFaceLandmarksGraph");
+  ConfigureTensorsToFaceLandmarksGraph(
+      image_tensor_specs,
+      &tensors_to_face_landmarks
+           .GetOptions<proto::TensorsToFaceLandmarksGraphOptions>());
+  landmark_tensors >> tensors_to_face_landmarks.In(kTensorsTag);
+  auto landmarks = tensors_to_face_landmarks.Out(kNormLandmarksTag);
+
+  // Converts the presence flag tensor into a float that represents the
+  // confidence score of face presence.
+  auto& tensors_to_presence = graph.AddNode("TensorsToFloatsCalculator");
+  tensors_to_presence.GetOptions<mediapipe::TensorsToFloatsCalculatorOptions>()
+      .set_activation(mediapipe::TensorsToFloatsCalculatorOptions::SIGMOID);
+  presence_flag_tensors >> tensors_to_presence.In(kTensorsTag);
+  auto presence_score = tensors_to_presence.Out(kFloatTag).Cast<float>();
+
+  // Applies a threshold to the confidence score to determine whether a
+  // face is present.
+  auto& presence_thresholding = graph.AddNode("ThresholdingCalculator");
+  presence_thresholding.GetOptions<mediapipe::ThresholdingCalculatorOptions>()
+      .set_threshold(subgraph_options.min_detection_confidence());
+  presence_score >> presence_thresholding.In(kFloatTag);
+  auto presence = presence_thresholding.Out(kFlagTag).Cast<bool>();
+
+  // Adjusts landmarks (already normalized to [0.f, 1.f]) on the letterboxed
+  // face image (after image transformation with the FIT scale mode) to the
+  // corresponding locations on the same image with the letterbox removed
+  // (face image before image transformation).
+  auto& landmark_letterbox_removal =
+      graph.AddNode("LandmarkLetterboxRemovalCalculator");
+  letterbox_padding >> landmark_letterbox_removal.In(kLetterboxPaddingTag);
+  landmarks >> landmark_letterbox_removal.In(kLandmarksTag);
+  auto landmarks_letterbox_removed =
+      landmark_letterbox_removal.Out(kLandmarksTag);
+
+  // Projects the landmarks from the cropped face image to the corresponding
+  // locations on the full image before cropping (input to the graph).
+  auto& landmark_projection = graph.AddNode("LandmarkProjectionCalculator");
+  landmarks_letterbox_removed >> landmark_projection.In(kNormLandmarksTag);
+  face_rect >> landmark_projection.In(kNormRectTag);
+  Stream<NormalizedLandmarkList> projected_landmarks = AllowIf(
+      landmark_projection[Output<NormalizedLandmarkList>(kNormLandmarksTag)],
+      presence, graph);
+
+  // Converts the face landmarks into a rectangle (normalized by image size)
+  // that encloses the face.
+  auto& landmarks_to_detection =
+      graph.AddNode("LandmarksToDetectionCalculator");
+  projected_landmarks >> landmarks_to_detection.In(kNormLandmarksTag);
+  auto face_landmarks_detection = landmarks_to_detection.Out(kDetectionTag);
+  auto& detection_to_rect = graph.AddNode("DetectionsToRectsCalculator");
+  ConfigureFaceDetectionsToRectsCalculator(
+      &detection_to_rect
+           .GetOptions<mediapipe::DetectionsToRectsCalculatorOptions>());
+  face_landmarks_detection >> detection_to_rect.In(kDetectionTag);
+  image_size >> detection_to_rect.In(kImageSizeTag);
+  auto face_landmarks_rect = detection_to_rect.Out(kNormRectTag);
+
+  // Expands the face rectangle so that in the next video frame it's likely to
+  // still contain the face even with some motion.
+  auto& face_rect_transformation =
+      graph.AddNode("RectTransformationCalculator");
+  ConfigureFaceRectTransformationCalculator(
+      &face_rect_transformation
+           .GetOptions<mediapipe::RectTransformationCalculatorOptions>());
+  image_size >> face_rect_transformation.In(kImageSizeTag);
+  face_landmarks_rect >> face_rect_transformation.In(kNormRectTag);
+  auto face_rect_next_frame =
+      AllowIf(face_rect_transformation.Out("").Cast<NormalizedRect>(),
+              presence, graph);
+
+  return {
+      /* landmarks= */ projected_landmarks,
+      /* rect_next_frame= */ face_rect_next_frame,
+      /* presence= */ presence,
+      /* presence_score= */ presence_score,
+  };
+}
+
 }  // namespace
 
 // A "mediapipe.tasks.vision.face_landmarker.SingleFaceLandmarksDetectorGraph"
@@ -275,103 +387,18 @@ class SingleFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
     auto letterbox_padding = preprocessing.Out(kLetterboxPaddingTag);
     auto input_tensors = preprocessing.Out(kTensorsTag);
 
+    ASSIGN_OR_RETURN(auto image_tensor_specs,
+                     vision::BuildInputImageTensorSpecs(model_resources));
+
     auto& inference = AddInference(
         model_resources, subgraph_options.base_options().acceleration(), graph);
     input_tensors >> inference.In(kTensorsTag);
-    auto output_tensors = inference.Out(kTensorsTag);
-
-    // Split model output tensors to multiple streams.
-    auto& split_tensors_vector = graph.AddNode("SplitTensorVectorCalculator");
-    ConfigureSplitTensorVectorCalculator(
-        &split_tensors_vector
-             .GetOptions<mediapipe::SplitVectorCalculatorOptions>());
-    output_tensors >> split_tensors_vector.In("");
-    auto landmark_tensors = split_tensors_vector.Out(0);
-    auto presence_flag_tensors = split_tensors_vector.Out(1);
-
-    // Decodes the landmark tensors into a list of landmarks, where the landmark
-    // coordinates are normalized by the size of the input image to the model.
-    ASSIGN_OR_RETURN(auto image_tensor_specs,
-                     vision::BuildInputImageTensorSpecs(model_resources));
-    auto& tensors_to_face_landmarks = graph.AddNode(
-        "mediapipe.tasks.vision.face_landmarker.TensorsToFaceLandmarksGraph");
-    ConfigureTensorsToFaceLandmarksGraph(
-        image_tensor_specs,
-        &tensors_to_face_landmarks
-             .GetOptions<proto::TensorsToFaceLandmarksGraphOptions>());
-    landmark_tensors >> tensors_to_face_landmarks.In(kTensorsTag);
-    auto landmarks = tensors_to_face_landmarks.Out(kNormLandmarksTag);
-
-    // Converts the presence flag tensor into a float that represents the
-    // confidence score of face presence.
-    auto& tensors_to_presence = graph.AddNode("TensorsToFloatsCalculator");
-    tensors_to_presence
-        .GetOptions<mediapipe::TensorsToFloatsCalculatorOptions>()
-        .set_activation(mediapipe::TensorsToFloatsCalculatorOptions::SIGMOID);
-    presence_flag_tensors >> tensors_to_presence.In(kTensorsTag);
-    auto presence_score = tensors_to_presence.Out(kFloatTag).Cast<float>();
-
-    // Applies a threshold to the confidence score to determine whether a
-    // face is present.
-    auto& presence_thresholding = graph.AddNode("ThresholdingCalculator");
-    presence_thresholding.GetOptions<mediapipe::ThresholdingCalculatorOptions>()
-        .set_threshold(subgraph_options.min_detection_confidence());
-    presence_score >> presence_thresholding.In(kFloatTag);
-    auto presence = presence_thresholding.Out(kFlagTag).Cast<bool>();
-
-    // Adjusts landmarks (already normalized to [0.f, 1.f]) on the letterboxed
-    // face image (after image transformation with the FIT scale mode) to the
-    // corresponding locations on the same image with the letterbox removed
-    // (face image before image transformation).
-    auto& landmark_letterbox_removal =
-        graph.AddNode("LandmarkLetterboxRemovalCalculator");
-    letterbox_padding >> landmark_letterbox_removal.In(kLetterboxPaddingTag);
-    landmarks >> landmark_letterbox_removal.In(kLandmarksTag);
-    auto landmarks_letterbox_removed =
-        landmark_letterbox_removal.Out(kLandmarksTag);
-
-    // Projects the landmarks from the cropped face image to the corresponding
-    // locations on the full image before cropping (input to the graph).
-    auto& landmark_projection = graph.AddNode("LandmarkProjectionCalculator");
-    landmarks_letterbox_removed >> landmark_projection.In(kNormLandmarksTag);
-    face_rect >> landmark_projection.In(kNormRectTag);
-    Stream<NormalizedLandmarkList> projected_landmarks = AllowIf(
-        landmark_projection[Output<NormalizedLandmarkList>(kNormLandmarksTag)],
-        presence, graph);
-
-    // Converts the face landmarks into a rectangle (normalized by image size)
-    // that encloses the face.
-    auto& landmarks_to_detection =
-        graph.AddNode("LandmarksToDetectionCalculator");
-    projected_landmarks >> landmarks_to_detection.In(kNormLandmarksTag);
-    auto face_landmarks_detection = landmarks_to_detection.Out(kDetectionTag);
-    auto& detection_to_rect = graph.AddNode("DetectionsToRectsCalculator");
-    ConfigureFaceDetectionsToRectsCalculator(
-        &detection_to_rect
-             .GetOptions<mediapipe::DetectionsToRectsCalculatorOptions>());
-    face_landmarks_detection >> detection_to_rect.In(kDetectionTag);
-    image_size >> detection_to_rect.In(kImageSizeTag);
-    auto face_landmarks_rect = detection_to_rect.Out(kNormRectTag);
-
-    // Expands the face rectangle so that in the next video frame it's likely to
-    // still contain the face even with some motion.
-    auto& face_rect_transformation =
-        graph.AddNode("RectTransformationCalculator");
-    ConfigureFaceRectTransformationCalculator(
-        &face_rect_transformation
-             .GetOptions<mediapipe::RectTransformationCalculatorOptions>());
-    image_size >> face_rect_transformation.In(kImageSizeTag);
-    face_landmarks_rect >> face_rect_transformation.In(kNormRectTag);
-    auto face_rect_next_frame =
-        AllowIf(face_rect_transformation.Out("").Cast<NormalizedRect>(),
-                presence, graph);
-
-    return {{
-        /* landmarks= */ projected_landmarks,
-        /* rect_next_frame= */ face_rect_next_frame,
-        /* presence= */ presence,
-        /* presence_score= */ presence_score,
-    }};
+
+    return DecodeFaceLandmarks(
+        subgraph_options, image_tensor_specs,
+        inference.Out(kTensorsTag).Cast<std::vector<Tensor>>(),
+        letterbox_padding.Cast<std::array<float, 4>>(),
+        image_size.Cast<std::pair<int, int>>(), face_rect, graph);
   }
 };
 
@@ -386,6 +413,9 @@ REGISTER_MEDIAPIPE_GRAPH(
 //   multiple face landmarks enclosed by the RoIs. Output vectors of
 //   face landmarks related results, where each element in the vectors
 //   corresponds to the result of the same face.
+// - If batch_face_rects is set in the options, crops all face RoIs of an image
+//   into one batched tensor on CPU and runs the face landmark model once for
+//   all of them.
 //
 // Inputs:
 //   IMAGE - Image
@@ -497,12 +527,18 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
   absl::StatusOr<CalculatorGraphConfig> GetConfig(
       SubgraphContext* sc) override {
     Graph graph;
+    auto& subgraph_options =
+        *sc->MutableOptions<proto::FaceLandmarksDetectorGraphOptions>();
+    auto image_in = graph[Input<Image>(kImageTag)];
+    auto multi_face_rects =
+        graph[Input<std::vector<NormalizedRect>>(kNormRectTag)];
     ASSIGN_OR_RETURN(
         auto outs,
-        BuildFaceLandmarksDetectorGraph(
-            *sc->MutableOptions<proto::FaceLandmarksDetectorGraphOptions>(),
-            graph[Input<Image>(kImageTag)],
-            graph[Input<std::vector<NormalizedRect>>(kNormRectTag)], graph));
+        subgraph_options.batch_face_rects()
+            ? BuildBatchedFaceLandmarksDetectorGraph(
+                  sc, subgraph_options, image_in, multi_face_rects, graph)
+            : BuildFaceLandmarksDetectorGraph(subgraph_options, image_in,
+                                              multi_face_rects, graph));
     outs.landmarks_lists >> graph.Out(kNormLandmarksTag)
                                 .Cast<std::vector<NormalizedLandmarkList>>();
     outs.rects_next_frame >>
@@ -518,6 +554,7 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
   }
 
  private:
+  // Runs a SingleFaceLandmarksDetectorGraph for each face rect.
   absl::StatusOr<MultiFaceLandmarksOutputs> BuildFaceLandmarksDetectorGraph(
       proto::FaceLandmarksDetectorGraphOptions& subgraph_options,
       Stream<Image> image_in,
@@ -525,9 +562,12 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
     auto& face_landmark_subgraph = graph.AddNode(
         "mediapipe.tasks.vision.face_landmarker."
         "SingleFaceLandmarksDetectorGraph");
-    face_landmark_subgraph
-        .GetOptions<proto::FaceLandmarksDetectorGraphOptions>()
-        .Swap(&subgraph_options);
+    auto& single_face_options =
+        face_landmark_subgraph
+            .GetOptions<proto::FaceLandmarksDetectorGraphOptions>();
+    single_face_options.CopyFrom(subgraph_options);
+    // Blendshapes are computed from the landmarks of all faces below.
+    single_face_options.clear_face_blendshapes_graph_options();
 
     auto& begin_loop_multi_face_rects =
         graph.AddNode("BeginLoopNormalizedRectCalculator");
@@ -540,11 +580,120 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
 
     image >> face_landmark_subgraph.In(kImageTag);
     face_rect >> face_landmark_subgraph.In(kNormRectTag);
-    auto presence = face_landmark_subgraph.Out(kPresenceTag);
-    auto presence_score = face_landmark_subgraph.Out(kPresenceScoreTag);
-    auto face_rect_next_frame =
-        face_landmark_subgraph.Out(kFaceRectNextFrameTag);
-    auto landmarks = face_landmark_subgraph.Out(kNormLandmarksTag);
+    return CollectFaceLandmarks(
+        subgraph_options, image_in, batch_end,
+        {
+            /* landmarks= */ face_landmark_subgraph.Out(kNormLandmarksTag)
+                .Cast<NormalizedLandmarkList>(),
+            /* rect_next_frame= */ face_landmark_subgraph
+                .Out(kFaceRectNextFrameTag)
+                .Cast<NormalizedRect>(),
+            /* presence= */ face_landmark_subgraph.Out(kPresenceTag)
+                .Cast<bool>(),
+            /* presence_score= */ face_landmark_subgraph
+                .Out(kPresenceScoreTag)
+                .Cast<float>(),
+        },
+        graph);
+  }
+
+  // Crops all face rects into one batched tensor and runs the face landmark
+  // model on it once. The model outputs are then decoded for each face rect.
+  absl::StatusOr<MultiFaceLandmarksOutputs>
+  BuildBatchedFaceLandmarksDetectorGraph(
+      SubgraphContext* sc,
+      proto::FaceLandmarksDetectorGraphOptions& subgraph_options,
+      Stream<Image> image_in,
+      Stream<std::vector<NormalizedRect>> multi_face_rects, Graph& graph) {
+    MP_RETURN_IF_ERROR(SanityCheckOptions(subgraph_options));
+    if (subgraph_options.base_options().acceleration().has_gpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "`batch_face_rects` requires the face landmark model to run on CPU.",
+          MediaPipeTasksStatus::kInvalidArgumentError);
+    }
+    ASSIGN_OR_RETURN(
+        const auto* model_resources,
+        CreateModelResources<proto::FaceLandmarksDetectorGraphOptions>(sc));
+    ASSIGN_OR_RETURN(auto image_tensor_specs,
+                     vision::BuildInputImageTensorSpecs(*model_resources));
+
+    // Crops all face rects into one tensor with a batch entry per face.
+    components::processors::proto::ImagePreprocessingGraphOptions
+        preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
+        *model_resources, /*use_gpu=*/false, &preprocessing_options));
+    auto& image_to_cpu = graph.AddNode("ImageCloneCalculator");
+    image_to_cpu.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
+        .set_output_on_gpu(false);
+    image_in >> image_to_cpu.In("");
+    auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
+    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
+        .Swap(preprocessing_options.mutable_image_to_tensor_options());
+    image_to_cpu.Out("") >> image_to_tensor.In(kImageTag);
+    multi_face_rects >> image_to_tensor.In(kNormRectsTag);
+
+    auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_properties.In(kImageTag);
+
+    auto& inference =
+        AddInference(*model_resources,
+                     subgraph_options.base_options().acceleration(), graph);
+    image_to_tensor.Out(kTensorsTag) >> inference.In(kTensorsTag);
+
+    // Loops over the indices of the face rects, which are also the indices of
+    // the faces in the batched model outputs.
+    auto& face_indices =
+        graph.AddNode("NormalizedRectVectorIndicesCalculator");
+    multi_face_rects >> face_indices.In(kVectorTag);
+    auto& begin_loop_face_indices = graph.AddNode("BeginLoopIntCalculator");
+    face_indices.Out(kIndicesTag) >> begin_loop_face_indices.In(kIterableTag);
+    inference.Out(kTensorsTag) >> begin_loop_face_indices.In(kCloneTag)[0];
+    image_to_tensor.Out(kLetterboxPaddingsTag) >>
+        begin_loop_face_indices.In(kCloneTag)[1];
+    multi_face_rects >> begin_loop_face_indices.In(kCloneTag)[2];
+    image_properties.Out(kSizeTag) >> begin_loop_face_indices.In(kCloneTag)[3];
+    auto batch_end = begin_loop_face_indices.Out(kBatchEndTag);
+    auto face_index = begin_loop_face_indices.Out(kItemTag);
+
+    auto& get_output_tensors = graph.AddNode("GetTensorsBatchItemCalculator");
+    begin_loop_face_indices.Out(kCloneTag)[0] >>
+        get_output_tensors.In(kTensorsTag);
+    face_index >> get_output_tensors.In(kIndexTag);
+
+    auto& get_letterbox_padding =
+        graph.AddNode("GetLetterboxPaddingVectorItemCalculator");
+    begin_loop_face_indices.Out(kCloneTag)[1] >>
+        get_letterbox_padding.In(kVectorTag);
+    face_index >> get_letterbox_padding.In(kIndexTag);
+
+    auto& get_face_rect =
+        graph.AddNode("GetNormalizedRectVectorItemCalculator");
+    begin_loop_face_indices.Out(kCloneTag)[2] >> get_face_rect.In(kVectorTag);
+    face_index >> get_face_rect.In(kIndexTag);
+
+    return CollectFaceLandmarks(
+        subgraph_options, image_in, batch_end,
+        DecodeFaceLandmarks(
+            subgraph_options, image_tensor_specs,
+            get_output_tensors.Out(kTensorsTag).Cast<std::vector<Tensor>>(),
+            get_letterbox_padding.Out(kItemTag).Cast<std::array<float, 4>>(),
+            begin_loop_face_indices.Out(kCloneTag)[3]
+                .Cast<std::pair<int, int>>(),
+            get_face_rect.Out(kItemTag).Cast<NormalizedRect>(), graph),
+        graph);
+  }
+
+  // Collects the outputs of all loop iterations into vectors, and smoothes
+  // the landmarks and computes the blendshapes if enabled in the options.
+  MultiFaceLandmarksOutputs CollectFaceLandmarks(
+      proto::FaceLandmarksDetectorGraphOptions& subgraph_options,
+      Stream<Image> image_in, Source<> batch_end,
+      SingleFaceLandmarksOutputs face_outputs, Graph& graph) {
+    auto presence = face_outputs.presence;
+    auto presence_score = face_outputs.presence_score;
+    auto face_rect_next_frame = face_outputs.rect_next_frame;
+    auto landmarks = face_outputs.landmarks;
 
     auto& end_loop_presence = graph.AddNode("EndLoopBooleanCalculator");
     batch_end >> end_loop_presence.In(kBatchEndTag);
@@ -579,9 +728,7 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
     // loop calculator, because the smoothing calculator utilize the timestamp
     // to smoote landmarks across frames but the for loop calculator makes fake
     // timestamps for the streams.
-    if (face_landmark_subgraph
-            .GetOptions<proto::FaceLandmarksDetectorGraphOptions>()
-            .smooth_landmarks()) {
+    if (subgraph_options.smooth_landmarks()) {
       // Get the single face landmarks
       auto& get_vector_item =
           graph.AddNode("GetNormalizedLandmarkListVectorItemCalculator");
@@ -615,9 +762,7 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
 
     std::optional<Stream<std::vector<ClassificationList>>>
         face_blendshapes_vector;
-    if (face_landmark_subgraph
-            .GetOptions<proto::FaceLandmarksDetectorGraphOptions>()
-            .has_face_blendshapes_graph_options()) {
+    if (subgraph_options.has_face_blendshapes_graph_options()) {
       auto& begin_loop_multi_face_landmarks =
           graph.AddNode("BeginLoopNormalizedLandmarkListVectorCalculator");
       landmark_lists >> begin_loop_multi_face_landmarks.In(kIterableTag);
@@ -633,9 +778,7 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
       auto& face_blendshapes_graph = graph.AddNode(
           "mediapipe.tasks.vision.face_landmarker.FaceBlendshapesGraph");
       face_blendshapes_graph.GetOptions<proto::FaceBlendshapesGraphOptions>()
-          .Swap(face_landmark_subgraph
-                    .GetOptions<proto::FaceLandmarksDetectorGraphOptions>()
-                    .mutable_face_blendshapes_graph_options());
+          .Swap(subgraph_options.mutable_face_blendshapes_graph_options());
       landmarks >> face_blendshapes_graph.In(kLandmarksTag);
       image_size >> face_blendshapes_graph.In(kImageSizeTag);
       auto face_blendshapes = face_blendshapes_graph.Out(kBlendshapesTag)
@@ -650,13 +793,13 @@ class MultiFaceLandmarksDetectorGraph : public core::ModelTaskGraph {
                                  .Cast<std::vector<ClassificationList>>());
     }
 
-    return {{
+    return {
         /* landmarks_lists= */ landmark_lists,
         /* face_rects_next_frame= */ face_rects_next_frame,
         /* presences= */ presences,
         /* presence_scores= */ presence_scores,
         /* face_blendshapes= */ face_blendshapes_vector,
-    }};
+    };
   }
 };
 
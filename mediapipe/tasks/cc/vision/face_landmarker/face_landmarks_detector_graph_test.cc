@@ -135,7 +135,8 @@ absl::StatusOr<std::unique_ptr<TaskRunner>> CreateSingleFaceLandmarksTaskRunner(
 // Helper function to create a Multi Face Landmark TaskRunner.
 absl::StatusOr<std::unique_ptr<TaskRunner>> CreateMultiFaceLandmarksTaskRunner(
     absl::string_view landmarks_model_name,
-    std::optional<absl::string_view> blendshapes_model_name) {
+    std::optional<absl::string_view> blendshapes_model_name,
+    bool batch_face_rects) {
   Graph graph;
 
   auto& face_landmark_detection = graph.AddNode(
@@ -146,6 +147,7 @@ absl::StatusOr<std::unique_ptr<TaskRunner>> CreateMultiFaceLandmarksTaskRunner(
   options->mutable_base_options()->mutable_model_asset()->set_file_name(
       JoinPath("./", kTestDataDirectory, landmarks_model_name));
   options->set_min_detection_confidence(0.5);
+  options->set_batch_face_rects(batch_face_rects);
   if (blendshapes_model_name.has_value()) {
     options->mutable_face_blendshapes_graph_options()
         ->mutable_base_options()
@@ -247,6 +249,8 @@ struct MultiFaceTestParams {
   // The max value difference between expected blendshapes and actual
   // blendshapes.
   float blendshapes_diff_threshold;
+  // Whether to run the model once on a batch of all face rects.
+  bool batch_face_rects = false;
 };
 
 class SingleFaceLandmarksDetectionTest
@@ -292,7 +296,8 @@ TEST_P(MultiFaceLandmarksDetectionTest, Succeeds) {
   MP_ASSERT_OK_AND_ASSIGN(
       auto task_runner,
       CreateMultiFaceLandmarksTaskRunner(GetParam().landmarks_model_name,
-                                         GetParam().blendshape_model_name));
+                                         GetParam().blendshape_model_name,
+                                         GetParam().batch_face_rects));
 
   auto output_packets = task_runner->Process(
       {{kImageName, MakePacket<Image>(std::move(image))},
@@ -375,6 +380,23 @@ INSTANTIATE_TEST_SUITE_P(
             {{GetBlendshapes(kPortraitExpectedBlendshapesName)}},
             /* landmarks_diff_threshold= */ kFractionDiff,
             /* blendshapes_diff_threshold= */ kBlendshapesDiffMargin},
+        MultiFaceTestParams{
+            /* test_name= */ "BatchedPortraitWithV2WithBlendshapes",
+            /* landmarks_model_name= */
+            kFaceLandmarksV2Model,
+            /* blendshape_model_name= */ kFaceBlendshapesModel,
+            /* test_image_name= */ kPortraitImageName,
+            /* norm_rects= */
+            {MakeNormRect(0.48906386, 0.22731927, 0.42905223, 0.34357703,
+                          0.008304443)},
+            /* expected_presence= */ {true},
+            /* expected_landmarks_list= */
+            {{GetExpectedLandmarkList(kPortraitExpectedFaceLandmarksName)}},
+            /* expected_blendshapes= */
+            {{GetBlendshapes(kPortraitExpectedBlendshapesName)}},
+            /* landmarks_diff_threshold= */ kFractionDiff,
+            /* blendshapes_diff_threshold= */ kBlendshapesDiffMargin,
+            /* batch_face_rects= */ true},
         MultiFaceTestParams{
             /* test_name= */ "NoFace",
             /* landmarks_model_name= */
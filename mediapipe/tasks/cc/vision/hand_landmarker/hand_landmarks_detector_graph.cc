@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <array>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -21,6 +22,8 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
+#include "mediapipe/calculators/image/image_clone_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_classification_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
@@ -156,6 +159,138 @@ void ConfigureHandRectTransformationCalculator(
   options->set_square_long(true);
 }
 
+// Decodes the hand landmark model outputs for the hand in hand_rect and
+// projects the results back to the image.
+//
+// output_tensors: the model outputs for a single hand.
+// letterbox_padding: the letterbox padding of the model input for the hand.
+// image_size: the size of the image the hand is detected in.
+SingleHandLandmarkerOutputs DecodeHandLandmarks(
+    const HandLandmarksDetectorGraphOptions& subgraph_options,
+    const ImageTensorSpecs& image_tensor_specs,
+    Source<std::vector<Tensor>> output_tensors,
+    Source<std::array<float, 4>> letterbox_padding,
+    Source<std::pair<int, int>> image_size, Source<NormalizedRect> hand_rect,
+    Graph& graph) {
+  // Split model output tensors to multiple streams.
+  auto& split_tensors_vector = graph.AddNode("SplitTensorVectorCalculator");
+  ConfigureSplitTensorVectorCalculator(
+      &split_tensors_vector
+           .GetOptions<mediapipe::SplitVectorCalculatorOptions>());
+  output_tensors >> split_tensors_vector.In("");
+  auto landmark_tensors = split_tensors_vector.Out(0);
+  auto hand_flag_tensors = split_tensors_vector.Out(1);
+  auto handedness_tensors = split_tensors_vector.Out(2);
+  auto world_landmark_tensors = split_tensors_vector.Out(3);
+
+  // Decodes the landmark tensors into a list of landmarks, where the landmark
+  // coordinates are normalized by the size of the input image to the model.
+  auto& tensors_to_landmarks = graph.AddNode("TensorsToLandmarksCalculator");
+  ConfigureTensorsToLandmarksCalculator(
+      image_tensor_specs, /* normalize = */ true,
+      &tensors_to_landmarks
+           .GetOptions<mediapipe::TensorsToLandmarksCalculatorOptions>());
+  landmark_tensors >> tensors_to_landmarks.In("TENSORS");
+
+  // Decodes the landmark tensors into a list of landmarks, where the landmark
+  // coordinates are world coordinates in meters.
+  auto& tensors_to_world_landmarks =
+      graph.AddNode("TensorsToLandmarksCalculator");
+  ConfigureTensorsToLandmarksCalculator(
+      image_tensor_specs, /* normalize = */ false,
+      &tensors_to_world_landmarks
+           .GetOptions<mediapipe::TensorsToLandmarksCalculatorOptions>());
+  world_landmark_tensors >> tensors_to_world_landmarks.In("TENSORS");
+
+  // Converts the hand-flag tensor into a float that represents the confidence
+  // score of hand presence.
+  auto& tensors_to_hand_presence = graph.AddNode("TensorsToFloatsCalculator");
+  hand_flag_tensors >> tensors_to_hand_presence.In("TENSORS");
+  auto hand_presence_score = tensors_to_hand_presence[Output<float>("FLOAT")];
+
+  // Applies a threshold to the confidence score to determine whether a
+  // hand is present.
+  auto& hand_presence_thresholding = graph.AddNode("ThresholdingCalculator");
+  hand_presence_thresholding
+      .GetOptions<mediapipe::ThresholdingCalculatorOptions>()
+      .set_threshold(subgraph_options.min_detection_confidence());
+  hand_presence_score >> hand_presence_thresholding.In("FLOAT");
+  auto hand_presence = hand_presence_thresholding[Output<bool>("FLAG")];
+
+  // Converts the handedness tensor into a float that represents the
+  // classification score of handedness.
+  auto& tensors_to_handedness =
+      graph.AddNode("TensorsToClassificationCalculator");
+  ConfigureTensorsToHandednessCalculator(
+      &tensors_to_handedness.GetOptions<
+          mediapipe::TensorsToClassificationCalculatorOptions>());
+  handedness_tensors >> tensors_to_handedness.In("TENSORS");
+  auto handedness = AllowIf(
+      tensors_to_handedness[Output<ClassificationList>("CLASSIFICATIONS")],
+      hand_presence, graph);
+
+  // Adjusts landmarks (already normalized to [0.f, 1.f]) on the letterboxed
+  // hand image (after image transformation with the FIT scale mode) to the
+  // corresponding locations on the same image with the letterbox removed
+  // (hand image before image transformation).
+  auto& landmark_letterbox_removal =
+      graph.AddNode("LandmarkLetterboxRemovalCalculator");
+  letterbox_padding >> landmark_letterbox_removal.In("LETTERBOX_PADDING");
+  tensors_to_landmarks.Out("NORM_LANDMARKS") >>
+      landmark_letterbox_removal.In("LANDMARKS");
+
+  // Projects the landmarks from the cropped hand image to the corresponding
+  // locations on the full image before cropping (input to the graph).
+  auto& landmark_projection = graph.AddNode("LandmarkProjectionCalculator");
+  landmark_letterbox_removal.Out("LANDMARKS") >>
+      landmark_projection.In("NORM_LANDMARKS");
+  hand_rect >> landmark_projection.In("NORM_RECT");
+  auto projected_landmarks = AllowIf(
+      landmark_projection[Output<NormalizedLandmarkList>("NORM_LANDMARKS")],
+      hand_presence, graph);
+
+  // Projects the world landmarks from the cropped hand image to the
+  // corresponding locations on the full image before cropping (input to the
+  // graph).
+  auto& world_landmark_projection =
+      graph.AddNode("WorldLandmarkProjectionCalculator");
+  tensors_to_world_landmarks.Out("LANDMARKS") >>
+      world_landmark_projection.In("LANDMARKS");
+  hand_rect >> world_landmark_projection.In("NORM_RECT");
+  auto projected_world_landmarks =
+      AllowIf(world_landmark_projection[Output<LandmarkList>("LANDMARKS")],
+              hand_presence, graph);
+
+  // Converts the hand landmarks into a rectangle (normalized by image size)
+  // that encloses the hand.
+  auto& hand_landmarks_to_rect = graph.AddNode("HandLandmarksToRectCalculator");
+  image_size >> hand_landmarks_to_rect.In("IMAGE_SIZE");
+  projected_landmarks >> hand_landmarks_to_rect.In("NORM_LANDMARKS");
+
+  // Expands the hand rectangle so that in the next video frame it's likely to
+  // still contain the hand even with some motion.
+  auto& hand_rect_transformation =
+      graph.AddNode("RectTransformationCalculator");
+  ConfigureHandRectTransformationCalculator(
+      &hand_rect_transformation
+           .GetOptions<mediapipe::RectTransformationCalculatorOptions>());
+  image_size >> hand_rect_transformation.In("IMAGE_SIZE");
+  hand_landmarks_to_rect.Out("NORM_RECT") >>
+      hand_rect_transformation.In("NORM_RECT");
+  auto hand_rect_next_frame =
+      AllowIf(hand_rect_transformation[Output<NormalizedRect>("")],
+              hand_presence, graph);
+
+  return {
+      /* hand_landmarks= */ projected_landmarks,
+      /* world_hand_landmarks= */ projected_world_landmarks,
+      /* hand_rect_next_frame= */ hand_rect_next_frame,
+      /* hand_presence= */ hand_presence,
+      /* hand_presence_score= */ hand_presence_score,
+      /* handedness= */ handedness,
+  };
+}
+
 }  // namespace
 
 // A "mediapipe.tasks.vision.hand_landmarker.SingleHandLandmarksDetectorGraph"
@@ -276,125 +411,11 @@ class SingleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
         model_resources, subgraph_options.base_options().acceleration(), graph);
     preprocessing.Out("TENSORS") >> inference.In("TENSORS");
 
-    // Split model output tensors to multiple streams.
-    auto& split_tensors_vector = graph.AddNode("SplitTensorVectorCalculator");
-    ConfigureSplitTensorVectorCalculator(
-        &split_tensors_vector
-             .GetOptions<mediapipe::SplitVectorCalculatorOptions>());
-    inference.Out("TENSORS") >> split_tensors_vector.In("");
-    auto landmark_tensors = split_tensors_vector.Out(0);
-    auto hand_flag_tensors = split_tensors_vector.Out(1);
-    auto handedness_tensors = split_tensors_vector.Out(2);
-    auto world_landmark_tensors = split_tensors_vector.Out(3);
-
-    // Decodes the landmark tensors into a list of landmarks, where the landmark
-    // coordinates are normalized by the size of the input image to the model.
-    auto& tensors_to_landmarks = graph.AddNode("TensorsToLandmarksCalculator");
-    ConfigureTensorsToLandmarksCalculator(
-        image_tensor_specs, /* normalize = */ true,
-        &tensors_to_landmarks
-             .GetOptions<mediapipe::TensorsToLandmarksCalculatorOptions>());
-    landmark_tensors >> tensors_to_landmarks.In("TENSORS");
-
-    // Decodes the landmark tensors into a list of landmarks, where the landmark
-    // coordinates are world coordinates in meters.
-    auto& tensors_to_world_landmarks =
-        graph.AddNode("TensorsToLandmarksCalculator");
-    ConfigureTensorsToLandmarksCalculator(
-        image_tensor_specs, /* normalize = */ false,
-        &tensors_to_world_landmarks
-             .GetOptions<mediapipe::TensorsToLandmarksCalculatorOptions>());
-    world_landmark_tensors >> tensors_to_world_landmarks.In("TENSORS");
-
-    // Converts the hand-flag tensor into a float that represents the confidence
-    // score of hand presence.
-    auto& tensors_to_hand_presence = graph.AddNode("TensorsToFloatsCalculator");
-    hand_flag_tensors >> tensors_to_hand_presence.In("TENSORS");
-    auto hand_presence_score = tensors_to_hand_presence[Output<float>("FLOAT")];
-
-    // Applies a threshold to the confidence score to determine whether a
-    // hand is present.
-    auto& hand_presence_thresholding = graph.AddNode("ThresholdingCalculator");
-    hand_presence_thresholding
-        .GetOptions<mediapipe::ThresholdingCalculatorOptions>()
-        .set_threshold(subgraph_options.min_detection_confidence());
-    hand_presence_score >> hand_presence_thresholding.In("FLOAT");
-    auto hand_presence = hand_presence_thresholding[Output<bool>("FLAG")];
-
-    // Converts the handedness tensor into a float that represents the
-    // classification score of handedness.
-    auto& tensors_to_handedness =
-        graph.AddNode("TensorsToClassificationCalculator");
-    ConfigureTensorsToHandednessCalculator(
-        &tensors_to_handedness.GetOptions<
-            mediapipe::TensorsToClassificationCalculatorOptions>());
-    handedness_tensors >> tensors_to_handedness.In("TENSORS");
-    auto handedness = AllowIf(
-        tensors_to_handedness[Output<ClassificationList>("CLASSIFICATIONS")],
-        hand_presence, graph);
-
-    // Adjusts landmarks (already normalized to [0.f, 1.f]) on the letterboxed
-    // hand image (after image transformation with the FIT scale mode) to the
-    // corresponding locations on the same image with the letterbox removed
-    // (hand image before image transformation).
-    auto& landmark_letterbox_removal =
-        graph.AddNode("LandmarkLetterboxRemovalCalculator");
-    preprocessing.Out("LETTERBOX_PADDING") >>
-        landmark_letterbox_removal.In("LETTERBOX_PADDING");
-    tensors_to_landmarks.Out("NORM_LANDMARKS") >>
-        landmark_letterbox_removal.In("LANDMARKS");
-
-    // Projects the landmarks from the cropped hand image to the corresponding
-    // locations on the full image before cropping (input to the graph).
-    auto& landmark_projection = graph.AddNode("LandmarkProjectionCalculator");
-    landmark_letterbox_removal.Out("LANDMARKS") >>
-        landmark_projection.In("NORM_LANDMARKS");
-    hand_rect >> landmark_projection.In("NORM_RECT");
-    auto projected_landmarks = AllowIf(
-        landmark_projection[Output<NormalizedLandmarkList>("NORM_LANDMARKS")],
-        hand_presence, graph);
-
-    // Projects the world landmarks from the cropped hand image to the
-    // corresponding locations on the full image before cropping (input to the
-    // graph).
-    auto& world_landmark_projection =
-        graph.AddNode("WorldLandmarkProjectionCalculator");
-    tensors_to_world_landmarks.Out("LANDMARKS") >>
-        world_landmark_projection.In("LANDMARKS");
-    hand_rect >> world_landmark_projection.In("NORM_RECT");
-    auto projected_world_landmarks =
-        AllowIf(world_landmark_projection[Output<LandmarkList>("LANDMARKS")],
-                hand_presence, graph);
-
-    // Converts the hand landmarks into a rectangle (normalized by image size)
-    // that encloses the hand.
-    auto& hand_landmarks_to_rect =
-        graph.AddNode("HandLandmarksToRectCalculator");
-    image_size >> hand_landmarks_to_rect.In("IMAGE_SIZE");
-    projected_landmarks >> hand_landmarks_to_rect.In("NORM_LANDMARKS");
-
-    // Expands the hand rectangle so that in the next video frame it's likely to
-    // still contain the hand even with some motion.
-    auto& hand_rect_transformation =
-        graph.AddNode("RectTransformationCalculator");
-    ConfigureHandRectTransformationCalculator(
-        &hand_rect_transformation
-             .GetOptions<mediapipe::RectTransformationCalculatorOptions>());
-    image_size >> hand_rect_transformation.In("IMAGE_SIZE");
-    hand_landmarks_to_rect.Out("NORM_RECT") >>
-        hand_rect_transformation.In("NORM_RECT");
-    auto hand_rect_next_frame =
-        AllowIf(hand_rect_transformation[Output<NormalizedRect>("")],
-                hand_presence, graph);
-
-    return {{
-        /* hand_landmarks= */ projected_landmarks,
-        /* world_hand_landmarks= */ projected_world_landmarks,
-        /* hand_rect_next_frame= */ hand_rect_next_frame,
-        /* hand_presence= */ hand_presence,
-        /* hand_presence_score= */ hand_presence_score,
-        /* handedness= */ handedness,
-    }};
+    return DecodeHandLandmarks(
+        subgraph_options, image_tensor_specs,
+        inference[Output<std::vector<Tensor>>("TENSORS")],
+        preprocessing[Output<std::array<float, 4>>("LETTERBOX_PADDING")],
+        image_size, hand_rect, graph);
   }
 };
 
@@ -409,6 +430,9 @@ REGISTER_MEDIAPIPE_GRAPH(
 //   multiple hands landmarks enclosed by the RoIs. Output vectors of
 //   hand landmarks related results, where each element in the vectors
 //   corresponds to the result of the same hand.
+// - If batch_hand_rects is set in the options, crops all hand RoIs of an image
+//   into one batched tensor on CPU and runs the hand landmark model once for
+//   all of them.
 //
 // Inputs:
 //   IMAGE - Image
@@ -461,13 +485,19 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
  public:
   absl::StatusOr<CalculatorGraphConfig> GetConfig(
       SubgraphContext* sc) override {
+    const auto& subgraph_options =
+        sc->Options<HandLandmarksDetectorGraphOptions>();
     Graph graph;
+    auto image_in = graph[Input<Image>(kImageTag)];
+    auto multi_hand_rects =
+        graph[Input<std::vector<NormalizedRect>>(kHandRectTag)];
     ASSIGN_OR_RETURN(
         auto hand_landmark_detection_outputs,
-        BuildHandLandmarksDetectorGraph(
-            sc->Options<HandLandmarksDetectorGraphOptions>(),
-            graph[Input<Image>(kImageTag)],
-            graph[Input<std::vector<NormalizedRect>>(kHandRectTag)], graph));
+        subgraph_options.batch_hand_rects()
+            ? BuildBatchedHandLandmarksDetectorGraph(
+                  sc, subgraph_options, image_in, multi_hand_rects, graph)
+            : BuildHandLandmarksDetectorGraph(subgraph_options, image_in,
+                                              multi_hand_rects, graph));
     hand_landmark_detection_outputs.landmark_lists >>
         graph[Output<std::vector<NormalizedLandmarkList>>(kLandmarksTag)];
     hand_landmark_detection_outputs.world_landmark_lists >>
@@ -485,6 +515,7 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
   }
 
  private:
+  // Runs a SingleHandLandmarksDetectorGraph for each hand rect.
   absl::StatusOr<HandLandmarkerOutputs> BuildHandLandmarksDetectorGraph(
       const HandLandmarksDetectorGraphOptions& subgraph_options,
       Source<Image> image_in,
@@ -506,37 +537,137 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
 
     image >> hand_landmark_subgraph.In("IMAGE");
     hand_rect >> hand_landmark_subgraph.In("HAND_RECT");
-    auto handedness = hand_landmark_subgraph.Out("HANDEDNESS");
-    auto presence = hand_landmark_subgraph.Out("PRESENCE");
-    auto presence_score = hand_landmark_subgraph.Out("PRESENCE_SCORE");
-    auto hand_rect_next_frame =
-        hand_landmark_subgraph.Out("HAND_RECT_NEXT_FRAME");
-    auto landmarks = hand_landmark_subgraph.Out("LANDMARKS");
-    auto world_landmarks = hand_landmark_subgraph.Out("WORLD_LANDMARKS");
+    return CollectHandLandmarks(
+        batch_end,
+        {
+            /* hand_landmarks= */ hand_landmark_subgraph
+                [Output<NormalizedLandmarkList>("LANDMARKS")],
+            /* world_hand_landmarks= */ hand_landmark_subgraph
+                [Output<LandmarkList>("WORLD_LANDMARKS")],
+            /* hand_rect_next_frame= */ hand_landmark_subgraph
+                [Output<NormalizedRect>("HAND_RECT_NEXT_FRAME")],
+            /* hand_presence= */ hand_landmark_subgraph
+                [Output<bool>("PRESENCE")],
+            /* hand_presence_score= */ hand_landmark_subgraph
+                [Output<float>("PRESENCE_SCORE")],
+            /* handedness= */ hand_landmark_subgraph
+                [Output<ClassificationList>("HANDEDNESS")],
+        },
+        graph);
+  }
+
+  // Crops all hand rects into one batched tensor and runs the hand landmark
+  // model on it once. The model outputs are then decoded for each hand rect.
+  absl::StatusOr<HandLandmarkerOutputs> BuildBatchedHandLandmarksDetectorGraph(
+      SubgraphContext* sc,
+      const HandLandmarksDetectorGraphOptions& subgraph_options,
+      Source<Image> image_in,
+      Source<std::vector<NormalizedRect>> multi_hand_rects, Graph& graph) {
+    MP_RETURN_IF_ERROR(SanityCheckOptions(subgraph_options));
+    if (subgraph_options.base_options().acceleration().has_gpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "`batch_hand_rects` requires the hand landmark model to run on CPU.",
+          MediaPipeTasksStatus::kInvalidArgumentError);
+    }
+    ASSIGN_OR_RETURN(
+        const auto* model_resources,
+        CreateModelResources<HandLandmarksDetectorGraphOptions>(sc));
+    ASSIGN_OR_RETURN(auto image_tensor_specs,
+                     BuildInputImageTensorSpecs(*model_resources));
+
+    // Crops all hand rects into one tensor with a batch entry per hand.
+    components::processors::proto::ImagePreprocessingGraphOptions
+        preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
+        *model_resources, /*use_gpu=*/false, &preprocessing_options));
+    auto& image_to_cpu = graph.AddNode("ImageCloneCalculator");
+    image_to_cpu.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
+        .set_output_on_gpu(false);
+    image_in >> image_to_cpu.In("");
+    auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
+    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
+        .Swap(preprocessing_options.mutable_image_to_tensor_options());
+    image_to_cpu.Out("") >> image_to_tensor.In("IMAGE");
+    multi_hand_rects >> image_to_tensor.In("NORM_RECTS");
+
+    auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_properties.In("IMAGE");
+
+    auto& inference =
+        AddInference(*model_resources,
+                     subgraph_options.base_options().acceleration(), graph);
+    image_to_tensor.Out("TENSORS") >> inference.In("TENSORS");
+
+    // Loops over the indices of the hand rects, which are also the indices of
+    // the hands in the batched model outputs.
+    auto& hand_indices =
+        graph.AddNode("NormalizedRectVectorIndicesCalculator");
+    multi_hand_rects >> hand_indices.In("VECTOR");
+    auto& begin_loop_hand_indices = graph.AddNode("BeginLoopIntCalculator");
+    hand_indices.Out("INDICES") >> begin_loop_hand_indices.In("ITERABLE");
+    inference.Out("TENSORS") >> begin_loop_hand_indices.In("CLONE")[0];
+    image_to_tensor.Out("LETTERBOX_PADDINGS") >>
+        begin_loop_hand_indices.In("CLONE")[1];
+    multi_hand_rects >> begin_loop_hand_indices.In("CLONE")[2];
+    image_properties.Out("SIZE") >> begin_loop_hand_indices.In("CLONE")[3];
+    auto batch_end = begin_loop_hand_indices.Out("BATCH_END");
+    auto hand_index = begin_loop_hand_indices.Out("ITEM");
+
+    auto& get_output_tensors = graph.AddNode("GetTensorsBatchItemCalculator");
+    begin_loop_hand_indices.Out("CLONE")[0] >> get_output_tensors.In("TENSORS");
+    hand_index >> get_output_tensors.In("INDEX");
+
+    auto& get_letterbox_padding =
+        graph.AddNode("GetLetterboxPaddingVectorItemCalculator");
+    begin_loop_hand_indices.Out("CLONE")[1] >>
+        get_letterbox_padding.In("VECTOR");
+    hand_index >> get_letterbox_padding.In("INDEX");
+
+    auto& get_hand_rect =
+        graph.AddNode("GetNormalizedRectVectorItemCalculator");
+    begin_loop_hand_indices.Out("CLONE")[2] >> get_hand_rect.In("VECTOR");
+    hand_index >> get_hand_rect.In("INDEX");
+
+    return CollectHandLandmarks(
+        batch_end,
+        DecodeHandLandmarks(
+            subgraph_options, image_tensor_specs,
+            get_output_tensors[Output<std::vector<Tensor>>("TENSORS")],
+            get_letterbox_padding[Output<std::array<float, 4>>("ITEM")],
+            begin_loop_hand_indices.Out("CLONE")[3]
+                .Cast<std::pair<int, int>>(),
+            get_hand_rect[Output<NormalizedRect>("ITEM")], graph),
+        graph);
+  }
 
+  // Collects the outputs of all loop iterations into vectors.
+  HandLandmarkerOutputs CollectHandLandmarks(
+      Source<> batch_end, SingleHandLandmarkerOutputs hand_outputs,
+      Graph& graph) {
     auto& end_loop_handedness =
         graph.AddNode("EndLoopClassificationListCalculator");
     batch_end >> end_loop_handedness.In("BATCH_END");
-    handedness >> end_loop_handedness.In("ITEM");
+    hand_outputs.handedness >> end_loop_handedness.In("ITEM");
     auto handednesses =
         end_loop_handedness[Output<std::vector<ClassificationList>>(
             "ITERABLE")];
 
     auto& end_loop_presence = graph.AddNode("EndLoopBooleanCalculator");
     batch_end >> end_loop_presence.In("BATCH_END");
-    presence >> end_loop_presence.In("ITEM");
+    hand_outputs.hand_presence >> end_loop_presence.In("ITEM");
     auto presences = end_loop_presence[Output<std::vector<bool>>("ITERABLE")];
 
     auto& end_loop_presence_score = graph.AddNode("EndLoopFloatCalculator");
     batch_end >> end_loop_presence_score.In("BATCH_END");
-    presence_score >> end_loop_presence_score.In("ITEM");
+    hand_outputs.hand_presence_score >> end_loop_presence_score.In("ITEM");
     auto presence_scores =
         end_loop_presence_score[Output<std::vector<float>>("ITERABLE")];
 
     auto& end_loop_landmarks =
         graph.AddNode("EndLoopNormalizedLandmarkListVectorCalculator");
     batch_end >> end_loop_landmarks.In("BATCH_END");
-    landmarks >> end_loop_landmarks.In("ITEM");
+    hand_outputs.hand_landmarks >> end_loop_landmarks.In("ITEM");
     auto landmark_lists =
         end_loop_landmarks[Output<std::vector<NormalizedLandmarkList>>(
             "ITERABLE")];
@@ -544,26 +675,26 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
     auto& end_loop_world_landmarks =
         graph.AddNode("EndLoopLandmarkListVectorCalculator");
     batch_end >> end_loop_world_landmarks.In("BATCH_END");
-    world_landmarks >> end_loop_world_landmarks.In("ITEM");
+    hand_outputs.world_hand_landmarks >> end_loop_world_landmarks.In("ITEM");
     auto world_landmark_lists =
         end_loop_world_landmarks[Output<std::vector<LandmarkList>>("ITERABLE")];
 
     auto& end_loop_rects_next_frame =
         graph.AddNode("EndLoopNormalizedRectCalculator");
     batch_end >> end_loop_rects_next_frame.In("BATCH_END");
-    hand_rect_next_frame >> end_loop_rects_next_frame.In("ITEM");
+    hand_outputs.hand_rect_next_frame >> end_loop_rects_next_frame.In("ITEM");
     auto hand_rects_next_frame =
         end_loop_rects_next_frame[Output<std::vector<NormalizedRect>>(
             "ITERABLE")];
 
-    return {{
+    return {
         /* landmark_lists= */ landmark_lists,
         /*  world_landmark_lists= */ world_landmark_lists,
         /* hand_rects_next_frame= */ hand_rects_next_frame,
         /* presences= */ presences,
         /* presence_scores= */ presence_scores,
         /* handednesses= */ handednesses,
-    }};
+    };
   }
 };
 
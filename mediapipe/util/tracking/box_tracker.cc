@@ -17,7 +17,9 @@
 #include <sys/stat.h>
 
 #include <fstream>
+#include <functional>
 #include <limits>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
@@ -230,19 +232,53 @@ TimedBoxProto TimedBox::ToProto() const {
 }
 
 BoxTracker::BoxTracker(const std::string& cache_dir,
-                       const BoxTrackerOptions& options)
-    : options_(options), cache_dir_(cache_dir) {
-  tracking_workers_.reset(new ThreadPool(options_.num_tracking_workers()));
-  tracking_workers_->StartWorkers();
+                       const BoxTrackerOptions& options,
+                       ParallelInvokerExecutor* executor)
+    : options_(options), cache_dir_(cache_dir), executor_(executor) {
+  if (executor_ == nullptr) {
+    tracking_workers_.reset(new ThreadPool(options_.num_tracking_workers()));
+    tracking_workers_->StartWorkers();
+  }
 }
 
 BoxTracker::BoxTracker(
     const std::vector<const TrackingDataChunk*>& tracking_data, bool copy_data,
-    const BoxTrackerOptions& options)
-    : BoxTracker("", options) {
+    const BoxTrackerOptions& options, ParallelInvokerExecutor* executor)
+    : BoxTracker("", options, executor) {
   AddTrackingDataChunks(tracking_data, copy_data);
 }
 
+BoxTracker::~BoxTracker() {
+  // Joins the workers, if any.
+  tracking_workers_.reset();
+  absl::MutexLock lock(&pending_tasks_->mutex);
+  pending_tasks_->mutex.Await(absl::Condition(
+      +[](PendingTasks* pending_tasks) { return pending_tasks->count == 0; },
+      pending_tasks_.get()));
+}
+
+void BoxTracker::ScheduleTask(std::function<void()> task) {
+  if (executor_ == nullptr) {
+    tracking_workers_->Schedule(std::move(task));
+    return;
+  }
+  {
+    absl::MutexLock lock(&pending_tasks_->mutex);
+    ++pending_tasks_->count;
+  }
+  executor_->executor()->Schedule([executor = executor_,
+                                   pending_tasks = pending_tasks_,
+                                   task = std::move(task)]() {
+    {
+      // Parallel loops within tracking run on the same executor.
+      ScopedParallelInvokerExecutor scoped_executor(executor);
+      task();
+    }
+    absl::MutexLock lock(&pending_tasks->mutex);
+    --pending_tasks->count;
+  });
+}
+
 void BoxTracker::AddTrackingDataChunk(const TrackingDataChunk* chunk,
                                       bool copy_data) {
   CHECK_GT(chunk->item_size(), 0) << "Empty chunk.";
@@ -287,7 +323,7 @@ void BoxTracker::NewBoxTrack(const TimedBox& initial_pos, int id,
     this->NewBoxTrackAsync(initial_pos, id, min_msec, max_msec);
   };
 
-  tracking_workers_->Schedule(operation);
+  ScheduleTask(operation);
 }
 
 std::pair<int64_t, int64_t> BoxTracker::TrackInterval(int id) {
@@ -390,7 +426,7 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
                                         min_msec, max_msec));
   };
 
-  tracking_workers_->Schedule(forward_operation);
+  ScheduleTask(forward_operation);
 
   // Track backward.
   auto backward_operation = [this, backward_chunk, start_state, start_frame,
@@ -400,7 +436,7 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
                                         false, true, min_msec, max_msec));
   };
 
-  tracking_workers_->Schedule(backward_operation);
+  ScheduleTask(backward_operation);
 
   DoneSchedulingId(id);
 
@@ -17,7 +17,9 @@
 
 #include <inttypes.h>
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +28,7 @@
 #include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/util/tracking/box_tracker.pb.h"
 #include "mediapipe/util/tracking/flow_packager.pb.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/tracking.h"
 #include "mediapipe/util/tracking/tracking.pb.h"
 
@@ -131,14 +134,24 @@ class BoxTracker {
  public:
   // Initializes a new BoxTracker to work on cached TrackingData from a chunk
   // directory.
-  BoxTracker(const std::string& cache_dir, const BoxTrackerOptions& options);
+  // If executor is not null, tracking runs on it instead of on
+  // options.num_tracking_workers() threads owned by the BoxTracker; it must
+  // outlive the BoxTracker. CancelAllOngoingTracks and WaitForAllOngoingTracks
+  // block until tracking tasks finish, so they must not be called from the
+  // only thread of the executor.
+  BoxTracker(const std::string& cache_dir, const BoxTrackerOptions& options,
+             ParallelInvokerExecutor* executor = nullptr);
 
   // Initializes a new BoxTracker to work on the passed TrackingDataChunks.
   // If copy_data is true, BoxTracker will retain its own copy of the data;
   // otherwise the passed pointer need to be valid for the lifetime of the
   // BoxTracker.
   BoxTracker(const std::vector<const TrackingDataChunk*>& tracking_data,
-             bool copy_data, const BoxTrackerOptions& options);
+             bool copy_data, const BoxTrackerOptions& options,
+             ParallelInvokerExecutor* executor = nullptr);
+
+  // Waits for scheduled tracking tasks to finish.
+  ~BoxTracker();
 
   // Add single TrackingDataChunk. This chunk must be correctly aligned with
   // existing chunks. If chunk starting timestamp is larger than next valid
@@ -364,8 +377,21 @@ class BoxTracker {
   // Buffer for tracking data in case we retain a deep copy.
   std::vector<std::unique_ptr<TrackingDataChunk>> tracking_data_buffer_;
 
-  // Workers that run the tracking algorithm.
+  // Schedules task on executor_, or on tracking_workers_ if it is null.
+  void ScheduleTask(std::function<void()> task);
+
+  // Workers that run the tracking algorithm, unless executor_ is set.
   std::unique_ptr<ThreadPool> tracking_workers_;
+  ParallelInvokerExecutor* executor_ = nullptr;
+
+  // Tasks scheduled on executor_ that did not finish yet. Shared with the
+  // tasks, which may still release the mutex after the destructor returns.
+  struct PendingTasks {
+    absl::Mutex mutex;
+    int count ABSL_GUARDED_BY(mutex) = 0;
+  };
+  std::shared_ptr<PendingTasks> pending_tasks_ =
+      std::make_shared<PendingTasks>();
 };
 
 }  // namespace mediapipe
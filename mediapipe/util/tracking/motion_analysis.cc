@@ -19,6 +19,7 @@
 #include <cstring>
 #include <deque>
 #include <memory>
+#include <utility>
 
 #include "absl/strings/str_format.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -38,7 +39,8 @@
 namespace mediapipe {
 
 MotionAnalysis::MotionAnalysis(const MotionAnalysisOptions& options,
-                               int frame_width, int frame_height)
+                               int frame_width, int frame_height,
+                               ParallelInvokerExecutor* executor)
     : options_(options),
       frame_width_(frame_width),
       frame_height_(frame_height) {
@@ -114,6 +116,24 @@ MotionAnalysis::MotionAnalysis(const MotionAnalysisOptions& options,
   buffer_.reset(new StreamingBuffer(
       options_.compute_motion_saliency() ? data_config_saliency : data_config,
       2 * overlap_size_));
+
+  if (executor != nullptr && options_.estimation_lookahead_clips() > 0) {
+    pipeline_ = std::make_shared<Pipeline>(executor);
+  }
+}
+
+MotionAnalysis::~MotionAnalysis() {
+  if (pipeline_ == nullptr) {
+    return;
+  }
+  absl::MutexLock lock(&pipeline_->mutex);
+  // Jobs that did not start are dropped.
+  pipeline_->stopped = true;
+  pipeline_->mutex.Await(absl::Condition(
+      +[](Pipeline* pipeline) {
+        return pipeline->num_scheduled_tasks == 0 && !pipeline->job_running;
+      },
+      pipeline_.get()));
 }
 
 void MotionAnalysis::InitPolicyOptions() {
@@ -439,7 +459,7 @@ bool MotionAnalysis::AddFrameGeneric(
     (*modify_features)(feature_list.get());
   }
 
-  buffer_->EmplaceDatum("features", feature_list.release());
+  AddFeatureList(std::move(feature_list));
 
   // Store frame for next call.
   if (compute_feature_descriptors_) {
@@ -453,13 +473,24 @@ bool MotionAnalysis::AddFrameGeneric(
 
 void MotionAnalysis::AddFeatures(const RegionFlowFeatureList& features) {
   feature_computation_ = false;
-  buffer_->EmplaceDatum("features", new RegionFlowFeatureList(features));
+  AddFeatureList(std::make_unique<RegionFlowFeatureList>(features));
 
   ++frame_num_;
 }
 
+void MotionAnalysis::AddFeatureList(
+    std::unique_ptr<RegionFlowFeatureList> feature_list) {
+  if (pipeline_ != nullptr) {
+    pending_features_.push_back(std::move(feature_list));
+  } else {
+    buffer_->EmplaceDatum("features", feature_list.release());
+  }
+}
+
 void MotionAnalysis::EnqueueFeaturesAndMotions(
     const RegionFlowFeatureList& features, const CameraMotion& motion) {
+  CHECK(pipeline_ == nullptr)
+      << "Can not be used with estimation_lookahead_clips";
   feature_computation_ = false;
   CHECK(buffer_->HaveEqualSize({"motion", "features"}))
       << "Can not be mixed with other Add* calls";
@@ -477,6 +508,122 @@ int MotionAnalysis::GetResults(
     std::vector<std::unique_ptr<SalientPointFrame>>* saliency) {
   MEASURE_TIME << "GetResults";
 
+  if (pipeline_ != nullptr) {
+    return GetPipelinedResults(flush, features, camera_motion, saliency);
+  }
+  return ComputeResults(flush, features, camera_motion, saliency);
+}
+
+int MotionAnalysis::GetPipelinedResults(
+    bool flush, std::vector<std::unique_ptr<RegionFlowFeatureList>>* features,
+    std::vector<std::unique_ptr<CameraMotion>>* camera_motion,
+    std::vector<std::unique_ptr<SalientPointFrame>>* saliency) {
+  const bool compute_saliency = options_.compute_motion_saliency();
+  CHECK_EQ(compute_saliency, saliency != nullptr)
+      << "Computing saliency requires saliency output and vice versa";
+
+  // Hand buffered features to a new job at the same points at which
+  // ComputeResults would estimate their motions, so that results match.
+  if (flush || static_cast<int>(pending_features_.size()) >=
+                   options_.estimation_clip_size()) {
+    auto job = std::make_unique<EstimationJob>();
+    job->new_features = std::move(pending_features_);
+    pending_features_.clear();
+    job->flush = flush;
+    {
+      absl::MutexLock lock(&pipeline_->mutex);
+      pipeline_->jobs.push_back(std::move(job));
+      ++pipeline_->num_scheduled_tasks;
+    }
+    pipeline_->executor->executor()->Schedule([this, pipeline = pipeline_]() {
+      {
+        ScopedParallelInvokerExecutor scoped_executor(pipeline->executor);
+        RunEstimationJobs(nullptr);
+      }
+      absl::MutexLock lock(&pipeline->mutex);
+      --pipeline->num_scheduled_tasks;
+    });
+  }
+
+  // Bound the number of clips ahead of motion estimation.
+  const int max_unfinished_jobs =
+      flush ? 0 : options_.estimation_lookahead_clips();
+  const EstimationJob* wait_job = nullptr;
+  {
+    absl::MutexLock lock(&pipeline_->mutex);
+    const int num_jobs = pipeline_->jobs.size();
+    if (num_jobs > max_unfinished_jobs) {
+      wait_job = pipeline_->jobs[num_jobs - 1 - max_unfinished_jobs].get();
+    }
+  }
+  if (wait_job != nullptr) {
+    // Runs the jobs on this thread if the executor did not start them yet.
+    RunEstimationJobs(wait_job);
+    absl::MutexLock lock(&pipeline_->mutex);
+    pipeline_->mutex.Await(absl::Condition(&wait_job->done));
+  }
+
+  // Output the results of finished jobs, in order.
+  int num_results = 0;
+  absl::MutexLock lock(&pipeline_->mutex);
+  while (!pipeline_->jobs.empty() && pipeline_->jobs.front()->done) {
+    std::unique_ptr<EstimationJob> job = std::move(pipeline_->jobs.front());
+    pipeline_->jobs.pop_front();
+    num_results += job->num_results;
+    for (int k = 0; k < job->num_results; ++k) {
+      if (features != nullptr) {
+        features->push_back(std::move(job->features[k]));
+      }
+      if (camera_motion != nullptr) {
+        camera_motion->push_back(std::move(job->camera_motion[k]));
+      }
+      if (saliency != nullptr) {
+        saliency->push_back(std::move(job->saliency[k]));
+      }
+    }
+  }
+  return num_results;
+}
+
+void MotionAnalysis::RunEstimationJobs(const EstimationJob* last_job) {
+  Pipeline* pipeline = pipeline_.get();
+  absl::MutexLock lock(&pipeline->mutex);
+  while (!pipeline->job_running && !pipeline->stopped) {
+    EstimationJob* job = nullptr;
+    for (const auto& pending_job : pipeline->jobs) {
+      if (!pending_job->started) {
+        job = pending_job.get();
+        break;
+      }
+    }
+    if (job == nullptr) {
+      return;
+    }
+    job->started = true;
+    pipeline->job_running = true;
+
+    pipeline->mutex.Unlock();
+    for (auto& feature_list : job->new_features) {
+      buffer_->EmplaceDatum("features", feature_list.release());
+    }
+    job->new_features.clear();
+    job->num_results = ComputeResults(
+        job->flush, &job->features, &job->camera_motion,
+        options_.compute_motion_saliency() ? &job->saliency : nullptr);
+    pipeline->mutex.Lock();
+
+    job->done = true;
+    pipeline->job_running = false;
+    if (job == last_job) {
+      return;
+    }
+  }
+}
+
+int MotionAnalysis::ComputeResults(
+    bool flush, std::vector<std::unique_ptr<RegionFlowFeatureList>>* features,
+    std::vector<std::unique_ptr<CameraMotion>>* camera_motion,
+    std::vector<std::unique_ptr<SalientPointFrame>>* saliency) {
   const int num_features_lists = buffer_->BufferSize("features");
   const int num_new_feature_lists = num_features_lists - overlap_start_;
   CHECK_GE(num_new_feature_lists, 0);
@@ -54,16 +54,20 @@
 #ifndef MEDIAPIPE_UTIL_TRACKING_MOTION_ANALYSIS_H_
 #define MEDIAPIPE_UTIL_TRACKING_MOTION_ANALYSIS_H_
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/util/tracking/camera_motion.pb.h"
 #include "mediapipe/util/tracking/motion_analysis.pb.h"
 #include "mediapipe/util/tracking/motion_estimation.h"
 #include "mediapipe/util/tracking/motion_estimation.pb.h"
 #include "mediapipe/util/tracking/motion_saliency.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/push_pull_filtering.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
@@ -76,9 +80,13 @@ typedef PushPullFiltering<1, FilterWeightMultiplierOne> PushPullFlowC1;
 
 class MotionAnalysis {
  public:
+  // If executor is not null and options.estimation_lookahead_clips() is
+  // positive, motion estimation of complete clips runs on executor, pipelined
+  // with AddFrame*. The executor must outlive this object.
   MotionAnalysis(const MotionAnalysisOptions& options, int frame_width,
-                 int frame_height);
-  ~MotionAnalysis() = default;
+                 int frame_height, ParallelInvokerExecutor* executor = nullptr);
+  // Waits for pipelined motion estimation to finish.
+  ~MotionAnalysis();
   MotionAnalysis(const MotionAnalysis&) = delete;
   MotionAnalysis& operator=(const MotionAnalysis&) = delete;
 
@@ -119,7 +127,7 @@ class MotionAnalysis {
 
   // Instead of tracking and computing camera motions, simply adds precomputed
   // features and camera motions to the internal buffers. Can not be mixed
-  // with above Add* calls.
+  // with above Add* calls, nor used with estimation_lookahead_clips.
   // This is useful for just computing saliency via GetResults.
   void EnqueueFeaturesAndMotions(const RegionFlowFeatureList& features,
                                  const CameraMotion& motion);
@@ -177,8 +185,62 @@ class MotionAnalysis {
   int NumFrames() const { return frame_num_; }
 
  private:
+  // Motion estimation, saliency and output of one clip, run by the pipeline.
+  struct EstimationJob {
+    // Features added since the previous job.
+    std::vector<std::unique_ptr<RegionFlowFeatureList>> new_features;
+    bool flush = false;
+
+    int num_results = 0;
+    std::vector<std::unique_ptr<RegionFlowFeatureList>> features;
+    std::vector<std::unique_ptr<CameraMotion>> camera_motion;
+    std::vector<std::unique_ptr<SalientPointFrame>> saliency;
+
+    bool started = false;
+    bool done = false;
+  };
+
+  // State of the pipelined motion estimation. Shared with the tasks scheduled
+  // on the executor, which may still release the mutex after the destructor
+  // returns.
+  struct Pipeline {
+    explicit Pipeline(ParallelInvokerExecutor* executor) : executor(executor) {}
+
+    ParallelInvokerExecutor* const executor;
+    absl::Mutex mutex;
+    // Jobs whose results were not returned yet, in order. Jobs run one at a
+    // time, in order, as they all modify buffer_.
+    std::deque<std::unique_ptr<EstimationJob>> jobs ABSL_GUARDED_BY(mutex);
+    bool job_running ABSL_GUARDED_BY(mutex) = false;
+    bool stopped ABSL_GUARDED_BY(mutex) = false;
+    int num_scheduled_tasks ABSL_GUARDED_BY(mutex) = 0;
+  };
+
   void InitPolicyOptions();
 
+  // Buffers a feature list computed or added for the next frame.
+  void AddFeatureList(std::unique_ptr<RegionFlowFeatureList> feature_list);
+
+  // Estimates motions and saliency for buffered features, once a clip is
+  // complete or if flush is set, and outputs results. Implements GetResults
+  // without pipelining.
+  int ComputeResults(
+      bool flush,  // Forces output.
+      std::vector<std::unique_ptr<RegionFlowFeatureList>>* features,
+      std::vector<std::unique_ptr<CameraMotion>>* camera_motion,
+      std::vector<std::unique_ptr<SalientPointFrame>>* saliency);
+
+  // Implements GetResults with pipelining.
+  int GetPipelinedResults(
+      bool flush,  // Forces output.
+      std::vector<std::unique_ptr<RegionFlowFeatureList>>* features,
+      std::vector<std::unique_ptr<CameraMotion>>* camera_motion,
+      std::vector<std::unique_ptr<SalientPointFrame>>* saliency);
+
+  // Runs jobs that were not started yet, in order, up to and including
+  // last_job, unless another thread is running a job.
+  void RunEstimationJobs(const EstimationJob* last_job);
+
   // Compute saliency from buffered features and motions.
   void ComputeSaliency();
 
@@ -222,6 +284,11 @@ class MotionAnalysis {
   int overlap_size_ = 0;
 
   bool feature_computation_ = true;
+
+  // Set if motion estimation is pipelined.
+  std::shared_ptr<Pipeline> pipeline_;
+  // Features of the clip being computed by AddFrame*, when pipelined.
+  std::vector<std::unique_ptr<RegionFlowFeatureList>> pending_features_;
 };
 
 }  // namespace mediapipe
@@ -0,0 +1,113 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/motion_analysis.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/tracking/camera_motion.pb.h"
+#include "mediapipe/util/tracking/motion_analysis.pb.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 30;
+constexpr int kBorder = 20;
+
+struct MotionAnalysisResults {
+  std::vector<std::unique_ptr<RegionFlowFeatureList>> features;
+  std::vector<std::unique_ptr<CameraMotion>> camera_motions;
+  std::vector<std::unique_ptr<SalientPointFrame>> saliency;
+};
+
+// Creates a movie by displacing the test image to random positions.
+std::vector<cv::Mat> MakeMovie() {
+  std::string png_data;
+  MEDIAPIPE_CHECK_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/",
+                     "stabilize_test.png"),
+      &png_data));
+  std::vector<char> buffer(png_data.begin(), png_data.end());
+  const cv::Mat image = cv::imdecode(cv::Mat(buffer), 1);
+  CHECK(!image.empty());
+
+  std::mt19937 random(/*seed=*/900913);
+  std::uniform_int_distribution<> uniform_dist(-5, 5);
+  std::vector<cv::Mat> movie(kNumFrames);
+  int x = kBorder;
+  int y = kBorder;
+  for (int f = 0; f < kNumFrames; ++f) {
+    x = std::clamp(x + uniform_dist(random), 0, 2 * kBorder);
+    y = std::clamp(y + uniform_dist(random), 0, 2 * kBorder);
+    image(cv::Rect(x, y, image.cols - 2 * kBorder, image.rows - 2 * kBorder))
+        .copyTo(movie[f]);
+  }
+  return movie;
+}
+
+MotionAnalysisResults RunMotionAnalysis(const MotionAnalysisOptions& options,
+                                        const std::vector<cv::Mat>& movie,
+                                        ParallelInvokerExecutor* executor) {
+  MotionAnalysis motion_analysis(options, movie[0].cols, movie[0].rows,
+                                 executor);
+  MotionAnalysisResults results;
+  for (int f = 0; f < movie.size(); ++f) {
+    EXPECT_TRUE(motion_analysis.AddFrame(movie[f], f * 33333));
+    motion_analysis.GetResults(f + 1 == movie.size(), &results.features,
+                               &results.camera_motions, &results.saliency);
+  }
+  return results;
+}
+
+TEST(MotionAnalysisTest, PipelinedEstimationMatchesSequential) {
+  const std::vector<cv::Mat> movie = MakeMovie();
+  MotionAnalysisOptions options;
+  options.set_estimation_clip_size(4);
+  options.set_compute_motion_saliency(true);
+  options.mutable_flow_options()->set_image_format(
+      RegionFlowComputationOptions::FORMAT_RGB);
+  const MotionAnalysisResults expected =
+      RunMotionAnalysis(options, movie, /*executor=*/nullptr);
+  ASSERT_EQ(expected.camera_motions.size(), kNumFrames);
+
+  ParallelInvokerExecutor executor(/*num_threads=*/2);
+  for (int lookahead_clips : {1, 3}) {
+    options.set_estimation_lookahead_clips(lookahead_clips);
+    const MotionAnalysisResults results =
+        RunMotionAnalysis(options, movie, &executor);
+    ASSERT_EQ(results.camera_motions.size(), kNumFrames);
+    for (int f = 0; f < kNumFrames; ++f) {
+      EXPECT_THAT(*results.features[f], EqualsProto(*expected.features[f]));
+      EXPECT_THAT(*results.camera_motions[f],
+                  EqualsProto(*expected.camera_motions[f]));
+      EXPECT_THAT(*results.saliency[f], EqualsProto(*expected.saliency[f]));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
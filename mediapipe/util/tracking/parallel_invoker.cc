@@ -14,6 +14,14 @@
 
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
+#include <atomic>
+#include <utility>
+
+#include "mediapipe/framework/mediapipe_options.pb.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/util/cpu_util.h"
+
 // Choose between ThreadPool, OpenMP and serial execution.
 // Note only one parallel_using_* directive can be active.
 int flags_parallel_invoker_mode = PARALLEL_INVOKER_MAX_VALUE;
@@ -33,4 +41,134 @@ ThreadPool* ParallelInvokerThreadPool() {
 }
 #endif
 
+namespace {
+
+// A loop needs at most this many chunks per thread to balance the load.
+constexpr int kChunksPerThread = 4;
+
+// The executor bound by ScopedParallelInvokerExecutor, if any.
+thread_local ParallelInvokerExecutor* current_executor = nullptr;
+
+#if defined(PARALLEL_INVOKER_ACTIVE)
+// Runs tasks on the ParallelInvokerThreadPool().
+class ParallelInvokerThreadPoolExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    ParallelInvokerThreadPool()->Schedule(std::move(task));
+  }
+};
+#endif  // PARALLEL_INVOKER_ACTIVE
+
+// A loop run by ParallelInvokerExecutor::Run(). It is shared with the tasks
+// scheduled on the executor, which may start after Run() has returned.
+struct ParallelLoop {
+  ParallelLoop(int num_chunks, const std::function<void(int)>* run_chunk)
+      : num_chunks(num_chunks), run_chunk(run_chunk) {}
+
+  const int num_chunks;
+  // Only called while some chunks are not finished, i.e. while Run() waits.
+  const std::function<void(int)>* const run_chunk;
+  std::atomic<int> next_chunk{0};
+
+  absl::Mutex mutex;
+  int num_finished_chunks ABSL_GUARDED_BY(mutex) = 0;
+};
+
+// Runs chunks of "loop" until all are claimed.
+void RunChunks(ParallelLoop* loop) {
+  int num_finished_chunks = 0;
+  for (int chunk = loop->next_chunk.fetch_add(1); chunk < loop->num_chunks;
+       chunk = loop->next_chunk.fetch_add(1)) {
+    (*loop->run_chunk)(chunk);
+    ++num_finished_chunks;
+  }
+  if (num_finished_chunks > 0) {
+    absl::MutexLock lock(&loop->mutex);
+    loop->num_finished_chunks += num_finished_chunks;
+  }
+}
+
+}  // namespace
+
+ParallelInvokerExecutor::ParallelInvokerExecutor(Executor* executor,
+                                                 int num_threads)
+    : executor_(executor), num_threads_(num_threads) {
+  CHECK(executor_ != nullptr);
+  CHECK_GT(num_threads_, 0);
+}
+
+ParallelInvokerExecutor::ParallelInvokerExecutor(int num_threads)
+    : num_threads_(num_threads) {
+  CHECK_GT(num_threads_, 0);
+  MediaPipeOptions options;
+  auto* pool_options = options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  pool_options->set_num_threads(num_threads_);
+  pool_options->set_queue_type(ThreadPoolExecutorOptions::WORK_STEALING);
+  pool_options->set_thread_name_prefix("ParallelInvoker");
+  auto executor = ThreadPoolExecutor::Create(options);
+  CHECK_OK(executor.status());
+  owned_executor_.reset(*executor);
+  executor_ = owned_executor_.get();
+}
+
+ParallelInvokerExecutor::~ParallelInvokerExecutor() = default;
+
+std::shared_ptr<ParallelInvokerExecutor> ParallelInvokerExecutor::Create() {
+  return std::make_shared<ParallelInvokerExecutor>(NumCPUCores());
+}
+
+ParallelInvokerExecutor* ParallelInvokerExecutor::Current() {
+  if (current_executor != nullptr) {
+    return current_executor;
+  }
+#if defined(PARALLEL_INVOKER_ACTIVE)
+  static ParallelInvokerExecutor* process_executor =
+      new ParallelInvokerExecutor(new ParallelInvokerThreadPoolExecutor(),
+                                  flags_parallel_invoker_max_threads);
+  return process_executor;
+#else
+  LOG(FATAL) << "Parallel execution requires PARALLEL_INVOKER_ACTIVE.";
+  return nullptr;
+#endif  // PARALLEL_INVOKER_ACTIVE
+}
+
+size_t ParallelInvokerExecutor::ChunkSize(size_t num_items,
+                                          size_t min_chunk_size) const {
+  // The calling thread runs chunks as well.
+  const size_t max_num_chunks = kChunksPerThread * (num_threads_ + 1);
+  return std::max<size_t>(
+      {min_chunk_size, (num_items + max_num_chunks - 1) / max_num_chunks, 1});
+}
+
+void ParallelInvokerExecutor::Run(int num_chunks,
+                                  const std::function<void(int)>& run_chunk) {
+  auto loop = std::make_shared<ParallelLoop>(num_chunks, &run_chunk);
+  // The calling thread takes one chunk.
+  const int num_tasks = std::min(num_threads_, num_chunks - 1);
+  for (int i = 0; i < num_tasks; ++i) {
+    executor_->Schedule([this, loop]() {
+      ScopedParallelInvokerExecutor scoped_executor(this);
+      RunChunks(loop.get());
+    });
+  }
+  RunChunks(loop.get());
+
+  absl::MutexLock lock(&loop->mutex);
+  loop->mutex.Await(absl::Condition(
+      +[](ParallelLoop* loop) {
+        return loop->num_finished_chunks == loop->num_chunks;
+      },
+      loop.get()));
+}
+
+ScopedParallelInvokerExecutor::ScopedParallelInvokerExecutor(
+    ParallelInvokerExecutor* executor)
+    : previous_(current_executor) {
+  current_executor = executor;
+}
+
+ScopedParallelInvokerExecutor::~ScopedParallelInvokerExecutor() {
+  current_executor = previous_;
+}
+
 }  // namespace mediapipe
@@ -69,9 +69,12 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/logging.h"
 
 #ifdef PARALLEL_INVOKER_ACTIVE
@@ -135,6 +138,65 @@ class BlockedRange2D {
   BlockedRange cols_;
 };
 
+// Runs the loops of ParallelFor and ParallelFor2D in
+// PARALLEL_INVOKER_THREAD_POOL mode on an Executor.
+//
+// A loop is split into chunks that are claimed in order by the thread calling
+// ParallelFor and by tasks scheduled on the executor. The calling thread only
+// waits for chunks that other threads have started, so loops may be nested
+// and may run on an executor whose threads are all busy, e.g. the executor of
+// the graph running the calculator that calls ParallelFor.
+class ParallelInvokerExecutor {
+ public:
+  // Runs loops on "executor", which has "num_threads" threads and must
+  // outlive this object.
+  ParallelInvokerExecutor(Executor* executor, int num_threads);
+  // Runs loops on a work-stealing thread pool of "num_threads" threads owned
+  // by this object.
+  explicit ParallelInvokerExecutor(int num_threads);
+  ~ParallelInvokerExecutor();
+
+  // Creates an executor with one thread per CPU core. Used to initialize
+  // kParallelInvokerExecutorService.
+  static std::shared_ptr<ParallelInvokerExecutor> Create();
+
+  // Returns the executor bound to the calling thread with
+  // ScopedParallelInvokerExecutor, or else a process-wide executor with
+  // flags_parallel_invoker_max_threads threads.
+  static ParallelInvokerExecutor* Current();
+
+  Executor* executor() const { return executor_; }
+  int num_threads() const { return num_threads_; }
+
+  // Returns the number of items per chunk for a loop over "num_items" items
+  // with at least "min_chunk_size" items per chunk. Chunks are made large
+  // enough to amortize scheduling, while leaving a few chunks per thread to
+  // balance the load.
+  size_t ChunkSize(size_t num_items, size_t min_chunk_size) const;
+
+  // Calls "run_chunk" with each chunk index in [0, num_chunks), concurrently,
+  // and returns once all calls have returned. Loops started by "run_chunk" run
+  // on this executor as well.
+  void Run(int num_chunks, const std::function<void(int)>& run_chunk);
+
+ private:
+  std::unique_ptr<Executor> owned_executor_;
+  Executor* executor_;
+  const int num_threads_;
+};
+
+// Binds "executor" to the calling thread while in scope, so that ParallelFor
+// and ParallelFor2D run their loops on it. A null "executor" restores the
+// process-wide executor.
+class ScopedParallelInvokerExecutor {
+ public:
+  explicit ScopedParallelInvokerExecutor(ParallelInvokerExecutor* executor);
+  ~ScopedParallelInvokerExecutor();
+
+ private:
+  ParallelInvokerExecutor* const previous_;
+};
+
 #ifdef PARALLEL_INVOKER_ACTIVE
 
 // Singleton ThreadPool for parallel invoker.
@@ -321,50 +383,22 @@ void ParallelFor(size_t start, size_t end, size_t grain_size,
 #endif  // __APPLE__
 
     case PARALLEL_INVOKER_THREAD_POOL: {
-      int iterations_remain = (end - start + grain_size - 1) / grain_size;
-      CHECK_GT(iterations_remain, 0);
-      if (iterations_remain == 1) {
+      ParallelInvokerExecutor* executor = ParallelInvokerExecutor::Current();
+      const size_t chunk_size = executor->ChunkSize(end - start, grain_size);
+      const int num_chunks = (end - start + chunk_size - 1) / chunk_size;
+      CHECK_GT(num_chunks, 0);
+      if (num_chunks == 1) {
         // Execute invoker serially.
-        invoker(BlockedRange(start, std::min(end, start + grain_size), 1));
+        invoker(BlockedRange(start, end, 1));
         break;
       }
 
-      struct {
-        absl::Mutex mutex;
-        absl::CondVar completed;
-        int iterations_remain ABSL_GUARDED_BY(mutex);
-      } loop;
-      {
-        absl::MutexLock lock(&loop.mutex);
-        loop.iterations_remain = iterations_remain;
-      }
-
-      for (int x = start; x < end; x += grain_size) {
-        auto loop_func = [x, end, grain_size, &loop, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange(x, std::min(end, x + grain_size), 1));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop.mutex);
-          --loop.iterations_remain;
-          if (loop.iterations_remain == 0) {
-            loop.completed.SignalAll();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        // This can happen during nested invocation of ParallelFor, as if the
-        // loop iteration itself is calling ParallelFor we might deadlock if
-        // we can not guarantee for the iteration to be scheduled.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop.mutex.Lock();
-      while (loop.iterations_remain > 0) {
-        loop.completed.Wait(&loop.mutex);
-      }
-      loop.mutex.Unlock();
+      executor->Run(num_chunks, [start, end, chunk_size, &invoker](int chunk) {
+        // Use chunk-local copy of invoker, which may hold scratch space.
+        Invoker local_invoker(invoker);
+        const size_t x = start + chunk * chunk_size;
+        local_invoker(BlockedRange(x, std::min(end, x + chunk_size), 1));
+      });
       break;
     }
 
@@ -435,43 +469,28 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
 #endif  // __APPLE__
 
     case PARALLEL_INVOKER_THREAD_POOL: {
-      int iterations_remain = end_row - start_row;  // Guarded by loop_mutex
-      CHECK_GT(iterations_remain, 0);
-      if (iterations_remain == 1) {
+      ParallelInvokerExecutor* executor = ParallelInvokerExecutor::Current();
+      // Rows are split into chunks, columns are not.
+      const size_t chunk_size =
+          executor->ChunkSize(end_row - start_row, grain_size);
+      const int num_chunks = (end_row - start_row + chunk_size - 1) / chunk_size;
+      CHECK_GT(num_chunks, 0);
+      if (num_chunks == 1) {
         // Execute invoker serially.
         invoker(BlockedRange2D(BlockedRange(start_row, end_row, 1),
                                BlockedRange(start_col, end_col, 1)));
         break;
       }
 
-      absl::Mutex loop_mutex;
-      absl::CondVar loop_completed;
-
-      for (int y = start_row; y < end_row; ++y) {
-        auto loop_func = [y, start_col, end_col, &loop_mutex, &loop_completed,
-                          &iterations_remain, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange2D(BlockedRange(y, y + 1, 1),
-                                 BlockedRange(start_col, end_col, 1)));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop_mutex);
-          --iterations_remain;
-          if (iterations_remain == 0) {
-            loop_completed.Signal();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop_mutex.Lock();
-      while (iterations_remain > 0) {
-        loop_completed.Wait(&loop_mutex);
-      }
-      loop_mutex.Unlock();
+      executor->Run(num_chunks, [start_row, end_row, start_col, end_col,
+                                 chunk_size, &invoker](int chunk) {
+        // Use chunk-local copy of invoker, which may hold scratch space.
+        Invoker local_invoker(invoker);
+        const size_t y = start_row + chunk * chunk_size;
+        local_invoker(BlockedRange2D(
+            BlockedRange(y, std::min(end_row, y + chunk_size), 1),
+            BlockedRange(start_col, end_col, 1)));
+      });
       break;
     }
 
@@ -0,0 +1,35 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_PARALLEL_INVOKER_SERVICE_H_
+#define MEDIAPIPE_UTIL_TRACKING_PARALLEL_INVOKER_SERVICE_H_
+
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+
+namespace mediapipe {
+
+// Provides the ParallelInvokerExecutor that the tracking calculators of a graph
+// run their parallel loops and tasks on. Unless set with
+// CalculatorGraph::SetServiceObject, e.g. to a ParallelInvokerExecutor wrapping
+// the graph's own executor, a work-stealing pool with one thread per core is
+// created on demand and shared by all calculators of the graph.
+inline constexpr GraphService<ParallelInvokerExecutor>
+    kParallelInvokerExecutorService(
+        "ParallelInvokerExecutorService",
+        GraphServiceBase::kAllowDefaultInitialization);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_PARALLEL_INVOKER_SERVICE_H_
@@ -15,10 +15,15 @@
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/thread_pool_executor.h"
 
 namespace mediapipe {
 namespace {
@@ -56,5 +61,104 @@ TEST(ParallelInvokerTest, ThreadPoolTest) {
   RunParallelTest();
 }
 
+// Counts the tasks scheduled on a ThreadPoolExecutor.
+class CountingExecutor : public Executor {
+ public:
+  explicit CountingExecutor(int num_threads) : executor_(num_threads) {}
+
+  void Schedule(std::function<void()> task) override {
+    ++num_tasks_;
+    executor_.Schedule(std::move(task));
+  }
+
+  int num_tasks() const { return num_tasks_; }
+
+ private:
+  ThreadPoolExecutor executor_;
+  std::atomic<int> num_tasks_ = 0;
+};
+
+TEST(ParallelInvokerTest, RunsOnBoundExecutor) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  CountingExecutor executor(2);
+  ParallelInvokerExecutor parallel_invoker_executor(&executor, 2);
+  {
+    ScopedParallelInvokerExecutor scoped_executor(&parallel_invoker_executor);
+    RunParallelTest();
+  }
+  EXPECT_GT(executor.num_tasks(), 0);
+}
+
+TEST(ParallelInvokerTest, NestedLoopsOnBusyExecutor) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  CountingExecutor executor(1);
+  ParallelInvokerExecutor parallel_invoker_executor(&executor, 1);
+  std::atomic<int> sum = 0;
+  absl::Notification done;
+  // The only thread of the executor runs the outer loop, as a calculator on a
+  // single threaded graph executor would.
+  executor.Schedule([&]() {
+    ScopedParallelInvokerExecutor scoped_executor(&parallel_invoker_executor);
+    ParallelFor2D(0, 10, 0, 10, 1, [&sum](const BlockedRange2D& b) {
+      for (int y = b.rows().begin(); y < b.rows().end(); ++y) {
+        ParallelFor(b.cols().begin(), b.cols().end(), 1,
+                    [&sum, y](const BlockedRange& r) {
+                      for (int x = r.begin(); x < r.end(); ++x) {
+                        sum += y * 10 + x;
+                      }
+                    });
+      }
+    });
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(sum, 99 * 100 / 2);
+}
+
+// Invoker that uses a member as scratch space, like EstimateMotionIRLSInvoker,
+// and fails if two threads use the same instance at once.
+class ScratchInvoker {
+ public:
+  explicit ScratchInvoker(std::atomic<int>* num_overlaps)
+      : num_overlaps_(num_overlaps) {}
+  ScratchInvoker(const ScratchInvoker& that)
+      : num_overlaps_(that.num_overlaps_) {}
+
+  void operator()(const BlockedRange& b) const {
+    if (in_use_.exchange(true)) {
+      ++*num_overlaps_;
+    }
+    // Gives other chunks time to start while the scratch space is in use.
+    absl::SleepFor(absl::Milliseconds(1));
+    in_use_ = false;
+  }
+
+  void operator()(const BlockedRange2D& b) const { (*this)(b.rows()); }
+
+ private:
+  std::atomic<int>* num_overlaps_;
+  mutable std::atomic<bool> in_use_ = false;
+};
+
+TEST(ParallelInvokerTest, EachChunkCallsItsOwnInvoker) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  ThreadPoolExecutor executor(4);
+  ParallelInvokerExecutor parallel_invoker_executor(&executor, 4);
+  ScopedParallelInvokerExecutor scoped_executor(&parallel_invoker_executor);
+  std::atomic<int> num_overlaps = 0;
+  const ScratchInvoker invoker(&num_overlaps);
+  ParallelFor(0, 64, 1, invoker);
+  ParallelFor2D(0, 64, 0, 8, 1, invoker);
+  EXPECT_EQ(num_overlaps, 0);
+}
+
+TEST(ParallelInvokerTest, ChunkSizeLeavesFewChunksPerThread) {
+  CountingExecutor executor(3);
+  ParallelInvokerExecutor parallel_invoker_executor(&executor, 3);
+  EXPECT_EQ(parallel_invoker_executor.ChunkSize(8, 1), 1);
+  EXPECT_EQ(parallel_invoker_executor.ChunkSize(8, 4), 4);
+  EXPECT_EQ(parallel_invoker_executor.ChunkSize(1600, 1), 100);
+}
+
 }  // namespace
 }  // namespace mediapipe
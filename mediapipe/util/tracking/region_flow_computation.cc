@@ -128,9 +128,27 @@ void AllocatePyramid(int frame_width, int frame_height, cv::Mat* pyramid) {
 
 namespace {
 
-// lab_window is used as scratch space only, to avoid allocations.
+// Per-thread scratch space for GetPatchDescriptorAtPoint, to avoid allocations.
+// Holds one row of the window widened to int and running per-column sums of
+// the window's values, squares and products of values 1 and 2 columns apart.
+struct PatchDescriptorScratch {
+  Eigen::ArrayXi row;
+  Eigen::ArrayXi sums;
+  Eigen::ArrayXi squares;
+  Eigen::ArrayXi products_1;
+  Eigen::ArrayXi products_2;
+};
+
+// Returns the sum of every third element of values, starting at offset.
+int SumEveryThird(const Eigen::ArrayXi& values, int offset, int count) {
+  return Eigen::Map<const Eigen::ArrayXi, 0, Eigen::InnerStride<3>>(
+             values.data() + offset, count)
+      .sum();
+}
+
 void GetPatchDescriptorAtPoint(const cv::Mat& rgb_frame, const Vector2_i& pt,
-                               const int radius, cv::Mat* lab_window,
+                               const int radius,
+                               PatchDescriptorScratch* scratch,
                                PatchDescriptor* descriptor) {
   CHECK(descriptor);
   descriptor->clear_data();
@@ -139,22 +157,38 @@ void GetPatchDescriptorAtPoint(const cv::Mat& rgb_frame, const Vector2_i& pt,
   // covariance matrix.
   descriptor->mutable_data()->Reserve(3 + 6);
 
-  // Extract a window of the RGB frame for Lab color conversion. We know that at
-  // this point the window doesn't overlap with the frame boundary. The
-  // windowing operation just generates a reference and doesn't copy the values.
+  // Extract a window of the RGB frame. We know that at this point the window
+  // doesn't overlap with the frame boundary. The windowing operation just
+  // generates a reference and doesn't copy the values.
   const int diameter = 2 * radius + 1;
   const cv::Mat rgb_window =
       rgb_frame(cv::Rect(pt.x() - radius, pt.y() - radius, diameter, diameter));
 
-  // Compute channel sums and means.
-  int sum[3] = {0, 0, 0};
+  // Accumulate all sums and products in a single vectorized pass over the
+  // window rows. Interleaved pixels (r, g, b) start at multiples of 3, so
+  // squares at 3 * x + c hold channel c, products of neighbors at 3 * x and
+  // 3 * x + 1 hold channel pairs (0, 1) and (1, 2) and products two elements
+  // apart at 3 * x hold channel pair (0, 2).
+  const int row_size = 3 * diameter;
+  scratch->sums.setZero(row_size);
+  scratch->squares.setZero(row_size);
+  scratch->products_1.setZero(row_size - 1);
+  scratch->products_2.setZero(row_size - 2);
+  auto& row = scratch->row;
   for (int y = 0; y < diameter; ++y) {
-    const uint8_t* data = rgb_window.ptr<uint8_t>(y);
-    for (int x = 0; x < diameter; ++x, data += 3) {
-      for (int c = 0; c < 3; ++c) {
-        sum[c] += data[c];
-      }
-    }
+    row = Eigen::Map<const Eigen::Array<uint8_t, Eigen::Dynamic, 1>>(
+              rgb_window.ptr<uint8_t>(y), row_size)
+              .cast<int>();
+    scratch->sums += row;
+    scratch->squares += row * row;
+    scratch->products_1 += row.head(row_size - 1) * row.tail(row_size - 1);
+    scratch->products_2 += row.head(row_size - 2) * row.tail(row_size - 2);
+  }
+
+  // Compute channel sums and means.
+  int sum[3];
+  for (int c = 0; c < 3; ++c) {
+    sum[c] = SumEveryThird(scratch->sums, c, diameter);
   }
   const float scale = 1.f / (diameter * diameter);
   for (int c = 0; c < 3; ++c) {
@@ -165,23 +199,23 @@ void GetPatchDescriptorAtPoint(const cv::Mat& rgb_frame, const Vector2_i& pt,
 
   // Compute the channel dot products, after centering around the respective
   // channel means. Only computing upper triangular part.
+  // We want to compute
+  //     sum_{x,y}[(data[c] - mean[c]) * (data[d] - mean[d])],
+  // which simplifies to
+  //     sum_{x,y}[data[c] * data[d]] - sum[c] * sum[d] / N
+  // using N = diameter * diameter and sum[c] = N * mean[c].
   int product[3][3];
   for (int c = 0; c < 3; ++c) {
     for (int d = c; d < 3; ++d) {
-      // We want to compute
-      //     sum_{x,y}[(data[c] - mean[c]) * (data[d] - mean[d])],
-      // which simplifies to
-      //     sum_{x,y}[data[c] * data[d]] - sum[c] * sum[d] / N
-      // using N = diameter * diameter and sum[c] = N * mean[c].
       product[c][d] = -sum[c] * sum[d] * denom;
-      for (int y = 0; y < diameter; ++y) {
-        const uint8_t* data = rgb_window.ptr<uint8_t>(y);
-        for (int x = 0; x < diameter; ++x, data += 3) {
-          product[c][d] += static_cast<int>(data[c]) * data[d];
-        }
-      }
     }
   }
+  for (int c = 0; c < 3; ++c) {
+    product[c][c] += SumEveryThird(scratch->squares, c, diameter);
+  }
+  product[0][1] += SumEveryThird(scratch->products_1, 0, diameter);
+  product[1][2] += SumEveryThird(scratch->products_1, 1, diameter);
+  product[0][2] += SumEveryThird(scratch->products_2, 0, diameter);
 
   // Finally, add the descriptors only storring upper triangular part.
   for (int c = 0; c < 3; ++c) {
@@ -202,7 +236,7 @@ class PatchDescriptorInvoker {
         features_(features) {}
 
   void operator()(const BlockedRange& range) const {
-    cv::Mat lab_window;  // To avoid repeated allocations below.
+    PatchDescriptorScratch scratch;  // To avoid repeated allocations below.
     for (int feature_idx = range.begin(); feature_idx != range.end();
          ++feature_idx) {
       RegionFlowFeature* feature = features_->mutable_feature(feature_idx);
@@ -211,7 +245,7 @@ class PatchDescriptorInvoker {
       DCHECK_GE(pt.y(), radius_);
       DCHECK_LT(pt.x(), rgb_frame_.cols - radius_);
       DCHECK_LT(pt.y(), rgb_frame_.rows - radius_);
-      GetPatchDescriptorAtPoint(rgb_frame_, pt, radius_, &lab_window,
+      GetPatchDescriptorAtPoint(rgb_frame_, pt, radius_, &scratch,
                                 feature->mutable_feature_descriptor());
 
       if (prev_rgb_frame_) {
@@ -221,7 +255,7 @@ class PatchDescriptorInvoker {
         DCHECK_LT(pt_match.x(), rgb_frame_.cols - radius_);
         DCHECK_LT(pt_match.y(), rgb_frame_.rows - radius_);
         GetPatchDescriptorAtPoint(*prev_rgb_frame_, pt_match, radius_,
-                                  &lab_window,
+                                  &scratch,
                                   feature->mutable_feature_match_descriptor());
       }
     }
@@ -1485,6 +1519,30 @@ struct FloatPointerComparator {
   }
 };
 
+// Appends pointers to the values in eig that are local maxima, i.e. equal to
+// their dilated value in tmp, and greater than lowest_quality. Most values are
+// below lowest_quality, so blocks of values are first rejected by their
+// (vectorized) maximum.
+void AppendLocalMaxima(const float* tmp, const float* eig, int size,
+                       double lowest_quality,
+                       std::vector<const float*>* local_maxima) {
+  constexpr int kBlockSize = 16;
+  for (int block = 0; block < size; block += kBlockSize) {
+    const int block_end = min(size, block + kBlockSize);
+    if (Eigen::Map<const Eigen::ArrayXf>(tmp + block, block_end - block)
+            .maxCoeff<Eigen::PropagateNaN>() <= lowest_quality) {
+      continue;
+    }
+    for (int j = block; j < block_end; ++j) {
+      const float max_supp_value = tmp[j];
+      if (max_supp_value > lowest_quality && max_supp_value == eig[j]) {
+        // This is a local maxima -> store in list.
+        local_maxima->push_back(eig + j);
+      }
+    }
+  }
+}
+
 // Invoker for ParallelFor. Needs to be copyable.
 // Extracts features from a 2nd moment gradient response image (eig_image)
 // by grid-based thresholding (removing feature responses below
@@ -1561,9 +1619,9 @@ class GridFeatureLocator {
           cv::Mat dilate_dst =
               cv::Mat(tmp_view, cv::Range(1, tmp_view.rows - 1),
                       cv::Range(1, tmp_view.cols - 1));
-          cv::Mat kernel(3, 3, CV_32F);
-          kernel.setTo(1.0);
-          cv::dilate(dilate_src, dilate_dst, kernel);
+          // An empty kernel selects the 3x3 rectangle without allocating a
+          // kernel per cell.
+          cv::dilate(dilate_src, dilate_dst, cv::Mat());
         }
 
         const int grid_pos = bin_y * bins_per_row_ + bin_x;
@@ -1572,16 +1630,9 @@ class GridFeatureLocator {
         // Iterate over view in image domain as we store feature location
         // pointers w.r.t. original frame.
         for (int i = view_y; i < view_end_y; ++i) {
-          const float* tmp_ptr = tmp_image_->ptr<float>(i);
-          const float* eig_ptr = eig_image_->ptr<float>(i);
-          for (int j = view_x; j < view_end_x; ++j) {
-            const float max_supp_value = tmp_ptr[j];
-            if (max_supp_value > lowest_quality &&
-                max_supp_value == eig_ptr[j]) {
-              // This is a local maxima -> store in list.
-              grid_cell.push_back(eig_ptr + j);
-            }
-          }
+          AppendLocalMaxima(tmp_image_->ptr<float>(i) + view_x,
+                            eig_image_->ptr<float>(i) + view_x,
+                            view_end_x - view_x, lowest_quality, &grid_cell);
         }
 
         const int level_max_elems =
@@ -1793,9 +1844,14 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
           break;
         }
 
-        std::vector<std::vector<const float*>> corner_pointers(num_bins);
+        // Bins are reused across levels and frames, keeping their capacity.
+        std::vector<std::vector<const float*>>& corner_pointers =
+            corner_pointers_;
+        if (corner_pointers.size() < num_bins) {
+          corner_pointers.resize(num_bins);
+        }
         for (int k = 0; k < num_bins; ++k) {
-          corner_pointers[k].reserve(level_max_features);
+          corner_pointers[k].clear();
         }
 
         GridFeatureLocator locator(
@@ -1810,7 +1866,8 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
         bool more_features_available = true;
 
         // Index of next to be processed corner in corner_points[k] array.
-        std::vector<int> corner_index(num_bins, 0);
+        std::vector<int>& corner_index = corner_index_;
+        corner_index.assign(num_bins, 0);
         while (more_features_available &&
                data->features.size() < max_features) {
           more_features_available = false;
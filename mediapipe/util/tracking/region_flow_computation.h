@@ -430,6 +430,11 @@ class RegionFlowComputation {
   std::unique_ptr<cv::Mat> feature_tmp_image_1_;
   std::unique_ptr<cv::Mat> feature_tmp_image_2_;
 
+  // Scratch space for AdaptiveGoodFeaturesToTrack: per grid bin pointers to
+  // local maxima of the corner response and the index of the next one to add.
+  std::vector<std::vector<const float*>> corner_pointers_;
+  std::vector<int> corner_index_;
+
   std::vector<uint8> feature_status_;       // Indicates if point could be
                                             // tracked.
   std::vector<float> feature_track_error_;  // Patch-based error.
@@ -0,0 +1,83 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures RegionFlowComputation per frame, including feature extraction,
+// tracking and patch descriptors, on 720p and 1080p movies made by displacing
+// the tracking test image.
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+#include "mediapipe/util/tracking/region_flow_computation.h"
+#include "mediapipe/util/tracking/region_flow_computation.pb.h"
+#include "mediapipe/util/tracking/region_flow_computation_test_util.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 16;
+constexpr int kBorder = 40;
+
+// Creates a movie of the given size from the resized tracking test image.
+std::vector<cv::Mat> MakeMovie(int width, int height) {
+  cv::Mat image;
+  cv::resize(LoadTrackingTestImage(), image,
+             cv::Size(width + 2 * kBorder, height + 2 * kBorder));
+  return MakeTrackingTestMovie(image, kNumFrames, kBorder, /*max_step=*/5,
+                               RegionFlowComputationOptions::FORMAT_RGB,
+                               /*seed=*/1);
+}
+
+void BM_RegionFlowComputation(benchmark::State& state) {
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::vector<cv::Mat> movie = MakeMovie(width, height);
+
+  RegionFlowComputationOptions options;
+  options.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  RegionFlowComputation flow_computation(options, width, height);
+
+  int frame = 0;
+  int64_t num_features = 0;
+  for (auto _ : state) {
+    const int curr = frame % kNumFrames;
+    const int prev = (frame + kNumFrames - 1) % kNumFrames;
+    CHECK(flow_computation.AddImage(movie[curr], frame * 33333));
+    std::unique_ptr<RegionFlowFeatureList> features(
+        flow_computation.RetrieveRegionFlowFeatureList(
+            /*compute_feature_descriptor=*/true,
+            /*compute_match_descriptor=*/frame > 0, &movie[curr],
+            frame > 0 ? &movie[prev] : nullptr));
+    num_features += features->feature_size();
+    ++frame;
+  }
+  state.counters["features"] =
+      benchmark::Counter(num_features, benchmark::Counter::kAvgIterations);
+  state.counters["frames"] =
+      benchmark::Counter(frame, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RegionFlowComputation)
+    ->Args({1280, 720})
+    ->Args({1920, 1080})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -16,24 +16,20 @@
 
 #include <math.h>
 
-#include <algorithm>
+#include <cstdint>
 #include <memory>
-#include <random>
-#include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/time/clock.h"
-#include "mediapipe/framework/deps/file_path.h"
-#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
-#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
-#include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/vector.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
+#include "mediapipe/util/tracking/region_flow_computation_test_util.h"
 
 // To ensure that the selected thresholds are robust, it is recommend
 // to run this test mutiple times with time seed, if changes are made.
@@ -42,8 +38,6 @@ ABSL_FLAG(bool, time_seed, false, "Activate to test thresholds");
 namespace mediapipe {
 namespace {
 
-using RandomEngine = std::mt19937_64;
-
 struct FlowDirectionParam {
   TrackingOptions::FlowDirection internal_direction;
   TrackingOptions::FlowDirection output_direction;
@@ -60,15 +54,7 @@ class RegionFlowComputationTest
     tracking_options->set_output_flow_direction(param.output_direction);
 
     // Load bee image.
-    data_dir_ = file::JoinPath("./", "/mediapipe/util/tracking/testdata/");
-
-    std::string png_data;
-    MEDIAPIPE_CHECK_OK(
-        file::GetContents(data_dir_ + "stabilize_test.png", &png_data));
-    std::vector<char> buffer(png_data.begin(), png_data.end());
-    original_frame_ = cv::imdecode(cv::Mat(buffer), 1);
-    ASSERT_FALSE(original_frame_.empty());
-    ASSERT_EQ(original_frame_.type(), CV_8UC3);
+    original_frame_ = LoadTrackingTestImage();
   }
 
   // Creates a movie in the specified format by displacing original_frame_ to
@@ -87,10 +73,50 @@ class RegionFlowComputationTest
   RegionFlowComputationOptions base_options_;
 
  private:
-  std::string data_dir_;
   cv::Mat original_frame_;
 };
 
+// Returns the patch descriptor of the window of the given radius around pt,
+// i.e. the channel means followed by the upper triangular part of the channel
+// covariance, computed with one scalar pass over the window per entry.
+std::vector<float> ComputePatchDescriptor(const cv::Mat& rgb_frame,
+                                          const Vector2_i& pt, int radius) {
+  const int diameter = 2 * radius + 1;
+  const cv::Mat rgb_window =
+      rgb_frame(cv::Rect(pt.x() - radius, pt.y() - radius, diameter, diameter));
+  const float scale = 1.f / (diameter * diameter);
+
+  std::vector<float> descriptor;
+  int sum[3] = {0, 0, 0};
+  for (int y = 0; y < diameter; ++y) {
+    const uint8_t* data = rgb_window.ptr<uint8_t>(y);
+    for (int x = 0; x < diameter; ++x, data += 3) {
+      for (int c = 0; c < 3; ++c) {
+        sum[c] += data[c];
+      }
+    }
+  }
+  for (int c = 0; c < 3; ++c) {
+    descriptor.push_back(sum[c] * scale);
+  }
+
+  for (int c = 0; c < 3; ++c) {
+    for (int d = c; d < 3; ++d) {
+      // The mean correction is truncated to an int, as in
+      // RegionFlowComputation.
+      int product = -sum[c] * sum[d] * scale;
+      for (int y = 0; y < diameter; ++y) {
+        const uint8_t* data = rgb_window.ptr<uint8_t>(y);
+        for (int x = 0; x < diameter; ++x, data += 3) {
+          product += static_cast<int>(data[c]) * data[d];
+        }
+      }
+      descriptor.push_back(product * scale);
+    }
+  }
+  return descriptor;
+}
+
 std::vector<FlowDirectionParam> FlowDirectionCombinations() {
   return {{TrackingOptions::FORWARD, TrackingOptions::FORWARD},
           {TrackingOptions::FORWARD, TrackingOptions::BACKWARD},
@@ -107,73 +133,13 @@ void RegionFlowComputationTest::MakeMovie(
   CHECK(positions != nullptr);
   CHECK(movie != nullptr);
 
-  const int border = 40;
-  int frame_width = original_frame_.cols - 2 * border;
-  int frame_height = original_frame_.rows - 2 * border;
-  ASSERT_GT(frame_width, 0);
-  ASSERT_GT(frame_height, 0);
-
-  // First generate random positions.
   int seed = 900913;  // google.
   if (absl::GetFlag(FLAGS_time_seed)) {
     seed = ToUnixMillis(absl::Now()) % (1 << 16);
     LOG(INFO) << "Using time seed: " << seed;
   }
-
-  RandomEngine random(seed);
-  std::uniform_int_distribution<> uniform_dist(-10, 10);
-  positions->resize(num_frames);
-  (*positions)[0] = Vector2_f(border, border);
-  for (int f = 1; f < num_frames; ++f) {
-    Vector2_f pos = (*positions)[f - 1] +
-                    Vector2_f(uniform_dist(random), uniform_dist(random));
-
-    // Clamp to valid positions.
-    pos.x(std::max<int>(0, pos.x()));
-    pos.y(std::max<int>(0, pos.y()));
-    pos.x(std::min<int>(2 * border, pos.x()));
-    pos.y(std::min<int>(2 * border, pos.y()));
-
-    (*positions)[f] = pos;
-  }
-
-  // Create movie by copying.
-  movie->resize(num_frames);
-  cv::Mat original_frame = original_frame_;
-
-  auto convert = [&](int channel_format, int conversion_code) {
-    original_frame.create(original_frame_.rows, original_frame_.cols,
-                          channel_format);
-    cv::cvtColor(original_frame_, original_frame, conversion_code);
-  };
-
-  switch (format) {
-    case RegionFlowComputationOptions::FORMAT_RGB:
-      break;
-
-    case RegionFlowComputationOptions::FORMAT_BGR:
-      convert(CV_8UC3, cv::COLOR_RGB2BGR);
-      break;
-
-    case RegionFlowComputationOptions::FORMAT_GRAYSCALE:
-      convert(CV_8UC1, cv::COLOR_RGB2GRAY);
-      break;
-
-    case RegionFlowComputationOptions::FORMAT_RGBA:
-      convert(CV_8UC4, cv::COLOR_RGB2RGBA);
-      break;
-
-    case RegionFlowComputationOptions::FORMAT_BGRA:
-      convert(CV_8UC4, cv::COLOR_RGB2BGRA);
-      break;
-  }
-  for (int f = 0; f < num_frames; ++f) {
-    (*movie)[f].create(frame_height, frame_width, original_frame.type());
-    const auto& pos = (*positions)[f];
-    cv::Mat tmp_view(original_frame, cv::Range(pos.y(), pos.y() + frame_height),
-                     cv::Range(pos.x(), pos.x() + frame_width));
-    tmp_view.copyTo((*movie)[f]);
-  }
+  *movie = MakeTrackingTestMovie(original_frame_, num_frames, /*border=*/40,
+                                 /*max_step=*/10, format, seed, positions);
 }
 
 void RegionFlowComputationTest::GetResizedFrame(int width, int height,
@@ -251,6 +217,41 @@ TEST_P(RegionFlowComputationTest, FramePairTest) {
   RunFramePairTest(RegionFlowComputationOptions::FORMAT_BGRA);
 }
 
+TEST_P(RegionFlowComputationTest, PatchDescriptors) {
+  std::vector<cv::Mat> movie;
+  std::vector<Vector2_f> positions;
+  const int num_frames = 4;
+  MakeMovie(num_frames, RegionFlowComputationOptions::FORMAT_RGB, &movie,
+            &positions);
+
+  base_options_.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  RegionFlowComputation flow_computation(base_options_, movie[0].cols,
+                                         movie[0].rows);
+  const int radius = base_options_.patch_descriptor_radius();
+
+  for (int i = 0; i < num_frames; ++i) {
+    flow_computation.AddImage(movie[i], 0);
+    const cv::Mat* prev_frame = i > 0 ? &movie[i - 1] : nullptr;
+    std::unique_ptr<RegionFlowFeatureList> feature_list(
+        flow_computation.RetrieveRegionFlowFeatureList(
+            /*compute_feature_descriptor=*/true,
+            /*compute_match_descriptor=*/i > 0, &movie[i], prev_frame));
+    if (i == 0) {
+      continue;
+    }
+    ASSERT_GT(feature_list->feature_size(), 0);
+    // The descriptors must match the scalar computation exactly.
+    for (const auto& feature : feature_list->feature()) {
+      EXPECT_THAT(feature.feature_descriptor().data(),
+                  testing::ElementsAreArray(ComputePatchDescriptor(
+                      movie[i], FeatureIntLocation(feature), radius)));
+      EXPECT_THAT(feature.feature_match_descriptor().data(),
+                  testing::ElementsAreArray(ComputePatchDescriptor(
+                      *prev_frame, FeatureMatchIntLocation(feature), radius)));
+    }
+  }
+}
+
 TEST_P(RegionFlowComputationTest, ResolutionTests) {
   // Test all kinds of resolutions (disregard resulting flow).
   // Square test, synthetic tracks.
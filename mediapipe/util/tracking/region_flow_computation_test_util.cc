@@ -0,0 +1,106 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/region_flow_computation_test_util.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+cv::Mat LoadTrackingTestImage() {
+  std::string png_data;
+  MEDIAPIPE_CHECK_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/",
+                     "stabilize_test.png"),
+      &png_data));
+  std::vector<char> buffer(png_data.begin(), png_data.end());
+  cv::Mat image = cv::imdecode(cv::Mat(buffer), 1);
+  CHECK(!image.empty());
+  CHECK_EQ(image.type(), CV_8UC3);
+  return image;
+}
+
+std::vector<cv::Mat> MakeTrackingTestMovie(
+    const cv::Mat& image, int num_frames, int border, int max_step,
+    RegionFlowComputationOptions::ImageFormat format, int seed,
+    std::vector<Vector2_f>* positions) {
+  const int frame_width = image.cols - 2 * border;
+  const int frame_height = image.rows - 2 * border;
+  CHECK_GT(frame_width, 0);
+  CHECK_GT(frame_height, 0);
+
+  // First generate random positions.
+  std::mt19937_64 random(seed);
+  std::uniform_int_distribution<> uniform_dist(-max_step, max_step);
+  std::vector<Vector2_f> frame_positions(num_frames);
+  frame_positions[0] = Vector2_f(border, border);
+  for (int f = 1; f < num_frames; ++f) {
+    Vector2_f pos = frame_positions[f - 1] +
+                    Vector2_f(uniform_dist(random), uniform_dist(random));
+
+    // Clamp to valid positions.
+    pos.x(std::clamp<int>(pos.x(), 0, 2 * border));
+    pos.y(std::clamp<int>(pos.y(), 0, 2 * border));
+
+    frame_positions[f] = pos;
+  }
+
+  cv::Mat converted;
+  switch (format) {
+    case RegionFlowComputationOptions::FORMAT_RGB:
+      converted = image;
+      break;
+
+    case RegionFlowComputationOptions::FORMAT_BGR:
+      cv::cvtColor(image, converted, cv::COLOR_RGB2BGR);
+      break;
+
+    case RegionFlowComputationOptions::FORMAT_GRAYSCALE:
+      cv::cvtColor(image, converted, cv::COLOR_RGB2GRAY);
+      break;
+
+    case RegionFlowComputationOptions::FORMAT_RGBA:
+      cv::cvtColor(image, converted, cv::COLOR_RGB2RGBA);
+      break;
+
+    case RegionFlowComputationOptions::FORMAT_BGRA:
+      cv::cvtColor(image, converted, cv::COLOR_RGB2BGRA);
+      break;
+  }
+
+  // Create movie by copying.
+  std::vector<cv::Mat> movie(num_frames);
+  for (int f = 0; f < num_frames; ++f) {
+    const auto& pos = frame_positions[f];
+    converted(cv::Rect(pos.x(), pos.y(), frame_width, frame_height))
+        .copyTo(movie[f]);
+  }
+  if (positions != nullptr) {
+    *positions = std::move(frame_positions);
+  }
+  return movie;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,44 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Synthetic movies for RegionFlowComputation tests and benchmarks.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_REGION_FLOW_COMPUTATION_TEST_UTIL_H_
+#define MEDIAPIPE_UTIL_TRACKING_REGION_FLOW_COMPUTATION_TEST_UTIL_H_
+
+#include <vector>
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/region_flow_computation.pb.h"
+
+namespace mediapipe {
+
+// Returns testdata/stabilize_test.png as a CV_8UC3 image.
+cv::Mat LoadTrackingTestImage();
+
+// Creates a movie of num_frames frames in the specified format by displacing
+// image to random positions. Frames are 2 * border pixels narrower and
+// shorter than image. The first frame is centered in image and each following
+// one moves by up to max_step pixels in x and y, staying within image.
+// If positions is not null, it receives the top-left corner of each frame in
+// image.
+std::vector<cv::Mat> MakeTrackingTestMovie(
+    const cv::Mat& image, int num_frames, int border, int max_step,
+    RegionFlowComputationOptions::ImageFormat format, int seed,
+    std::vector<Vector2_f>* positions = nullptr);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_REGION_FLOW_COMPUTATION_TEST_UTIL_H_